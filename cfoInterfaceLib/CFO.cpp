@@ -21,7 +21,7 @@
 #include <sstream>  // Convert uint to hex string
 
 CFOLib::CFO::CFO(DTC_SimMode mode, int cfo, std::string expectedDesignVersion, bool skipInit, const std::string& uid)
-	: CFO_Registers(mode, cfo, expectedDesignVersion, skipInit, uid), daqDMAInfo_()//, dcsDMAInfo_()
+	: CFO_Registers(mode, cfo, expectedDesignVersion, skipInit, uid), daqDMAInfo_(), recordReader_(device_)//, dcsDMAInfo_()
 {
 	__COUT_INFO__ << "CONSTRUCTOR";
 }
@@ -604,6 +604,7 @@ void CFOLib::CFO::ReleaseAllBuffers(const DTC_DMA_Engine& channel)
 	if (channel == DTC_DMA_Engine_DAQ)
 	{
 		daqDMAInfo_.buffer.clear();
+		recordReader_.Reset();
 		device_.release_all(channel);
 	}
 	// else if (channel == CFO_DMA_Engine_RunPlan)
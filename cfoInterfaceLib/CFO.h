@@ -12,6 +12,7 @@
 #include "artdaq-core-mu2e/Overlays/CFO_Packets/CFO_EventRecord.h"
 #include "artdaq-core-mu2e/Overlays/CFO_Packets/CFO_PacketType.h"
 
+#include "CFO_RecordReader.h"
 #include "CFO_Registers.h"
 #include "dtcInterfaceLib/CFOandDTC_DMAs.h"
 
@@ -80,6 +81,19 @@ public:
 	*/
 	bool ReadNextCFORecordDMA(std::vector<std::unique_ptr<CFO_Event>>& output, int tmo_ms );
 
+	/// <summary>
+	/// Read the CFO records of all DAQ DMA buffers which are ready, without copying them (see CFO_RecordReader). The
+	/// buffers of the previous batch are released first, in one call. Do not mix with GetData.
+	/// </summary>
+	/// <param name="batch">Batch to fill; the records are valid until the next ReadRecordBatch or ReleaseRecordBatch</param>
+	/// <param name="tmo_ms">Time to wait for the first DMA buffer</param>
+	/// <returns>Number of records read; 0 on timeout</returns>
+	size_t ReadRecordBatch(CFO_RecordBatch& batch, int tmo_ms) { return recordReader_.ReadBatch(batch, tmo_ms); }
+	/// <summary>
+	/// Release the DAQ DMA buffers of the last ReadRecordBatch
+	/// </summary>
+	void ReleaseRecordBatch() { recordReader_.Release(); }
+
 	/// <summary>
 	/// Release all buffers to the hardware on the given channel
 	/// </summary>
@@ -115,6 +129,7 @@ private:
 	// int GetCurrentBuffer(DMAInfo* info);
 	// uint16_t GetBufferByteCount(DMAInfo* info, size_t index);
 	CFOandDTC_DMAs::DMAInfo daqDMAInfo_;
+	CFO_RecordReader recordReader_;
 	// DMAInfo dcsDMAInfo_;
 
 	// uint8_t lastDTCErrorBitsValue_ = 0;
@@ -1,5 +1,6 @@
 #include "cfoInterfaceLib/CFO_Compiler.hh"
 
+#include <iomanip>
 #include <iostream>
 #include <set>
 
@@ -26,6 +27,9 @@ bool        			getNumber					(const std::string& s, T& retValue);
 
 
 const std::string	CFOLib::CFO_Compiler::MAIN_GOTO_LABEL = "MAIN";
+const uint64_t		CFOLib::CFO_Compiler::PARAMETER_MASK;
+std::mutex			CFOLib::CFO_Compiler::cacheMutex_;
+std::map<uint64_t, CFOLib::CFO_Compiler::CachedRunPlan> CFOLib::CFO_Compiler::cache_;
 
 //========================================================================
 std::string CFOLib::CFO_Compiler::processFile(const std::string& sourceCodeFile, 
@@ -34,89 +38,55 @@ try
 {
 	__COUT_INFO__ << "CFO_Compiler::processFile BEGIN";
 
-	FILE* fp = fopen(sourceCodeFile.c_str(),"r");
-	if(!fp)
+	std::ifstream sourceFile(sourceCodeFile);
+	if(!sourceFile)
 	{
 		__SS__ << "Input File (" << sourceCodeFile << ") didn't open. Does it exist?" << __E__;
 		__SS_THROW__;
 	}
-	
-	std::string line;
-	char lineChars[100];
-		
-
-	txtLineNumber_ = 0;
-	binLineNumber_ = 0;
-	hasRequiredPlanEndOp_ = false; //require at least one END, REPEAT, or GOTO MAIN command to give a handle on switch Run Plan buffers to the CFO firmware
-
-	loopStack_.clear();
-	labelMap_.clear();
-
-	output_.clear();
-
-	//main line processing loop
-	while(fgets(lineChars,100,fp))
+	std::stringstream sourceSs;
+	sourceSs << sourceFile.rdbuf();
+	const std::string source = sourceSs.str();
+
+	//compile cache: the same source text with the same options compiles to the same binary
+	uint64_t sourceHash = 0xcbf29ce484222325; //FNV-1a
+	for (auto c : source)
+		sourceHash = (sourceHash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+	sourceHash ^= optimize_ ? 1 : 0;
+	sourceHash = (sourceHash ^ clocksPerInstruction_) * 0x100000001b3;
+
+	cached_ = false;
 	{
-		line = lineChars;
-		while(strlen(lineChars) && lineChars[strlen(lineChars)-1] != '\n' && fgets(lineChars,100,fp))
-			line += lineChars;
-	
-		++txtLineNumber_; 
-		__COUT__ << "Line number " << txtLineNumber_ << ": " << line << __E__;
-		
-		if (isComment(line)) 
-		{ 
-			__COUT__ << txtLineNumber_ << ": is comment" << __E__; 
-			continue; 
-		}
-
-		//read all arguments
-		opArguments_.clear();
-		getVectorFromString(line,opArguments_, 
-			{',', ' ', '\t', ';', '='} /*delimiter*/,
-			{'\n','\r'} /*white space (empty because white space is a delimiter)*/);
-
-		//clean up empty strings (because of white space delimiter) and comments
-		for(size_t i=0;i<opArguments_.size();++i)
-			if(opArguments_[i].length() == 0) 
-				opArguments_.erase(opArguments_.begin() + i--); //erase and rewind
-			else if(opArguments_[i].length() >= 2  && 
-				opArguments_[i][0] == '/' && opArguments_[i][1] == '/') //comment to the end
-			{
-				//erase remainder of arguments because they are commented out
-				while(i<opArguments_.size())
-					opArguments_.erase(opArguments_.begin() + i); //erase
-				break;
-			}
-
-		__COUTV__(opArguments_.size());
-		__COUTV__(vectorToString(opArguments_));
-
-		if(!opArguments_.size()) //skip no arguments		
-		{ 
-			__COUT__ << txtLineNumber_ << ": is empty" << __E__; 
-			continue; 
+		std::lock_guard<std::mutex> lock(cacheMutex_);
+		auto it = cache_.find(sourceHash);
+		if(it != cache_.end() && it->second.source == source)
+		{
+			ops_ = it->second.ops;
+			output_ = it->second.output;
+			compiledInstructionCount_ = it->second.compiledInstructionCount;
+			optimizedInstructionCount_ = it->second.optimizedInstructionCount;
+			cached_ = true;
+			__COUT_INFO__ << "Run plan source unchanged since it was last compiled, using the cached binary." << __E__;
 		}
+	}
 
-		// CFOLib::CFO_Compiler::CFO_MACRO macroOpTest = parseMacro(opArguments_[0]);
-		// if(macroOpTest == CFO_MACRO::NON_MACRO)
-		processOp();
-		// else
-		// 	processMacro(macroOpTest);
-
-	} //end main processing loop
-
-	if(!hasRequiredPlanEndOp_)
+	if(!cached_)
 	{
-		__SS__ << "The Run Plan is missing an concluding operation that can be used as a moment to dynamically swith to the next run plan."
-			" At least one of these commands is required in your run plan: END, REPEAT, or GOTO MAIN." << __E__;
-		__SS_THROW__;
+		compileSource(source);
+
+		std::lock_guard<std::mutex> lock(cacheMutex_);
+		if(cache_.size() >= 64) cache_.clear(); //keep the cache bounded; run plans are small and few
+		cache_[sourceHash] = {source, ops_, output_, compiledInstructionCount_, optimizedInstructionCount_};
 	}
 
-	
+	__COUT_INFO__ << "Run plan has " << compiledInstructionCount_ << " instructions, " << 
+		optimizedInstructionCount_ << " after optimization." << __E__;
+
 	std::stringstream resultSs;
 	resultSs << "Run plan text file: " << sourceCodeFile << __E__ <<
 		"was compiled to binary: " << binaryOutputFile << __E__;
+	resultSs << "Instructions: " << compiledInstructionCount_ << " compiled, " << 
+		optimizedInstructionCount_ << " after optimization" << (cached_ ? " (cached)" : "") << __E__;
 	resultSs << "\n\nBinary Result:\n";
 	int cnt = 0;
 
@@ -198,6 +168,88 @@ catch(...)
 	throw;
 }	// end processFile() error handling
 
+//========================================================================
+// compileSource
+//		Parses the run plan source text into ops_, optimizes and encodes them into output_
+void CFOLib::CFO_Compiler::compileSource(const std::string& source)
+{
+	std::istringstream sourceLines(source);
+	std::string line;
+
+	txtLineNumber_ = 0;
+	binLineNumber_ = 0;
+	hasRequiredPlanEndOp_ = false; //require at least one END, REPEAT, or GOTO MAIN command to give a handle on switch Run Plan buffers to the CFO firmware
+
+	loopStack_.clear();
+	labelMap_.clear();
+
+	ops_.clear();
+	output_.clear();
+
+	//main line processing loop
+	while(std::getline(sourceLines, line))
+	{
+		line += '\n';
+	
+		++txtLineNumber_; 
+		__COUT__ << "Line number " << txtLineNumber_ << ": " << line << __E__;
+		
+		if (isComment(line)) 
+		{ 
+			__COUT__ << txtLineNumber_ << ": is comment" << __E__; 
+			continue; 
+		}
+
+		//read all arguments
+		opArguments_.clear();
+		getVectorFromString(line,opArguments_, 
+			{',', ' ', '\t', ';', '='} /*delimiter*/,
+			{'\n','\r'} /*white space (empty because white space is a delimiter)*/);
+
+		//clean up empty strings (because of white space delimiter) and comments
+		for(size_t i=0;i<opArguments_.size();++i)
+			if(opArguments_[i].length() == 0) 
+				opArguments_.erase(opArguments_.begin() + i--); //erase and rewind
+			else if(opArguments_[i].length() >= 2  && 
+				opArguments_[i][0] == '/' && opArguments_[i][1] == '/') //comment to the end
+			{
+				//erase remainder of arguments because they are commented out
+				while(i<opArguments_.size())
+					opArguments_.erase(opArguments_.begin() + i); //erase
+				break;
+			}
+
+		__COUTV__(opArguments_.size());
+		__COUTV__(vectorToString(opArguments_));
+
+		if(!opArguments_.size()) //skip no arguments		
+		{ 
+			__COUT__ << txtLineNumber_ << ": is empty" << __E__; 
+			continue; 
+		}
+
+		// CFOLib::CFO_Compiler::CFO_MACRO macroOpTest = parseMacro(opArguments_[0]);
+		// if(macroOpTest == CFO_MACRO::NON_MACRO)
+		processOp();
+		// else
+		// 	processMacro(macroOpTest);
+
+	} //end main processing loop
+
+	if(!hasRequiredPlanEndOp_)
+	{
+		__SS__ << "The Run Plan is missing an concluding operation that can be used as a moment to dynamically swith to the next run plan."
+			" At least one of these commands is required in your run plan: END, REPEAT, or GOTO MAIN." << __E__;
+		__SS_THROW__;
+	}
+
+	compiledInstructionCount_ = ops_.size();
+	if(optimize_)
+		optimizeOps(ops_, clocksPerInstruction_);
+	optimizedInstructionCount_ = ops_.size();
+	encodeOps();
+} //end compileSource()
+
 //========================================================================
 // Boolean Operators
 bool CFOLib::CFO_Compiler::isComment(const std::string& line)  // Checks if line has a comment.
@@ -304,13 +356,14 @@ void CFOLib::CFO_Compiler::outParameter(uint64_t paramBuf)  // Writes the 6 byte
 
 //========================================================================
 // processOp
-// 		Outputs a byte stream based on the buffers.
+// 		Appends the instruction(s) of the current source line to ops_.
 //		opArguments_ must be checked before to be size >= 1
 void CFOLib::CFO_Compiler::processOp()  
 {
 	//calculate line numbers that match this hexdump call (all usage of bin is relative/differences):
 	//		hexdump -e '"%08_ax | " 1/8 "%016x "' -e '"\n"'  CFOCommands.bin | cat -n
-	binLineNumber_ = 1 + output_.size()/8;
+	//	(before optimization; encodeOps resolves the final loop and goto targets)
+	binLineNumber_ = 1 + ops_.size();
 	__COUT__ << "binLineNumber_: " << (int)binLineNumber_ << __E__;
 
 	CFO_INSTR instructionOpcode = parseInstruction(opArguments_[0]);
@@ -330,34 +383,243 @@ void CFOLib::CFO_Compiler::processOp()
 	{
 		__COUT__ << "MASK off 0x" << std::hex << modeClearMask_ << __E__;
 		//treat as two ops: an AND and an OR
-		outParameter(modeClearMask_);
-		output_.push_back(0x00);
-		__COUT__ << "[" << output_.size() << "] ==> output_ 0x" << std::hex << std::setfill('0') << std::setprecision(2) << (uint16_t)output_.back() << __E__;
-		output_.push_back(static_cast<char>(CFO_INSTR::AND_MODE_BITS));
-		__COUT__ << "[" << output_.size() << "] ==> output_ 0x" << std::hex << std::setfill('0') << std::setprecision(2) << (uint16_t)output_.back() << __E__;
+		ops_.push_back({CFO_INSTR::AND_MODE_BITS, modeClearMask_ & PARAMETER_MASK});
 
 		instructionOpcode = CFO_INSTR::OR_MODE_BITS;
 		__COUT__ << "MASK on 0x" << std::hex << parameterCalc << __E__;
 	}
 
-	outParameter(parameterCalc);
-
 	if(instructionOpcode == CFO_INSTR::REPEAT ||
 		instructionOpcode == CFO_INSTR::END ||
 		instructionOpcode == CFO_INSTR::GOTO)
 			hasRequiredPlanEndOp_ = true;	
-	else if(instructionOpcode == CFO_INSTR::LABEL) //in binary, treat as NOOP
-		instructionOpcode = CFO_INSTR::NOOP;
 	else if(instructionOpcode == CFO_INSTR::CLEAR_MODE_BITS) //treat clear as AND
 		instructionOpcode = CFO_INSTR::AND_MODE_BITS;
 
-	output_.push_back(0x00);
-	__COUT__ << "[" << output_.size() << "] ==> output_ 0x" << std::hex << std::setfill('0') << std::setprecision(2) << (uint16_t)output_.back() << __E__;
-	output_.push_back(static_cast<char>(instructionOpcode));
-	__COUT__ << "[" << output_.size() << "] ==> output_ 0x" << std::hex << std::setfill('0') << std::setprecision(2) << (uint16_t)output_.back() << __E__;
-
+	ops_.push_back({instructionOpcode, static_cast<uint64_t>(parameterCalc) & PARAMETER_MASK});
 } //end processOp()
 
+//========================================================================
+// encodeOps
+//		Outputs a byte stream based on ops_: per instruction, the 6 byte parameter, a reserved byte, then the opcode.
+//		DO_LOOP parameters are the distance back to the LOOP, and GOTO parameters the line of the LABEL.
+void CFOLib::CFO_Compiler::encodeOps()
+{
+	output_.clear();
+
+	std::vector<size_t> loopLines;
+	uint64_t labelLine = 0;
+	for (size_t i = 0; i < ops_.size(); ++i)
+		if(ops_[i].instr == CFO_INSTR::LABEL)
+			labelLine = i + 1;
+
+	for (size_t i = 0; i < ops_.size(); ++i)
+	{
+		CFO_INSTR instructionOpcode = ops_[i].instr;
+		uint64_t parameter = ops_[i].parameter;
+
+		if(instructionOpcode == CFO_INSTR::LOOP)
+			loopLines.push_back(i + 1);
+		else if(instructionOpcode == CFO_INSTR::DO_LOOP)
+		{
+			parameter = (i + 1) - loopLines.back(); //loop nesting was checked while parsing
+			loopLines.pop_back();
+		}
+		else if(instructionOpcode == CFO_INSTR::GOTO)
+			parameter = labelLine;
+		else if(instructionOpcode == CFO_INSTR::LABEL) //in binary, treat as NOOP
+			instructionOpcode = CFO_INSTR::NOOP;
+
+		outParameter(parameter);
+		output_.push_back(0x00);
+		output_.push_back(static_cast<char>(instructionOpcode));
+		__COUT__ << "[" << output_.size() << "] ==> output_ 0x" << std::hex << std::setfill('0') << std::setprecision(2) << (uint16_t)output_.back() << __E__;
+	}
+} //end encodeOps()
+
+//========================================================================
+// optimizeOps
+//		Peephole optimization of a run plan. The result has the same timing, i.e. the same sequence of
+//		HEARTBEAT, MARKER and DATA_REQUEST instructions at the same times, with the same event window
+//		tags and event modes, as seen by CFO_RunPlanSimulator with the same clocksPerInstruction:
+//			- adjacent numeric WAITs are merged into one (WAIT NEXT RF0 is never merged)
+//			- adjacent SET_TAG/INC_TAG are folded into one, and INC_TAG 0 is removed
+//			- adjacent mode bit operations are folded into at most one AND followed by one OR
+//			- loops of a single numeric WAIT become one WAIT
+//			- if instructions take no time (clocksPerInstruction 0), LOOP 1, and loops whose unrolled
+//				body is shorter than the loop, are unrolled
+//		Each instruction takes clocksPerInstruction clocks, so every removed instruction adds that
+//		many clocks to a WAIT before it; an instruction is only removed if only tag and mode bit
+//		instructions lie between it and that WAIT. Nothing is moved across a LOOP, DO_LOOP or LABEL.
+void CFOLib::CFO_Compiler::optimizeOps(std::vector<CFO_OP>& ops, uint64_t clocksPerInstruction)
+{
+	std::vector<CFO_OP> out;
+	out.reserve(ops.size());
+	appendOptimizedBlock(out, ops, 0, ops.size(), clocksPerInstruction);
+	ops.swap(out);
+} //end optimizeOps()
+
+//========================================================================
+// appendOptimizedBlock
+//		Appends the optimized ops [begin, end) to out. Loops are optimized from the inside out.
+void CFOLib::CFO_Compiler::appendOptimizedBlock(std::vector<CFO_OP>& out, const std::vector<CFO_OP>& ops, size_t begin, size_t end,
+												uint64_t clocksPerInstruction)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		if(ops[i].instr != CFO_INSTR::LOOP)
+		{
+			appendOptimizedOp(out, ops[i], clocksPerInstruction);
+			continue;
+		}
+
+		//find the matching DO_LOOP
+		size_t doLoop = i + 1;
+		for (int depth = 1; doLoop < end; ++doLoop)
+		{
+			if(ops[doLoop].instr == CFO_INSTR::LOOP) ++depth;
+			else if(ops[doLoop].instr == CFO_INSTR::DO_LOOP && --depth == 0) break;
+		}
+		if(doLoop >= end) //unmatched loop, checked while parsing; leave as is
+		{
+			appendOptimizedOp(out, ops[i], clocksPerInstruction);
+			continue;
+		}
+
+		std::vector<CFO_OP> body;
+		appendOptimizedBlock(body, ops, i + 1, doLoop, clocksPerInstruction);
+		uint64_t count = ops[i].parameter;
+		uint64_t loopClocks = 2 * clocksPerInstruction; //WAIT and DO_LOOP of each iteration, on top of the delay
+
+		if(clocksPerInstruction == 0 && (count == 1 ||
+			(count > 1 && count * body.size() < body.size() + 2))) //unrolled is shorter than LOOP + body + DO_LOOP
+		{
+			for (uint64_t iteration = 0; iteration < count; ++iteration)
+				for (auto const& op : body)
+					appendOptimizedOp(out, op, clocksPerInstruction);
+		}
+		else if(count > 1 && body.size() == 1 && body[0].instr == CFO_INSTR::WAIT &&
+			body[0].parameter != PARAMETER_MASK && body[0].parameter + loopClocks < PARAMETER_MASK / count) //loop of a single delay
+		{
+			//LOOP takes clocksPerInstruction, and so does the WAIT replacing the loop
+			appendOptimizedOp(out, {CFO_INSTR::WAIT, (body[0].parameter + loopClocks) * count}, clocksPerInstruction);
+		}
+		else
+		{
+			out.push_back(ops[i]);
+			out.insert(out.end(), body.begin(), body.end());
+			out.push_back(ops[doLoop]);
+		}
+		i = doLoop;
+	}
+} //end appendOptimizedBlock()
+
+//========================================================================
+// absorbInstructionClocks
+//		Adds the execution time of an instruction about to be removed from the end of out to the last
+//		numeric WAIT of out, if only tag and mode bit instructions (which take effect at no observable
+//		time) follow it. Returns false if there is no such WAIT, i.e. the instruction must be kept.
+bool CFOLib::CFO_Compiler::absorbInstructionClocks(std::vector<CFO_OP>& out, uint64_t clocksPerInstruction)
+{
+	if(clocksPerInstruction == 0) return true;
+
+	for (auto op = out.rbegin(); op != out.rend(); ++op)
+	{
+		switch (op->instr)
+		{
+			case CFO_INSTR::SET_TAG:
+			case CFO_INSTR::INC_TAG:
+			case CFO_INSTR::AND_MODE_BITS:
+			case CFO_INSTR::OR_MODE_BITS:
+				continue;
+			case CFO_INSTR::WAIT:
+				if(op->parameter == PARAMETER_MASK || op->parameter + clocksPerInstruction >= PARAMETER_MASK) return false;
+				op->parameter += clocksPerInstruction;
+				return true;
+			default:
+				return false;
+		}
+	}
+	return false;
+} //end absorbInstructionClocks()
+
+//========================================================================
+// appendOptimizedOp
+//		Appends op to out, folding it into the last op of out where that keeps the same effect and timing
+void CFOLib::CFO_Compiler::appendOptimizedOp(std::vector<CFO_OP>& out, const CFO_OP& op, uint64_t clocksPerInstruction)
+{
+	if(((op.instr == CFO_INSTR::INC_TAG && op.parameter == 0) ||
+		(op.instr == CFO_INSTR::AND_MODE_BITS && op.parameter == PARAMETER_MASK) ||
+		(op.instr == CFO_INSTR::OR_MODE_BITS && op.parameter == 0)) &&
+		absorbInstructionClocks(out, clocksPerInstruction))
+		return;
+
+	if(!out.empty())
+	{
+		CFO_OP& last = out.back();
+		switch (op.instr)
+		{
+			case CFO_INSTR::WAIT:
+				if(last.instr == CFO_INSTR::WAIT && 
+					last.parameter != PARAMETER_MASK && op.parameter != PARAMETER_MASK &&
+					last.parameter + op.parameter + clocksPerInstruction < PARAMETER_MASK) //keep clear of the NEXT RF0 value
+				{
+					last.parameter += op.parameter + clocksPerInstruction;
+					return;
+				}
+				break;
+			case CFO_INSTR::INC_TAG:
+				if((last.instr == CFO_INSTR::INC_TAG || last.instr == CFO_INSTR::SET_TAG) &&
+					absorbInstructionClocks(out, clocksPerInstruction))
+				{
+					last.parameter = (last.parameter + op.parameter) & PARAMETER_MASK;
+					return;
+				}
+				break;
+			case CFO_INSTR::SET_TAG:
+				if((last.instr == CFO_INSTR::INC_TAG || last.instr == CFO_INSTR::SET_TAG) &&
+					absorbInstructionClocks(out, clocksPerInstruction))
+				{
+					last = op;
+					return;
+				}
+				break;
+			case CFO_INSTR::AND_MODE_BITS:
+				if(last.instr == CFO_INSTR::AND_MODE_BITS && absorbInstructionClocks(out, clocksPerInstruction))
+				{
+					last.parameter &= op.parameter;
+					return;
+				}
+				if(last.instr == CFO_INSTR::OR_MODE_BITS) //(mode | a) & b == (mode & b) | (a & b)
+				{
+					CFO_OP orOp = {CFO_INSTR::OR_MODE_BITS, last.parameter & op.parameter};
+					out.pop_back();
+					appendOptimizedOp(out, op, clocksPerInstruction);
+					appendOptimizedOp(out, orOp, clocksPerInstruction);
+					return;
+				}
+				break;
+			case CFO_INSTR::OR_MODE_BITS:
+				if(last.instr == CFO_INSTR::OR_MODE_BITS && absorbInstructionClocks(out, clocksPerInstruction))
+				{
+					last.parameter |= op.parameter;
+					return;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	out.push_back(op);
+} //end appendOptimizedOp()
+
+//========================================================================
+void CFOLib::CFO_Compiler::clearCache()
+{
+	std::lock_guard<std::mutex> lock(cacheMutex_);
+	cache_.clear();
+} //end clearCache()
+
 //========================================================================
 // Parameter Calculations
 // 	Calculates the parameter for the instruction (if needed) and does error checking
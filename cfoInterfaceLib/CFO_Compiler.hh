@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <cctype>
 #include <locale>
+#include <mutex>
 
 #ifndef __CLING__
 #include "tracemf.h"
@@ -54,7 +55,18 @@ public:
 		INVALID = 0xFF,
 	};
 
+	/// <summary>
+	/// One run plan instruction before encoding. DO_LOOP and GOTO targets are resolved when encoding, so that
+	/// the optimizer can add and remove instructions.
+	/// </summary>
+	struct CFO_OP
+	{
+		CFO_INSTR	instr;
+		uint64_t	parameter; //48-bit parameter; unused for DO_LOOP and GOTO
+	};
+
 	static const std::string	MAIN_GOTO_LABEL;
+	static const uint64_t		PARAMETER_MASK = 0xFFFFFFFFFFFF; //6-byte instruction parameter; all 1s for WAIT NEXT RF0
 	static const std::map<CFOLib::CFO_Compiler::CFO_INSTR, std::string> CODE_to_OP_TRANSLATION;
 	static const std::map<std::string, CFOLib::CFO_Compiler::CFO_INSTR> OP_to_CODE_TRANSLATION;
 
@@ -64,9 +76,20 @@ public:
 
 	std::string		 	processFile						(const std::string& sourceCodeFile , const std::string& binaryOutputFile);
 	const std::deque<char>& getBinaryOutput				() { return output_; }
+	const std::vector<CFO_OP>& getOps					() { return ops_; }
+
+	void				setOptimize						(bool optimize) { optimize_ = optimize; } //enable peephole optimization (default off, see optimizeOps)
+	void				setClocksPerInstruction			(uint64_t clocks) { clocksPerInstruction_ = clocks; } //firmware execution time of each instruction, kept by the optimizer
+	size_t				getCompiledInstructionCount		() const { return compiledInstructionCount_; } //before optimization
+	size_t				getOptimizedInstructionCount	() const { return optimizedInstructionCount_; }
+	bool				wasCached						() const { return cached_; } //last processFile result came from the compile cache
+
+	static void			optimizeOps						(std::vector<CFO_OP>& ops, uint64_t clocksPerInstruction = 0);
+	static void			clearCache						();
 
 private:
 
+	void				compileSource					(const std::string& source);
 	bool 				isComment						(const std::string& line);
 
 	CFO_INSTR 			parseInstruction				(const std::string& instructionBuffer);
@@ -74,6 +97,11 @@ private:
 	void 				processOp						(void);
 	uint64_t			calculateParameterAndErrorCheck	(CFO_INSTR);
 	void 				outParameter					(uint64_t);
+	void 				encodeOps						(void);
+
+	static void			appendOptimizedOp				(std::vector<CFO_OP>& out, const CFO_OP& op, uint64_t clocksPerInstruction);
+	static void			appendOptimizedBlock			(std::vector<CFO_OP>& out, const std::vector<CFO_OP>& ops, size_t begin, size_t end, uint64_t clocksPerInstruction);
+	static bool			absorbInstructionClocks			(std::vector<CFO_OP>& out, uint64_t clocksPerInstruction);
 
 	std::vector<uint64_t /* line number */> loopStack_;
 	std::map<std::string /* label */, 
@@ -85,7 +113,26 @@ private:
 	const uint64_t 							FPGAClock_ = (1e9/(40e6) /* 40MHz FPGAClock for calculating delays */); //period of FPGA clock in ns
 	
 	size_t 									txtLineNumber_, binLineNumber_;
+	std::vector<CFO_OP>						ops_;
 	std::deque<char> 						output_;
+
+	bool									optimize_ = false;
+	uint64_t								clocksPerInstruction_ = 0;
+	size_t									compiledInstructionCount_ = 0, optimizedInstructionCount_ = 0;
+	bool									cached_ = false;
+
+	/// <summary>
+	/// Compile cache entry, keyed by a hash of the source text and the compiler options
+	/// </summary>
+	struct CachedRunPlan
+	{
+		std::string		source; //to rule out hash collisions
+		std::vector<CFO_OP> ops;
+		std::deque<char> output;
+		size_t			compiledInstructionCount, optimizedInstructionCount;
+	};
+	static std::mutex								cacheMutex_;
+	static std::map<uint64_t, CachedRunPlan>		cache_;
 };
 
 }  // namespace CFOLib
@@ -0,0 +1,85 @@
+#include "cfoInterfaceLib/CFO_RecordReader.h"
+
+#include "TRACE/tracemf.h"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+CFOLib::CFO_RecordReader::CFO_RecordReader(mu2edev& device, size_t maxBuffers)
+	: device_(device), maxBuffers_(maxBuffers)
+{
+	if (maxBuffers_ == 0)
+	{
+		__SS__ << "The CFO record reader must read at least one DMA buffer per batch" << __E__;
+		__SS_THROW__;
+	}
+}
+
+size_t CFOLib::CFO_RecordReader::ReadBatch(CFO_RecordBatch& batch, int tmo_ms)
+{
+	Release();
+	batch.records.clear();
+	batch.buffers = 0;
+	batch.bytes = 0;
+
+	while (batch.buffers < maxBuffers_)
+	{
+		mu2e_databuff_t* buffer = nullptr;
+		// Wait for the first buffer only; the rest of the batch is whatever the DMA engine has already filled
+		auto sts = device_.read_data(DTC_DMA_Engine_DAQ, reinterpret_cast<void**>(&buffer), batch.buffers == 0 ? tmo_ms : 0);
+		if (sts < 0)
+		{
+			__SS__ << "Error reading CFO records: read_data returned " << sts << __E__;
+			__SS_THROW__;
+		}
+		if (sts == 0) break;  // Timeout
+
+		// Stamp the buffer with a running index, as CFO::ReadNextCFORecordDMA does, to spot the device handing back a stale buffer
+		auto bufferIndexPointer = reinterpret_cast<uint32_t*>(&(*buffer)[4]);
+		if (buffer == lastBuffer_ && *bufferIndexPointer == bufferIndex_)
+		{
+			__COUT_WARN__ << "New DMA buffer was the same as the old one, releasing it" << __E__;
+			device_.read_release(DTC_DMA_Engine_DAQ, 1);
+			break;
+		}
+		lastBuffer_ = buffer;
+		*bufferIndexPointer = ++bufferIndex_;
+
+		++heldBuffers_;
+		++batch.buffers;
+		batch.bytes += sts;
+		ParseBuffer_(buffer, sts, batch);
+	}
+
+	recordCount_ += batch.records.size();
+	bufferCount_ += batch.buffers;
+	__COUTT__ << "Read " << batch.records.size() << " CFO records from " << batch.buffers << " DMA buffers" << __E__;
+	return batch.records.size();
+}  // end ReadBatch()
+
+void CFOLib::CFO_RecordReader::ParseBuffer_(mu2e_databuff_t* buffer, int byteCount, CFO_RecordBatch& batch)
+{
+	if (byteCount >= static_cast<int>(sizeof(mu2e_databuff_t)))
+	{
+		__SS__ << "Impossible CFO DMA buffer size of " << byteCount << __E__;
+		__SS_THROW__;
+	}
+
+	// The DMA byte count includes one byte for tlast; the rest is one transfer header and record per record
+	size_t recordBytes = byteCount - 1;
+	if (recordBytes % RecordStride != 0)
+	{
+		__SS__ << "CFO DMA buffer of " << byteCount << " bytes is not a whole number of " << RecordStride << "-byte records" << __E__;
+		__SS_THROW__;
+	}
+
+	auto record = reinterpret_cast<const uint8_t*>(&(*buffer)[0]) + sizeof(uint64_t);
+	for (size_t ii = 0; ii < recordBytes / RecordStride; ++ii, record += RecordStride)
+		batch.records.push_back(reinterpret_cast<const CFO_EventRecord*>(record));
+}  // end ParseBuffer_()
+
+void CFOLib::CFO_RecordReader::Release()
+{
+	if (heldBuffers_ == 0) return;
+	device_.read_release(DTC_DMA_Engine_DAQ, static_cast<unsigned>(heldBuffers_));
+	heldBuffers_ = 0;
+}  // end Release()
@@ -0,0 +1,100 @@
+#ifndef CFO_RECORDREADER_H
+#define CFO_RECORDREADER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "artdaq-core-mu2e/Overlays/CFO_Packets/CFO_EventRecord.h"
+
+#include "dtcInterfaceLib/mu2edev.h"
+
+namespace CFOLib {
+
+/// <summary>
+/// A batch of CFO event records read by the CFO_RecordReader. The records are views into the DMA buffers of the
+/// device: they are valid until the next ReadBatch or Release of the reader which filled the batch.
+/// </summary>
+struct CFO_RecordBatch
+{
+	std::vector<const CFO_EventRecord*> records;  ///< Records, in DMA order
+	size_t buffers = 0;                           ///< DMA buffers the records were read from
+	size_t bytes = 0;                             ///< DMA bytes of those buffers
+
+	size_t size() const { return records.size(); }
+	bool empty() const { return records.empty(); }
+	const CFO_EventRecord& operator[](size_t index) const { return *records[index]; }
+};
+
+/// <summary>
+/// The CFO_RecordReader reads CFO event records from the DAQ DMA channel in batches, without copying: each ReadBatch
+/// takes every DMA buffer which is ready (up to a maximum), returns pointers to the records in those buffers, and
+/// releases them all with a single read_release on the next ReadBatch or Release. Only the first buffer of a batch is
+/// waited for.
+///
+/// The reader keeps its own count of held buffers, so it must not be mixed with CFO::GetData on the same device.
+/// Like the CFO, the reader does not release its buffers on destruction; call Release when done.
+/// </summary>
+class CFO_RecordReader
+{
+public:
+	/// <summary>
+	/// Construct a CFO_RecordReader
+	/// </summary>
+	/// <param name="device">Device to read from</param>
+	/// <param name="maxBuffers">Maximum number of DMA buffers per batch. Must be less than the number of buffers in
+	/// the DMA ring (40 in mu2esim, 100 in the driver).</param>
+	explicit CFO_RecordReader(mu2edev& device, size_t maxBuffers = 32);
+
+	/// <summary>
+	/// Release the previous batch, then read the DMA buffers which are ready into a batch
+	/// </summary>
+	/// <param name="batch">Batch to fill. Its record vector is cleared first; its capacity is kept.</param>
+	/// <param name="tmo_ms">Time to wait for the first buffer</param>
+	/// <returns>Number of records in the batch; 0 on timeout</returns>
+	size_t ReadBatch(CFO_RecordBatch& batch, int tmo_ms);
+	/// <summary>
+	/// Release all DMA buffers of the last batch to the hardware. Records of that batch must not be used afterwards.
+	/// </summary>
+	void Release();
+	/// <summary>
+	/// Forget the held buffers without releasing them, e.g. after the DMA channel was released with release_all
+	/// </summary>
+	void Reset() { heldBuffers_ = 0; }
+
+	/// <summary>
+	/// Get the number of DMA buffers held by the reader
+	/// </summary>
+	/// <returns>Number of held buffers</returns>
+	size_t GetHeldBuffers() const { return heldBuffers_; }
+	/// <summary>
+	/// Get the number of records read since construction
+	/// </summary>
+	/// <returns>Number of records</returns>
+	uint64_t GetRecordCount() const { return recordCount_; }
+	/// <summary>
+	/// Get the number of DMA buffers read since construction
+	/// </summary>
+	/// <returns>Number of DMA buffers</returns>
+	uint64_t GetBufferCount() const { return bufferCount_; }
+
+	/// <summary>
+	/// Size of one record in a DMA buffer: the 8-byte DMA transfer header of the record, then the record. The CFO stacks
+	/// one transfer per record into each DMA buffer.
+	/// </summary>
+	static constexpr size_t RecordStride = sizeof(uint64_t) + sizeof(CFO_EventRecord);
+
+private:
+	void ParseBuffer_(mu2e_databuff_t* buffer, int byteCount, CFO_RecordBatch& batch);
+
+	mu2edev& device_;
+	size_t maxBuffers_;
+	size_t heldBuffers_ = 0;
+	mu2e_databuff_t* lastBuffer_ = nullptr;
+	uint32_t bufferIndex_ = 0;  ///< Stamped into each buffer, to detect the device returning the same buffer twice
+	uint64_t recordCount_ = 0;
+	uint64_t bufferCount_ = 0;
+};
+
+}  // namespace CFOLib
+
+#endif  // CFO_RECORDREADER_H
@@ -2,11 +2,16 @@
 
 #include <assert.h>
 #include <unistd.h>
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <iomanip>  // std::setw, std::setfill
 #include <sstream>  // Convert uint to hex stLink
 
+#include "cfoInterfaceLib/CFO_RunPlanDisassembler.h"
+
 #include "artdaq-core/Utilities/ExceptionHandler.hh" /*for artdaq::ExceptionHandler*/
 #include "artdaq-core/Utilities/ExceptionStackTrace.hh" /*for artdaq::ExceptionStackTrace*/
 
@@ -75,7 +80,11 @@ CFOLib::CFO_Registers::CFO_Registers(DTC_SimMode mode, int cfo, std::string expe
 		}
 	}
 	
-	SetSimMode(expectedDesignVersion, simMode_, cfo, skipInit, (uid == ""? ("CFO"+std::to_string(cfo)):uid));
+	{
+		DTCLib::BringUpTimeline::Recording recording(&bringUpTimeline_);
+		SetSimMode(expectedDesignVersion, simMode_, cfo, skipInit, (uid == ""? ("CFO"+std::to_string(cfo)):uid));
+	}
+	ReportBringUpTimeline_();
 } //end costructor()
 
 CFOLib::CFO_Registers::~CFO_Registers() 
@@ -87,19 +96,25 @@ CFOLib::CFO_Registers::~CFO_Registers()
 DTCLib::DTC_SimMode CFOLib::CFO_Registers::SetSimMode(std::string expectedDesignVersion, DTC_SimMode mode, int cfo,
 													  bool skipInit, const std::string& uid)
 {
+	DTCLib::BringUpPhaseScope phase("CFO SetSimMode", &device_);
 	simMode_ = mode;
 
 	TLOG(TLVL_INFO) << "Initializing CFO device, sim mode is " << 
 		DTC_SimModeConverter(simMode_).toString() << " for uid = " << uid << ", deviceIndex = " << cfo;
 
-	device_.init(simMode_, cfo, /* simMemoryFile */ "", uid);
-	if (expectedDesignVersion != "" && expectedDesignVersion != ReadDesignVersion())
+	device_.init(simMode_, cfo, /* simMemoryFile */ "", uid, /* simulateCFO */ true);
+	ClearRegisterCache();  // The cached values belong to the previously opened device
+	if (expectedDesignVersion != "")
 	{
-		__SS__ << "Version mismatch! Expected CFO version is '" << expectedDesignVersion <<
-			"' while the readback version was '" << ReadDesignVersion() << ".'" << __E__;
-		__SS_THROW__;
+		DTCLib::BringUpPhaseScope versionPhase("Design version check", &device_);
+		if (expectedDesignVersion != ReadDesignVersion())
+		{
+			__SS__ << "Version mismatch! Expected CFO version is '" << expectedDesignVersion <<
+				"' while the readback version was '" << ReadDesignVersion() << ".'" << __E__;
+			__SS_THROW__;
 
-		// throw new DTC_WrongVersionException(expectedDesignVersion, ReadDesignVersion());
+			// throw new DTC_WrongVersionException(expectedDesignVersion, ReadDesignVersion());
+		}
 	}
 
 	if (skipInit)
@@ -109,6 +124,9 @@ DTCLib::DTC_SimMode CFOLib::CFO_Registers::SetSimMode(std::string expectedDesign
 	} 
 
 	__COUT__ << "Initialize requested, setting device registers acccording to sim mode " << DTC_SimModeConverter(simMode_).toString();
+
+	// Collect all bit changes below, so that each register is read and written (and verified) once
+	DTCLib::RegisterTransaction transaction(this);
 	for (auto link : CFO_Links)
 	{
 		bool LinkEnabled = ((maxDTCs_ >> (link * 4)) & 0xF) != 0;
@@ -140,8 +158,10 @@ DTCLib::DTC_SimMode CFOLib::CFO_Registers::SetSimMode(std::string expectedDesign
 		DisableEmbeddedClockMarker();
 	}
 	ReadMinDMATransferLength();
+	DTCLib::BringUpPhaseScope commitPhase("Write register configuration", &device_);
+	auto writes = transaction.Commit();
 
-	__COUT__ << "Done setting device registers";
+	__COUT__ << "Done setting device registers (" << writes << " register writes)";
 	return simMode_;
 }
 
@@ -398,30 +418,30 @@ DTCLib::RegisterFormatter CFOLib::CFO_Registers::FormatClockOscillatorStatus()
 void CFOLib::CFO_Registers::EnableLink(const CFO_Link_ID& link, const DTC_LinkEnableMode& mode,
 									   const uint8_t& dtcCount)
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_LinkEnable);
+	DTCLib::RegisterTransaction transaction(this);
 	if(link == CFO_Link_ALL)
 	{	
 		for(uint8_t i=0;i<8;++i)
 		{
-			data[i] = mode.TransmitEnable;
-			data[i + 8] = mode.ReceiveEnable;
+			transaction.SetBit(CFOandDTC_Register_LinkEnable, i, mode.TransmitEnable);
+			transaction.SetBit(CFOandDTC_Register_LinkEnable, i + 8, mode.ReceiveEnable);
 		}
 	}
 	else
 	{
-		data[link] = mode.TransmitEnable;
-		data[link + 8] = mode.ReceiveEnable;
+		transaction.SetBit(CFOandDTC_Register_LinkEnable, link, mode.TransmitEnable);
+		transaction.SetBit(CFOandDTC_Register_LinkEnable, link + 8, mode.ReceiveEnable);
 	}
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_LinkEnable);
 	SetMaxDTCNumber(link, dtcCount);
+	transaction.Commit();
 }
 
 void CFOLib::CFO_Registers::DisableLink(const CFO_Link_ID& link, const DTC_LinkEnableMode& mode)
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_LinkEnable);
-	data[link] = data[link] && !mode.TransmitEnable;
-	data[link + 8] = data[link + 8] && !mode.ReceiveEnable;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_LinkEnable);
+	DTCLib::RegisterTransaction transaction(this);
+	if (mode.TransmitEnable) transaction.SetBit(CFOandDTC_Register_LinkEnable, link, false);
+	if (mode.ReceiveEnable) transaction.SetBit(CFOandDTC_Register_LinkEnable, link + 8, false);
+	transaction.Commit();
 }
 
 DTCLib::DTC_LinkEnableMode CFOLib::CFO_Registers::ReadLinkEnabled(const CFO_Link_ID& link, std::optional<uint32_t> val)
@@ -1877,43 +1897,112 @@ DTCLib::RegisterFormatter CFOLib::CFO_Registers::FormatRunPlanBeamOffBaseAddress
 
 void CFOLib::CFO_Registers::SetRunPlanData(const std::string& inputData, const uint32_t& runPlanBaseAddress)
 {
-	__COUTTV__(inputData.size());
 	__COUTT__ << "Writing run plan of size " << inputData.size() << " to base address 0x" << 
 		std::hex << std::setw(8) << std::setfill('0') << runPlanBaseAddress << __E__;
+	auto start = std::chrono::steady_clock::now();
 
-	auto dataPtr = reinterpret_cast<const uint8_t*>(&inputData[0]);
+	auto words = RunPlanWords_(inputData);
+	// CFO_Register_RunPlan_Data increments the run plan BRAM address with each access
+	std::vector<uint16_t> addresses(words.size(), CFO_Register_RunPlan_Data);
 
-	//primary run plan write loop
+	//primary run plan write, one bulk pass
 	WriteRegister_(runPlanBaseAddress, CFO_Register_RunPlan_Address); //resets run plan BRAM write address 
-	for(uint32_t l = 0; l < inputData.size(); l+=4)
-	{ 
-		// CFO_Register_RunPlan_Address = 0x9314,
-		// CFO_Register_RunPlan_Data = 0x9318,
-		WriteRegister_(*((uint32_t *)(&(dataPtr[l]))), CFO_Register_RunPlan_Data); //write data then increment BRAM address
-		__COUTT__ << std::hex << std::setw(8) << std::setfill('0') << "addr 0x" << (runPlanBaseAddress + l/4) <<
-			 " data 0x" << *((uint32_t *)(&(dataPtr[l]))) << __E__;
-	} //end primary run plan write loop
-
-	//now verify run plan w/readback
-	WriteRegister_(runPlanBaseAddress, CFO_Register_RunPlan_Address); //resets run plan BRAM write address 
-	uint32_t val;
-	for(uint32_t l = 0; l < inputData.size(); l+=4)
-	{ 
-		val = ReadRegister_(CFO_Register_RunPlan_Data);
-
-		__COUTT__ << std::hex << std::setw(8) << std::setfill('0') << "addr 0x" << (runPlanBaseAddress + l/4) <<
-			 " data 0x" << *((uint32_t *)(&(dataPtr[l]))) << " =? rdata 0x" << val << __E__;
-		if(val != *((uint32_t *)(&(dataPtr[l]))))
-		{
-			__SS__ << "Run plan write validation failed at " << std::hex << std::setw(8) << std::setfill('0') << 
-				"addr 0x" << (runPlanBaseAddress + l/4) <<
-				" data 0x" << *((uint32_t *)(&(dataPtr[l]))) << " != rdata 0x" << val << __E__;
-			__SS_THROW__;
-		}
+	WriteRegisterBlock_(addresses.data(), words.data(), words.size());
+
+	//now verify run plan w/bulk readback and block compare
+	auto readback = ReadRunPlanWords_(runPlanBaseAddress, words.size());
+	if (readback != words)
+	{
+		auto mismatch = std::mismatch(words.begin(), words.end(), readback.begin());
+		auto index = mismatch.first - words.begin();
+		__SS__ << "Run plan write validation failed at " << std::hex << std::setw(8) << std::setfill('0') << 
+			"addr 0x" << (runPlanBaseAddress + index) <<
+			" data 0x" << *mismatch.first << " != rdata 0x" << *mismatch.second << 
+			" (CRC 0x" << RunPlanCRC_(words) << " != 0x" << RunPlanCRC_(readback) << ")" << __E__ <<
+			FormatRunPlanDifferences_(inputData, readback);
+		__SS_THROW__;
 	} //end run plan validation
 
+	__COUTT__ << "Run plan of " << std::dec << words.size() << " words loaded and verified in " << 
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms, CRC 0x" << 
+		std::hex << RunPlanCRC_(words) << __E__;
 } //end SetRunPlanData()
 
+uint32_t CFOLib::CFO_Registers::ReadRunPlanCRC(const uint32_t& runPlanBaseAddress, size_t words)
+{
+	return RunPlanCRC_(ReadRunPlanWords_(runPlanBaseAddress, words));
+} //end ReadRunPlanCRC()
+
+std::string CFOLib::CFO_Registers::ReadRunPlanData(const uint32_t& runPlanBaseAddress, size_t bytes)
+{
+	if (bytes == 0) return "";
+	auto readback = ReadRunPlanWords_(runPlanBaseAddress, (bytes + 3) / 4);
+	return std::string(reinterpret_cast<const char*>(readback.data()), bytes);
+} //end ReadRunPlanData()
+
+bool CFOLib::CFO_Registers::IsRunPlanLoaded(const std::string& inputData, const uint32_t& runPlanBaseAddress)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto words = RunPlanWords_(inputData);
+	auto loaded = ReadRunPlanWords_(runPlanBaseAddress, words.size()) == words;
+	__COUTT__ << "Run plan of " << words.size() << " words " << (loaded ? "is" : "is not") << " loaded at base address 0x" << 
+		std::hex << runPlanBaseAddress << " (checked in " << std::dec << 
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms)" << __E__;
+	return loaded;
+} //end IsRunPlanLoaded()
+
+uint32_t CFOLib::CFO_Registers::ComputeRunPlanCRC(const std::string& inputData)
+{
+	return RunPlanCRC_(RunPlanWords_(inputData));
+} //end ComputeRunPlanCRC()
+
+// Split a compiled run plan into run plan memory words, padding a partial last word with zeros
+std::vector<uint32_t> CFOLib::CFO_Registers::RunPlanWords_(const std::string& inputData)
+{
+	std::vector<uint32_t> words((inputData.size() + 3) / 4, 0);
+	if (!inputData.empty()) memcpy(words.data(), inputData.data(), inputData.size());
+	return words;
+} //end RunPlanWords_()
+
+// Read run plan memory words in one bulk pass through the auto-incrementing data register
+std::vector<uint32_t> CFOLib::CFO_Registers::ReadRunPlanWords_(const uint32_t& runPlanBaseAddress, size_t words)
+{
+	std::vector<uint16_t> addresses(words, CFO_Register_RunPlan_Data);
+	std::vector<uint32_t> readback(words);
+	WriteRegister_(runPlanBaseAddress, CFO_Register_RunPlan_Address); //resets run plan BRAM address 
+	ReadRegisterBlock_(addresses.data(), addresses.size(), readback.data());
+	return readback;
+} //end ReadRunPlanWords_()
+
+// Disassembled differences between a compiled run plan and its readback, for error messages
+std::string CFOLib::CFO_Registers::FormatRunPlanDifferences_(const std::string& inputData, const std::vector<uint32_t>& readback)
+{
+	if (inputData.size() % 8 != 0 || readback.size() * sizeof(uint32_t) < inputData.size()) return "";
+	std::string readbackData(reinterpret_cast<const char*>(readback.data()), inputData.size());
+	return CFO_RunPlanDisassembler::FormatDiff(CFO_RunPlanDisassembler::Diff(CFO_RunPlanDisassembler::Disassemble(inputData),
+		CFO_RunPlanDisassembler::Disassemble(readbackData)), 10 /* maxDifferences */);
+} //end FormatRunPlanDifferences_()
+
+// CRC-32 (IEEE 802.3, as zlib) of the bytes of the run plan memory words
+uint32_t CFOLib::CFO_Registers::RunPlanCRC_(const std::vector<uint32_t>& words)
+{
+	static const auto table = [] {
+		std::array<uint32_t, 256> t{};
+		for (uint32_t ii = 0; ii < 256; ++ii)
+		{
+			uint32_t c = ii;
+			for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			t[ii] = c;
+		}
+		return t;
+	}();
+
+	uint32_t crc = 0xFFFFFFFF;
+	auto bytes = reinterpret_cast<const uint8_t*>(words.data());
+	for (size_t ii = 0; ii < words.size() * sizeof(uint32_t); ++ii) crc = table[(crc ^ bytes[ii]) & 0xFF] ^ (crc >> 8);
+	return crc ^ 0xFFFFFFFF;
+} //end RunPlanCRC_()
+
 // Firefly CSR Register
 bool CFOLib::CFO_Registers::ReadFireflyTXRXPresent(std::optional<uint32_t> val)
 {
@@ -2739,6 +2828,126 @@ uint32_t CFOLib::CFO_Registers::ReadCableDelayMeasurement(const CFO_Link_ID link
 	return readVal & (~(1<<31)); //return 4-bit nibble at bit-16
 } //end ReadCableDelayMeasureExponentialCount()
 
+CFOLib::CFO_CableDelayTable CFOLib::CFO_Registers::MeasureCableDelays(const CFO_CableDelayOptions& options)
+{
+	const uint8_t maxHops = 6;  // Cable Delay Value registers 0x9360 to 0x987C
+	if (options.hops == 0 || options.hops > maxHops || options.samples == 0)
+	{
+		__SS__ << "Invalid cable delay measurement of " << int(options.hops) << " hops and " << options.samples
+			   << " samples; there must be 1 to " << int(maxHops) << " hops and at least one sample" << __E__;
+		__SS_THROW__;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	if (options.exponentialCount >= 0) SetCableDelayMeasureExponentialCount(options.exponentialCount);
+
+	CFO_CableDelayTable table;
+	std::vector<uint16_t> addresses;
+	std::vector<double> sums, sumsOfSquares;
+	for (auto link : CFO_Links)
+	{
+		if (((options.linkMask >> link) & 1) == 0) continue;
+		for (uint8_t hop = 0; hop < options.hops; ++hop)
+		{
+			CFO_CableDelayEntry entry;
+			entry.link = link;
+			entry.hop = hop;
+			table.entries.push_back(entry);
+			addresses.push_back(CFO_Register_CableDelayValue_offset + 0x100 * hop + 0x4 * link);
+		}
+	}
+	sums.resize(addresses.size(), 0);
+	sumsOfSquares.resize(addresses.size(), 0);
+	std::vector<bool> connected(addresses.size(), true);
+
+	std::vector<uint16_t> pollAddresses;
+	std::vector<size_t> pollEntries;
+	std::vector<uint32_t> values;
+	for (size_t sample = 0; sample < options.samples; ++sample)
+	{
+		pollEntries.clear();
+		for (size_t ii = 0; ii < addresses.size(); ++ii)
+			if (connected[ii]) pollEntries.push_back(ii);
+		if (pollEntries.empty()) break;
+
+		RunCableDelayLoopbackTest();  // One loopback marker, broadcast to all links
+		++table.measurements;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.timeoutMs);
+
+		while (!pollEntries.empty())
+		{
+			usleep(options.pollIntervalUs);
+			pollAddresses.clear();
+			for (auto ii : pollEntries) pollAddresses.push_back(addresses[ii]);
+			values.resize(pollAddresses.size());
+			ReadRegisterBlock_(pollAddresses.data(), pollAddresses.size(), values.data());
+			++table.polls;
+
+			size_t pending = 0;
+			for (size_t jj = 0; jj < pollEntries.size(); ++jj)
+			{
+				auto ii = pollEntries[jj];
+				if (((values[jj] >> 31) & 1) == 0)
+				{
+					pollEntries[pending++] = ii;
+					continue;
+				}
+				auto delay = values[jj] & 0x7FFFFFFF;
+				auto& entry = table.entries[ii];
+				entry.minimum = entry.samples == 0 ? delay : std::min(entry.minimum, delay);
+				entry.maximum = std::max(entry.maximum, delay);
+				++entry.samples;
+				sums[ii] += delay;
+				sumsOfSquares[ii] += double(delay) * delay;
+			}
+			pollEntries.resize(pending);
+
+			if (!pollEntries.empty() && std::chrono::steady_clock::now() > deadline)
+			{
+				for (auto ii : pollEntries)
+				{
+					++table.entries[ii].timeouts;
+					if (sample == 0) connected[ii] = false;  // Nothing at this hop; do not wait for it again
+				}
+				break;
+			}
+		}
+	}
+
+	for (size_t ii = 0; ii < table.entries.size(); ++ii)
+	{
+		auto& entry = table.entries[ii];
+		if (entry.samples == 0) continue;
+		entry.mean = sums[ii] / entry.samples;
+		entry.rms = std::sqrt(std::max(0.0, sumsOfSquares[ii] / entry.samples - entry.mean * entry.mean));
+	}
+	table.durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	__COUT_INFO__ << "Measured cable delays of " << table.entries.size() << " link hops: " << table.measurements << " measurements, "
+				  << table.polls << " polls, " << table.durationMs << " ms" << __E__;
+	return table;
+} //end MeasureCableDelays()
+
+std::string CFOLib::CFO_CableDelayTable::Format() const
+{
+	std::ostringstream o;
+	o << "Cable delays: " << measurements << " measurements, " << polls << " polls, " << std::fixed << std::setprecision(3) << durationMs
+	  << " ms" << std::endl;
+	o << std::setw(6) << "Link" << std::setw(6) << "Hop" << std::setw(10) << "Samples" << std::setw(10) << "Timeouts" << std::setw(12)
+	  << "Mean" << std::setw(10) << "RMS" << std::setw(10) << "Min" << std::setw(10) << "Max" << std::endl;
+	for (auto const& entry : entries)
+	{
+		o << std::setw(6) << int(entry.link) << std::setw(6) << int(entry.hop) << std::setw(10) << entry.samples << std::setw(10)
+		  << entry.timeouts;
+		if (entry.samples > 0)
+			o << std::setw(12) << entry.mean << std::setw(10) << entry.rms << std::setw(10) << entry.minimum << std::setw(10) << entry.maximum;
+		else
+			o << std::setw(12) << "-";
+		o << std::endl;
+	}
+	return o.str();
+} //end CFO_CableDelayTable::Format()
+
 // void CFOLib::CFO_Registers::SetCableDelayValue(const CFO_Link_ID& link, const uint32_t delay)
 // {
 // 	CFO_Register reg;
@@ -3097,6 +3306,40 @@ bool CFOLib::CFO_Registers::NeedToVerifyRegisterWrite_(const CFOandDTC_Register&
 	return true;
 } //end NeedToVerifyRegisterWrite_()
 
+DTCLib::RegisterCacheClass CFOLib::CFO_Registers::GetRegisterCacheClass_(const CFOandDTC_Register& address)
+{
+	switch(address)
+	{
+		//list the presets, which only software writes
+		case CFO_Register_BeamOnTimerPreset:
+		case CFO_Register_EnableBeamOnMode:
+		case CFO_Register_EnableBeamOffMode:
+		case CFO_Register_ClockMarkerIntervalCount:
+		case CFO_Register_SERDESOscillatorFrequency:
+		case CFO_Register_NUMDTCs:
+		case CFO_Register_EventWindowHoldoffTime:
+		case CFO_Register_EventWindowTimeoutValue:
+		case CFO_Register_RunPlanBeamOnBaseAddress:
+		case CFO_Register_RunPlanBeamOffBaseAddress:
+			return DTCLib::RegisterCacheClass_Configuration;
+		default:;
+	}
+	return CFOandDTC_Registers::GetRegisterCacheClass_(address);
+} //end GetRegisterCacheClass_()
+
+bool CFOLib::CFO_Registers::HasReadSideEffect_(const CFOandDTC_Register& address)
+{
+	switch(address)
+	{
+		//list the data ports
+		case CFO_Register_RunPlan_Data:  // Advances CFO_Register_RunPlan_Address
+		case CFO_Register_FPGAProgramData:
+			return true;
+		default:;
+	}
+	return CFOandDTC_Registers::HasReadSideEffect_(address);
+} //end HasReadSideEffect_()
+
 void CFOLib::CFO_Registers::VerifyRegisterWrite_(const CFOandDTC_Register& address, uint32_t readbackValue, uint32_t dataToWrite)
 {
 	//verify register readback
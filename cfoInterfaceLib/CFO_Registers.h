@@ -131,6 +131,51 @@ enum CFO_Link_ID : uint8_t
 static const std::vector<CFO_Link_ID> CFO_Links{CFO_Link_0, CFO_Link_1, CFO_Link_2, CFO_Link_3,
 												CFO_Link_4, CFO_Link_5, CFO_Link_6, CFO_Link_7};
 
+/// <summary>
+/// Options of CFO_Registers::MeasureCableDelays
+/// </summary>
+struct CFO_CableDelayOptions
+{
+	uint8_t linkMask = 0xFF;        ///< Links to measure
+	uint8_t hops = 1;               ///< DTCs to measure along the chain of each link (1 to 6)
+	size_t samples = 8;             ///< Measurements to collect statistics over
+	int exponentialCount = -1;      ///< Cable Delay Measure Exponential Count to set first, -1 to keep the current one
+	unsigned pollIntervalUs = 100;  ///< Time between completion polls
+	unsigned timeoutMs = 100;       ///< Time for one measurement to complete on all links
+};
+
+/// <summary>
+/// Cable delay statistics of one link and DTC hop
+/// </summary>
+struct CFO_CableDelayEntry
+{
+	CFO_Link_ID link = CFO_Link_0;
+	uint8_t hop = 0;       ///< Position of the DTC along the chain of the link (0 is the first DTC)
+	size_t samples = 0;    ///< Completed measurements
+	size_t timeouts = 0;   ///< Measurements which did not complete in time
+	uint32_t minimum = 0;  ///< Delay statistics, in the units of the Cable Delay Value registers
+	uint32_t maximum = 0;
+	double mean = 0;
+	double rms = 0;
+};
+
+/// <summary>
+/// Result of CFO_Registers::MeasureCableDelays
+/// </summary>
+struct CFO_CableDelayTable
+{
+	std::vector<CFO_CableDelayEntry> entries;  ///< By link, then hop
+	size_t measurements = 0;                   ///< Measurements armed (each one on all links)
+	size_t polls = 0;                          ///< Batched completion polls
+	double durationMs = 0;
+
+	/// <summary>
+	/// Format the table, one line per link and hop
+	/// </summary>
+	/// <returns>Delay table text</returns>
+	std::string Format() const;
+};
+
 /// <summary>
 /// The CFO_Registers class represents the CFO Register space, and all the methods necessary to read and write those
 /// registers. Each register has, at the very least, a read method, a write method, and a RegisterFormatter method
@@ -1045,7 +1090,43 @@ public:
 	/// </summary>
 	/// <returns>RegisterFormatter object containing register information</returns>
 	RegisterFormatter FormatRunPlanBeamOffBaseAddress();
+
+	// Run Plan Address/Data Registers
+	/// <summary>
+	/// Load a run plan into the run plan memory and verify it. The words are written in one bulk pass through the
+	/// auto-incrementing data register, then read back in one bulk pass and compared as a block.
+	/// </summary>
+	/// <param name="inputData">Compiled run plan; a partial last word is padded with zeros</param>
+	/// <param name="address">Run plan memory word address to load the run plan at</param>
 	void SetRunPlanData(const std::string& inputData, const uint32_t& address);
+	/// <summary>
+	/// Read back a run plan from the run plan memory and compute its CRC-32
+	/// </summary>
+	/// <param name="address">Run plan memory word address of the run plan</param>
+	/// <param name="words">Length of the run plan, in 32-bit words</param>
+	/// <returns>CRC-32 of the run plan memory contents, comparable to ComputeRunPlanCRC</returns>
+	uint32_t ReadRunPlanCRC(const uint32_t& address, size_t words);
+	/// <summary>
+	/// Read back a run plan from the run plan memory, in one bulk pass
+	/// </summary>
+	/// <param name="address">Run plan memory word address of the run plan</param>
+	/// <param name="bytes">Length of the run plan, in bytes</param>
+	/// <returns>Run plan memory contents, comparable to the compiled run plan and readable with CFO_RunPlanDisassembler</returns>
+	std::string ReadRunPlanData(const uint32_t& address, size_t bytes);
+	/// <summary>
+	/// Check whether a run plan is the one loaded in the run plan memory: one bulk readback, compared as a block. This
+	/// is much faster than disassembling and comparing the run plans, so use it first, and diff only on a mismatch.
+	/// </summary>
+	/// <param name="inputData">Compiled run plan</param>
+	/// <param name="address">Run plan memory word address of the run plan</param>
+	/// <returns>True if the run plan memory holds the run plan at the address</returns>
+	bool IsRunPlanLoaded(const std::string& inputData, const uint32_t& address);
+	/// <summary>
+	/// Compute the CRC-32 of a compiled run plan, as it is stored in the run plan memory (padded to whole words)
+	/// </summary>
+	/// <param name="inputData">Compiled run plan</param>
+	/// <returns>CRC-32 of the run plan</returns>
+	static uint32_t ComputeRunPlanCRC(const std::string& inputData);
 
 	// Firefly CSR Register
 	/// <summary>
@@ -1254,6 +1335,14 @@ public:
 	uint32_t 	ReadCableDelayMeasureExponentialCount	(std::optional<uint32_t> val = std::nullopt);
 	void 		SetCableDelayMeasureExponentialCount	(const uint32_t exponent);
 	uint32_t 	ReadCableDelayMeasurement				(const CFO_Link_ID link, const uint8_t roc, bool& done);
+	/// <summary>
+	/// Measure the cable delays of all selected links and DTC hops at once: each measurement is armed with one
+	/// loopback marker broadcast to all links, and its completion is polled with one batched read of all the Cable
+	/// Delay Value registers. Link/hop pairs which do not complete in the first measurement are not polled again.
+	/// </summary>
+	/// <param name="options">Links, hops, number of samples and timing of the measurement</param>
+	/// <returns>Delay statistics per link and hop</returns>
+	CFO_CableDelayTable	MeasureCableDelays						(const CFO_CableDelayOptions& options = CFO_CableDelayOptions());
 	
 	// /// <summary>
 	// /// Set the cable delay value for the given link
@@ -1428,6 +1517,8 @@ public:
 
 private:
 	bool NeedToVerifyRegisterWrite_(const CFOandDTC_Register& address) override;
+	DTCLib::RegisterCacheClass GetRegisterCacheClass_(const CFOandDTC_Register& address) override;
+	bool HasReadSideEffect_(const CFOandDTC_Register& address) override;
 	void VerifyRegisterWrite_(const CFOandDTC_Register& address, uint32_t readbackValue, uint32_t dataToWrite) override;
 
 	int DecodeHighSpeedDivider_(int input);
@@ -1438,6 +1529,10 @@ private:
 	uint64_t EncodeRFREQ_(double input) { return static_cast<uint64_t>(input * 268435456) & 0x3FFFFFFFFF; }
 	uint64_t CalculateFrequencyForProgramming_(double targetFrequency, double currentFrequency,
 											   uint64_t currentProgram);
+	static std::vector<uint32_t> RunPlanWords_(const std::string& inputData);
+	std::vector<uint32_t> ReadRunPlanWords_(const uint32_t& address, size_t words);
+	static std::string FormatRunPlanDifferences_(const std::string& inputData, const std::vector<uint32_t>& readback);
+	static uint32_t RunPlanCRC_(const std::vector<uint32_t>& words);
 
 protected:
 	DTC_SimMode simMode_;         ///< Simulation mode
@@ -0,0 +1,404 @@
+#include "cfoInterfaceLib/CFO_RunPlanDisassembler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "TRACE/tracemf.h"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+namespace {
+typedef CFOLib::CFO_Compiler::CFO_INSTR CFO_INSTR;
+
+const uint64_t clockPeriodNs = 25;         // CFO FPGA clock (40 MHz, as used by CFO_Compiler for WAIT)
+const size_t maxAlignmentCells = 1 << 24;  // Larger differing regions are compared position by position
+const size_t pairingWindow = 64;           // Added instructions searched for one to pair with a removed one
+
+std::string Hex(uint64_t value)
+{
+	std::ostringstream o;
+	o << "0x" << std::hex << value;
+	return o.str();
+}
+
+std::string FormatTime(uint64_t ns)
+{
+	std::ostringstream o;
+	if (ns < 1000)
+		o << ns << " ns";
+	else if (ns < 1000000)
+		o << ns / 1e3 << " us";
+	else if (ns < 1000000000)
+		o << ns / 1e6 << " ms";
+	else
+		o << ns / 1e9 << " s";
+	return o.str();
+}
+
+// Lowest set bit of a mode bit mask, and the number of bits from there up to the highest set bit
+void BitSpan(uint64_t bits, unsigned& startBit, unsigned& bitCount)
+{
+	startBit = 0;
+	bitCount = 0;
+	if (bits == 0) return;
+	while (!(bits & (uint64_t(1) << startBit))) ++startBit;
+	unsigned endBit = 47;
+	while (!(bits & (uint64_t(1) << endBit))) --endBit;
+	bitCount = endBit - startBit + 1;
+}
+
+struct AlignmentStep
+{
+	enum Type
+	{
+		Match,
+		Remove,
+		Add,
+	} type;
+	size_t a;  // Index in the first run plan (Match, Remove)
+	size_t b;  // Index in the second run plan (Match, Add)
+};
+}  // namespace
+
+std::vector<CFOLib::CFO_RunPlanInstruction> CFOLib::CFO_RunPlanDisassembler::Disassemble(const std::deque<char>& binary)
+{
+	return Disassemble(std::string(binary.begin(), binary.end()));
+}
+
+std::vector<CFOLib::CFO_RunPlanInstruction> CFOLib::CFO_RunPlanDisassembler::Disassemble(const std::string& binary)
+{
+	if (binary.size() % 8 != 0)
+	{
+		__SS__ << "Run plan binary size " << binary.size() << " is not a whole number of 8-byte instructions" << __E__;
+		__SS_THROW__;
+	}
+
+	std::vector<CFO_RunPlanInstruction> instructions(binary.size() / 8);
+	std::vector<size_t> loops;  // Lines of the open LOOPs, innermost last
+	for (size_t ii = 0; ii < instructions.size(); ++ii)
+	{
+		auto& instruction = instructions[ii];
+		instruction.line = ii + 1;
+		for (size_t byte = 0; byte < 8; ++byte)
+			instruction.word |= static_cast<uint64_t>(static_cast<uint8_t>(binary[ii * 8 + byte])) << (8 * byte);
+		instruction.instr = static_cast<CFO_INSTR>(instruction.word >> 56);
+		instruction.parameter = instruction.word & CFO_Compiler::PARAMETER_MASK;
+
+		size_t loopStart = 0;
+		if (instruction.instr == CFO_INSTR::DO_LOOP && !loops.empty())
+		{
+			loopStart = loops.back();
+			loops.pop_back();
+		}
+		instruction.depth = loops.size();
+		instruction.loopLine = loops.empty() ? 0 : loops.back();
+		Decode_(instruction);
+
+		if (instruction.instr == CFO_INSTR::LOOP)
+			loops.push_back(instruction.line);
+		else if (instruction.instr == CFO_INSTR::DO_LOOP)
+		{
+			if (instruction.parameter > 0 && instruction.parameter < instruction.line)
+				instruction.target = instruction.line - instruction.parameter;
+			std::ostringstream comment;
+			comment << "back to line " << instruction.target;
+			if (loopStart == 0)
+				comment << ", no open LOOP";
+			else if (instruction.target != loopStart)
+				comment << ", not to the LOOP at line " << loopStart;
+			instruction.comment = comment.str();
+		}
+		else if (instruction.instr == CFO_INSTR::GOTO)
+		{
+			if (instruction.parameter > 0 && instruction.parameter <= instructions.size())
+				instruction.target = instruction.parameter;
+			instruction.comment = "line " + std::to_string(instruction.parameter);
+		}
+
+		auto reserved = (instruction.word >> 48) & 0xFF;
+		if (reserved != 0)
+			instruction.comment += (instruction.comment.empty() ? "" : ", ") + std::string("reserved byte ") + Hex(reserved);
+	}
+	return instructions;
+}  // end Disassemble()
+
+// Source text and comment of an instruction; DO_LOOP and GOTO targets are added by Disassemble
+void CFOLib::CFO_RunPlanDisassembler::Decode_(CFO_RunPlanInstruction& instruction)
+{
+	const uint64_t mask = CFO_Compiler::PARAMETER_MASK;
+	auto parameter = instruction.parameter;
+	std::ostringstream text;
+	unsigned startBit, bitCount;
+
+	switch (instruction.instr)
+	{
+		case CFO_INSTR::NOOP:
+			if (parameter == 1)
+				text << "LABEL";  // The MAIN label
+			else
+				instruction.comment = "NOOP " + Hex(parameter);
+			break;
+		case CFO_INSTR::HEARTBEAT:
+			text << "HEARTBEAT event_mode=" << (parameter == mask ? "registered" : Hex(parameter));
+			break;
+		case CFO_INSTR::MARKER:
+			text << "MARKER";
+			break;
+		case CFO_INSTR::DATA_REQUEST:
+			text << "DATA_REQUEST request_tag=" << (parameter == mask ? "current" : std::to_string(parameter));
+			break;
+		case CFO_INSTR::SET_TAG:
+			text << "SET_TAG " << parameter;
+			break;
+		case CFO_INSTR::INC_TAG:
+			text << "INC_TAG";
+			if (parameter != 1) text << " add_value=" << parameter;
+			break;
+		case CFO_INSTR::WAIT:
+			if (parameter == mask)
+				text << "WAIT NEXT RF0";
+			else
+			{
+				text << "WAIT " << parameter << " clocks";
+				instruction.comment = FormatTime(parameter * clockPeriodNs);
+			}
+			break;
+		case CFO_INSTR::LOOP:
+			text << "LOOP " << parameter;
+			break;
+		case CFO_INSTR::DO_LOOP:
+			text << "DO_LOOP";
+			break;
+		case CFO_INSTR::REPEAT:
+			text << "REPEAT";
+			break;
+		case CFO_INSTR::END:
+			text << "END";
+			break;
+		case CFO_INSTR::GOTO:
+			text << "GOTO_LABEL";
+			break;
+		case CFO_INSTR::AND_MODE_BITS:
+			// CFO_Compiler encodes CLEAR_MODE_BITS, and the clearing half of SET_MODE_BITS, as an AND of the other bits
+			BitSpan(~parameter & mask, startBit, bitCount);
+			if (bitCount != 0 && (~parameter & mask) == (((uint64_t(1) << bitCount) - 1) << startBit))
+				text << "CLEAR_MODE_BITS start_bit=" << startBit << " bit_count=" << bitCount;
+			else
+				text << "AND_MODE_BITS start_bit=0 bit_count=48 value=" << Hex(parameter);
+			instruction.comment = "mode &= " + Hex(parameter);
+			break;
+		case CFO_INSTR::OR_MODE_BITS:
+			BitSpan(parameter, startBit, bitCount);
+			text << "OR_MODE_BITS start_bit=" << startBit << " bit_count=" << std::max(bitCount, 1u)
+				 << " value=" << Hex(parameter >> startBit);
+			instruction.comment = "mode |= " + Hex(parameter);
+			break;
+		default:
+			instruction.comment = "unknown opcode " + Hex(static_cast<uint64_t>(instruction.instr)) + ", parameter " + Hex(parameter);
+			break;
+	}
+	instruction.text = text.str();
+}  // end Decode_()
+
+std::string CFOLib::CFO_RunPlanDisassembler::FormatInstruction(const CFO_RunPlanInstruction& instruction)
+{
+	if (instruction.text.empty()) return "// " + instruction.comment;
+	if (instruction.comment.empty()) return instruction.text;
+	return instruction.text + " // " + instruction.comment;
+}
+
+std::string CFOLib::CFO_RunPlanDisassembler::Format(const std::vector<CFO_RunPlanInstruction>& instructions, bool showWords)
+{
+	std::ostringstream o;
+	for (auto& instruction : instructions)
+	{
+		if (showWords)
+			o << std::setw(5) << std::setfill(' ') << instruction.line << ": 0x" << std::hex << std::setw(16) << std::setfill('0')
+			  << instruction.word << std::dec << "     ";
+		o << std::string(instruction.depth, '\t') << FormatInstruction(instruction) << "\n";
+	}
+	return o.str();
+}  // end Format()
+
+bool CFOLib::CFO_RunPlanDisassembler::Same_(const CFO_RunPlanInstruction& a, const CFO_RunPlanInstruction& b)
+{
+	if (a.instr != b.instr) return false;
+	// Their parameters are positions, which shift with every instruction added before them; Diff checks their targets
+	if (a.instr == CFO_INSTR::DO_LOOP || a.instr == CFO_INSTR::GOTO) return (a.word >> 48) == (b.word >> 48);
+	return a.word == b.word;
+}
+
+std::string CFOLib::CFO_RunPlanDisassembler::Context_(const std::vector<CFO_RunPlanInstruction>& instructions, size_t line)
+{
+	auto loopLine = instructions[line - 1].loopLine;
+	if (loopLine == 0) return "";
+	return "in LOOP " + std::to_string(instructions[loopLine - 1].parameter) + " at line " + std::to_string(loopLine);
+}
+
+std::vector<CFOLib::CFO_RunPlanDifference> CFOLib::CFO_RunPlanDisassembler::Diff(const std::vector<CFO_RunPlanInstruction>& a,
+																				 const std::vector<CFO_RunPlanInstruction>& b)
+{
+	// Align the run plans: the common start and end directly, the rest by longest common subsequence
+	size_t prefix = 0;
+	while (prefix < a.size() && prefix < b.size() && Same_(a[prefix], b[prefix])) ++prefix;
+	size_t suffix = 0;
+	while (suffix < a.size() - prefix && suffix < b.size() - prefix && Same_(a[a.size() - 1 - suffix], b[b.size() - 1 - suffix])) ++suffix;
+
+	std::vector<AlignmentStep> steps;
+	steps.reserve(std::max(a.size(), b.size()));
+	for (size_t ii = 0; ii < prefix; ++ii) steps.push_back({AlignmentStep::Match, ii, ii});
+
+	size_t rows = a.size() - prefix - suffix, cols = b.size() - prefix - suffix;
+	if (rows * cols <= maxAlignmentCells)
+	{
+		// lcs(i, j): length of the longest common subsequence of a[prefix + i...] and b[prefix + j...]
+		std::vector<uint32_t> lcs((rows + 1) * (cols + 1), 0);
+		auto at = [&lcs, cols](size_t i, size_t j) -> uint32_t& { return lcs[i * (cols + 1) + j]; };
+		for (size_t i = rows; i-- > 0;)
+			for (size_t j = cols; j-- > 0;)
+				at(i, j) = Same_(a[prefix + i], b[prefix + j]) ? at(i + 1, j + 1) + 1 : std::max(at(i + 1, j), at(i, j + 1));
+
+		size_t i = 0, j = 0;
+		while (i < rows && j < cols)
+		{
+			if (Same_(a[prefix + i], b[prefix + j]))
+				steps.push_back({AlignmentStep::Match, prefix + i++, prefix + j++});
+			else if (at(i + 1, j) >= at(i, j + 1))
+				steps.push_back({AlignmentStep::Remove, prefix + i++, 0});
+			else
+				steps.push_back({AlignmentStep::Add, 0, prefix + j++});
+		}
+		for (; i < rows; ++i) steps.push_back({AlignmentStep::Remove, prefix + i, 0});
+		for (; j < cols; ++j) steps.push_back({AlignmentStep::Add, 0, prefix + j});
+	}
+	else
+	{
+		__COUT_WARN__ << "Run plans differ over " << rows << " and " << cols << " instructions; comparing them position by position" << __E__;
+		for (size_t k = 0; k < std::max(rows, cols); ++k)
+		{
+			if (k < rows && k < cols && Same_(a[prefix + k], b[prefix + k]))
+				steps.push_back({AlignmentStep::Match, prefix + k, prefix + k});
+			else
+			{
+				if (k < rows) steps.push_back({AlignmentStep::Remove, prefix + k, 0});
+				if (k < cols) steps.push_back({AlignmentStep::Add, 0, prefix + k});
+			}
+		}
+	}
+	for (size_t ii = suffix; ii > 0; --ii) steps.push_back({AlignmentStep::Match, a.size() - ii, b.size() - ii});
+
+	std::vector<size_t> matchedLine(a.size() + 1, 0);  // Line in b of each matched (or changed) line of a
+	for (auto& step : steps)
+		if (step.type == AlignmentStep::Match) matchedLine[a[step.a].line] = b[step.b].line;
+
+	std::vector<CFO_RunPlanDifference> differences;
+	auto record = [&](CFO_RunPlanDifferenceType type, const CFO_RunPlanInstruction* x, const CFO_RunPlanInstruction* y) {
+		CFO_RunPlanDifference difference;
+		difference.type = type;
+		if (x != nullptr)
+		{
+			difference.lineA = x->line;
+			difference.textA = FormatInstruction(*x);
+		}
+		if (y != nullptr)
+		{
+			difference.lineB = y->line;
+			difference.textB = FormatInstruction(*y);
+		}
+		difference.context = x != nullptr ? Context_(a, x->line) : Context_(b, y->line);
+		differences.push_back(difference);
+	};
+
+	// Each run of removed and added instructions: a removed instruction and an added one of the same kind are a change
+	std::vector<size_t> removed, added;
+	auto flush = [&]() {
+		size_t k = 0;
+		for (auto ra : removed)
+		{
+			auto found = k;
+			while (found < added.size() && found < k + pairingWindow && b[added[found]].instr != a[ra].instr) ++found;
+			if (found == added.size() || found == k + pairingWindow)
+			{
+				record(CFO_RunPlanDifference_Removed, &a[ra], nullptr);
+				continue;
+			}
+			for (; k < found; ++k) record(CFO_RunPlanDifference_Added, nullptr, &b[added[k]]);
+			record(CFO_RunPlanDifference_Changed, &a[ra], &b[added[found]]);
+			matchedLine[a[ra].line] = b[added[found]].line;  // e.g. a LOOP with a new count is still the DO_LOOP's target
+			k = found + 1;
+		}
+		for (; k < added.size(); ++k) record(CFO_RunPlanDifference_Added, nullptr, &b[added[k]]);
+		removed.clear();
+		added.clear();
+	};
+
+	for (auto& step : steps)
+	{
+		if (step.type == AlignmentStep::Remove)
+		{
+			removed.push_back(step.a);
+			continue;
+		}
+		if (step.type == AlignmentStep::Add)
+		{
+			added.push_back(step.b);
+			continue;
+		}
+		flush();
+
+		// A DO_LOOP or GOTO is the same if it jumps to the instruction matched with the other one's target
+		auto& x = a[step.a];
+		auto& y = b[step.b];
+		if (x.instr == CFO_INSTR::DO_LOOP || x.instr == CFO_INSTR::GOTO)
+		{
+			auto same = x.target != 0 && y.target != 0 ? matchedLine[x.target] == y.target : x.parameter == y.parameter;
+			if (!same) record(CFO_RunPlanDifference_Changed, &x, &y);
+		}
+	}
+	flush();
+	return differences;
+}  // end Diff()
+
+std::string CFOLib::CFO_RunPlanDisassembler::FormatDiff(const std::vector<CFO_RunPlanDifference>& differences, size_t maxDifferences)
+{
+	std::ostringstream o;
+	if (differences.empty())
+	{
+		o << "Run plans are equivalent\n";
+		return o.str();
+	}
+
+	size_t changed = 0, added = 0, removed = 0;
+	for (auto& difference : differences)
+	{
+		if (difference.type == CFO_RunPlanDifference_Changed) ++changed;
+		if (difference.type == CFO_RunPlanDifference_Added) ++added;
+		if (difference.type == CFO_RunPlanDifference_Removed) ++removed;
+	}
+	o << "Run plans differ: " << changed << " changed, " << added << " added, " << removed << " removed\n";
+
+	for (size_t ii = 0; ii < differences.size() && ii < maxDifferences; ++ii)
+	{
+		auto& difference = differences[ii];
+		switch (difference.type)
+		{
+			case CFO_RunPlanDifference_Changed:
+				o << "changed line " << difference.lineA;
+				if (difference.lineB != difference.lineA) o << " (line " << difference.lineB << " in the second)";
+				break;
+			case CFO_RunPlanDifference_Added:
+				o << "added line " << difference.lineB;
+				break;
+			case CFO_RunPlanDifference_Removed:
+				o << "removed line " << difference.lineA;
+				break;
+		}
+		if (!difference.context.empty()) o << ", " << difference.context;
+		o << ":\n";
+		if (difference.type != CFO_RunPlanDifference_Added) o << "\t- " << difference.textA << "\n";
+		if (difference.type != CFO_RunPlanDifference_Removed) o << "\t+ " << difference.textB << "\n";
+	}
+	if (differences.size() > maxDifferences) o << "... and " << differences.size() - maxDifferences << " more differences\n";
+	return o.str();
+}  // end FormatDiff()
@@ -0,0 +1,115 @@
+#ifndef CFO_RUNPLANDISASSEMBLER_H
+#define CFO_RUNPLANDISASSEMBLER_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "cfoInterfaceLib/CFO_Compiler.hh"
+
+namespace CFOLib {
+
+/// <summary>
+/// One instruction of a compiled run plan, decoded by the CFO_RunPlanDisassembler
+/// </summary>
+struct CFO_RunPlanInstruction
+{
+	size_t line = 0;      ///< 1-based instruction number, as in the CFO_Compiler listing
+	uint64_t word = 0;    ///< Encoded instruction
+	CFO_Compiler::CFO_INSTR instr = CFO_Compiler::CFO_INSTR::NOOP;
+	uint64_t parameter = 0;
+	size_t depth = 0;     ///< Loop nesting depth
+	size_t loopLine = 0;  ///< Line of the innermost enclosing LOOP (0: none)
+	size_t target = 0;    ///< Line a DO_LOOP jumps back to, or a GOTO jumps to (0: none)
+	std::string text;     ///< The instruction in CFO_Compiler source syntax
+	std::string comment;  ///< Decoded meaning, e.g. the time of a WAIT
+};
+
+/// <summary>
+/// Type of a CFO_RunPlanDifference
+/// </summary>
+enum CFO_RunPlanDifferenceType
+{
+	CFO_RunPlanDifference_Changed,
+	CFO_RunPlanDifference_Added,
+	CFO_RunPlanDifference_Removed,
+};
+
+/// <summary>
+/// A difference between two run plans, found by CFO_RunPlanDisassembler::Diff
+/// </summary>
+struct CFO_RunPlanDifference
+{
+	CFO_RunPlanDifferenceType type = CFO_RunPlanDifference_Changed;
+	size_t lineA = 0;     ///< Line in the first run plan (0 for an added instruction)
+	size_t lineB = 0;     ///< Line in the second run plan (0 for a removed instruction)
+	std::string textA;
+	std::string textB;
+	std::string context;  ///< Enclosing loop, e.g. "in LOOP 100 at line 3"
+};
+
+/// <summary>
+/// The CFO_RunPlanDisassembler turns a compiled run plan (CFO_Compiler output, or a readback of the run plan memory)
+/// back into CFO_Compiler source, one source line per instruction, so that a loaded run plan can be read and
+/// recompiled. It also compares two run plans op by op: instructions are aligned as a sequence (longest common
+/// subsequence), so that an inserted instruction shows as one addition instead of a change of every following line.
+/// DO_LOOP and GOTO are compared by the instructions they jump to, not by their encoded distances and line numbers,
+/// which shift whenever an instruction is added or removed before them.
+/// </summary>
+class CFO_RunPlanDisassembler
+{
+public:
+	/// <summary>
+	/// Decode a compiled run plan
+	/// </summary>
+	/// <param name="binary">Compiled run plan, e.g. the contents of a CFO_Compiler output file</param>
+	/// <returns>Instructions, in order</returns>
+	static std::vector<CFO_RunPlanInstruction> Disassemble(const std::string& binary);
+	/// <summary>
+	/// Decode a compiled run plan
+	/// </summary>
+	/// <param name="binary">Compiled run plan, e.g. CFO_Compiler::getBinaryOutput()</param>
+	/// <returns>Instructions, in order</returns>
+	static std::vector<CFO_RunPlanInstruction> Disassemble(const std::deque<char>& binary);
+
+	/// <summary>
+	/// Format one instruction as a source line: its text, then its comment
+	/// </summary>
+	/// <param name="instruction">Decoded instruction</param>
+	/// <returns>Source line, without indentation</returns>
+	static std::string FormatInstruction(const CFO_RunPlanInstruction& instruction);
+	/// <summary>
+	/// Format decoded instructions, indented by loop depth
+	/// </summary>
+	/// <param name="instructions">Decoded instructions</param>
+	/// <param name="showWords">Prefix each line with its line number and encoded word, as in the CFO_Compiler listing.
+	/// Without them, the result is run plan source which compiles back to the same binary (with optimization off).</param>
+	/// <returns>Run plan listing</returns>
+	static std::string Format(const std::vector<CFO_RunPlanInstruction>& instructions, bool showWords = true);
+
+	/// <summary>
+	/// Compare two run plans op by op
+	/// </summary>
+	/// <param name="a">First run plan, e.g. the intended one</param>
+	/// <param name="b">Second run plan, e.g. the one read back from the CFO</param>
+	/// <returns>Differences, in run plan order; empty if the run plans are equivalent</returns>
+	static std::vector<CFO_RunPlanDifference> Diff(const std::vector<CFO_RunPlanInstruction>& a,
+												   const std::vector<CFO_RunPlanInstruction>& b);
+	/// <summary>
+	/// Format the differences of two run plans
+	/// </summary>
+	/// <param name="differences">Result of Diff</param>
+	/// <param name="maxDifferences">Number of differences to format; the others are counted</param>
+	/// <returns>Summary line, then each difference with the lines of both run plans</returns>
+	static std::string FormatDiff(const std::vector<CFO_RunPlanDifference>& differences, size_t maxDifferences = 1000);
+
+private:
+	static void Decode_(CFO_RunPlanInstruction& instruction);
+	static bool Same_(const CFO_RunPlanInstruction& a, const CFO_RunPlanInstruction& b);
+	static std::string Context_(const std::vector<CFO_RunPlanInstruction>& instructions, size_t line);
+};
+
+}  // namespace CFOLib
+
+#endif  // CFO_RUNPLANDISASSEMBLER_H
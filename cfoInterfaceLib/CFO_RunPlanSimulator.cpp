@@ -0,0 +1,338 @@
+#include "cfoInterfaceLib/CFO_RunPlanSimulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "cfoInterfaceLib/CFO_Compiler.hh"
+#include "dtcInterfaceLib/DTC_Registers.h"
+
+#include "TRACE/tracemf.h"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+namespace {
+template <typename Container>
+std::vector<uint64_t> RunPlanWords(const Container& binary)
+{
+	if (binary.size() % 8 != 0)
+	{
+		__SS__ << "Run plan binary size " << binary.size() << " is not a whole number of 8-byte instructions" << __E__;
+		__SS_THROW__;
+	}
+
+	std::vector<uint64_t> words(binary.size() / 8, 0);
+	size_t byte = 0;
+	for (auto c : binary)
+	{
+		words[byte / 8] |= static_cast<uint64_t>(static_cast<uint8_t>(c)) << (8 * (byte % 8));
+		++byte;
+	}
+	return words;
+}
+}  // namespace
+
+CFOLib::CFO_RunPlanSimulator::CFO_RunPlanSimulator(const CFO_RunPlanSimulatorOptions& options)
+	: options_(options)
+{
+	if (options_.clockPeriodNs == 0 || options_.rf0PeriodNs == 0)
+	{
+		__SS__ << "The clock and RF-0 periods of the run plan simulator must be non-zero" << __E__;
+		__SS_THROW__;
+	}
+}
+
+void CFOLib::CFO_RunPlanSimulator::Run(const std::deque<char>& binary) { Run_(RunPlanWords(binary)); }
+
+void CFOLib::CFO_RunPlanSimulator::Run(const std::string& binary) { Run_(RunPlanWords(binary)); }
+
+void CFOLib::CFO_RunPlanSimulator::Run_(const std::vector<uint64_t>& words)
+{
+	typedef CFO_Compiler::CFO_INSTR CFO_INSTR;
+	const uint64_t mask = CFO_Compiler::PARAMETER_MASK;
+
+	timeline_.clear();
+	requests_.clear();
+	statistics_ = CFO_RunPlanStatistics();
+	modes_.clear();
+	peakWindow_.clear();
+
+	uint64_t timeNs = 0;
+	uint64_t tag = 0;
+	uint64_t registeredMode = 0;
+	uint64_t windowMode = 0;                // Event mode of the last heartbeat
+	std::vector<uint64_t> loopRemaining;   // Iterations left, innermost last
+
+	size_t pc = 0;
+	while (pc < words.size() && timeNs < options_.maxDurationNs && statistics_.instructions < options_.maxInstructions)
+	{
+		auto instr = static_cast<CFO_INSTR>(words[pc] >> 56);
+		uint64_t parameter = words[pc] & mask;
+		++statistics_.instructions;
+		timeNs += options_.clocksPerInstruction * options_.clockPeriodNs;
+		size_t next = pc + 1;
+
+		switch (instr)
+		{
+			case CFO_INSTR::NOOP:
+				break;
+			case CFO_INSTR::HEARTBEAT:
+				windowMode = parameter == mask ? registeredMode : parameter;
+				Record_(CFO_RunPlanEvent_Heartbeat, timeNs, tag, windowMode);
+				break;
+			case CFO_INSTR::MARKER:
+				Record_(CFO_RunPlanEvent_Marker, timeNs, tag, windowMode);
+				break;
+			case CFO_INSTR::DATA_REQUEST:
+				Record_(CFO_RunPlanEvent_DataRequest, timeNs, parameter == mask ? tag : parameter, windowMode);
+				break;
+			case CFO_INSTR::SET_TAG:
+				tag = parameter;
+				break;
+			case CFO_INSTR::INC_TAG:
+				tag = (tag + parameter) & mask;
+				break;
+			case CFO_INSTR::WAIT:
+				if (parameter == mask)  // NEXT RF0
+					timeNs = (timeNs / options_.rf0PeriodNs + 1) * options_.rf0PeriodNs;
+				else
+					timeNs += parameter * options_.clockPeriodNs;
+				break;
+			case CFO_INSTR::LOOP:
+				loopRemaining.push_back(parameter);
+				break;
+			case CFO_INSTR::DO_LOOP:
+				if (loopRemaining.empty() || parameter == 0 || parameter > pc)
+				{
+					__SS__ << "Run plan instruction " << pc + 1 << ": DO_LOOP without a matching LOOP" << __E__;
+					__SS_THROW__;
+				}
+				if (loopRemaining.back() > 1)  // LOOP 0 runs once, like LOOP 1
+				{
+					--loopRemaining.back();
+					next = pc - parameter + 1;  // First instruction of the loop body
+				}
+				else
+					loopRemaining.pop_back();
+				break;
+			case CFO_INSTR::REPEAT:
+				loopRemaining.clear();
+				next = 0;
+				break;
+			case CFO_INSTR::GOTO:
+				if (parameter == 0 || parameter > words.size())
+				{
+					__SS__ << "Run plan instruction " << pc + 1 << ": GOTO to invalid line " << parameter << __E__;
+					__SS_THROW__;
+				}
+				loopRemaining.clear();
+				next = parameter - 1;
+				break;
+			case CFO_INSTR::END:
+				statistics_.ended = true;
+				next = words.size();
+				break;
+			case CFO_INSTR::AND_MODE_BITS:
+				registeredMode &= parameter;
+				break;
+			case CFO_INSTR::OR_MODE_BITS:
+				registeredMode |= parameter;
+				break;
+			default:
+			{
+				__SS__ << "Run plan instruction " << pc + 1 << ": unknown opcode " << static_cast<int>(instr) << __E__;
+				__SS_THROW__;
+			}
+		}
+		pc = next;
+	}
+
+	statistics_.durationNs = timeNs;
+	Finish_();
+	__COUT__ << "Simulated " << statistics_.instructions << " run plan instructions over " << timeNs / 1e6 << " ms: " << statistics_.heartbeats
+			 << " heartbeats, " << statistics_.dataRequests << " data requests" << __E__;
+}  // end Run_()
+
+void CFOLib::CFO_RunPlanSimulator::Record_(CFO_RunPlanEventType type, uint64_t timeNs, uint64_t tag, uint64_t eventMode)
+{
+	CFO_RunPlanEvent event;
+	event.timeNs = timeNs;
+	event.type = type;
+	event.tag = tag;
+	event.eventMode = eventMode;
+	if (timeline_.size() < options_.maxTimelineEvents) timeline_.push_back(event);
+
+	if (type == CFO_RunPlanEvent_Marker)
+	{
+		++statistics_.markers;
+		return;
+	}
+
+	ModeAccumulator_* mode = nullptr;
+	for (auto& accumulator : modes_)
+		if (accumulator.statistics.eventMode == eventMode) mode = &accumulator;
+	if (mode == nullptr)
+	{
+		modes_.emplace_back();
+		mode = &modes_.back();
+		mode->statistics.eventMode = eventMode;
+	}
+
+	if (type == CFO_RunPlanEvent_Heartbeat)
+	{
+		++statistics_.heartbeats;
+		++mode->statistics.heartbeats;
+		return;
+	}
+
+	++statistics_.dataRequests;
+	if (requests_.size() < options_.maxTimelineEvents) requests_.push_back(event);
+
+	peakWindow_.push_back(timeNs);
+	while (peakWindow_.front() + options_.peakWindowNs <= timeNs) peakWindow_.pop_front();
+	statistics_.peakRequests = std::max<uint64_t>(statistics_.peakRequests, peakWindow_.size());
+
+	auto& stats = mode->statistics;
+	if (stats.dataRequests > 0)
+	{
+		double gapNs = timeNs - mode->lastRequestNs;
+		stats.minimumGapNs = stats.dataRequests == 1 ? gapNs : std::min(stats.minimumGapNs, gapNs);
+		stats.maximumGapNs = std::max(stats.maximumGapNs, gapNs);
+		mode->gapSumNs += gapNs;
+		if (gapNs > options_.burstGapNs)
+		{
+			++stats.bursts;
+			stats.maximumBurstSize = std::max(stats.maximumBurstSize, mode->burstSize);
+			mode->burstSize = 0;
+		}
+	}
+	++mode->burstSize;
+	++stats.dataRequests;
+	mode->lastRequestNs = timeNs;
+}  // end Record_()
+
+void CFOLib::CFO_RunPlanSimulator::Finish_()
+{
+	double seconds = statistics_.durationNs / 1e9;
+	if (seconds > 0)
+	{
+		statistics_.heartbeatsPerSecond = statistics_.heartbeats / seconds;
+		statistics_.requestsPerSecond = statistics_.dataRequests / seconds;
+	}
+	statistics_.peakRequestsPerSecond = statistics_.peakRequests * 1e9 / options_.peakWindowNs;
+
+	for (auto& mode : modes_)
+	{
+		auto& stats = mode.statistics;
+		if (stats.dataRequests > 0)
+		{
+			++stats.bursts;  // The burst in progress
+			stats.maximumBurstSize = std::max(stats.maximumBurstSize, mode.burstSize);
+			stats.meanBurstSize = static_cast<double>(stats.dataRequests) / stats.bursts;
+		}
+		if (stats.dataRequests > 1) stats.meanGapNs = mode.gapSumNs / (stats.dataRequests - 1);
+		if (seconds > 0) stats.requestsPerSecond = stats.dataRequests / seconds;
+		statistics_.modes.push_back(stats);
+	}
+}  // end Finish_()
+
+std::string CFOLib::CFO_RunPlanSimulator::FormatStatistics() const
+{
+	std::ostringstream o;
+	o << std::fixed << std::setprecision(3);
+	o << "Run plan simulation: " << statistics_.durationNs / 1e6 << " ms, " << statistics_.instructions << " instructions"
+	  << (statistics_.ended ? ", reached END" : ", stopped at the simulation limit") << std::endl;
+	o << "Heartbeats: " << statistics_.heartbeats << " (" << statistics_.heartbeatsPerSecond << " /s), markers: " << statistics_.markers
+	  << ", data requests: " << statistics_.dataRequests << " (" << statistics_.requestsPerSecond << " /s)" << std::endl;
+	o << "Peak data requests: " << statistics_.peakRequests << " in " << options_.peakWindowNs / 1e6 << " ms ("
+	  << statistics_.peakRequestsPerSecond << " /s)" << std::endl;
+
+	o << std::left << std::setw(16) << "Event mode" << std::right << std::setw(12) << "Heartbeats" << std::setw(12) << "Requests"
+	  << std::setw(14) << "Requests/s" << std::setw(12) << "Gap min ns" << std::setw(12) << "Gap mean ns" << std::setw(12) << "Gap max ns"
+	  << std::setw(10) << "Bursts" << std::setw(12) << "Burst mean" << std::setw(11) << "Burst max" << std::endl;
+	for (auto const& mode : statistics_.modes)
+	{
+		std::ostringstream modeHex;
+		modeHex << "0x" << std::hex << mode.eventMode;
+		o << std::left << std::setw(16) << modeHex.str() << std::right << std::setw(12) << mode.heartbeats << std::setw(12) << mode.dataRequests
+		  << std::setw(14) << mode.requestsPerSecond << std::setw(12) << mode.minimumGapNs << std::setw(12) << mode.meanGapNs << std::setw(12)
+		  << mode.maximumGapNs << std::setw(10) << mode.bursts << std::setw(12) << mode.meanBurstSize << std::setw(11) << mode.maximumBurstSize
+		  << std::endl;
+	}
+	return o.str();
+}  // end FormatStatistics()
+
+std::string CFOLib::CFO_RunPlanSimulator::FormatTimeline(size_t maxEvents) const
+{
+	std::ostringstream o;
+	for (size_t ii = 0; ii < timeline_.size() && ii < maxEvents; ++ii)
+	{
+		auto const& event = timeline_[ii];
+		o << std::setw(14) << event.timeNs << " ns  "
+		  << (event.type == CFO_RunPlanEvent_Heartbeat ? "HEARTBEAT   " : event.type == CFO_RunPlanEvent_Marker ? "MARKER      " : "DATA_REQUEST")
+		  << " tag " << event.tag << " mode 0x" << std::hex << event.eventMode << std::dec << std::endl;
+	}
+	if (timeline_.size() > maxEvents) o << "... " << timeline_.size() - maxEvents << " more events" << std::endl;
+	return o.str();
+}  // end FormatTimeline()
+
+std::vector<CFOLib::CFO_EmulatorSegment> CFOLib::CFO_RunPlanSimulator::GetEmulatorSegments() const
+{
+	std::vector<CFO_EmulatorSegment> segments;
+	uint64_t lastTimeNs = 0;
+	for (auto const& request : requests_)
+	{
+		auto intervalClocks = (request.timeNs - lastTimeNs) / options_.clockPeriodNs;
+		if (!segments.empty())
+		{
+			auto& segment = segments.back();
+			bool sameRun = segment.eventMode == request.eventMode && request.tag == segment.startTag + segment.count &&
+						   segment.count < UINT32_MAX;
+			if (sameRun && segment.count == 1 && intervalClocks <= UINT32_MAX)
+			{
+				segment.intervalClocks = static_cast<uint32_t>(intervalClocks);  // The second request sets the interval
+				++segment.count;
+				lastTimeNs = request.timeNs;
+				continue;
+			}
+			if (sameRun && segment.intervalClocks == intervalClocks)
+			{
+				++segment.count;
+				lastTimeNs = request.timeNs;
+				continue;
+			}
+		}
+
+		CFO_EmulatorSegment segment;
+		segment.startTag = request.tag;
+		segment.count = 1;
+		segment.eventMode = request.eventMode;
+		segments.push_back(segment);
+		lastTimeNs = request.timeNs;
+	}
+	return segments;
+}  // end GetEmulatorSegments()
+
+void CFOLib::CFO_RunPlanSimulator::PlayOnCFOEmulator(DTCLib::DTC_Registers& dtc, const std::vector<CFO_EmulatorSegment>& segments)
+{
+	bool hardware = dtc.GetSimMode() == DTCLib::DTC_SimMode_Disabled || dtc.GetSimMode() == DTCLib::DTC_SimMode_NoCFO;
+	dtc.SetCFOEmulationMode();
+	for (auto const& segment : segments)
+	{
+		// The CFO emulator needs at least 0x20 clocks (800 ns) between event windows
+		auto intervalClocks = std::max<uint32_t>(segment.intervalClocks, 0x20);
+
+		dtc.DisableCFOEmulation();
+		dtc.SetCFOEmulationTimestamp(DTCLib::DTC_EventWindowTag(segment.startTag));
+		dtc.SetCFOEmulationNumHeartbeats(segment.count);
+		dtc.SetCFOEmulationEventWindowInterval(intervalClocks);
+		dtc.SetCFOEmulationEventMode(segment.eventMode);
+		dtc.EnableCFOEmulation();
+
+		if (hardware)  // Let the segment finish; the DTC clock is 40 MHz
+			std::this_thread::sleep_for(std::chrono::nanoseconds(uint64_t(segment.count) * intervalClocks * 25));
+	}
+	dtc.DisableCFOEmulation();
+}  // end PlayOnCFOEmulator()
@@ -0,0 +1,187 @@
+#ifndef CFO_RUNPLANSIMULATOR_H
+#define CFO_RUNPLANSIMULATOR_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace DTCLib {
+class DTC_Registers;
+}
+
+namespace CFOLib {
+
+/// <summary>
+/// Type of a CFO_RunPlanEvent
+/// </summary>
+enum CFO_RunPlanEventType
+{
+	CFO_RunPlanEvent_Heartbeat,
+	CFO_RunPlanEvent_Marker,
+	CFO_RunPlanEvent_DataRequest,
+};
+
+/// <summary>
+/// A packet the CFO sends while executing a run plan, as predicted by the CFO_RunPlanSimulator
+/// </summary>
+struct CFO_RunPlanEvent
+{
+	uint64_t timeNs = 0;  ///< Time since the start of the run plan
+	CFO_RunPlanEventType type = CFO_RunPlanEvent_Heartbeat;
+	uint64_t tag = 0;        ///< Event Window Tag (Heartbeat, Marker) or requested tag (Data Request)
+	uint64_t eventMode = 0;  ///< Event mode of the heartbeat, or of the event window of the data request
+};
+
+/// <summary>
+/// Statistics of the heartbeats and data requests of one event mode
+/// </summary>
+struct CFO_RunPlanModeStatistics
+{
+	uint64_t eventMode = 0;
+	uint64_t heartbeats = 0;
+	uint64_t dataRequests = 0;
+	double requestsPerSecond = 0;
+	double minimumGapNs = 0;  ///< Gaps between consecutive data requests of this event mode
+	double meanGapNs = 0;
+	double maximumGapNs = 0;
+	uint64_t bursts = 0;  ///< Runs of data requests separated by at most the burst gap
+	double meanBurstSize = 0;
+	uint64_t maximumBurstSize = 0;
+};
+
+/// <summary>
+/// Statistics of a simulated run plan
+/// </summary>
+struct CFO_RunPlanStatistics
+{
+	uint64_t durationNs = 0;    ///< Simulated time
+	uint64_t instructions = 0;  ///< Instructions executed
+	bool ended = false;         ///< Whether the run plan reached END (otherwise the simulation limit was reached)
+	uint64_t heartbeats = 0;
+	uint64_t markers = 0;
+	uint64_t dataRequests = 0;
+	double heartbeatsPerSecond = 0;
+	double requestsPerSecond = 0;
+	uint64_t peakRequests = 0;        ///< Most data requests within one peak window
+	double peakRequestsPerSecond = 0;  ///< peakRequests scaled to one second
+	std::vector<CFO_RunPlanModeStatistics> modes;  ///< By event mode, in order of first appearance
+};
+
+/// <summary>
+/// A run of evenly spaced data requests with consecutive tags and the same event mode, which the DTC CFO emulator
+/// can reproduce with one configuration
+/// </summary>
+struct CFO_EmulatorSegment
+{
+	uint64_t startTag = 0;
+	uint32_t count = 0;
+	uint32_t intervalClocks = 0;  ///< Clocks between event windows
+	uint64_t eventMode = 0;
+};
+
+/// <summary>
+/// Options of the CFO_RunPlanSimulator
+/// </summary>
+struct CFO_RunPlanSimulatorOptions
+{
+	uint64_t clockPeriodNs = 25;       ///< CFO FPGA clock period (40 MHz, as used by CFO_Compiler for WAIT)
+	uint64_t rf0PeriodNs = 1695;       ///< Period of the RF-0 accelerator marker, for WAIT NEXT RF0
+	/// Execution time of each instruction, in clocks, on top of WAITs. CFO_Compiler converts WAIT times to clocks as if
+	/// the other instructions took no time, and the firmware's per-instruction cost is not specified here, so the
+	/// default of 0 gives the timeline the run plan source describes. Set it to see how the firmware overhead shifts
+	/// the timeline (cfoUtil simulate_program --instruction-clocks).
+	uint64_t clocksPerInstruction = 0;
+	uint64_t maxDurationNs = 1000000000;  ///< Simulated time limit, for run plans which REPEAT or GOTO forever
+	uint64_t maxInstructions = 1000000000;
+	size_t maxTimelineEvents = 1000000;   ///< Events kept in the timeline; statistics cover all events
+	uint64_t burstGapNs = 2000;           ///< Data requests at most this far apart belong to the same burst
+	uint64_t peakWindowNs = 1000000;      ///< Window for the peak data request rate
+};
+
+/// <summary>
+/// The CFO_RunPlanSimulator executes a compiled run plan (CFO_Compiler output) the way the CFO does, with clock
+/// resolution: HEARTBEAT, MARKER, DATA_REQUEST, SET_TAG/INC_TAG, WAIT (clocks or NEXT RF0), LOOP/DO_LOOP, REPEAT,
+/// GOTO, END and the mode bit operations. It predicts the heartbeat and data request timeline of the run plan and
+/// the resulting rates, gaps, bursts and peak DTC load, so that readout can be sized for a beam pattern offline.
+/// The predicted data requests can also be played on the DTC CFO emulator (e.g. in mu2esim).
+/// </summary>
+class CFO_RunPlanSimulator
+{
+public:
+	/// <summary>
+	/// Construct a CFO_RunPlanSimulator
+	/// </summary>
+	/// <param name="options">Simulation options</param>
+	explicit CFO_RunPlanSimulator(const CFO_RunPlanSimulatorOptions& options = CFO_RunPlanSimulatorOptions());
+
+	/// <summary>
+	/// Simulate a compiled run plan
+	/// </summary>
+	/// <param name="binary">Compiled run plan, e.g. CFO_Compiler::getBinaryOutput()</param>
+	void Run(const std::deque<char>& binary);
+	/// <summary>
+	/// Simulate a compiled run plan
+	/// </summary>
+	/// <param name="binary">Compiled run plan, e.g. the contents of a CFO_Compiler output file</param>
+	void Run(const std::string& binary);
+
+	/// <summary>
+	/// Get the predicted timeline of the last Run (at most maxTimelineEvents events)
+	/// </summary>
+	/// <returns>Heartbeats, markers and data requests, in time order</returns>
+	const std::vector<CFO_RunPlanEvent>& GetTimeline() const { return timeline_; }
+	/// <summary>
+	/// Get the statistics of the last Run
+	/// </summary>
+	/// <returns>Run plan statistics</returns>
+	const CFO_RunPlanStatistics& GetStatistics() const { return statistics_; }
+	/// <summary>
+	/// Format the statistics of the last Run as a table
+	/// </summary>
+	/// <returns>Statistics table</returns>
+	std::string FormatStatistics() const;
+	/// <summary>
+	/// Format the timeline of the last Run, one event per line
+	/// </summary>
+	/// <param name="maxEvents">Number of events to format</param>
+	/// <returns>Timeline text</returns>
+	std::string FormatTimeline(size_t maxEvents = 1000) const;
+
+	/// <summary>
+	/// Split the data requests of the timeline into runs which the DTC CFO emulator can reproduce
+	/// </summary>
+	/// <returns>CFO emulator segments, in time order</returns>
+	std::vector<CFO_EmulatorSegment> GetEmulatorSegments() const;
+	/// <summary>
+	/// Play CFO emulator segments on a DTC: each segment configures the CFO emulator (start tag, count, interval and
+	/// event mode) and enables it. On hardware, each segment is given its duration to complete before the next one.
+	/// </summary>
+	/// <param name="dtc">DTC whose CFO emulator to drive, e.g. a DTC in a mu2esim simulation mode</param>
+	/// <param name="segments">Segments to play</param>
+	static void PlayOnCFOEmulator(DTCLib::DTC_Registers& dtc, const std::vector<CFO_EmulatorSegment>& segments);
+
+private:
+	void Run_(const std::vector<uint64_t>& words);
+	void Record_(CFO_RunPlanEventType type, uint64_t timeNs, uint64_t tag, uint64_t eventMode);
+	void Finish_();
+
+	struct ModeAccumulator_
+	{
+		CFO_RunPlanModeStatistics statistics;
+		uint64_t lastRequestNs = 0;
+		uint64_t burstSize = 0;
+		double gapSumNs = 0;
+	};
+
+	CFO_RunPlanSimulatorOptions options_;
+	std::vector<CFO_RunPlanEvent> timeline_;
+	std::vector<CFO_RunPlanEvent> requests_;  ///< Data requests, for the emulator segments (at most maxTimelineEvents)
+	CFO_RunPlanStatistics statistics_;
+	std::vector<ModeAccumulator_> modes_;
+	std::deque<uint64_t> peakWindow_;  ///< Times of the data requests within the last peak window
+};
+
+}  // namespace CFOLib
+
+#endif  // CFO_RUNPLANSIMULATOR_H
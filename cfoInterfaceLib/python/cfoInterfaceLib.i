@@ -10,8 +10,11 @@
 
 %{
 #include "cfoInterfaceLib/CFO_Registers.h"
+#include "cfoInterfaceLib/CFO_RecordReader.h"
 #include "cfoInterfaceLib/CFO.h"
 #include "cfoInterfaceLib/CFO_Compiler.hh"
+#include "cfoInterfaceLib/CFO_RunPlanSimulator.h"
+#include "cfoInterfaceLib/CFO_RunPlanDisassembler.h"
 using namespace CFOLib;
 %}
 //------------------------------------------------------------------------------
@@ -24,5 +27,13 @@ using namespace CFOLib;
 //-----------------------------------------------------------------------------
 // %include "mu2e_driver/mu2e_mmap_ioctl.h"
 %include "cfoInterfaceLib/CFO_Registers.h"
+%include "cfoInterfaceLib/CFO_RecordReader.h"
 %include "cfoInterfaceLib/CFO.h"
 %include "cfoInterfaceLib/CFO_Compiler.hh"
+%include "cfoInterfaceLib/CFO_RunPlanSimulator.h"
+%include "cfoInterfaceLib/CFO_RunPlanDisassembler.h"
+%template(CFO_RunPlanEventVector) std::vector<CFOLib::CFO_RunPlanEvent>;
+%template(CFO_RunPlanModeStatisticsVector) std::vector<CFOLib::CFO_RunPlanModeStatistics>;
+%template(CFO_EmulatorSegmentVector) std::vector<CFOLib::CFO_EmulatorSegment>;
+%template(CFO_RunPlanInstructionVector) std::vector<CFOLib::CFO_RunPlanInstruction>;
+%template(CFO_RunPlanDifferenceVector) std::vector<CFOLib::CFO_RunPlanDifference>;
@@ -0,0 +1,70 @@
+// Cable delay measurement test on the simulated CFO (mu2esim), which models a chain of DTCs on every link
+// (DTCLIB_SIM_CFO_DTCS_PER_LINK, 2 by default) and completes each loopback measurement after 2^exponent samples.
+// Checks that all links are measured together, that a hop without a DTC times out once and is then skipped,
+// and that the statistics match the simulated delays.
+
+#include <cstdlib>
+#include <iostream>
+
+#include "cfoInterfaceLib/CFO_Registers.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace CFOLib;
+
+int main()
+{
+	setenv("DTCLIB_SIM_CFO_DTCS_PER_LINK", "2", 1);
+	CFO_Registers thisCFO(DTC_SimMode_Performance, 0);
+	TestChecks checks;
+
+	CFO_CableDelayOptions options;
+	options.hops = 3;  // The third hop has no DTC
+	options.samples = 16;
+	options.exponentialCount = 2;
+	options.timeoutMs = 20;
+	auto table = thisCFO.MeasureCableDelays(options);
+	std::cout << table.Format();
+
+	if (table.entries.size() != 24 || table.measurements != options.samples)
+	{
+		checks.Fail() << "expected 24 link hops and " << options.samples << " measurements, got " << table.entries.size() << " and "
+					  << table.measurements << std::endl;
+	}
+	for (auto const& entry : table.entries)
+	{
+		if (entry.hop < 2)
+		{
+			double expected = 400 + 25 * entry.link + 300 * entry.hop;
+			if (entry.samples != options.samples || entry.timeouts != 0 || entry.minimum < expected || entry.maximum > expected + 4 ||
+				entry.mean < expected || entry.mean > expected + 4 || entry.minimum == entry.maximum)
+			{
+				checks.Fail() << "link " << int(entry.link) << " hop " << int(entry.hop) << " statistics do not match the simulated delay "
+							  << expected << std::endl;
+			}
+		}
+		else if (entry.samples != 0 || entry.timeouts != 1)
+		{
+			checks.Fail() << "link " << int(entry.link) << " hop " << int(entry.hop) << " without a DTC should time out exactly once"
+						  << std::endl;
+		}
+	}
+
+	// All links are polled together: a handful of polls per measurement, not one per link and hop
+	if (table.polls > table.measurements * 10 + 200)
+	{
+		checks.Fail() << table.polls << " polls for " << table.measurements << " measurements" << std::endl;
+	}
+	std::cout << "Measured " << table.entries.size() << " link hops in " << table.durationMs << " ms" << std::endl;
+
+	try
+	{
+		options.hops = 7;
+		thisCFO.MeasureCableDelays(options);
+		checks.Fail() << "7 hops were accepted" << std::endl;
+	}
+	catch (std::exception const&)
+	{
+	}
+
+	return checks.Finish();
+}
@@ -0,0 +1,100 @@
+// Run plan disassembler and diff test. Checks that a disassembled run plan compiles back to the same binary, that an
+// inserted instruction shows as one addition (not as changed DO_LOOP distances and GOTO lines after it), that a
+// changed WAIT shows as one change, and the quick loaded-run-plan check on the simulated CFO (mu2esim).
+
+#include <fstream>
+#include <iostream>
+
+#include "cfoInterfaceLib/CFO_Compiler.hh"
+#include "cfoInterfaceLib/CFO_Registers.h"
+#include "cfoInterfaceLib/CFO_RunPlanDisassembler.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace CFOLib;
+
+namespace {
+// Compile run plan source, without optimization so that each source line is one instruction
+std::string Compile(const std::string& source)
+{
+	TestTemporaryFile sourceFile(".txt"), binaryFile(".bin");
+	std::ofstream(sourceFile.Path()) << source;
+	CFO_Compiler compiler;
+	compiler.setOptimize(false);
+	compiler.processFile(sourceFile.Path(), binaryFile.Path());
+	auto& binary = compiler.getBinaryOutput();
+	return std::string(binary.begin(), binary.end());
+}
+}  // namespace
+
+int main()
+{
+	TestChecks checks;
+
+	auto plan = Compile(
+		"SET_TAG 1\n"
+		"LABEL\n"
+		"HEARTBEAT event_mode=0x20\n"
+		"LOOP 100\n"
+		"	DATA_REQUEST request_tag=current\n"
+		"	WAIT 10 us\n"
+		"	INC_TAG\n"
+		"DO_LOOP\n"
+		"SET_MODE_BITS start_bit=4 bit_count=4 value=5\n"
+		"CLEAR_MODE_BITS start_bit=8 bit_count=2\n"
+		"HEARTBEAT event_mode=registered\n"
+		"WAIT NEXT RF0\n"
+		"GOTO_LABEL\n");
+	// A MARKER before the LABEL and one in the loop, and a longer WAIT
+	auto changed = Compile(
+		"SET_TAG 1\n"
+		"MARKER\n"
+		"LABEL\n"
+		"HEARTBEAT event_mode=0x20\n"
+		"LOOP 100\n"
+		"	DATA_REQUEST request_tag=current\n"
+		"	MARKER\n"
+		"	WAIT 20 us\n"
+		"	INC_TAG\n"
+		"DO_LOOP\n"
+		"SET_MODE_BITS start_bit=4 bit_count=4 value=5\n"
+		"CLEAR_MODE_BITS start_bit=8 bit_count=2\n"
+		"HEARTBEAT event_mode=registered\n"
+		"WAIT NEXT RF0\n"
+		"GOTO_LABEL\n");
+
+	auto instructions = CFO_RunPlanDisassembler::Disassemble(plan);
+	std::cout << CFO_RunPlanDisassembler::Format(instructions);
+	checks.Check("one instruction per source line", instructions.size() == 14);
+	checks.Check("loop structure", instructions[4].depth == 1 && instructions[7].instr == CFO_Compiler::CFO_INSTR::DO_LOOP &&
+									   instructions[7].target == 4 && instructions[13].target == 2);
+
+	auto source = CFO_RunPlanDisassembler::Format(instructions, false /* showWords */);
+	checks.Check("disassembly compiles back to the same binary", Compile(source) == plan);
+
+	auto differences = CFO_RunPlanDisassembler::Diff(instructions, CFO_RunPlanDisassembler::Disassemble(changed));
+	std::cout << CFO_RunPlanDisassembler::FormatDiff(differences);
+	checks.Check("inserted instructions and a changed WAIT are three differences", differences.size() == 3);
+	checks.Check("inserted MARKERs are additions", differences.size() == 3 && differences[0].type == CFO_RunPlanDifference_Added &&
+													   differences[0].lineB == 2 && differences[1].type == CFO_RunPlanDifference_Added &&
+													   differences[1].lineB == 7 && differences[1].context == "in LOOP 100 at line 5");
+	checks.Check("changed WAIT", differences.size() == 3 && differences[2].type == CFO_RunPlanDifference_Changed &&
+									 differences[2].lineA == 6 && differences[2].lineB == 8);
+	checks.Check("identical run plans", CFO_RunPlanDisassembler::Diff(instructions, instructions).empty());
+
+	// A DO_LOOP jumping back to another instruction is a change, even with the same encoded distance
+	auto moved = plan;
+	moved[8 * 7] = 2;  // DO_LOOP back to line 6
+	auto movedDifferences = CFO_RunPlanDisassembler::Diff(instructions, CFO_RunPlanDisassembler::Disassemble(moved));
+	checks.Check("DO_LOOP target", movedDifferences.size() == 1 && movedDifferences[0].lineA == 8);
+
+	// Loaded run plan check on the simulated CFO
+	CFO_Registers thisCFO(DTC_SimMode_Performance, 0);
+	thisCFO.SetRunPlanData(plan, 0x100);
+	checks.Check("run plan loaded", thisCFO.IsRunPlanLoaded(plan, 0x100));
+	checks.Check("other run plan not loaded", !thisCFO.IsRunPlanLoaded(changed, 0x100) && !thisCFO.IsRunPlanLoaded(plan, 0x101));
+	auto readback = thisCFO.ReadRunPlanData(0x100, plan.size());
+	checks.Check("run plan readback", readback == plan);
+	checks.Check("readback is equivalent", CFO_RunPlanDisassembler::Diff(CFO_RunPlanDisassembler::Disassemble(readback), instructions).empty());
+
+	return checks.Finish();
+}
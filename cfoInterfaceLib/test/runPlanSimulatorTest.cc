@@ -0,0 +1,144 @@
+// Run plan simulator test. Checks the LOOP/DO_LOOP, WAIT (clocks and NEXT RF0) and GOTO timing of a run plan against
+// hand-computed timelines, without and with a per-instruction cost, and that the run plan optimizer keeps the timing.
+
+#include <fstream>
+#include <iostream>
+
+#include "cfoInterfaceLib/CFO_Compiler.hh"
+#include "cfoInterfaceLib/CFO_RunPlanSimulator.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace CFOLib;
+
+namespace {
+// Expected events: time, type and tag
+struct Expected
+{
+	uint64_t timeNs;
+	CFO_RunPlanEventType type;
+	uint64_t tag;
+};
+
+bool Matches(const std::vector<CFO_RunPlanEvent>& timeline, const std::vector<Expected>& expected)
+{
+	auto ok = timeline.size() == expected.size();
+	for (size_t ii = 0; ii < timeline.size(); ++ii)
+	{
+		std::cout << "    " << timeline[ii].timeNs << " ns: type " << timeline[ii].type << ", tag " << timeline[ii].tag << std::endl;
+		ok = ok && ii < expected.size() && timeline[ii].timeNs == expected[ii].timeNs && timeline[ii].type == expected[ii].type &&
+			 timeline[ii].tag == expected[ii].tag;
+	}
+	return ok;
+}
+}  // namespace
+
+int main()
+{
+	TestChecks checks;
+
+	// Instructions: 1 SET_TAG, 2 LABEL, 3 HEARTBEAT, 4 LOOP, 5-7 body, 8 DO_LOOP, 9 WAIT NEXT RF0, 10 GOTO
+	TestTemporaryFile sourceFile(".txt"), binaryFile(".bin");
+	std::ofstream(sourceFile.Path()) << "SET_TAG 1\n"
+										"LABEL\n"
+										"HEARTBEAT event_mode=0x20\n"
+										"LOOP 3\n"
+										"	DATA_REQUEST request_tag=current\n"
+										"	WAIT 100 clocks\n"
+										"	INC_TAG\n"
+										"DO_LOOP\n"
+										"WAIT NEXT RF0\n"
+										"GOTO_LABEL\n";
+	CFO_Compiler compiler;
+	compiler.processFile(sourceFile.Path(), binaryFile.Path());
+	checks.Check("one instruction per source line", compiler.getBinaryOutput().size() == 10 * 8);
+
+	// One pass is 4 + 3 * 4 + 2 = 18 instructions; the GOTO then runs LABEL and the second HEARTBEAT
+	CFO_RunPlanSimulatorOptions options;
+	options.maxInstructions = 20;
+
+	// No per-instruction cost: only the WAITs take time. Three 100-clock (2500 ns) WAITs end at 7500 ns, and the next
+	// RF-0 marker after that is at 5 * 1695 = 8475 ns.
+	{
+		CFO_RunPlanSimulator simulator(options);
+		simulator.Run(compiler.getBinaryOutput());
+		checks.Check("timeline without per-instruction cost",
+					 Matches(simulator.GetTimeline(), {{0, CFO_RunPlanEvent_Heartbeat, 1},
+													   {0, CFO_RunPlanEvent_DataRequest, 1},
+													   {2500, CFO_RunPlanEvent_DataRequest, 2},
+													   {5000, CFO_RunPlanEvent_DataRequest, 3},
+													   {8475, CFO_RunPlanEvent_Heartbeat, 4}}));
+		checks.Check("instructions executed", simulator.GetStatistics().instructions == 20 && !simulator.GetStatistics().ended);
+	}
+
+	// 2 clocks (50 ns) per instruction, counted before each instruction takes effect: the HEARTBEAT is the third
+	// instruction (150 ns), each loop iteration takes 4 * 50 + 2500 = 2700 ns, the third iteration ends at 8300 ns,
+	// the WAIT NEXT RF0 starts at 8350 ns and still ends at 8475 ns, and the GOTO and LABEL add 100 ns before the
+	// second HEARTBEAT.
+	{
+		options.clocksPerInstruction = 2;
+		CFO_RunPlanSimulator simulator(options);
+		simulator.Run(compiler.getBinaryOutput());
+		checks.Check("timeline with 2 clocks per instruction",
+					 Matches(simulator.GetTimeline(), {{150, CFO_RunPlanEvent_Heartbeat, 1},
+													   {250, CFO_RunPlanEvent_DataRequest, 1},
+													   {2950, CFO_RunPlanEvent_DataRequest, 2},
+													   {5650, CFO_RunPlanEvent_DataRequest, 3},
+													   {8625, CFO_RunPlanEvent_Heartbeat, 4}}));
+		checks.Check("duration with 2 clocks per instruction", simulator.GetStatistics().durationNs == 8625);
+	}
+
+	// The optimizer merges WAITs, folds tag and mode bit instructions and collapses delay loops; with the same
+	// per-instruction cost, the optimized plan must give the same timeline in fewer instructions.
+	TestTemporaryFile optimizeFile(".txt"), plainFile(".bin"), optimizedFile(".bin");
+	std::ofstream(optimizeFile.Path()) << "SET_TAG 5\n"
+										  "HEARTBEAT event_mode=0x20\n"
+										  "WAIT 10 clocks\n"
+										  "INC_TAG\n"
+										  "OR_MODE_BITS start_bit=0 bit_count=2 value=3\n"
+										  "WAIT 20 clocks\n"
+										  "AND_MODE_BITS start_bit=0 bit_count=4 value=1\n"
+										  "INC_TAG\n"
+										  "DATA_REQUEST request_tag=current\n"
+										  "LOOP 4\n"
+										  "	WAIT 7 clocks\n"
+										  "DO_LOOP\n"
+										  "INC_TAG add_value=0\n"
+										  "HEARTBEAT event_mode=registered\n"
+										  "WAIT NEXT RF0\n"
+										  "WAIT 3 clocks\n"
+										  "WAIT 4 clocks\n"
+										  "MARKER\n"
+										  "END\n";
+	for (uint64_t clocksPerInstruction : {0, 2})
+	{
+		CFO_RunPlanSimulatorOptions optimizeOptions;
+		optimizeOptions.clocksPerInstruction = clocksPerInstruction;
+
+		CFO_Compiler plain;
+		plain.processFile(optimizeFile.Path(), plainFile.Path());
+		CFO_RunPlanSimulator plainSimulator(optimizeOptions);
+		plainSimulator.Run(plain.getBinaryOutput());
+
+		CFO_Compiler optimizing;
+		optimizing.setOptimize(true);
+		optimizing.setClocksPerInstruction(clocksPerInstruction);
+		optimizing.processFile(optimizeFile.Path(), optimizedFile.Path());
+		CFO_RunPlanSimulator optimizedSimulator(optimizeOptions);
+		optimizedSimulator.Run(optimizing.getBinaryOutput());
+
+		auto const& plainTimeline = plainSimulator.GetTimeline();
+		auto const& optimizedTimeline = optimizedSimulator.GetTimeline();
+		auto same = plainTimeline.size() == optimizedTimeline.size() && plainSimulator.GetStatistics().ended &&
+					optimizedSimulator.GetStatistics().ended &&
+					plainSimulator.GetStatistics().durationNs == optimizedSimulator.GetStatistics().durationNs;
+		for (size_t ii = 0; same && ii < plainTimeline.size(); ++ii)
+			same = plainTimeline[ii].timeNs == optimizedTimeline[ii].timeNs && plainTimeline[ii].type == optimizedTimeline[ii].type &&
+				   plainTimeline[ii].tag == optimizedTimeline[ii].tag && plainTimeline[ii].eventMode == optimizedTimeline[ii].eventMode;
+		std::cout << "    " << plain.getBinaryOutput().size() / 8 << " instructions, " << optimizing.getBinaryOutput().size() / 8
+				  << " optimized, " << optimizedSimulator.GetStatistics().durationNs << " ns" << std::endl;
+		checks.Check("optimized timeline with " + std::to_string(clocksPerInstruction) + " clocks per instruction",
+					 same && optimizing.getBinaryOutput().size() < plain.getBinaryOutput().size());
+	}
+
+	return checks.Finish();
+}
@@ -10,6 +10,7 @@
 #include <cmath>
 #include <cstdio>   // printf
 #include <cstdlib>  // strtoul
+#include <cstring>  // memcpy
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -18,8 +19,12 @@
 
 #include "TRACE/tracemf.h"
 
+#include "cfoInterfaceLib/CFO.h"
 #include "cfoInterfaceLib/CFO_Compiler.hh"
 #include "cfoInterfaceLib/CFO_Registers.h"
+#include "cfoInterfaceLib/CFO_RunPlanDisassembler.h"
+#include "cfoInterfaceLib/CFO_RunPlanSimulator.h"
+#include "dtcInterfaceLib/DTC.h"
 
 using namespace CFOLib;
 
@@ -27,6 +32,12 @@ using namespace CFOLib;
 std::string rawOutputFile = "/tmp/cfoUtil.raw";
 std::string inputFile = "/tmp/cfoUtil.raw";
 bool compileInputFile = false;
+bool emulateProgram = false;
+unsigned instructionClocks = 0;
+std::string compareFile = "";
+unsigned runPlanAddress = 0;
+unsigned timelineEvents = 0;
+unsigned recordCount = 1000;
 std::ofstream outputStream;
 unsigned targetFrequency = 166666667;
 unsigned clockSpeed = 40000000;
@@ -160,19 +171,112 @@ std::string getLongOptionString(int* index, char** argv[])
 	}
 }
 
+// Compare the copying CFO readout (one DMA buffer per read and one CFO_Event copy per record, as in CFO::GetData)
+// with the batched, zero-copy CFO_RecordReader, on mu2esim serving a generated file of CFO record buffers
+void benchmarkReadout()
+{
+	const std::string simFile = "/tmp/cfoUtil_benchmark.bin";
+	const size_t recordsPerBuffer = 100;
+	const size_t buffersInFile = 64;
+	const size_t stride = CFO_RecordReader::RecordStride;
+
+	{
+		// Each buffer is the DMA byte count (records plus one tlast byte), then the stacked transfers of the records
+		std::ofstream file(simFile, std::ios::binary | std::ios::trunc);
+		std::vector<char> buffer(recordsPerBuffer * stride + 1, 0);
+		uint64_t counter = 0;
+		for (size_t bb = 0; bb < buffersInFile; ++bb)
+		{
+			for (size_t rr = 0; rr < recordsPerBuffer; ++rr)
+			{
+				uint64_t header = rr == 0 ? buffer.size() : stride;
+				memcpy(&buffer[rr * stride], &header, sizeof(header));
+				++counter;  // Running counter, so that every record differs
+				memcpy(&buffer[rr * stride + sizeof(uint64_t)], &counter, sizeof(counter));
+			}
+			file.write(buffer.data(), buffer.size());
+		}
+	}
+
+	mu2edev device;
+	device.init(DTC_SimMode_Performance, 0, simFile, "", /* simulateCFO */ true);
+
+	auto start = std::chrono::steady_clock::now();
+	size_t copied = 0;
+	std::vector<std::unique_ptr<CFO_Event>> events;
+	while (copied < recordCount)
+	{
+		mu2e_databuff_t* buffer;
+		auto sts = device.read_data(DTC_DMA_Engine_DAQ, reinterpret_cast<void**>(&buffer), 100);
+		if (sts <= 0) break;
+		events.clear();
+		auto record = &(*buffer)[sizeof(uint64_t)];
+		for (size_t ii = 0; ii < (sts - 1) / stride; ++ii, record += stride) events.push_back(std::make_unique<CFO_Event>(record));
+		copied += events.size();
+		device.read_release(DTC_DMA_Engine_DAQ, 1);
+	}
+	double copyTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	CFO_RecordReader reader(device);
+	CFO_RecordBatch batch;
+	while (reader.GetRecordCount() < recordCount)
+		if (reader.ReadBatch(batch, 100) == 0) break;
+	reader.Release();
+	double batchTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Copying readout: " << copied << " records in " << copyTime * 1000 << " ms (" << copied / copyTime << " records/s, "
+			  << copied * stride / copyTime / 1e6 << " MB/s)" << std::endl;
+	std::cout << "Batch readout:   " << reader.GetRecordCount() << " records in " << batchTime * 1000 << " ms ("
+			  << reader.GetRecordCount() / batchTime << " records/s, " << reader.GetRecordCount() * stride / batchTime / 1e6
+			  << " MB/s), " << reader.GetBufferCount() << " DMA buffers" << std::endl;
+	std::cout << "Speedup: " << (copied / copyTime > 0 ? (reader.GetRecordCount() / batchTime) / (copied / copyTime) : 0) << "x"
+			  << std::endl;
+}
+
+// Read a compiled run plan, or compile it first with -C
+std::string loadRunPlan(const std::string& file, const std::string& binaryFile)
+{
+	if (compileInputFile)
+	{
+		CFO_Compiler compiler;
+		compiler.processFile(file, binaryFile);
+		auto& binary = compiler.getBinaryOutput();
+		return std::string(binary.begin(), binary.end());
+	}
+
+	std::ifstream input(file, std::ios::binary);
+	if (!input)
+	{
+		std::cout << "Input file " << file << " does not exist!" << std::endl;
+		exit(1);
+	}
+	return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
 void printHelpMsg()
 {
-	std::cout << "Usage: cfoUtil [options] [write_program,program_clock,dma_info]" << std::endl;
+	std::cout << "Usage: cfoUtil [options] [write_program,simulate_program,disassemble_program,diff_program,program_clock,dma_info,read_records,benchmark_readout]" << std::endl;
 	std::cout
 		<< "Options are:" << std::endl
 		<< "    -h, --help: This message." << std::endl
-		<< "    -f: RAW Output file path" << std::endl
+		<< "    -f: RAW Output file path (also the output of read_records)" << std::endl
 		<< "    -F: Frequency to program (in Hz, sorry...Default 166666667 Hz)" << std::endl
 		<< "    -p: CFO program to write (Default: /tmp/cfoUtil.raw)" << std::endl
 		<< "    -C: CFO program needs to be compiled (i.e. not bitfile). If specified with -f, will not write compiled "
 		   "program to CFO"
 		<< std::endl
 		<< "    -c: Clock speed for CFO (default 40000000)" << std::endl
+		<< "    -n: Number of CFO records to read for read_records and benchmark_readout (default 1000)" << std::endl
+		<< "    -t: Number of timeline events to print for simulate_program (default 0)" << std::endl
+		<< "    --emulate: For simulate_program, also play the data requests on the CFO emulator of a simulated DTC" << std::endl
+		<< "    --instruction-clocks: For simulate_program, execution time of each instruction in clocks, on top of WAITs (default 0)" << std::endl
+		<< "    --compare: For diff_program, the run plan to compare with (also compiled with -C). Without it, diff_program "
+		   "compares with the run plan loaded in the CFO. The CFO readback covers only the length of the given run plan, "
+		   "so instructions loaded after it are not reported"
+		<< std::endl
+		<< "    --address: Run plan memory address for diff_program (default 0)" << std::endl
 		<< "    --cfo: Use cfo <num> (Defaults to DTCLIB_DTC if set, 0 otherwise, see ls /dev/mu2e* for available CFOs)"
 		<< std::endl;
 	exit(0);
@@ -202,6 +306,12 @@ int main(int argc, char* argv[])
 				case 'p':
 					inputFile = getOptionString(&optind, &argv);
 					break;
+				case 'n':
+					recordCount = getOptionValue(&optind, &argv);
+					break;
+				case 't':
+					timelineEvents = getOptionValue(&optind, &argv);
+					break;
 				case '-':  // Long option
 				{
 					auto option = getLongOptionOption(&optind, &argv);
@@ -209,6 +319,22 @@ int main(int argc, char* argv[])
 					{
 						dtc = getLongOptionValue(&optind, &argv);
 					}
+					else if (option == "--emulate")
+					{
+						emulateProgram = true;
+					}
+					else if (option == "--instruction-clocks")
+					{
+						instructionClocks = getLongOptionValue(&optind, &argv);
+					}
+					else if (option == "--compare")
+					{
+						compareFile = getLongOptionString(&optind, &argv);
+					}
+					else if (option == "--address")
+					{
+						runPlanAddress = getLongOptionValue(&optind, &argv);
+					}
 					else if (option == "--help")
 					{
 						printHelpMsg();
@@ -266,6 +392,104 @@ int main(int argc, char* argv[])
 			delete thisCFO;
 		}
 	}
+	else if (op == "simulate_program")
+	{
+		CFO_RunPlanSimulatorOptions options;
+		options.clocksPerInstruction = instructionClocks;
+		CFO_RunPlanSimulator simulator(options);
+		if (compileInputFile)
+		{
+			CFO_Compiler compiler;
+			compiler.processFile(inputFile, rawOutputFile);
+			simulator.Run(compiler.getBinaryOutput());
+		}
+		else
+		{
+			std::ifstream file(inputFile, std::ios::binary);
+			if (!file)
+			{
+				std::cout << "Input file " << inputFile << " does not exist!" << std::endl;
+				return 1;
+			}
+			simulator.Run(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+		}
+
+		std::cout << simulator.FormatStatistics();
+		if (timelineEvents > 0) std::cout << simulator.FormatTimeline(timelineEvents);
+
+		if (emulateProgram)
+		{
+			auto segments = simulator.GetEmulatorSegments();
+			std::cout << "Playing " << segments.size() << " segments on the DTC CFO emulator" << std::endl;
+			DTCLib::DTC thisDTC(DTCLib::DTC_SimMode_Performance, dtc, 0x1, "");
+			CFO_RunPlanSimulator::PlayOnCFOEmulator(thisDTC, segments);
+		}
+	}
+	else if (op == "disassemble_program")
+	{
+		auto instructions = CFO_RunPlanDisassembler::Disassemble(loadRunPlan(inputFile, rawOutputFile));
+		std::cout << CFO_RunPlanDisassembler::Format(instructions);
+	}
+	else if (op == "diff_program")
+	{
+		auto runPlan = loadRunPlan(inputFile, rawOutputFile);
+		std::string other;
+		if (compareFile != "")
+			other = loadRunPlan(compareFile, rawOutputFile + ".compare");
+		else
+		{
+			// The quick check first: one bulk readback of the run plan memory, compared as a block
+			CFO_Registers thisCFO(DTC_SimMode_NoCFO, dtc);
+			if (thisCFO.IsRunPlanLoaded(runPlan, runPlanAddress))
+			{
+				std::cout << "Run plan " << inputFile << " is loaded at address " << runPlanAddress << " (CRC 0x" << std::hex
+						  << CFO_Registers::ComputeRunPlanCRC(runPlan) << std::dec << ")" << std::endl;
+				return 0;
+			}
+			other = thisCFO.ReadRunPlanData(runPlanAddress, runPlan.size());
+			std::cout << "Run plan " << inputFile << " is not the one loaded at address " << runPlanAddress << std::endl;
+		}
+
+		auto differences = CFO_RunPlanDisassembler::Diff(CFO_RunPlanDisassembler::Disassemble(runPlan),
+														  CFO_RunPlanDisassembler::Disassemble(other));
+		std::cout << CFO_RunPlanDisassembler::FormatDiff(differences);
+		return differences.empty() ? 0 : 1;
+	}
+	else if (op == "read_records")
+	{
+		std::cout << "Raw output file: " << rawOutputFile << std::endl;
+		std::ofstream output(rawOutputFile, std::ios::binary);
+		CFO thisCFO(DTC_SimMode_NoCFO, dtc);
+
+		CFO_RecordBatch batch;
+		uint64_t records = 0;
+		auto start = std::chrono::steady_clock::now();
+		auto lastData = start;
+		while (records < recordCount)
+		{
+			if (thisCFO.ReadRecordBatch(batch, 100) == 0)
+			{
+				if (std::chrono::steady_clock::now() - lastData > std::chrono::seconds(10))
+				{
+					std::cout << "No CFO records for 10 s, stopping" << std::endl;
+					break;
+				}
+				continue;
+			}
+			lastData = std::chrono::steady_clock::now();
+			for (auto record : batch.records) output.write(reinterpret_cast<const char*>(record), sizeof(CFO_EventRecord));
+			records += batch.size();
+		}
+		thisCFO.ReleaseRecordBatch();
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "Read " << records << " CFO records in " << seconds << " s (" << (seconds > 0 ? records / seconds : 0)
+				  << " records/s)" << std::endl;
+	}
+	else if (op == "benchmark_readout")
+	{
+		benchmarkReadout();
+	}
 	else if (op == "program_clock")
 	{
 		auto thisDTC = new CFO_Registers(DTC_SimMode_NoCFO, dtc);
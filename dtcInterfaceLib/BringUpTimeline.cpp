@@ -0,0 +1,161 @@
+#include "BringUpTimeline.h"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include "mu2edev.h"
+
+#include "TRACE/tracemf.h"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+namespace {
+thread_local DTCLib::BringUpTimeline* activeTimeline = nullptr;
+}
+
+DTCLib::BringUpTimeline::Recording::Recording(BringUpTimeline* timeline)
+	: previous_(activeTimeline)
+{
+	timeline->phases_.clear();
+	timeline->open_.clear();
+	timeline->start_ = std::chrono::steady_clock::now();
+	activeTimeline = timeline;
+}
+
+DTCLib::BringUpTimeline::Recording::~Recording() { activeTimeline = previous_; }
+
+DTCLib::BringUpTimeline* DTCLib::BringUpTimeline::Active() { return activeTimeline; }
+
+size_t DTCLib::BringUpTimeline::BeginPhase(const std::string& name, const mu2edev* device)
+{
+	BringUpPhase phase;
+	phase.name = name;
+	phase.depth = static_cast<int>(open_.size());
+	phase.startUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count();
+	// Counter values at the start of the phase, replaced by the differences in EndPhase
+	if (device != nullptr)
+	{
+		phase.registerReads = device->GetRegisterReadCount();
+		phase.registerWrites = device->GetRegisterWriteCount();
+	}
+	phases_.push_back(phase);
+	open_.push_back(phases_.size() - 1);
+	return phases_.size() - 1;
+}
+
+void DTCLib::BringUpTimeline::EndPhase(size_t index, const mu2edev* device)
+{
+	if (index >= phases_.size()) return;  // Recording restarted since the phase began
+	auto& phase = phases_[index];
+	phase.durationUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_).count() - phase.startUs;
+	if (device != nullptr)
+	{
+		phase.registerReads = device->GetRegisterReadCount() - phase.registerReads;
+		phase.registerWrites = device->GetRegisterWriteCount() - phase.registerWrites;
+	}
+	while (!open_.empty())
+	{
+		auto last = open_.back();
+		open_.pop_back();
+		if (last == index) break;
+	}
+}
+
+double DTCLib::BringUpTimeline::GetTotalUs() const
+{
+	double total = 0;
+	for (auto const& phase : phases_)
+		if (phase.depth == 0) total += phase.durationUs;
+	return total;
+}
+
+std::string DTCLib::BringUpTimeline::Format() const
+{
+	std::ostringstream o;
+	o << "Bring-up timeline: " << phases_.size() << " phases, " << std::fixed << std::setprecision(3) << GetTotalUs() / 1000 << " ms"
+	  << std::endl;
+	o << std::left << std::setw(40) << "Phase" << std::right << std::setw(12) << "Start ms" << std::setw(12) << "Duration ms"
+	  << std::setw(10) << "Reads" << std::setw(10) << "Writes" << std::endl;
+	for (auto const& phase : phases_)
+	{
+		o << std::left << std::setw(40) << (std::string(2 * phase.depth, ' ') + phase.name) << std::right << std::setw(12)
+		  << std::setprecision(3) << phase.startUs / 1000 << std::setw(12) << phase.durationUs / 1000 << std::setw(10)
+		  << phase.registerReads << std::setw(10) << phase.registerWrites << std::endl;
+	}
+	return o.str();
+}
+
+void DTCLib::BringUpTimeline::SaveBaseline(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file)
+	{
+		__SS__ << "Cannot open bring-up baseline file " << path << " for writing" << __E__;
+		__SS_THROW__;
+	}
+	file << "# name\tdepth\tduration_us\tregister_reads\tregister_writes" << std::endl;
+	for (auto const& phase : phases_)
+		file << phase.name << '\t' << phase.depth << '\t' << phase.durationUs << '\t' << phase.registerReads << '\t' << phase.registerWrites
+			 << std::endl;
+}
+
+std::vector<DTCLib::BringUpPhase> DTCLib::BringUpTimeline::LoadBaseline(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		__SS__ << "Cannot open bring-up baseline file " << path << __E__;
+		__SS_THROW__;
+	}
+
+	std::vector<BringUpPhase> phases;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream fields(line);
+		BringUpPhase phase;
+		std::string depth, duration, reads, writes;
+		if (!std::getline(fields, phase.name, '\t') || !std::getline(fields, depth, '\t') || !std::getline(fields, duration, '\t') ||
+			!std::getline(fields, reads, '\t') || !std::getline(fields, writes, '\t'))
+		{
+			__SS__ << "Malformed line in bring-up baseline file " << path << ": '" << line << "'" << __E__;
+			__SS_THROW__;
+		}
+		phase.depth = std::stoi(depth);
+		phase.durationUs = std::stod(duration);
+		phase.registerReads = std::stoull(reads);
+		phase.registerWrites = std::stoull(writes);
+		phases.push_back(phase);
+	}
+	return phases;
+}
+
+std::vector<DTCLib::BringUpRegression> DTCLib::BringUpTimeline::Compare(const std::vector<BringUpPhase>& baseline, double tolerance,
+																	   double minimumUs) const
+{
+	std::map<std::string, BringUpPhase const*> baselineByName;
+	for (auto const& phase : baseline) baselineByName.emplace(phase.name, &phase);  // First occurrence of each name
+
+	std::vector<BringUpRegression> regressions;
+	for (auto const& phase : phases_)
+	{
+		auto it = baselineByName.find(phase.name);
+		if (it == baselineByName.end()) continue;
+		auto const& reference = *it->second;
+
+		BringUpRegression regression;
+		regression.phase = phase.name;
+		regression.baselineUs = reference.durationUs;
+		regression.durationUs = phase.durationUs;
+		regression.baselineAccesses = reference.registerReads + reference.registerWrites;
+		regression.accesses = phase.registerReads + phase.registerWrites;
+
+		auto slower = phase.durationUs > reference.durationUs * (1 + tolerance) && phase.durationUs - reference.durationUs > minimumUs;
+		if (slower || regression.accesses > regression.baselineAccesses) regressions.push_back(regression);
+		baselineByName.erase(it);  // Repeated phases are compared to the baseline once
+	}
+	return regressions;
+}
@@ -0,0 +1,163 @@
+#ifndef BRINGUPTIMELINE_H
+#define BRINGUPTIMELINE_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class mu2edev;
+
+namespace DTCLib {
+
+/// <summary>
+/// One phase of a device bring-up, as recorded by the BringUpTimeline
+/// </summary>
+struct BringUpPhase
+{
+	std::string name;
+	int depth = 0;               ///< Nesting level, 0 for the outermost phases
+	double startUs = 0;          ///< Start of the phase, in microseconds since the start of the recording
+	double durationUs = 0;       ///< Duration of the phase, in microseconds
+	uint64_t registerReads = 0;  ///< Device register reads made during the phase
+	uint64_t registerWrites = 0; ///< Device register writes made during the phase
+};
+
+/// <summary>
+/// A bring-up phase which took longer, or accessed more registers, than in the baseline
+/// </summary>
+struct BringUpRegression
+{
+	std::string phase;
+	double baselineUs = 0;
+	double durationUs = 0;
+	uint64_t baselineAccesses = 0;  ///< Register reads and writes in the baseline
+	uint64_t accesses = 0;          ///< Register reads and writes in this recording
+};
+
+/// <summary>
+/// The BringUpTimeline records the phases of a CFO/DTC bring-up (device open, mmap setup, SetSimMode, initial register
+/// reads...) with their durations and register access counts, so that a slow construction can be broken down and compared
+/// to a stored baseline.
+///
+/// Phases are marked with BringUpPhaseScope, which records into the timeline active on the calling thread (see
+/// BringUpTimeline::Recording) and costs nothing when no recording is active.
+/// </summary>
+class BringUpTimeline
+{
+public:
+	/// <summary>
+	/// Scoped recording: clears the timeline and makes it the active timeline of the calling thread until the end of the scope
+	/// </summary>
+	class Recording
+	{
+	public:
+		/// <summary>
+		/// Start recording into the given timeline
+		/// </summary>
+		/// <param name="timeline">Timeline to record into</param>
+		explicit Recording(BringUpTimeline* timeline);
+		~Recording();
+		Recording(const Recording&) = delete;
+		Recording& operator=(const Recording&) = delete;
+
+	private:
+		BringUpTimeline* previous_;
+	};
+
+	/// <summary>
+	/// Get the timeline recording on the calling thread
+	/// </summary>
+	/// <returns>Active timeline, or nullptr</returns>
+	static BringUpTimeline* Active();
+
+	/// <summary>
+	/// Start a phase
+	/// </summary>
+	/// <param name="name">Phase name</param>
+	/// <param name="device">Device whose register accesses are counted (may be nullptr)</param>
+	/// <returns>Index of the phase, for EndPhase</returns>
+	size_t BeginPhase(const std::string& name, const mu2edev* device);
+	/// <summary>
+	/// End a phase started by BeginPhase
+	/// </summary>
+	/// <param name="index">Index returned by BeginPhase</param>
+	/// <param name="device">Device passed to BeginPhase</param>
+	void EndPhase(size_t index, const mu2edev* device);
+
+	/// <summary>
+	/// Get the recorded phases, in the order they started
+	/// </summary>
+	/// <returns>Recorded phases</returns>
+	const std::vector<BringUpPhase>& GetPhases() const { return phases_; }
+	/// <summary>
+	/// Get the duration of the whole recording
+	/// </summary>
+	/// <returns>Sum of the outermost phases, in microseconds</returns>
+	double GetTotalUs() const;
+	/// <summary>
+	/// Format the recorded phases as an indented table
+	/// </summary>
+	/// <returns>Timeline table</returns>
+	std::string Format() const;
+
+	/// <summary>
+	/// Write the recorded phases to a baseline file
+	/// </summary>
+	/// <param name="path">Baseline file to write</param>
+	void SaveBaseline(const std::string& path) const;
+	/// <summary>
+	/// Read a baseline file written by SaveBaseline
+	/// </summary>
+	/// <param name="path">Baseline file to read</param>
+	/// <returns>Phases of the baseline</returns>
+	static std::vector<BringUpPhase> LoadBaseline(const std::string& path);
+	/// <summary>
+	/// Compare the recorded phases to a baseline, by name. A phase regresses if it makes more register accesses than in the
+	/// baseline, or if it is both more than tolerance (relative) and more than minimumUs (absolute) slower.
+	/// </summary>
+	/// <param name="baseline">Baseline phases</param>
+	/// <param name="tolerance">Allowed relative slowdown (0.5 = 50%)</param>
+	/// <param name="minimumUs">Slowdowns smaller than this are ignored, in microseconds</param>
+	/// <returns>Phases which regressed</returns>
+	std::vector<BringUpRegression> Compare(const std::vector<BringUpPhase>& baseline, double tolerance = 0.5,
+										   double minimumUs = 1000) const;
+
+private:
+	std::vector<BringUpPhase> phases_;
+	std::vector<size_t> open_;  ///< Phases started but not ended, innermost last
+	std::chrono::steady_clock::time_point start_;
+};
+
+/// <summary>
+/// Scoped bring-up phase, recorded into the active BringUpTimeline of the calling thread (if any)
+/// </summary>
+class BringUpPhaseScope
+{
+public:
+	/// <summary>
+	/// Start a phase
+	/// </summary>
+	/// <param name="name">Phase name</param>
+	/// <param name="device">Device whose register accesses are counted (may be nullptr)</param>
+	BringUpPhaseScope(const char* name, const mu2edev* device)
+		: timeline_(BringUpTimeline::Active()), device_(device)
+	{
+		if (timeline_ != nullptr) index_ = timeline_->BeginPhase(name, device_);
+	}
+	~BringUpPhaseScope()
+	{
+		if (timeline_ != nullptr) timeline_->EndPhase(index_, device_);
+	}
+	BringUpPhaseScope(const BringUpPhaseScope&) = delete;
+	BringUpPhaseScope& operator=(const BringUpPhaseScope&) = delete;
+
+private:
+	BringUpTimeline* timeline_;
+	const mu2edev* device_;
+	size_t index_ = 0;
+};
+
+}  // namespace DTCLib
+
+#endif  // BRINGUPTIMELINE_H
@@ -1,11 +1,14 @@
 #include "CFOandDTC_Registers.h"
+#include "RegisterAccessProfiler.h"
 
 #include <assert.h>
 #include <unistd.h>
 #include <chrono>
 #include <cmath>
+#include <ctime>
 #include <iomanip>  // std::setw, std::setfill
 #include <sstream>  // Convert uint to hex string
+#include <unordered_set>
 
 #include "TRACE/tracemf.h"
 
@@ -31,12 +34,13 @@ enum CFOandDTC_Register : uint16_t
 
 // }; //end CFOandDTC_Register enum
 
+thread_local DTCLib::CFOandDTC_Registers::ThreadSnapshot_ DTCLib::CFOandDTC_Registers::threadSnapshot_;
 
 /// <summary>
 /// Construct an instance of the core CFO-and-DTC register map
 /// </summary>
 DTCLib::CFOandDTC_Registers::CFOandDTC_Registers()
-	: device_()
+	: device_(), registerCacheEnabled_(getenv("DTCLIB_REGISTER_CACHE") != nullptr)
 {
 } //end constructor()
 
@@ -46,17 +50,94 @@ DTCLib::CFOandDTC_Registers::CFOandDTC_Registers()
 DTCLib::CFOandDTC_Registers::~CFOandDTC_Registers()
 {
 	TLOG(TLVL_INFO) << "DESTRUCTOR";
+	iicEngines_.clear();  // Stop the IIC engines while the device is still open
 	device_.close();
 } //end destructor()
 
 /// <summary>
-/// Perform a register dump
+/// Log the bring-up timeline, and compare it to the baseline given by DTCLIB_BRINGUP_BASELINE
+/// </summary>
+void DTCLib::CFOandDTC_Registers::ReportBringUpTimeline_()
+{
+	__COUT__ << "Bring-up took " << bringUpTimeline_.GetTotalUs() / 1000 << " ms";
+	if (getenv("DTCLIB_BRINGUP_TIMELINE") != nullptr) __COUT_INFO__ << bringUpTimeline_.Format();
+
+	auto baselinePath = getenv("DTCLIB_BRINGUP_BASELINE");
+	if (baselinePath == nullptr) return;
+	try
+	{
+		for (auto const& regression : bringUpTimeline_.Compare(BringUpTimeline::LoadBaseline(baselinePath)))
+			__COUT_WARN__ << "Bring-up phase '" << regression.phase << "' took " << regression.durationUs / 1000 << " ms and "
+						  << regression.accesses << " register accesses, baseline is " << regression.baselineUs / 1000 << " ms and "
+						  << regression.baselineAccesses << " register accesses";
+	}
+	catch (const std::exception& e)
+	{
+		__COUT_WARN__ << "Cannot compare the bring-up timeline to the baseline: " << e.what();
+	}
+} //end ReportBringUpTimeline_()
+
+/// <summary>
+/// Get the IICEngine of an IIC bus, starting it on first use
+/// </summary>
+/// <param name="bus">IIC Bus Low/High register pair</param>
+/// <returns>IICEngine of the bus</returns>
+DTCLib::IICEngine& DTCLib::CFOandDTC_Registers::GetIICEngine(IICBus const& bus)
+{
+	std::lock_guard<std::mutex> lock(iicEnginesMutex_);
+	auto& engine = iicEngines_[bus.lowRegister];
+	if (engine == nullptr) engine = std::make_unique<IICEngine>(this, bus);
+	return *engine;
+}
+
+/// <summary>
+/// Perform a register dump. The first dump of regVec reads register by register and remembers which registers the
+/// formatters read; later dumps bulk read those registers first. The registers are remembered by the address of
+/// regVec: should another vector reuse that address, registers missing from the snapshot are still read from the device.
 /// </summary>
 /// <param name="width">Printable width of description fields</param>
 /// <returns>String containing all registers, with their human-readable representations</returns>
 std::string DTCLib::CFOandDTC_Registers::FormattedRegDump(int width,
 	const std::vector<std::function<RegisterFormatter()>>& regVec)
 {
+	RegisterAccessTag tag("FormattedRegDump");
+	{
+		std::unique_lock<std::mutex> lock(formatterReadsMutex_);
+		auto reads = formatterReads_.find(&regVec);
+		if (reads != formatterReads_.end())
+		{
+			auto addresses = reads->second;
+			lock.unlock();
+			auto snapshot = TakeRegisterSnapshot(addresses);
+			return FormattedRegDump(width, regVec, snapshot);
+		}
+	}
+
+	RegisterSnapshot snapshot;
+	snapshot.timestamp_ = std::chrono::system_clock::now();
+	snapshot.fillOnRead_ = true;
+	auto start = std::chrono::steady_clock::now();
+	auto dump = FormattedRegDump(width, regVec, snapshot);
+	snapshot.readDurationUs_ = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+	std::vector<uint16_t> addresses;
+	addresses.reserve(snapshot.Size());
+	for (auto const& value : snapshot.GetValues()) addresses.push_back(value.first);
+	std::lock_guard<std::mutex> lock(formatterReadsMutex_);
+	formatterReads_[&regVec] = std::move(addresses);
+	return dump;
+} //end FormattedRegDump()
+
+/// <summary>
+/// Perform a register dump from a previously taken snapshot
+/// </summary>
+/// <param name="width">Printable width of description fields</param>
+/// <param name="snapshot">Register values to format</param>
+/// <returns>String containing all registers, with their human-readable representations</returns>
+std::string DTCLib::CFOandDTC_Registers::FormattedRegDump(int width,
+	const std::vector<std::function<RegisterFormatter()>>& regVec, RegisterSnapshot& snapshot)
+{
+	RegisterAccessTag tag("FormattedRegDump");
 	std::string divider(width, '=');
 	formatterWidth_ = width - 27 - 65;
 	if (formatterWidth_ < 28)
@@ -65,7 +146,6 @@ std::string DTCLib::CFOandDTC_Registers::FormattedRegDump(int width,
 	}
 	std::string spaces(formatterWidth_ - 4 - 9, ' ');
 	std::ostringstream o;
-	o << "Register Dump: " << std::endl;
 	o << divider << std::endl;
 	{ //move address to right-align with values
 		std::string placeholder = "";
@@ -78,14 +158,426 @@ std::string DTCLib::CFOandDTC_Registers::FormattedRegDump(int width,
 		placeholder.resize(formatterWidth_ , ' ');
 		o << placeholder << " | Decorated Values" << std::endl;
 	}
-	for (auto i : regVec)
+
+	auto previousSnapshot = threadSnapshot_;
+	UseRegisterSnapshot(&snapshot);
+	try
 	{
-		o << divider << std::endl;
-		o << i();
+		for (auto i : regVec)
+		{
+			o << divider << std::endl;
+			o << i();
+		}
 	}
-	return o.str();
+	catch (...)
+	{
+		threadSnapshot_ = previousSnapshot;
+		throw;
+	}
+	threadSnapshot_ = previousSnapshot;
+
+	// The header comes last, as the formatters may add registers to a snapshot which fills on read
+	std::ostringstream header;
+	auto time = std::chrono::system_clock::to_time_t(snapshot.GetTimestamp());
+	header << "Register Dump: " << std::endl
+		   << snapshot.Size() << " registers read at " << std::put_time(std::localtime(&time), "%F %T") << " in "
+		   << snapshot.GetReadDurationUs() << " us" << std::endl;
+	return header.str() + o.str();
 } //end FormattedRegDump()
 
+/// <summary>
+/// Read the whole register map in one bulk pass, except the registers with read side effects
+/// </summary>
+/// <returns>RegisterSnapshot with the values and the time of the read</returns>
+DTCLib::RegisterSnapshot DTCLib::CFOandDTC_Registers::TakeRegisterSnapshot()
+{
+	std::vector<uint16_t> addresses;
+	addresses.reserve((CFOandDTC_RegisterMapEnd - CFOandDTC_RegisterMapBegin) / 4);
+	for (uint32_t address = CFOandDTC_RegisterMapBegin; address < CFOandDTC_RegisterMapEnd; address += 4)
+		addresses.push_back(static_cast<uint16_t>(address));
+	return TakeRegisterSnapshot(addresses);
+} //end TakeRegisterSnapshot()
+
+/// <summary>
+/// Read the given registers in one bulk pass
+/// </summary>
+/// <param name="addresses">Register addresses to read</param>
+/// <returns>RegisterSnapshot with the values and the time of the read</returns>
+DTCLib::RegisterSnapshot DTCLib::CFOandDTC_Registers::TakeRegisterSnapshot(const std::vector<uint16_t>& addresses)
+{
+	RegisterSnapshot snapshot;
+	std::vector<uint16_t> readable;
+	readable.reserve(addresses.size());
+	for (auto address : addresses)
+		if (!HasReadSideEffect_(static_cast<CFOandDTC_Register>(address))) readable.push_back(address);
+	std::vector<uint32_t> values(readable.size());
+
+	snapshot.timestamp_ = std::chrono::system_clock::now();
+	snapshot.readDurationUs_ = ReadRegisterBlock_(readable.data(), readable.size(), values.data());
+	for (size_t ii = 0; ii < readable.size(); ++ii) snapshot.values_[readable[ii]] = values[ii];
+
+	__COUTT__ << "Read snapshot of " << readable.size() << " registers in " << snapshot.readDurationUs_ << " us";
+	return snapshot;
+} //end TakeRegisterSnapshot()
+
+/// <summary>
+/// Read the given registers in one bulk pass, refreshing the register cache and recording the profile
+/// </summary>
+/// <param name="addresses">Register addresses to read</param>
+/// <param name="count">Number of registers</param>
+/// <param name="values">Output values, at least count long</param>
+/// <returns>Duration of the bulk read, in microseconds</returns>
+double DTCLib::CFOandDTC_Registers::ReadRegisterBlock_(const uint16_t* addresses, size_t count, uint32_t* values)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto errorCode = device_.read_registers(addresses, count, 100, values);
+	auto durationUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	if (errorCode != 0)
+	{
+		__SS__ << "Error reading block of " << count << " registers: " << errorCode;
+		__SS_THROW__;
+	}
+
+	if (IsRegisterCacheEnabled())
+	{
+		std::lock_guard<std::mutex> lock(registerCacheMutex_);
+		for (size_t ii = 0; ii < count; ++ii)
+			if (values[ii] != uint32_t(-1) && GetRegisterCacheClass_(static_cast<CFOandDTC_Register>(addresses[ii])) != RegisterCacheClass_Volatile)
+				registerCache_[addresses[ii]] = values[ii];
+	}
+
+	// The bulk read is shared evenly between the registers it covers
+	auto& profiler = RegisterAccessProfiler::Instance();
+	if (profiler.IsEnabled())
+		for (size_t ii = 0; ii < count; ++ii) profiler.RecordRead(addresses[ii], durationUs / count);
+	return durationUs;
+} //end ReadRegisterBlock_()
+
+/// <summary>
+/// Write the given registers in one bulk pass, without readback verification or per-register logging.
+/// Inside a register transaction, the writes go to the transaction shadow like any other write. The shadow keeps one
+/// value per register, so a block which writes a register more than once (e.g. the auto-incrementing
+/// CFO_Register_RunPlan_Data) cannot be written inside a transaction.
+/// </summary>
+/// <param name="addresses">Register addresses to write (may repeat)</param>
+/// <param name="values">Values to write, one per address</param>
+/// <param name="count">Number of registers</param>
+/// <returns>Duration of the bulk write, in microseconds</returns>
+double DTCLib::CFOandDTC_Registers::WriteRegisterBlock_(const uint16_t* addresses, const uint32_t* values, size_t count)
+{
+	if (InRegisterTransaction_())
+	{
+		std::unordered_set<uint16_t> written;
+		for (size_t ii = 0; ii < count; ++ii)
+			if (!written.insert(addresses[ii]).second)
+			{
+				__SS__ << "Cannot write a block of " << count << " registers inside a register transaction: register 0x"
+					   << std::hex << addresses[ii] << " is written more than once, and the transaction keeps only its last value." << __E__;
+				__SS_THROW__;
+			}
+		for (size_t ii = 0; ii < count; ++ii) WriteRegister_(values[ii], static_cast<CFOandDTC_Register>(addresses[ii]));
+		return 0;
+	}
+
+	if (auto snapshot = ActiveSnapshot_())
+		for (size_t ii = 0; ii < count; ++ii) snapshot->Erase(addresses[ii]);
+	{
+		std::lock_guard<std::mutex> lock(registerCacheMutex_);
+		for (size_t ii = 0; ii < count; ++ii) registerCache_.erase(addresses[ii]);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto errorCode = device_.write_registers(addresses, values, count, 100);
+	auto durationUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	if (errorCode != 0)
+	{
+		__SS__ << "Error writing block of " << count << " registers: " << errorCode;
+		__SS_THROW__;
+	}
+
+	auto& profiler = RegisterAccessProfiler::Instance();
+	if (profiler.IsEnabled())
+		for (size_t ii = 0; ii < count; ++ii) profiler.RecordWrite(addresses[ii], durationUs / count);
+
+	__COUTT__ << "Wrote block of " << count << " registers in " << durationUs << " us";
+	return durationUs;
+} //end WriteRegisterBlock_()
+
+/// <summary>
+/// Work out the layout of a register dump by running the formatter functions once. Each register they read is read
+/// from the device at most once.
+/// </summary>
+/// <param name="regVec">Formatter functions of the registers to dump</param>
+/// <returns>RegisterDumpLayout of the registers</returns>
+DTCLib::RegisterDumpLayout DTCLib::CFOandDTC_Registers::MakeRegisterDumpLayout(const std::vector<std::function<RegisterFormatter()>>& regVec)
+{
+	RegisterSnapshot snapshot;
+	snapshot.fillOnRead_ = true;
+	std::vector<RegisterDumpEntry> entries;
+	entries.reserve(regVec.size());
+
+	auto previousSnapshot = threadSnapshot_;
+	UseRegisterSnapshot(&snapshot);
+	try
+	{
+		for (auto const& formatter : regVec)
+		{
+			auto form = formatter();
+			RegisterDumpEntry entry;
+			entry.address = form.address;
+			entry.name = form.description;
+			DescribeRegisterDumpFields_(entry.address, entry.fields);
+			entries.push_back(std::move(entry));
+		}
+	}
+	catch (...)
+	{
+		threadSnapshot_ = previousSnapshot;
+		throw;
+	}
+	threadSnapshot_ = previousSnapshot;
+	return RegisterDumpLayout(entries);
+} //end MakeRegisterDumpLayout()
+
+/// <summary>
+/// Get the layout of the full register dump, made on first use
+/// </summary>
+/// <returns>RegisterDumpLayout of getFormattedDumpFunctions()</returns>
+const DTCLib::RegisterDumpLayout& DTCLib::CFOandDTC_Registers::GetRegisterDumpLayout()
+{
+	std::lock_guard<std::mutex> lock(registerDumpLayoutMutex_);
+	if (registerDumpLayout_ == nullptr)
+		registerDumpLayout_ = std::make_unique<RegisterDumpLayout>(MakeRegisterDumpLayout(getFormattedDumpFunctions()));
+	return *registerDumpLayout_;
+} //end GetRegisterDumpLayout()
+
+/// <summary>
+/// Read the registers of a layout in one bulk pass and format them
+/// </summary>
+/// <param name="layout">Layout of the dump</param>
+/// <param name="format">Output format</param>
+/// <param name="out">Output buffer, cleared first</param>
+void DTCLib::CFOandDTC_Registers::FormatRegisterDump(const RegisterDumpLayout& layout, RegisterDumpFormat format, std::string& out)
+{
+	RegisterAccessTag tag("FormatRegisterDump");
+	thread_local std::vector<uint32_t> values;  // Kept between dumps, so that only the first one allocates
+	values.resize(layout.Size());
+
+	auto timestamp = std::chrono::system_clock::now();
+	ReadRegisterBlock_(layout.GetAddresses().data(), layout.Size(), values.data());
+	layout.Format(values.data(), format, out,
+				  std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count());
+} //end FormatRegisterDump()
+
+/// <summary>
+/// Serve register reads of the calling thread from the given snapshot
+/// </summary>
+/// <param name="snapshot">Snapshot to use, or nullptr to read from the device again</param>
+void DTCLib::CFOandDTC_Registers::UseRegisterSnapshot(RegisterSnapshot* snapshot)
+{
+	threadSnapshot_.owner = this;
+	threadSnapshot_.snapshot = snapshot;
+} //end UseRegisterSnapshot()
+
+/// <summary>
+/// Start collecting register changes of the calling thread in a shadow copy
+/// </summary>
+void DTCLib::CFOandDTC_Registers::BeginRegisterTransaction()
+{
+	// Only the thread which opens a transaction touches the transaction state, until it closes the transaction
+	std::thread::id noThread;
+	if (!transactionThread_.compare_exchange_strong(noThread, std::this_thread::get_id(), std::memory_order_acq_rel) &&
+		noThread != std::this_thread::get_id())
+	{
+		__SS__ << "Cannot begin a register transaction, another thread has a register transaction open." << __E__;
+		__SS_THROW__;
+	}
+	++transactionDepth_;
+} //end BeginRegisterTransaction()
+
+/// <summary>
+/// Close the current transaction level, writing the changed registers if it is the outermost one
+/// </summary>
+/// <returns>Number of registers written to the device</returns>
+size_t DTCLib::CFOandDTC_Registers::CommitRegisterTransaction()
+{
+	if (!InRegisterTransaction_()) return 0;
+	if (--transactionDepth_ > 0) return 0;
+
+	// Leave the transaction first, so that the writes below go to the device
+	auto shadow = std::move(transactionShadow_);
+	auto order = std::move(transactionOrder_);
+	transactionShadow_.clear();
+	transactionOrder_.clear();
+	transactionThread_.store(std::thread::id(), std::memory_order_release);
+
+	size_t writes = 0;
+	for (auto address : order)
+	{
+		auto& reg = shadow[address];
+		if (reg.deviceValue.has_value() && *reg.deviceValue == reg.value) continue;  // Changes cancelled out
+		WriteRegister_(reg.value, static_cast<CFOandDTC_Register>(address));
+		++writes;
+	}
+	__COUTT__ << "Register transaction committed: " << shadow.size() << " registers touched, " << writes << " written";
+	return writes;
+} //end CommitRegisterTransaction()
+
+/// <summary>
+/// Compare the registers written in the open register transaction to the device. Registers which were written
+/// without being read first are read from the device here, so that Commit() skips them too if they are unchanged.
+/// </summary>
+/// <returns>Registers Commit() would write, in the order it would write them</returns>
+std::vector<DTCLib::RegisterDifference> DTCLib::CFOandDTC_Registers::PendingRegisterWrites_()
+{
+	std::vector<RegisterDifference> differences;
+	if (!InRegisterTransaction_()) return differences;
+
+	for (auto address : transactionOrder_)
+	{
+		auto& reg = transactionShadow_[address];
+		if (!reg.deviceValue.has_value())
+		{
+			uint32_t data = 0;
+			if (device_.read_register(address, 100, &data) != 0)
+			{
+				__SS__ << "Error reading register 0x" << std::hex << static_cast<uint32_t>(address) << " to compare it to the transaction" << __E__;
+				__SS_THROW__;
+			}
+			reg.deviceValue = data;
+		}
+		if (*reg.deviceValue == reg.value) continue;
+
+		RegisterDifference difference;
+		difference.address = address;
+		difference.current = *reg.deviceValue;
+		difference.target = reg.value;
+		differences.push_back(difference);
+	}
+	return differences;
+} //end PendingRegisterWrites_()
+
+/// <summary>
+/// Discard all changes collected by the current transaction
+/// </summary>
+void DTCLib::CFOandDTC_Registers::AbortRegisterTransaction()
+{
+	if (!InRegisterTransaction_()) return;
+	transactionDepth_ = 0;
+	transactionShadow_.clear();
+	transactionOrder_.clear();
+	transactionThread_.store(std::thread::id(), std::memory_order_release);
+} //end AbortRegisterTransaction()
+
+/// <summary>
+/// Enable or disable the register cache
+/// </summary>
+/// <param name="enable">Whether to serve reads of static and configuration registers from the cache</param>
+void DTCLib::CFOandDTC_Registers::SetRegisterCacheEnabled(bool enable)
+{
+	registerCacheEnabled_.store(enable, std::memory_order_relaxed);
+	if (!enable) ClearRegisterCache();
+} //end SetRegisterCacheEnabled()
+
+/// <summary>
+/// Forget all cached register values
+/// </summary>
+void DTCLib::CFOandDTC_Registers::ClearRegisterCache()
+{
+	std::lock_guard<std::mutex> lock(registerCacheMutex_);
+	registerCache_.clear();
+} //end ClearRegisterCache()
+
+/// <summary>
+/// Classify a register for the register cache. Derived classes classify their own registers and defer to this
+/// function for the common ones. Registers not listed here are volatile.
+/// </summary>
+/// <param name="address">Register address</param>
+/// <returns>RegisterCacheClass of the register</returns>
+DTCLib::RegisterCacheClass DTCLib::CFOandDTC_Registers::GetRegisterCacheClass_(const CFOandDTC_Register& address)
+{
+	switch (address)
+	{
+		case CFOandDTC_Register_DesignVersion:
+		case CFOandDTC_Register_DesignDate:
+		case CFOandDTC_Register_VivadoVersion:
+			return RegisterCacheClass_Static;
+		case CFOandDTC_Register_DMATransferLength:
+		case CFOandDTC_Register_SERDES_LoopbackEnable:
+		case CFOandDTC_Register_LinkEnable:
+			return RegisterCacheClass_Configuration;
+		default:;
+	}
+	return RegisterCacheClass_Volatile;
+} //end GetRegisterCacheClass_()
+
+/// <summary>
+/// Determine whether reading a register changes the device state (data ports which auto-increment or pop a FIFO on
+/// read, IIC data registers), so that it is never read ahead in a snapshot. Derived classes list their own registers
+/// and defer to this function for the common ones.
+/// </summary>
+/// <param name="address">Register address</param>
+/// <returns>Whether the register must only be read when its value is asked for</returns>
+bool DTCLib::CFOandDTC_Registers::HasReadSideEffect_(const CFOandDTC_Register& address)
+{
+	switch (address)
+	{
+		case CFOandDTC_Register_SERDESClock_IICBusLow:
+		case CFOandDTC_Register_SERDESClock_IICBusHigh:
+		case CFOandDTC_Register_FireflyTX_IICBusConfigLow:
+		case CFOandDTC_Register_FireflyTX_IICBusConfigHigh:
+		case CFOandDTC_Register_FireflyRX_IICBusConfigLow:
+		case CFOandDTC_Register_FireflyRX_IICBusConfigHigh:
+		case CFOandDTC_Register_FireflyTXRX_IICBusConfigLow:
+		case CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh:
+			return true;
+		default:;
+	}
+	return false;
+} //end HasReadSideEffect_()
+
+DTCLib::RegisterTransaction::RegisterTransaction(CFOandDTC_Registers* registers)
+	: registers_(registers), open_(true)
+{
+	registers_->BeginRegisterTransaction();
+}
+
+DTCLib::RegisterTransaction::~RegisterTransaction()
+{
+	if (open_) registers_->AbortRegisterTransaction();
+}
+
+uint32_t DTCLib::RegisterTransaction::Read(const CFOandDTC_Register& address) { return registers_->ReadRegister_(address); }
+
+void DTCLib::RegisterTransaction::Write(const CFOandDTC_Register& address, uint32_t value) { registers_->WriteRegister_(value, address); }
+
+void DTCLib::RegisterTransaction::SetBit(const CFOandDTC_Register& address, size_t bit, bool value) { registers_->SetBit_(address, bit, value); }
+
+void DTCLib::RegisterTransaction::SetField(const CFOandDTC_Register& address, size_t offset, size_t width, uint32_t value)
+{
+	registers_->SetField_(address, offset, width, value);
+}
+
+size_t DTCLib::RegisterTransaction::Commit()
+{
+	if (!open_) return 0;
+	open_ = false;
+	return registers_->CommitRegisterTransaction();
+}
+
+std::vector<DTCLib::RegisterDifference> DTCLib::RegisterTransaction::GetPendingWrites()
+{
+	if (!open_) return std::vector<RegisterDifference>();
+	return registers_->PendingRegisterWrites_();
+}
+
+void DTCLib::RegisterTransaction::Abort()
+{
+	if (!open_) return;
+	open_ = false;
+	registers_->AbortRegisterTransaction();
+}
+
 // Desgin Version/Date Registers
 /// <summary>
 /// Read the design version
@@ -603,6 +1095,41 @@ DTCLib::RegisterFormatter DTCLib::CFOandDTC_Registers::FormatFPGAAlarms()
 // Private Functions
 uint32_t DTCLib::CFOandDTC_Registers::WriteRegister_(uint32_t dataToWrite, const CFOandDTC_Register& address)
 {
+	// The snapshot value is stale once the register is written. The snapshot is thread-local; writes from other
+	// threads are not served from it, so they leave it alone.
+	if (auto snapshot = ActiveSnapshot_()) snapshot->Erase(address);
+
+	if (InRegisterTransaction_())
+	{
+		auto& reg = transactionShadow_[address];
+		if (!reg.dirty) transactionOrder_.push_back(address);
+		reg.value = dataToWrite;
+		reg.dirty = true;
+		return dataToWrite;
+	}
+
+	auto cacheClass = GetRegisterCacheClass_(address);
+	if (cacheClass != RegisterCacheClass_Volatile || address == CFOandDTC_Register_Control)
+	{
+		std::lock_guard<std::mutex> lock(registerCacheMutex_);
+		registerCache_.erase(address);
+		// Soft (bit 31) and hard (bit 0) resets restore the default configuration
+		if (address == CFOandDTC_Register_Control && (dataToWrite & 0x80000001) != 0)
+		{
+			for (auto it = registerCache_.begin(); it != registerCache_.end();)
+			{
+				if (GetRegisterCacheClass_(static_cast<CFOandDTC_Register>(it->first)) == RegisterCacheClass_Configuration)
+					it = registerCache_.erase(it);
+				else
+					++it;
+			}
+		}
+	}
+
+	auto& profiler = RegisterAccessProfiler::Instance();
+	auto profile = profiler.IsEnabled();
+	auto start = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
 	auto retry = 3;
 	int errorCode;
 	bool needToVerify = NeedToVerifyRegisterWrite_(address);
@@ -616,6 +1143,7 @@ uint32_t DTCLib::CFOandDTC_Registers::WriteRegister_(uint32_t dataToWrite, const
 
 		--retry;
 	} while (retry > 0 && errorCode != 0);
+	if (profile) profiler.RecordWrite(address, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
 	if (errorCode != 0)
 	{
 		__SS__ << "Error writing register 0x" << std::hex << static_cast<uint32_t>(address) << " " << errorCode;
@@ -638,6 +1166,13 @@ uint32_t DTCLib::CFOandDTC_Registers::WriteRegister_(uint32_t dataToWrite, const
 		// readbackValue = ReadRegister_(address); //already read above by write_register_checked!
  		if(!CFOandDTCVerifyRegisterWrite_(address,readbackValue,dataToWrite)) //first check if it is a core register, i.e. CFOandDTC*
 			VerifyRegisterWrite_(address,readbackValue,dataToWrite); //virtual function call
+
+		// The readback is the device value, so the next read does not need to go to the device
+		if (cacheClass == RegisterCacheClass_Configuration && IsRegisterCacheEnabled())
+		{
+			std::lock_guard<std::mutex> lock(registerCacheMutex_);
+			registerCache_[address] = readbackValue;
+		}
 		return readbackValue;
 	} //end verify register readback
 	
@@ -725,14 +1260,60 @@ bool DTCLib::CFOandDTC_Registers::CFOandDTCVerifyRegisterWrite_(const CFOandDTC_
 
 uint32_t DTCLib::CFOandDTC_Registers::ReadRegister_(const CFOandDTC_Register& address)
 {
+	uint32_t data;
+	if (InRegisterTransaction_())
+	{
+		auto reg = transactionShadow_.find(address);
+		if (reg != transactionShadow_.end()) return reg->second.value;
+	}
+	auto snapshot = ActiveSnapshot_();
+	if (snapshot != nullptr && snapshot->Get(address, data))
+	{
+		if (address == CFOandDTC_Register_Control && data == uint32_t(-1))
+		{
+			__SS__ << "Invalid register read for the Control Register: " << data << 
+				". If the value is all 1s (4294967295), this likely means the FPGA-PCIe interface in not initialized and perhaps a PCIe reset of the linux system would fix the issue.";				
+			__SS_THROW__;
+		}
+		if (InRegisterTransaction_())
+		{
+			auto& reg = transactionShadow_[address];
+			reg.deviceValue = data;
+			reg.value = data;
+		}
+		return data;
+	}
+
+	auto cacheClass = IsRegisterCacheEnabled() ? GetRegisterCacheClass_(address) : RegisterCacheClass_Volatile;
+	if (cacheClass != RegisterCacheClass_Volatile)
+	{
+		std::lock_guard<std::mutex> lock(registerCacheMutex_);
+		auto cached = registerCache_.find(address);
+		if (cached != registerCache_.end())
+		{
+			data = cached->second;
+			if (InRegisterTransaction_())
+			{
+				auto& reg = transactionShadow_[address];
+				reg.deviceValue = data;
+				reg.value = data;
+			}
+			return data;
+		}
+	}
+
+	auto& profiler = RegisterAccessProfiler::Instance();
+	auto profile = profiler.IsEnabled();
+	auto start = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
 	auto retry = 3;
 	int errorCode;
-	uint32_t data;
 	do
 	{
 		errorCode = device_.read_register(address, 100, &data);
 		--retry;
 	} while (retry > 0 && errorCode != 0);
+	if (profile) profiler.RecordRead(address, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
 	if (errorCode != 0)
 	{
 		__SS__ << "Error reading register 0x" << std::setw(4) << std::setfill('0') << std::setprecision(4) << std::hex << static_cast<uint32_t>(address) << " " << errorCode;
@@ -756,6 +1337,21 @@ uint32_t DTCLib::CFOandDTC_Registers::ReadRegister_(const CFOandDTC_Register& ad
 		__COUTT__ << o.str();
 	}
 
+	// All 1s is what an uninitialized FPGA-PCIe interface returns, do not keep it
+	if (cacheClass != RegisterCacheClass_Volatile && data != uint32_t(-1))
+	{
+		std::lock_guard<std::mutex> lock(registerCacheMutex_);
+		registerCache_[address] = data;
+	}
+
+	if (snapshot != nullptr && snapshot->fillOnRead_ && !HasReadSideEffect_(address)) snapshot->values_[address] = data;
+
+	if (InRegisterTransaction_())
+	{
+		auto& reg = transactionShadow_[address];
+		reg.deviceValue = data;
+		reg.value = data;
+	}
 	return data;
 } //end ReadRegister_()
 
@@ -785,6 +1381,20 @@ void DTCLib::CFOandDTC_Registers::SetBit_(const CFOandDTC_Register& address, siz
 	WriteRegister_(regVal.to_ulong(), address);
 }
 
+//========================================================================
+void DTCLib::CFOandDTC_Registers::SetField_(const CFOandDTC_Register& address, size_t offset, size_t width, uint32_t value)
+{
+	if (width == 0 || offset + width > 32)
+	{
+		__SS__ << "Cannot set a field of " << width << " bits at bit " << offset << ", as it is out of range";
+		__SS_THROW__;
+	}
+	uint32_t mask = (width == 32 ? 0xFFFFFFFF : ((1u << width) - 1)) << offset;
+	auto regVal = ReadRegister_(address);
+	regVal = (regVal & ~mask) | ((value << offset) & mask);
+	WriteRegister_(regVal, address);
+}
+
 //========================================================================
 // Jitter Attenuator CSR Register
 /// <summary>
@@ -914,19 +1524,8 @@ DTCLib::RegisterFormatter DTCLib::CFOandDTC_Registers::FormatJitterAttenuatorCSR
 /// <param name="data">Data to write</param>
 void DTCLib::CFOandDTC_Registers::WriteSERDESIICInterface(DTC_IICSERDESBusAddress device, uint8_t address, uint8_t data)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16) + (data << 8);
-	WriteRegister_(reg_data, CFOandDTC_Register_SERDESClock_IICBusLow);
-	WriteRegister_(0x1, CFOandDTC_Register_SERDESClock_IICBusHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_SERDESClock_IICBusHigh) == 0x1)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to write!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
+	auto& engine = GetIICEngine({CFOandDTC_Register_SERDESClock_IICBusLow, CFOandDTC_Register_SERDESClock_IICBusHigh});
+	engine.Write(static_cast<uint8_t>(device), address, data).get();
 }
 
 /// <summary>
@@ -937,21 +1536,8 @@ void DTCLib::CFOandDTC_Registers::WriteSERDESIICInterface(DTC_IICSERDESBusAddres
 /// <returns>Value of register</returns>
 uint8_t DTCLib::CFOandDTC_Registers::ReadSERDESIICInterface(DTC_IICSERDESBusAddress device, uint8_t address)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16);
-	WriteRegister_(reg_data, CFOandDTC_Register_SERDESClock_IICBusLow);
-	WriteRegister_(0x2, CFOandDTC_Register_SERDESClock_IICBusHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_SERDESClock_IICBusHigh) == 0x2)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to read!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
-	auto data = ReadRegister_(CFOandDTC_Register_SERDESClock_IICBusLow);
-	return static_cast<uint8_t>(data);
+	auto& engine = GetIICEngine({CFOandDTC_Register_SERDESClock_IICBusLow, CFOandDTC_Register_SERDESClock_IICBusHigh});
+	return engine.Read(static_cast<uint8_t>(device), address).get();
 }
 
 /// <summary>
@@ -1028,19 +1614,8 @@ void DTCLib::CFOandDTC_Registers::ResetFireflyTXIICInterface()
 /// <param name="data">Data to write</param>
 void DTCLib::CFOandDTC_Registers::WriteFireflyTXIICInterface(uint8_t device, uint8_t address, uint8_t data)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16) + (data << 8);
-	WriteRegister_(reg_data, CFOandDTC_Register_FireflyTX_IICBusConfigLow);
-	WriteRegister_(0x1, CFOandDTC_Register_FireflyTX_IICBusConfigHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_FireflyTX_IICBusConfigHigh) == 0x1)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to write!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
+	auto& engine = GetIICEngine({CFOandDTC_Register_FireflyTX_IICBusConfigLow, CFOandDTC_Register_FireflyTX_IICBusConfigHigh});
+	engine.Write(device, address, data).get();
 }
 /// <summary>
 /// Read a value from the Firefly TX IIC Bus
@@ -1050,21 +1625,8 @@ void DTCLib::CFOandDTC_Registers::WriteFireflyTXIICInterface(uint8_t device, uin
 /// <returns>Value of register</returns>
 uint8_t DTCLib::CFOandDTC_Registers::ReadFireflyTXIICInterface(uint8_t device, uint8_t address)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16);
-	WriteRegister_(reg_data, CFOandDTC_Register_FireflyTX_IICBusConfigLow);
-	WriteRegister_(0x2, CFOandDTC_Register_FireflyTX_IICBusConfigHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_FireflyTX_IICBusConfigHigh) == 0x2)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to read!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
-	auto data = ReadRegister_(CFOandDTC_Register_FireflyTX_IICBusConfigLow);
-	return static_cast<uint8_t>(data);
+	auto& engine = GetIICEngine({CFOandDTC_Register_FireflyTX_IICBusConfigLow, CFOandDTC_Register_FireflyTX_IICBusConfigHigh});
+	return engine.Read(device, address).get();
 }
 /// <summary>
 /// Formats the register's current value for register dumps
@@ -1150,19 +1712,8 @@ void DTCLib::CFOandDTC_Registers::ResetFireflyRXIICInterface()
 /// <param name="data">Data to write</param>
 void DTCLib::CFOandDTC_Registers::WriteFireflyRXIICInterface(uint8_t device, uint8_t address, uint8_t data)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16) + (data << 8);
-	WriteRegister_(reg_data, CFOandDTC_Register_FireflyRX_IICBusConfigLow);
-	WriteRegister_(0x1, CFOandDTC_Register_FireflyRX_IICBusConfigHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_FireflyRX_IICBusConfigHigh) == 0x1)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to write!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
+	auto& engine = GetIICEngine({CFOandDTC_Register_FireflyRX_IICBusConfigLow, CFOandDTC_Register_FireflyRX_IICBusConfigHigh});
+	engine.Write(device, address, data).get();
 }
 /// <summary>
 /// Read a value from the Firefly RX IIC Bus
@@ -1172,21 +1723,8 @@ void DTCLib::CFOandDTC_Registers::WriteFireflyRXIICInterface(uint8_t device, uin
 /// <returns>Value of register</returns>
 uint8_t DTCLib::CFOandDTC_Registers::ReadFireflyRXIICInterface(uint8_t device, uint8_t address)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16);
-	WriteRegister_(reg_data, CFOandDTC_Register_FireflyRX_IICBusConfigLow);
-	WriteRegister_(0x2, CFOandDTC_Register_FireflyRX_IICBusConfigHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_FireflyRX_IICBusConfigHigh) == 0x2)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to read!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
-	auto data = ReadRegister_(CFOandDTC_Register_FireflyRX_IICBusConfigLow);
-	return static_cast<uint8_t>(data);
+	auto& engine = GetIICEngine({CFOandDTC_Register_FireflyRX_IICBusConfigLow, CFOandDTC_Register_FireflyRX_IICBusConfigHigh});
+	return engine.Read(device, address).get();
 }
 /// <summary>
 /// Formats the register's current value for register dumps
@@ -1272,19 +1810,8 @@ void DTCLib::CFOandDTC_Registers::ResetFireflyTXRXIICInterface()
 /// <param name="data">Data to write</param>
 void DTCLib::CFOandDTC_Registers::WriteFireflyTXRXIICInterface(uint8_t device, uint8_t address, uint8_t data)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16) + (data << 8);
-	WriteRegister_(reg_data, CFOandDTC_Register_FireflyTXRX_IICBusConfigLow);
-	WriteRegister_(0x1, CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh) == 0x1)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to write!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
+	auto& engine = GetIICEngine({CFOandDTC_Register_FireflyTXRX_IICBusConfigLow, CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh});
+	engine.Write(device, address, data).get();
 }
 /// <summary>
 /// Read a value from the Firefly TXRX IIC Bus
@@ -1294,21 +1821,8 @@ void DTCLib::CFOandDTC_Registers::WriteFireflyTXRXIICInterface(uint8_t device, u
 /// <returns>Value of register</returns>
 uint8_t DTCLib::CFOandDTC_Registers::ReadFireflyTXRXIICInterface(uint8_t device, uint8_t address)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16);
-	WriteRegister_(reg_data, CFOandDTC_Register_FireflyTXRX_IICBusConfigLow);
-	WriteRegister_(0x2, CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh);
-	u_int16_t retries = 1000;
-	while (ReadRegister_(CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh) == 0x2)
-	{
-		if(--retries == 0)
-		{
-			__SS__ << "Timeout waiting for I2C interface to read!" << __E__;
-			__SS_THROW__;
-		}
-		usleep(1000);
-	}
-	auto data = ReadRegister_(CFOandDTC_Register_FireflyTXRX_IICBusConfigLow);
-	return static_cast<uint8_t>(data);
+	auto& engine = GetIICEngine({CFOandDTC_Register_FireflyTXRX_IICBusConfigLow, CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh});
+	return engine.Read(device, address).get();
 }
 /// <summary>
 /// Formats the register's current value for register dumps
@@ -1552,1338 +2066,533 @@ DTCLib::RegisterFormatter DTCLib::CFOandDTC_Registers::FormatFireflyCSR()
 
 
 //========================================================================
-/// <summary>
-/// Configure the Jitter Attenuator
-/// </summary>
-void DTCLib::CFOandDTC_Registers::ConfigureJitterAttenuator()
-{
-	CFOandDTC_Register IICLowReg = CFOandDTC_Register_SERDESClock_IICBusLow;
-	CFOandDTC_Register IICHighReg = CFOandDTC_Register_SERDESClock_IICBusHigh;
-
-		// Start configuration preamble
+// Jitter attenuator configuration script, as IIC Bus Low register words (device 0x68, register, data).
+// The preamble is followed by a 300 ms delay, which is the worst case time for the device to complete any calibration
+// that is running due to device state change previous to this script being processed.
+namespace {
+const std::vector<uint32_t> JitterAttenuatorPreamble = {
+	// Start configuration preamble
 	// set page B
-	WriteRegister_(0x68010B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010B00,
 
 	// page B registers
-	WriteRegister_(0x6824C000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68250000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x6824C000,
+	0x68250000,
 
 	// set page 5
-	WriteRegister_(0x68010500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010500,
 
 	// page 5 registers
-	WriteRegister_(0x68400100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68400100,
 
 	// End configuration preamble
-	//
-	// Delay 300 msec
-	usleep(300000 /*300ms*/); 
+};
 
-	// Delay is worst case time for device to complete any calibration
-	// that is running due to device state change previous to this script
-	// being processed.
-	//
+const std::vector<uint32_t> JitterAttenuatorConfiguration = {
 	// Start configuration registers
 	// set page 0
-	WriteRegister_(0x68010000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010000,
 
 	// page 0 registers
-	WriteRegister_(0x68060000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68070000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68080000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680B6800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68160200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6817DC00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68180000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6819DD00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681ADF00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682B0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682C0F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682D5500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682E3700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68303700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68310000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68323700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68330000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68343700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68350000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68363700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68370000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68383700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68390000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683A3700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683C3700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683FFF00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68400400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68410E00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68420E00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68430E00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68440E00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68450C00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68463200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68473200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68483200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68493200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684A3200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684B3200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684C3200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684D3200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684E5500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684F5500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68500F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68510300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68520300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68530300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68540300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68550300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68560300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68570300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68580300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68595500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685AAA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685BAA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685C0A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685D0100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685EAA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685FAA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68600A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68610100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6862AA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6863AA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68640A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68650100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6866AA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6867AA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68680A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68690100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68920200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6893A000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68950000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68968000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68986000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689A0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689B6000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689D0800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689E4000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A02000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A20000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A98A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68AA6100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68AB0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68AC0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68E52100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68EA0A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68EB6000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68EC0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68ED0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68060000,
+	0x68070000,
+	0x68080000,
+	0x680B6800,
+	0x68160200,
+	0x6817DC00,
+	0x68180000,
+	0x6819DD00,
+	0x681ADF00,
+	0x682B0200,
+	0x682C0F00,
+	0x682D5500,
+	0x682E3700,
+	0x682F0000,
+	0x68303700,
+	0x68310000,
+	0x68323700,
+	0x68330000,
+	0x68343700,
+	0x68350000,
+	0x68363700,
+	0x68370000,
+	0x68383700,
+	0x68390000,
+	0x683A3700,
+	0x683B0000,
+	0x683C3700,
+	0x683D0000,
+	0x683FFF00,
+	0x68400400,
+	0x68410E00,
+	0x68420E00,
+	0x68430E00,
+	0x68440E00,
+	0x68450C00,
+	0x68463200,
+	0x68473200,
+	0x68483200,
+	0x68493200,
+	0x684A3200,
+	0x684B3200,
+	0x684C3200,
+	0x684D3200,
+	0x684E5500,
+	0x684F5500,
+	0x68500F00,
+	0x68510300,
+	0x68520300,
+	0x68530300,
+	0x68540300,
+	0x68550300,
+	0x68560300,
+	0x68570300,
+	0x68580300,
+	0x68595500,
+	0x685AAA00,
+	0x685BAA00,
+	0x685C0A00,
+	0x685D0100,
+	0x685EAA00,
+	0x685FAA00,
+	0x68600A00,
+	0x68610100,
+	0x6862AA00,
+	0x6863AA00,
+	0x68640A00,
+	0x68650100,
+	0x6866AA00,
+	0x6867AA00,
+	0x68680A00,
+	0x68690100,
+	0x68920200,
+	0x6893A000,
+	0x68950000,
+	0x68968000,
+	0x68986000,
+	0x689A0200,
+	0x689B6000,
+	0x689D0800,
+	0x689E4000,
+	0x68A02000,
+	0x68A20000,
+	0x68A98A00,
+	0x68AA6100,
+	0x68AB0000,
+	0x68AC0000,
+	0x68E52100,
+	0x68EA0A00,
+	0x68EB6000,
+	0x68EC0000,
+	0x68ED0000,
 
 	// set page 1
-	WriteRegister_(0x68010100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010100,
 
 	// page 1 registers
-	WriteRegister_(0x68020100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68120600, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68130900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68143B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68152800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68170600, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68180900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68193B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681A2800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683F1000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68400000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68414000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6842FF00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68020100,
+	0x68120600,
+	0x68130900,
+	0x68143B00,
+	0x68152800,
+	0x68170600,
+	0x68180900,
+	0x68193B00,
+	0x681A2800,
+	0x683F1000,
+	0x68400000,
+	0x68414000,
+	0x6842FF00,
 
 	// set page 2
-	WriteRegister_(0x68010200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010200,
 
 	// page 2 registers
-	WriteRegister_(0x68060000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68086400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68090000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680E0100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68100000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68110000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68126400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68130000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68140000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68150000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68160000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68170000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68180100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68190000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681C6400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68200000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68210000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68220100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68230000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68240000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68250000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68266400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68270000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68280000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68290000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682C0100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68310B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68320B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68330B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68340B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68350000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68360000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68370000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68388000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6839D400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683EC000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68500000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68510000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68520000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68530000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68540000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68550000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x686B5200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x686C6500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x686D7600, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x686E3100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x686F2000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68702000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68712000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68722000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68900000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68910000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6894B000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68960200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68970200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68990200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689DFA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689E0100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A9CC00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68AA0400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68AB0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68B7FF00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68060000,
+	0x68086400,
+	0x68090000,
+	0x680A0000,
+	0x680B0000,
+	0x680C0000,
+	0x680D0000,
+	0x680E0100,
+	0x680F0000,
+	0x68100000,
+	0x68110000,
+	0x68126400,
+	0x68130000,
+	0x68140000,
+	0x68150000,
+	0x68160000,
+	0x68170000,
+	0x68180100,
+	0x68190000,
+	0x681A0000,
+	0x681B0000,
+	0x681C6400,
+	0x681D0000,
+	0x681E0000,
+	0x681F0000,
+	0x68200000,
+	0x68210000,
+	0x68220100,
+	0x68230000,
+	0x68240000,
+	0x68250000,
+	0x68266400,
+	0x68270000,
+	0x68280000,
+	0x68290000,
+	0x682A0000,
+	0x682B0000,
+	0x682C0100,
+	0x682D0000,
+	0x682E0000,
+	0x682F0000,
+	0x68310B00,
+	0x68320B00,
+	0x68330B00,
+	0x68340B00,
+	0x68350000,
+	0x68360000,
+	0x68370000,
+	0x68388000,
+	0x6839D400,
+	0x683A0000,
+	0x683B0000,
+	0x683C0000,
+	0x683D0000,
+	0x683EC000,
+	0x68500000,
+	0x68510000,
+	0x68520000,
+	0x68530000,
+	0x68540000,
+	0x68550000,
+	0x686B5200,
+	0x686C6500,
+	0x686D7600,
+	0x686E3100,
+	0x686F2000,
+	0x68702000,
+	0x68712000,
+	0x68722000,
+	0x688A0000,
+	0x688B0000,
+	0x688C0000,
+	0x688D0000,
+	0x688E0000,
+	0x688F0000,
+	0x68900000,
+	0x68910000,
+	0x6894B000,
+	0x68960200,
+	0x68970200,
+	0x68990200,
+	0x689DFA00,
+	0x689E0100,
+	0x689F0000,
+	0x68A9CC00,
+	0x68AA0400,
+	0x68AB0000,
+	0x68B7FF00,
 
 	// set page 3
-	WriteRegister_(0x68010300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010300,
 
 	// page 3 registers
-	WriteRegister_(0x68020000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68030000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68040000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68050000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68061100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68070000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68080000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68090000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680B8000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68100000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68110000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68120000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68130000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68140000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68150000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68160000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68170000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68380000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68391F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68400000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68410000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68420000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68430000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68440000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68450000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68460000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68590000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68020000,
+	0x68030000,
+	0x68040000,
+	0x68050000,
+	0x68061100,
+	0x68070000,
+	0x68080000,
+	0x68090000,
+	0x680A0000,
+	0x680B8000,
+	0x680C0000,
+	0x680D0000,
+	0x680E0000,
+	0x680F0000,
+	0x68100000,
+	0x68110000,
+	0x68120000,
+	0x68130000,
+	0x68140000,
+	0x68150000,
+	0x68160000,
+	0x68170000,
+	0x68380000,
+	0x68391F00,
+	0x683B0000,
+	0x683C0000,
+	0x683D0000,
+	0x683E0000,
+	0x683F0000,
+	0x68400000,
+	0x68410000,
+	0x68420000,
+	0x68430000,
+	0x68440000,
+	0x68450000,
+	0x68460000,
+	0x68590000,
+	0x685A0000,
+	0x685B0000,
+	0x685C0000,
 
 	// set page 4
-	WriteRegister_(0x68010400, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010400,
 
 	// page 4 registers
-	WriteRegister_(0x68870100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68870100,
 
 	// set page 5
-	WriteRegister_(0x68010500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010500,
 
 	// page 5 registers
-	WriteRegister_(0x68081000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68091F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680A0C00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680B0B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680C3F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680D3F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680E1300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680F2700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68100900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68110800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68123F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68133F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68150000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68160000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68170000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68180000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x6819A800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681A0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681F8000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68212B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682B0100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682C8700, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682D0300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682E1900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682F1900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68310000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68324200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68330300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68340000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68350000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68360000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68370000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68380000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68390000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683A0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683B0300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683D1100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683E0600, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68890D00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x688A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689BFA00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689D1000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689E2100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x689F0C00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A00B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A13F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A23F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68A60300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68081000,
+	0x68091F00,
+	0x680A0C00,
+	0x680B0B00,
+	0x680C3F00,
+	0x680D3F00,
+	0x680E1300,
+	0x680F2700,
+	0x68100900,
+	0x68110800,
+	0x68123F00,
+	0x68133F00,
+	0x68150000,
+	0x68160000,
+	0x68170000,
+	0x68180000,
+	0x6819A800,
+	0x681A0200,
+	0x681B0000,
+	0x681C0000,
+	0x681D0000,
+	0x681E0000,
+	0x681F8000,
+	0x68212B00,
+	0x682A0000,
+	0x682B0100,
+	0x682C8700,
+	0x682D0300,
+	0x682E1900,
+	0x682F1900,
+	0x68310000,
+	0x68324200,
+	0x68330300,
+	0x68340000,
+	0x68350000,
+	0x68360000,
+	0x68370000,
+	0x68380000,
+	0x68390000,
+	0x683A0200,
+	0x683B0300,
+	0x683C0000,
+	0x683D1100,
+	0x683E0600,
+	0x68890D00,
+	0x688A0000,
+	0x689BFA00,
+	0x689D1000,
+	0x689E2100,
+	0x689F0C00,
+	0x68A00B00,
+	0x68A13F00,
+	0x68A23F00,
+	0x68A60300,
 
 	// set page 8
-	WriteRegister_(0x68010800, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010800,
 
 	// page 8 registers
-	WriteRegister_(0x68023500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68030500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68040000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68050000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68060000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68070000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68080000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68090000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x680F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68100000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68110000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68120000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68130000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68140000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68150000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68160000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68170000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68180000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68190000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68200000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68210000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68220000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68230000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68240000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68250000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68260000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68270000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68280000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68290000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x682F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68300000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68310000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68320000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68330000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68340000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68350000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68360000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68370000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68380000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68390000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x683F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68400000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68410000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68420000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68430000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68440000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68450000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68460000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68470000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68480000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68490000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68500000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68510000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68520000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68530000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68540000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68550000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68560000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68570000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68580000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68590000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685B0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685C0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685D0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685F0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68600000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68610000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68023500,
+	0x68030500,
+	0x68040000,
+	0x68050000,
+	0x68060000,
+	0x68070000,
+	0x68080000,
+	0x68090000,
+	0x680A0000,
+	0x680B0000,
+	0x680C0000,
+	0x680D0000,
+	0x680E0000,
+	0x680F0000,
+	0x68100000,
+	0x68110000,
+	0x68120000,
+	0x68130000,
+	0x68140000,
+	0x68150000,
+	0x68160000,
+	0x68170000,
+	0x68180000,
+	0x68190000,
+	0x681A0000,
+	0x681B0000,
+	0x681C0000,
+	0x681D0000,
+	0x681E0000,
+	0x681F0000,
+	0x68200000,
+	0x68210000,
+	0x68220000,
+	0x68230000,
+	0x68240000,
+	0x68250000,
+	0x68260000,
+	0x68270000,
+	0x68280000,
+	0x68290000,
+	0x682A0000,
+	0x682B0000,
+	0x682C0000,
+	0x682D0000,
+	0x682E0000,
+	0x682F0000,
+	0x68300000,
+	0x68310000,
+	0x68320000,
+	0x68330000,
+	0x68340000,
+	0x68350000,
+	0x68360000,
+	0x68370000,
+	0x68380000,
+	0x68390000,
+	0x683A0000,
+	0x683B0000,
+	0x683C0000,
+	0x683D0000,
+	0x683E0000,
+	0x683F0000,
+	0x68400000,
+	0x68410000,
+	0x68420000,
+	0x68430000,
+	0x68440000,
+	0x68450000,
+	0x68460000,
+	0x68470000,
+	0x68480000,
+	0x68490000,
+	0x684A0000,
+	0x684B0000,
+	0x684C0000,
+	0x684D0000,
+	0x684E0000,
+	0x684F0000,
+	0x68500000,
+	0x68510000,
+	0x68520000,
+	0x68530000,
+	0x68540000,
+	0x68550000,
+	0x68560000,
+	0x68570000,
+	0x68580000,
+	0x68590000,
+	0x685A0000,
+	0x685B0000,
+	0x685C0000,
+	0x685D0000,
+	0x685E0000,
+	0x685F0000,
+	0x68600000,
+	0x68610000,
 
 	// set page 9
-	WriteRegister_(0x68010900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010900,
 
 	// page 9 registers
-	WriteRegister_(0x680E0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68430100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68490F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684A0F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684E4900, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684F0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x685E0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x680E0200,
+	0x68430100,
+	0x68490F00,
+	0x684A0F00,
+	0x684E4900,
+	0x684F0200,
+	0x685E0000,
 
 	// set page A
-	WriteRegister_(0x68010A00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010A00,
 
 	// page A registers
-	WriteRegister_(0x68020000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68030100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68040100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68050100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68140000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x681A0000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68020000,
+	0x68030100,
+	0x68040100,
+	0x68050100,
+	0x68140000,
+	0x681A0000,
 
 	// set page B
-	WriteRegister_(0x68010B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010B00,
 
 	// page B registers
-	WriteRegister_(0x68442F00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68460000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68470000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68480000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x684A0200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68570E00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-
-	WriteRegister_(0x68580100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68442F00,
+	0x68460000,
+	0x68470000,
+	0x68480000,
+	0x684A0200,
+	0x68570E00,
+	0x68580100,
 
 	// End configuration registers
 	//
 	// Start configuration postamble
 	// set page 5
-	WriteRegister_(0x68010500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010500,
 
 	// page 5 registers
-	WriteRegister_(0x68140100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68140100,
 
 	// set page 0
-	WriteRegister_(0x68010000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010000,
 
 	// page 0 registers
-	WriteRegister_(0x681C0100, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x681C0100,
 
 	// set page 5
-	WriteRegister_(0x68010500, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010500,
 
 	// page 5 registers
-	WriteRegister_(0x68400000, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68400000,
 
 	// set page B
-	WriteRegister_(0x68010B00, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x68010B00,
 
 	// page B registers
-	WriteRegister_(0x6824C300, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
+	0x6824C300,
+	0x68250200,
+};
+}  // namespace
 
-	WriteRegister_(0x68250200, IICLowReg); 
-	WriteRegister_(0x00000001, IICHighReg); 
-}
\ No newline at end of file
+/// <summary>
+/// Configure the Jitter Attenuator
+/// </summary>
+void DTCLib::CFOandDTC_Registers::ConfigureJitterAttenuator()
+{
+	ConfigureJitterAttenuatorAsync().get();
+}
+
+/// <summary>
+/// Queue the Jitter Attenuator configuration on the SERDES IIC bus
+/// </summary>
+/// <returns>Future which completes when the configuration is written, or holds the exception if an IIC write timed out</returns>
+std::future<void> DTCLib::CFOandDTC_Registers::ConfigureJitterAttenuatorAsync()
+{
+	auto engine = &GetIICEngine({CFOandDTC_Register_SERDESClock_IICBusLow, CFOandDTC_Register_SERDESClock_IICBusHigh});
+
+	// The configuration is only written if the preamble succeeded
+	return std::async(std::launch::async, [engine]() {
+		engine->WriteSequence(JitterAttenuatorPreamble).get();
+		engine->Delay(std::chrono::milliseconds(300)).get();
+		engine->WriteSequence(JitterAttenuatorConfiguration).get();
+	});
+}
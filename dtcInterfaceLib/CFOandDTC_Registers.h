@@ -3,10 +3,20 @@
 
 //#include <bitset> // std::bitset
 //#include <cstdint> // uint8_t, uint16_t
+#include <atomic>
+#include <chrono>
 #include <functional>  // std::bind, std::function
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>      // std::vector
 #include <optional>
 
+#include "BringUpTimeline.h"
+#include "IICEngine.h"
+#include "RegisterDump.h"
 #include "mu2edev.h"
 
 #define DTCLIB_COMMON_REGISTERS \
@@ -134,6 +144,89 @@ struct RegisterFormatter
 	}
 }; // end RegisterFormatter class
 
+constexpr uint16_t CFOandDTC_RegisterMapBegin = 0x9000;  ///< First address of the CFO/DTC register map
+constexpr uint16_t CFOandDTC_RegisterMapEnd = 0xA000;    ///< One past the last address of the CFO/DTC register map
+
+/// <summary>
+/// The RegisterSnapshot class holds register values read in one bulk pass, so that formatters and getters
+/// can decode a set of registers which were all read at (nearly) the same time.
+/// </summary>
+class RegisterSnapshot
+{
+public:
+	/// <summary>
+	/// Get the value of a register in the snapshot
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <param name="value">Output value, unchanged if the register is not in the snapshot</param>
+	/// <returns>Whether the register is in the snapshot</returns>
+	bool Get(uint16_t address, uint32_t& value) const
+	{
+		auto it = values_.find(address);
+		if (it == values_.end()) return false;
+		value = it->second;
+		return true;
+	}
+	/// <summary>
+	/// Determine whether a register is in the snapshot
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <returns>Whether the register is in the snapshot</returns>
+	bool Contains(uint16_t address) const { return values_.count(address) > 0; }
+	/// <summary>
+	/// Remove a register from the snapshot, e.g. because it was written since
+	/// </summary>
+	/// <param name="address">Register address</param>
+	void Erase(uint16_t address) { values_.erase(address); }
+	/// <summary>
+	/// Get all register values in the snapshot, ordered by address
+	/// </summary>
+	/// <returns>Map of address to value</returns>
+	const std::map<uint16_t, uint32_t>& GetValues() const { return values_; }
+	/// <summary>
+	/// Get the number of registers in the snapshot
+	/// </summary>
+	/// <returns>Number of registers</returns>
+	size_t Size() const { return values_.size(); }
+	/// <summary>
+	/// Get the time at which the bulk read started
+	/// </summary>
+	/// <returns>Wall-clock time of the snapshot</returns>
+	std::chrono::system_clock::time_point GetTimestamp() const { return timestamp_; }
+	/// <summary>
+	/// Get the time taken by the bulk read, i.e. the window in which all values were read
+	/// </summary>
+	/// <returns>Duration of the bulk read, in microseconds</returns>
+	double GetReadDurationUs() const { return readDurationUs_; }
+
+private:
+	friend class CFOandDTC_Registers;
+	std::map<uint16_t, uint32_t> values_;
+	std::chrono::system_clock::time_point timestamp_;
+	double readDurationUs_ = 0;
+	bool fillOnRead_ = false;  ///< Keep the registers read from the device while the snapshot is in use, see FormattedRegDump
+};
+
+/// <summary>
+/// A register whose value on the device differs from the value a configuration needs
+/// </summary>
+struct RegisterDifference
+{
+	uint16_t address = 0;
+	uint32_t current = 0;  ///< Value on the device
+	uint32_t target = 0;   ///< Value the configuration needs
+};
+
+/// <summary>
+/// How long a register value read from the device stays valid, see CFOandDTC_Registers::GetRegisterCacheClass_
+/// </summary>
+enum RegisterCacheClass
+{
+	RegisterCacheClass_Volatile,       ///< Changed by the hardware (status, counters, self-clearing bits): always read from the device
+	RegisterCacheClass_Configuration,  ///< Only changed by software: read once, then cached until it is written
+	RegisterCacheClass_Static,         ///< Fixed by the loaded firmware (design version, date...): read once per device open
+};
+
 /// <summary>
 /// The CFOandDTC_Registers class represents the common CFO-and-DTC Register space, and all the methods necessary to read and write those
 /// registers. Each register has, at the very least, a read method, a write method, and a RegisterFormatter method
@@ -158,7 +251,115 @@ public:
 	/// <returns>The current DTC UID for this instance</returns>
 	std::string getDeviceUID() { return GetDevice()->getDeviceUID(); }
 
+	/// <summary>
+	/// Get the phases of the last device bring-up (construction or SetSimMode), with their durations and register
+	/// access counts. Set DTCLIB_BRINGUP_TIMELINE to print it after construction, and DTCLIB_BRINGUP_BASELINE to the path
+	/// of a file written by BringUpTimeline::SaveBaseline to warn about phases slower than in the baseline.
+	/// </summary>
+	/// <returns>Bring-up timeline</returns>
+	const BringUpTimeline& GetBringUpTimeline() const { return bringUpTimeline_; }
+
+	/// <summary>
+	/// Perform a register dump. The registers the formatters read are read in one bulk pass first (see
+	/// TakeRegisterSnapshot), so the dump is consistent in time. Which registers those are is learnt from the first dump
+	/// of regVec, which reads register by register. Registers with read side effects (see HasReadSideEffect_) are
+	/// never bulk read; the formatters read them from the device, once, as without a snapshot.
+	/// </summary>
+	/// <param name="width">Printable width of description fields</param>
+	/// <param name="regVec">Formatter functions of the registers to dump</param>
+	/// <returns>String containing all registers, with their human-readable representations</returns>
 	std::string FormattedRegDump(int width, const std::vector<std::function<RegisterFormatter()>>& regVec);
+	/// <summary>
+	/// Perform a register dump from a previously taken snapshot. Registers missing from the snapshot are read from the device.
+	/// </summary>
+	/// <param name="width">Printable width of description fields</param>
+	/// <param name="regVec">Formatter functions of the registers to dump</param>
+	/// <param name="snapshot">Register values to format</param>
+	/// <returns>String containing all registers, with their human-readable representations</returns>
+	std::string FormattedRegDump(int width, const std::vector<std::function<RegisterFormatter()>>& regVec, RegisterSnapshot& snapshot);
+
+	/// <summary>
+	/// Read the whole register map (CFOandDTC_RegisterMapBegin to CFOandDTC_RegisterMapEnd) in one bulk pass,
+	/// except the registers with read side effects (see HasReadSideEffect_)
+	/// </summary>
+	/// <returns>RegisterSnapshot with the values and the time of the read</returns>
+	RegisterSnapshot TakeRegisterSnapshot();
+	/// <summary>
+	/// Read the given registers in one bulk pass. Registers with read side effects (see HasReadSideEffect_) are skipped.
+	/// </summary>
+	/// <param name="addresses">Register addresses to read</param>
+	/// <returns>RegisterSnapshot with the values and the time of the read</returns>
+	RegisterSnapshot TakeRegisterSnapshot(const std::vector<uint16_t>& addresses);
+	/// <summary>
+	/// Serve register reads of the calling thread from the given snapshot (reads of registers not in the snapshot,
+	/// and reads from other threads, still go to the device). Register writes remove the register from the snapshot.
+	/// </summary>
+	/// <param name="snapshot">Snapshot to use, or nullptr to read from the device again</param>
+	void UseRegisterSnapshot(RegisterSnapshot* snapshot);
+
+	/// <summary>
+	/// Work out the layout of a register dump once, by running the formatter functions. Register names are
+	/// taken from the formatters; bit fields from the register description of the derived class, if it has one.
+	/// </summary>
+	/// <param name="regVec">Formatter functions of the registers to dump</param>
+	/// <returns>RegisterDumpLayout for FormatRegisterDump</returns>
+	RegisterDumpLayout MakeRegisterDumpLayout(const std::vector<std::function<RegisterFormatter()>>& regVec);
+	/// <summary>
+	/// Get the layout of the full register dump (getFormattedDumpFunctions), made on first use
+	/// </summary>
+	/// <returns>RegisterDumpLayout of the full register dump</returns>
+	const RegisterDumpLayout& GetRegisterDumpLayout();
+	/// <summary>
+	/// Read the registers of a layout in one bulk pass and format them into a buffer. Reusing the buffer between calls
+	/// avoids all heap allocation after the first dump.
+	/// </summary>
+	/// <param name="layout">Layout of the dump</param>
+	/// <param name="format">Output format</param>
+	/// <param name="out">Output buffer, cleared first</param>
+	void FormatRegisterDump(const RegisterDumpLayout& layout, RegisterDumpFormat format, std::string& out);
+	/// <summary>
+	/// Read and format the full register dump (see GetRegisterDumpLayout)
+	/// </summary>
+	/// <param name="format">Output format</param>
+	/// <param name="out">Output buffer, cleared first</param>
+	void FormatRegisterDump(RegisterDumpFormat format, std::string& out) { FormatRegisterDump(GetRegisterDumpLayout(), format, out); }
+
+	/// <summary>
+	/// Start collecting register changes of the calling thread in a shadow copy instead of writing them to the device.
+	/// Each register is read from the device at most once, and every read-modify-write (SetBit_, Enable*/Disable*, ...)
+	/// of the transaction operates on the shadow value. Transactions nest; only the outermost commit writes.
+	/// Only use transactions for configuration registers: writes which trigger an action (resets, write-to-clear) are coalesced too.
+	/// </summary>
+	void BeginRegisterTransaction();
+	/// <summary>
+	/// Close the current transaction level. When the outermost level is committed, each changed register is written
+	/// (and verified) once, in the order the registers were first written.
+	/// </summary>
+	/// <returns>Number of registers written to the device</returns>
+	size_t CommitRegisterTransaction();
+	/// <summary>
+	/// Discard all changes collected by the current transaction, at every level
+	/// </summary>
+	void AbortRegisterTransaction();
+
+	/// <summary>
+	/// Enable or disable the register cache. While enabled, static and configuration registers (see RegisterCacheClass)
+	/// are only read from the device the first time. The cache assumes this instance is the only writer of the
+	/// configuration registers, so it is disabled by default: writes from another process with its own instance would
+	/// leave stale values. Set DTCLIB_REGISTER_CACHE=1 in the environment to enable it.
+	/// </summary>
+	/// <param name="enable">Whether to serve reads from the cache</param>
+	void SetRegisterCacheEnabled(bool enable);
+	/// <summary>
+	/// Whether reads of static and configuration registers are served from the cache
+	/// </summary>
+	/// <returns>True if the register cache is enabled</returns>
+	bool IsRegisterCacheEnabled() const { return registerCacheEnabled_.load(std::memory_order_relaxed); }
+	/// <summary>
+	/// Forget all cached register values, e.g. after the registers were changed by another process
+	/// </summary>
+	void ClearRegisterCache();
+
 	virtual const std::vector<std::function<RegisterFormatter()>>& getFormattedDumpFunctions() = 0; //pure virtual
 	virtual const std::vector<std::function<RegisterFormatter()>>& getFormattedSimpleDumpFunctions() = 0; //pure virtual
 
@@ -243,6 +444,15 @@ public:
 	RegisterFormatter FormatJitterAttenuatorCSR(CFOandDTC_Register JAreg);
 	// virtual void ConfigureJitterAttenuator() = 0; //pure virtual
 	void ConfigureJitterAttenuator();
+	std::future<void> ConfigureJitterAttenuatorAsync();
+
+	/// <summary>
+	/// Get the IICEngine of an IIC bus, starting it on first use. The engine queues IIC transactions and runs them in the
+	/// background; the Read/Write IIC Interface functions are blocking calls through the same engine.
+	/// </summary>
+	/// <param name="bus">IIC Bus Low/High register pair</param>
+	/// <returns>IICEngine of the bus, owned by this instance</returns>
+	IICEngine& GetIICEngine(IICBus const& bus);
 
 	void WriteSERDESIICInterface(DTC_IICSERDESBusAddress device, uint8_t address, uint8_t data);
 	uint8_t ReadSERDESIICInterface(DTC_IICSERDESBusAddress device, uint8_t address);
@@ -305,6 +515,8 @@ protected:
 	virtual bool NeedToVerifyRegisterWrite_(const CFOandDTC_Register& address) = 0;
 	virtual void VerifyRegisterWrite_(const CFOandDTC_Register& address, uint32_t readbackValue, uint32_t dataToWrite) = 0;
 	bool CFOandDTCVerifyRegisterWrite_(const CFOandDTC_Register& address, uint32_t readbackValue, uint32_t dataToWrite);
+	virtual RegisterCacheClass GetRegisterCacheClass_(const CFOandDTC_Register& address);
+	virtual bool HasReadSideEffect_(const CFOandDTC_Register& address);
 
 	/// <summary>
 	/// Initializes a RegisterFormatter for the given CFOandDTC_Register
@@ -323,6 +535,7 @@ protected:
 	
 	bool GetBit_(const CFOandDTC_Register& address, size_t bit);
 	void SetBit_(const CFOandDTC_Register& address, size_t bit, bool value);
+	void SetField_(const CFOandDTC_Register& address, size_t offset, size_t width, uint32_t value);
 	bool ToggleBit_(const CFOandDTC_Register& address, size_t bit)
 	{
 		auto val = GetBit_(address, bit);
@@ -330,11 +543,120 @@ protected:
 		return !val;
 	}
 
+	/// <summary>
+	/// Shadow copy of a register touched by a register transaction
+	/// </summary>
+	struct ShadowRegister_
+	{
+		std::optional<uint32_t> deviceValue;  ///< Value read from the device, if it was read
+		uint32_t value = 0;                   ///< Value to write on commit
+		bool dirty = false;                   ///< Whether the register was written in the transaction
+	};
+	bool InRegisterTransaction_() const { return transactionThread_.load(std::memory_order_acquire) == std::this_thread::get_id(); }
+	std::vector<RegisterDifference> PendingRegisterWrites_();
+	void ReportBringUpTimeline_();
+	double ReadRegisterBlock_(const uint16_t* addresses, size_t count, uint32_t* values);
+	double WriteRegisterBlock_(const uint16_t* addresses, const uint32_t* values, size_t count);
+	virtual void DescribeRegisterDumpFields_(uint16_t /*address*/, std::vector<RegisterDumpField>& /*fields*/) {}
+
 	mu2edev device_;                     ///< Device handle
+	std::map<uint16_t, ShadowRegister_> transactionShadow_;  ///< Registers touched by the open register transaction
+	std::vector<uint16_t> transactionOrder_;                 ///< Written registers, in the order of their first write
+	int transactionDepth_ = 0;                               ///< Only accessed by transactionThread_
+	std::atomic<std::thread::id> transactionThread_;         ///< Thread with the open register transaction, none if there is no transaction
+	/// <summary>
+	/// Snapshot serving the register reads of a thread, see UseRegisterSnapshot
+	/// </summary>
+	struct ThreadSnapshot_
+	{
+		const CFOandDTC_Registers* owner = nullptr;  ///< Register instance the snapshot is used for
+		RegisterSnapshot* snapshot = nullptr;
+	};
+	static thread_local ThreadSnapshot_ threadSnapshot_;  ///< Thread-local, so that threads neither see nor race on each other's snapshot
+	RegisterSnapshot* ActiveSnapshot_() const { return threadSnapshot_.owner == this ? threadSnapshot_.snapshot : nullptr; }
+	std::mutex formatterReadsMutex_;
+	std::map<const void*, std::vector<uint16_t>> formatterReads_;  ///< Registers read by each formatter vector, see FormattedRegDump
+	BringUpTimeline bringUpTimeline_;    ///< Phases of the last bring-up
+	std::mutex registerDumpLayoutMutex_;
+	std::unique_ptr<RegisterDumpLayout> registerDumpLayout_;  ///< Layout of the full register dump, see GetRegisterDumpLayout
+	std::mutex registerCacheMutex_;
+	std::map<uint16_t, uint32_t> registerCache_;  ///< Static and configuration register values, see RegisterCacheClass
+	std::atomic<bool> registerCacheEnabled_;
+	std::mutex iicEnginesMutex_;
+	std::map<uint16_t, std::unique_ptr<IICEngine>> iicEngines_;  ///< IIC engines, by IIC Bus Low register
 	int formatterWidth_ = 28;            ///< Description field width, in characters (must be initialized or RegisterFormatter can resize to crazy large values!)
 
 
+
+	friend class RegisterTransaction;
+	friend class IICEngine;
 }; // end CFOandDTC_Registers class
+
+/// <summary>
+/// The RegisterTransaction class is a scoped register editor. Bit and field changes are collected against a shadow
+/// copy of the registers and applied as one write per touched register by Commit(). Register methods called while
+/// the transaction is open (e.g. EnableLink, SetSERDESLoopbackMode) join it. If the transaction goes out of scope
+/// without Commit(), for example because of an exception, the changes are discarded.
+/// </summary>
+class RegisterTransaction
+{
+public:
+	/// <summary>
+	/// Open a register transaction (or a nested level of the one already open on this thread)
+	/// </summary>
+	/// <param name="registers">Register interface to edit</param>
+	explicit RegisterTransaction(CFOandDTC_Registers* registers);
+	~RegisterTransaction();
+	RegisterTransaction(const RegisterTransaction&) = delete;
+	RegisterTransaction& operator=(const RegisterTransaction&) = delete;
+
+	/// <summary>
+	/// Read a register, from the shadow copy if it was already touched
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <returns>Current (shadow) value</returns>
+	uint32_t Read(const CFOandDTC_Register& address);
+	/// <summary>
+	/// Set the whole register
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <param name="value">Value to write on commit</param>
+	void Write(const CFOandDTC_Register& address, uint32_t value);
+	/// <summary>
+	/// Set a single bit of a register
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <param name="bit">Bit index (0-31)</param>
+	/// <param name="value">Bit value</param>
+	void SetBit(const CFOandDTC_Register& address, size_t bit, bool value);
+	/// <summary>
+	/// Set a field of a register
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <param name="offset">Index of the lowest bit of the field</param>
+	/// <param name="width">Width of the field, in bits</param>
+	/// <param name="value">Field value (bits beyond the width are ignored)</param>
+	void SetField(const CFOandDTC_Register& address, size_t offset, size_t width, uint32_t value);
+
+	/// <summary>
+	/// Apply the collected changes (if this is the outermost transaction)
+	/// </summary>
+	/// <returns>Number of registers written to the device</returns>
+	size_t Commit();
+	/// <summary>
+	/// Discard the collected changes
+	/// </summary>
+	void Abort();
+	/// <summary>
+	/// Get the registers Commit() would write: the written registers whose value differs from the device
+	/// </summary>
+	/// <returns>Current and target value of each register, in write order</returns>
+	std::vector<RegisterDifference> GetPendingWrites();
+
+private:
+	CFOandDTC_Registers* registers_;
+	bool open_;
+};
 }  // namespace DTCLib
 
 #endif  // CFO_AND_DTC_REGISTERS_H
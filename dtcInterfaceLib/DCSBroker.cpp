@@ -0,0 +1,582 @@
+#include "DCSBroker.h"
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "DCSBroker"
+
+#define TLVL_ServeRequest TLVL_DEBUG + 5
+#define TLVL_ClientRequest TLVL_DEBUG + 6
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+/// <summary>
+/// Scoped lock on the broker segment mutex. The mutex is robust, so if a client dies while
+/// holding it, the next locker recovers it instead of deadlocking.
+/// </summary>
+class SegmentLock
+{
+public:
+	explicit SegmentLock(DTCLib::DCSBrokerSegment* segment)
+		: segment_(segment)
+	{
+		if (pthread_mutex_lock(&segment_->mutex) == EOWNERDEAD) pthread_mutex_consistent(&segment_->mutex);
+	}
+	~SegmentLock() { pthread_mutex_unlock(&segment_->mutex); }
+
+	/// <summary>
+	/// Wait on a condition variable of the segment, for at most tmo_ms milliseconds
+	/// </summary>
+	void Wait(pthread_cond_t* cond, int tmo_ms)
+	{
+		timespec deadline;
+		clock_gettime(CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += tmo_ms / 1000;
+		deadline.tv_nsec += (tmo_ms % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+		if (pthread_cond_timedwait(cond, &segment_->mutex, &deadline) == EOWNERDEAD) pthread_mutex_consistent(&segment_->mutex);
+	}
+
+private:
+	DTCLib::DCSBrokerSegment* segment_;
+};
+
+bool ProcessIsAlive(pid_t pid) { return pid != 0 && (kill(pid, 0) == 0 || errno != ESRCH); }
+
+/// <summary>
+/// Find the broker serving an existing shared-memory segment
+/// </summary>
+/// <returns>Pid of the live broker which owns the segment, or 0 if there is none (no segment, or one left behind)</returns>
+pid_t LiveBrokerPid(const std::string& shmName)
+{
+	auto fd = shm_open(shmName.c_str(), O_RDONLY, 0);
+	if (fd < 0) return 0;
+	auto ptr = mmap(nullptr, sizeof(DTCLib::DCSBrokerSegment), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (ptr == MAP_FAILED) return 0;  // E.g. truncated by a broker which failed during construction
+
+	auto segment = static_cast<const DTCLib::DCSBrokerSegment*>(ptr);
+	pid_t pid = 0;
+	if (segment->magic == DTCLib::DCS_BROKER_MAGIC && segment->running != 0 && ProcessIsAlive(segment->brokerPid))
+		pid = segment->brokerPid;
+	munmap(ptr, sizeof(DTCLib::DCSBrokerSegment));
+	return pid;
+}
+
+void InitSharedCond(pthread_cond_t* cond)
+{
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+}  // namespace
+
+std::string DTCLib::DCSBrokerDefaultName(int dtc)
+{
+	if (dtc == -1)
+	{
+		auto dtcE = getenv("DTCLIB_DTC");
+		dtc = dtcE != nullptr ? atoi(dtcE) : 0;
+	}
+	return "/mu2e_dcs_broker_" + std::to_string(dtc);
+}
+
+DTCLib::DCSBroker::DCSBroker(DTC* dtc, std::string shmName)
+	: dtc_(dtc), shmName_(shmName), segment_(nullptr), stop_(false), servedCount_(0), roundRobin_(0)
+{
+	auto ownerPid = LiveBrokerPid(shmName_);
+	if (ownerPid != 0)
+	{
+		__SS__ << "DCS broker shared memory " << shmName_ << " is in use by the running DCS broker with pid " << ownerPid
+			   << "; refusing to start a second broker for the same DTC." << __E__;
+		__SS_THROW__;
+	}
+	shm_unlink(shmName_.c_str());  // Remove any segment left behind by a broker which did not exit cleanly
+	auto fd = shm_open(shmName_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0666);
+	if (fd < 0)
+	{
+		__SS__ << "Could not create DCS broker shared memory " << shmName_ << ": " << strerror(errno) << __E__;
+		__SS_THROW__;
+	}
+	if (ftruncate(fd, sizeof(DCSBrokerSegment)) != 0)
+	{
+		::close(fd);
+		__SS__ << "Could not size DCS broker shared memory " << shmName_ << ": " << strerror(errno) << __E__;
+		__SS_THROW__;
+	}
+	auto ptr = mmap(nullptr, sizeof(DCSBrokerSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (ptr == MAP_FAILED)
+	{
+		__SS__ << "Could not map DCS broker shared memory " << shmName_ << ": " << strerror(errno) << __E__;
+		__SS_THROW__;
+	}
+	segment_ = static_cast<DCSBrokerSegment*>(ptr);
+	memset(segment_, 0, sizeof(DCSBrokerSegment));
+
+	pthread_mutexattr_t mutexAttr;
+	pthread_mutexattr_init(&mutexAttr);
+	pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+	pthread_mutexattr_setrobust(&mutexAttr, PTHREAD_MUTEX_ROBUST);
+	pthread_mutex_init(&segment_->mutex, &mutexAttr);
+	pthread_mutexattr_destroy(&mutexAttr);
+
+	InitSharedCond(&segment_->requestPending);
+	for (auto& client : segment_->clients)
+	{
+		InitSharedCond(&client.replyReady);
+	}
+
+	segment_->brokerPid = getpid();
+	segment_->running = 1;
+	segment_->version = DCS_BROKER_VERSION;
+	segment_->magic = DCS_BROKER_MAGIC;
+
+	dispatcher_ = std::make_unique<DCSReplyDispatcher>(dtc_);
+
+	TLOG(TLVL_INFO) << "DCS broker serving " << shmName_;
+}
+
+DTCLib::DCSBroker::~DCSBroker()
+{
+	Stop();
+	dispatcher_.reset();
+	{
+		SegmentLock lock(segment_);
+		segment_->running = 0;
+		for (auto& client : segment_->clients)
+		{
+			pthread_cond_broadcast(&client.replyReady);
+		}
+	}
+	munmap(segment_, sizeof(DCSBrokerSegment));
+	shm_unlink(shmName_.c_str());
+}
+
+void DTCLib::DCSBroker::Run()
+{
+	while (!stop_)
+	{
+		if (!ServeBatch_())
+		{
+			SegmentLock lock(segment_);
+			lock.Wait(&segment_->requestPending, 100);
+		}
+	}
+}
+
+// Only sets a flag, so that it may be called from a signal handler. Run() polls the flag at least every 100 ms.
+void DTCLib::DCSBroker::Stop() { stop_ = true; }
+
+// Serve pending requests, keeping up to DCS_BROKER_MAX_IN_FLIGHT of them in flight. Once stopped, only the requests
+// already in flight are completed. Returns false if there was nothing to do.
+bool DTCLib::DCSBroker::ServeBatch_()
+{
+	size_t served = 0;
+
+	while (!stop_ || !inFlight_.empty())
+	{
+		if (!stop_) Dispatch_();
+		if (inFlight_.empty()) break;
+
+		// The ROC answers in order, so the oldest request is the next one to complete
+		Complete_(inFlight_.front());
+		inFlight_.pop_front();
+		++served;
+		++servedCount_;
+	}
+	return served > 0;
+}
+
+// Take pending requests from the client rings and send them, highest-priority client first. Within a priority,
+// clients take turns. A block operation is only taken when nothing else is in flight, and nothing is taken after it.
+void DTCLib::DCSBroker::Dispatch_()
+{
+	while (inFlight_.size() < DCS_BROKER_MAX_IN_FLIGHT)
+	{
+		InFlight_ next;
+		bool isBlock;
+		{
+			SegmentLock lock(segment_);
+			ReapDeadClients_();
+
+			int clientIndex = -1;
+			int bestPriority = 0;
+			DCSBrokerRequest* req = nullptr;
+			for (size_t ii = 0; ii < DCS_BROKER_MAX_CLIENTS; ++ii)
+			{
+				auto idx = (roundRobin_ + ii) % DCS_BROKER_MAX_CLIENTS;
+				auto& client = segment_->clients[idx];
+				if (client.pid == 0) continue;
+
+				// Requests of a client are sent in ring order, after the ones already in flight
+				DCSBrokerRequest* pending = nullptr;
+				for (auto sequence = client.tail; sequence != client.head && pending == nullptr; ++sequence)
+				{
+					auto& slot = client.ring[sequence % DCS_BROKER_RING_SIZE];
+					if (slot.state == DCSBrokerSlotState_Pending) pending = &slot;
+				}
+				if (pending == nullptr) continue;
+				if (clientIndex < 0 || client.priority > bestPriority)
+				{
+					clientIndex = idx;
+					bestPriority = client.priority;
+					req = pending;
+				}
+			}
+			if (clientIndex < 0) return;
+
+			isBlock = req->op == DCSBrokerOp_BlockRead || req->op == DCSBrokerOp_BlockWrite;
+			if (isBlock && !inFlight_.empty()) return;
+
+			// Hand the request over: from here on the client leaves the slot alone until it is marked Done
+			req->state = DCSBrokerSlotState_InFlight;
+			next.request = *req;
+			next.clientIndex = clientIndex;
+			next.clientPid = segment_->clients[clientIndex].pid;
+			roundRobin_ = clientIndex + 1;
+		}
+
+		Send_(next);
+		inFlight_.push_back(std::move(next));
+		if (isBlock) return;
+	}
+}
+
+// Send a request through the dispatcher. Block operations are served synchronously.
+void DTCLib::DCSBroker::Send_(InFlight_& inFlight)
+{
+	auto& req = inFlight.request;
+	auto link = static_cast<DTC_Link_ID>(req.link);
+	TLOG(TLVL_ServeRequest) << "Serving request " << req.sequence << ": op=" << static_cast<int>(req.op) << ", link=" << static_cast<int>(req.link)
+							<< ", address=0x" << std::hex << req.address << ", wordCount=" << std::dec << req.wordCount;
+	req.status = 0;
+	req.error[0] = '\0';
+	try
+	{
+		switch (req.op)
+		{
+			case DCSBrokerOp_Read:
+				inFlight.replies.push_back(dispatcher_->Send(link, DTC_DCSOperationType_Read, req.address, 0, false, req.tmo_ms));
+				break;
+			case DCSBrokerOp_Write:
+				inFlight.replies.push_back(dispatcher_->Send(link, DTC_DCSOperationType_Write, req.address, req.data[0], req.requestAck, req.tmo_ms));
+				break;
+			case DCSBrokerOp_ReadExt:
+			{
+				// Same sequence as DTC::ReadExtROCRegister. The broker is the only sender, so nothing comes in between.
+				uint16_t address = req.address & 0x7FFF;
+				dispatcher_->Send(link, DTC_DCSOperationType_Write, 12, req.block, false, req.tmo_ms);
+				dispatcher_->Send(link, DTC_DCSOperationType_Write, 13, address, false, req.tmo_ms);
+				dispatcher_->Send(link, DTC_DCSOperationType_Write, 13, address | 0x8000, false, req.tmo_ms);
+				inFlight.replies.push_back(dispatcher_->Send(link, DTC_DCSOperationType_Read, 22, 0, false, req.tmo_ms));
+				break;
+			}
+			case DCSBrokerOp_WriteExt:
+			{
+				// Same sequence as DTC::WriteExtROCRegister
+				uint16_t data = req.data[0] & 0x7FFF;
+				inFlight.replies.push_back(
+					dispatcher_->Send(link, DTC_DCSOperationType_Write, 12, req.block + (req.address << 8), req.requestAck, req.tmo_ms));
+				inFlight.replies.push_back(dispatcher_->Send(link, DTC_DCSOperationType_Write, 13, data, req.requestAck, req.tmo_ms));
+				inFlight.replies.push_back(dispatcher_->Send(link, DTC_DCSOperationType_Write, 13, data | 0x8000, req.requestAck, req.tmo_ms));
+				break;
+			}
+			case DCSBrokerOp_BlockRead:
+			case DCSBrokerOp_BlockWrite:
+				dispatcher_->RunExclusive([&]() { ProcessBlock_(req); });
+				break;
+			default:
+				req.status = -1;
+				snprintf(req.error, DCS_BROKER_ERROR_LENGTH, "Unknown DCS broker operation %d", static_cast<int>(req.op));
+				break;
+		}
+	}
+	catch (std::exception const& ex)
+	{
+		req.status = -1;
+		strncpy(req.error, ex.what(), DCS_BROKER_ERROR_LENGTH - 1);
+		req.error[DCS_BROKER_ERROR_LENGTH - 1] = '\0';
+	}
+}
+
+// Wait for the replies of a request and write the result to its ring slot
+void DTCLib::DCSBroker::Complete_(InFlight_& inFlight)
+{
+	auto& req = inFlight.request;
+	if (req.status == 0 && !inFlight.replies.empty())
+	{
+		std::vector<std::unique_ptr<DTC_DCSReplyPacket>> replies;
+		for (auto& reply : inFlight.replies) replies.push_back(reply.get());
+
+		req.wordCount = 1;
+		if (req.op == DCSBrokerOp_Read || req.op == DCSBrokerOp_ReadExt)
+		{
+			if (replies.back() != nullptr)
+				req.data[0] = replies.back()->GetReply(false).second;
+			else
+			{
+				req.status = -1;
+				snprintf(req.error, DCS_BROKER_ERROR_LENGTH, "A timeout occurred attempting to read a ROC register at link %d address 0x%x",
+						 static_cast<int>(req.link), static_cast<unsigned>(req.address));
+			}
+		}
+		else
+		{
+			// Writes reply with whether every acknowledgement arrived (true if none was requested)
+			auto acknowledged = true;
+			for (auto& reply : replies) acknowledged = acknowledged && reply != nullptr;
+			req.data[0] = !req.requestAck || acknowledged;
+		}
+	}
+
+	SegmentLock lock(segment_);
+	auto& client = segment_->clients[inFlight.clientIndex];
+	auto& slot = client.ring[req.sequence % DCS_BROKER_RING_SIZE];
+	if (client.pid != inFlight.clientPid || slot.sequence != req.sequence || slot.state != DCSBrokerSlotState_InFlight)
+	{
+		TLOG(TLVL_DEBUG) << "Dropping the reply to request " << req.sequence << ", its client disconnected";
+		return;
+	}
+	slot.status = req.status;
+	memcpy(slot.error, req.error, DCS_BROKER_ERROR_LENGTH);
+	slot.wordCount = req.wordCount;
+	std::copy(req.data, req.data + req.wordCount, slot.data);
+	slot.state = DCSBrokerSlotState_Done;
+	client.tail++;
+	client.served++;
+	pthread_cond_broadcast(&client.replyReady);
+}
+
+// Serve a block operation through the DTC block functions, which read the DCS channel themselves
+void DTCLib::DCSBroker::ProcessBlock_(DCSBrokerRequest& req)
+{
+	auto link = static_cast<DTC_Link_ID>(req.link);
+	if (req.op == DCSBrokerOp_BlockRead)
+	{
+		std::vector<roc_data_t> data;
+		dtc_->ReadROCBlock(data, link, req.address, req.wordCount, req.incrementAddress, req.tmo_ms);
+		req.wordCount = static_cast<uint16_t>(std::min(data.size(), DCS_BROKER_MAX_BLOCK_WORDS));
+		std::copy(data.begin(), data.begin() + req.wordCount, req.data);
+	}
+	else
+	{
+		std::vector<roc_data_t> data(req.data, req.data + req.wordCount);
+		req.data[0] = dtc_->WriteROCBlock(link, req.address, data, req.requestAck, req.incrementAddress, req.tmo_ms);
+		req.wordCount = 1;
+	}
+}
+
+// Must be called with the segment lock held
+void DTCLib::DCSBroker::ReapDeadClients_()
+{
+	for (auto& client : segment_->clients)
+	{
+		if (client.pid != 0 && !ProcessIsAlive(client.pid))
+		{
+			TLOG(TLVL_INFO) << "Releasing slot of DCS broker client " << client.pid << ", which exited without disconnecting";
+			client.pid = 0;
+			client.head = client.tail = 0;
+		}
+	}
+}
+
+DTCLib::DCSBrokerClient::DCSBrokerClient(std::string shmName, int priority)
+	: shmName_(shmName), segment_(nullptr), clientIndex_(-1), nextSequence_(0)
+{
+	auto fd = shm_open(shmName_.c_str(), O_RDWR, 0);
+	if (fd < 0)
+	{
+		__SS__ << "Could not open DCS broker shared memory " << shmName_ << " (is the DCS broker running?): " << strerror(errno) << __E__;
+		__SS_THROW__;
+	}
+	auto ptr = mmap(nullptr, sizeof(DCSBrokerSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (ptr == MAP_FAILED)
+	{
+		__SS__ << "Could not map DCS broker shared memory " << shmName_ << ": " << strerror(errno) << __E__;
+		__SS_THROW__;
+	}
+	segment_ = static_cast<DCSBrokerSegment*>(ptr);
+	if (segment_->magic != DCS_BROKER_MAGIC || segment_->version != DCS_BROKER_VERSION)
+	{
+		auto version = segment_->version;
+		munmap(segment_, sizeof(DCSBrokerSegment));
+		__SS__ << "DCS broker shared memory " << shmName_ << " has an unexpected layout (version " << version << ", expected "
+			   << DCS_BROKER_VERSION << ")" << __E__;
+		__SS_THROW__;
+	}
+
+	SegmentLock lock(segment_);
+	for (size_t ii = 0; ii < DCS_BROKER_MAX_CLIENTS; ++ii)
+	{
+		auto& client = segment_->clients[ii];
+		if (client.pid == 0 || !ProcessIsAlive(client.pid))
+		{
+			client.pid = getpid();
+			client.priority = priority;
+			client.head = client.tail = 0;
+			client.served = 0;
+			for (auto& slot : client.ring)
+			{
+				slot.state = DCSBrokerSlotState_Free;
+			}
+			clientIndex_ = ii;
+			break;
+		}
+	}
+	if (clientIndex_ < 0)
+	{
+		__SS__ << "All " << DCS_BROKER_MAX_CLIENTS << " DCS broker client slots are in use" << __E__;
+		__SS_THROW_ONLY__;
+	}
+	TLOG(TLVL_DEBUG) << "Connected to DCS broker " << shmName_ << " as client " << clientIndex_ << " with priority " << priority;
+}
+
+DTCLib::DCSBrokerClient::~DCSBrokerClient()
+{
+	if (clientIndex_ >= 0)
+	{
+		SegmentLock lock(segment_);
+		segment_->clients[clientIndex_].pid = 0;
+	}
+	munmap(segment_, sizeof(DCSBrokerSegment));
+}
+
+uint32_t DTCLib::DCSBrokerClient::Submit(DCSBrokerOp op, const DTC_Link_ID& link, roc_address_t address, const std::vector<roc_data_t>& data,
+										 uint16_t wordCount, bool requestAck, bool incrementAddress, int tmo_ms, roc_address_t block)
+{
+	if (data.size() > DCS_BROKER_MAX_BLOCK_WORDS)
+	{
+		__SS__ << "DCS broker requests are limited to " << DCS_BROKER_MAX_BLOCK_WORDS << " words, " << data.size() << " requested" << __E__;
+		__SS_THROW__;
+	}
+
+	SegmentLock lock(segment_);
+	auto& client = segment_->clients[clientIndex_];
+	auto ticket = nextSequence_;
+	auto& slot = client.ring[ticket % DCS_BROKER_RING_SIZE];
+
+	// Slot is still in use if the ring is full of pending requests, wait for the broker to work through them.
+	// A completed reply which was never collected with Wait() would block forever, so that is an error.
+	while (slot.state != DCSBrokerSlotState_Free)
+	{
+		if (slot.state == DCSBrokerSlotState_Done)
+		{
+			__SS__ << "More than " << DCS_BROKER_RING_SIZE << " DCS broker requests outstanding, call Wait() on request " << slot.sequence
+				   << " before submitting more" << __E__;
+			__SS_THROW_ONLY__;
+		}
+		if (!segment_->running || !ProcessIsAlive(segment_->brokerPid))
+		{
+			__SS__ << "DCS broker " << shmName_ << " is not running" << __E__;
+			__SS_THROW_ONLY__;
+		}
+		lock.Wait(&client.replyReady, 100);
+	}
+
+	slot.sequence = ticket;
+	slot.op = op;
+	slot.link = static_cast<uint8_t>(link);
+	slot.requestAck = requestAck;
+	slot.incrementAddress = incrementAddress;
+	slot.block = block;
+	slot.address = address;
+	slot.wordCount = op == DCSBrokerOp_BlockRead ? wordCount : static_cast<uint16_t>(data.size());
+	slot.tmo_ms = tmo_ms;
+	std::copy(data.begin(), data.end(), slot.data);
+	slot.state = DCSBrokerSlotState_Pending;
+
+	client.head = ticket + 1;
+	nextSequence_++;
+	pthread_cond_signal(&segment_->requestPending);
+
+	TLOG(TLVL_ClientRequest) << "Submitted request " << ticket << ": op=" << static_cast<int>(op) << ", link=" << static_cast<int>(link)
+							 << ", address=0x" << std::hex << address;
+	return ticket;
+}
+
+std::vector<DTCLib::roc_data_t> DTCLib::DCSBrokerClient::Wait(uint32_t ticket)
+{
+	SegmentLock lock(segment_);
+	auto& client = segment_->clients[clientIndex_];
+	auto& slot = client.ring[ticket % DCS_BROKER_RING_SIZE];
+	if (slot.sequence != ticket || slot.state == DCSBrokerSlotState_Free)
+	{
+		__SS__ << "Unknown DCS broker ticket " << ticket << __E__;
+		__SS_THROW_ONLY__;
+	}
+
+	while (slot.state != DCSBrokerSlotState_Done)
+	{
+		if (!segment_->running || !ProcessIsAlive(segment_->brokerPid))
+		{
+			__SS__ << "DCS broker " << shmName_ << " stopped before replying to request " << ticket << __E__;
+			__SS_THROW_ONLY__;
+		}
+		lock.Wait(&client.replyReady, 100);
+	}
+
+	std::vector<roc_data_t> output(slot.data, slot.data + slot.wordCount);
+	auto status = slot.status;
+	std::string error(slot.error);
+	slot.state = DCSBrokerSlotState_Free;
+	pthread_cond_broadcast(&client.replyReady);  // Wake a Submit waiting for this slot
+
+	if (status != 0)
+	{
+		__SS__ << "DCS broker request " << ticket << " failed: " << error << __E__;
+		__SS_THROW_ONLY__;
+	}
+	return output;
+}
+
+DTCLib::roc_data_t DTCLib::DCSBrokerClient::ReadROCRegister(const DTC_Link_ID& link, const roc_address_t address, int tmo_ms)
+{
+	return Wait(Submit(DCSBrokerOp_Read, link, address, {}, 0, false, false, tmo_ms))[0];
+}
+
+bool DTCLib::DCSBrokerClient::WriteROCRegister(const DTC_Link_ID& link, const roc_address_t address, const roc_data_t data, bool requestAck,
+											   int ack_tmo_ms)
+{
+	return Wait(Submit(DCSBrokerOp_Write, link, address, {data}, 0, requestAck, false, ack_tmo_ms))[0] != 0;
+}
+
+void DTCLib::DCSBrokerClient::ReadROCBlock(std::vector<roc_data_t>& data, const DTC_Link_ID& link, const roc_address_t address,
+										   const uint16_t wordCount, bool incrementAddress, int tmo_ms)
+{
+	data = Wait(Submit(DCSBrokerOp_BlockRead, link, address, {}, wordCount, false, incrementAddress, tmo_ms));
+}
+
+bool DTCLib::DCSBrokerClient::WriteROCBlock(const DTC_Link_ID& link, const roc_address_t address, const std::vector<roc_data_t>& blockData,
+											bool requestAck, bool incrementAddress, int ack_tmo_ms)
+{
+	return Wait(Submit(DCSBrokerOp_BlockWrite, link, address, blockData, 0, requestAck, incrementAddress, ack_tmo_ms))[0] != 0;
+}
+
+DTCLib::roc_data_t DTCLib::DCSBrokerClient::ReadExtROCRegister(const DTC_Link_ID& link, const roc_address_t block, const roc_address_t address,
+															   int tmo_ms)
+{
+	return Wait(Submit(DCSBrokerOp_ReadExt, link, address, {}, 0, false, false, tmo_ms, block))[0];
+}
+
+bool DTCLib::DCSBrokerClient::WriteExtROCRegister(const DTC_Link_ID& link, const roc_address_t block, const roc_address_t address,
+												  const roc_data_t data, bool requestAck, int ack_tmo_ms)
+{
+	return Wait(Submit(DCSBrokerOp_WriteExt, link, address, {data}, 0, requestAck, false, ack_tmo_ms, block))[0] != 0;
+}
@@ -0,0 +1,286 @@
+#ifndef DCSBROKER_H
+#define DCSBROKER_H
+
+#include "DCSReplyDispatcher.h"
+#include "DTC.h"
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace DTCLib {
+
+/// <summary>
+/// Operations which can be requested from the DCS broker
+/// </summary>
+enum DCSBrokerOp : uint8_t
+{
+	DCSBrokerOp_Read = 0,
+	DCSBrokerOp_Write = 1,
+	DCSBrokerOp_BlockRead = 2,
+	DCSBrokerOp_BlockWrite = 3,
+	DCSBrokerOp_ReadExt = 4,
+	DCSBrokerOp_WriteExt = 5,
+};
+
+/// <summary>
+/// State of a request slot in a client ring
+/// </summary>
+enum DCSBrokerSlotState : uint8_t
+{
+	DCSBrokerSlotState_Free = 0,
+	DCSBrokerSlotState_Pending = 1,
+	DCSBrokerSlotState_Done = 2,
+	DCSBrokerSlotState_InFlight = 3,  ///< Sent by the broker, waiting for the reply
+};
+
+constexpr uint32_t DCS_BROKER_MAGIC = 0x44435342;  // "DCSB"
+constexpr uint32_t DCS_BROKER_VERSION = 1;
+constexpr size_t DCS_BROKER_MAX_CLIENTS = 16;
+constexpr size_t DCS_BROKER_RING_SIZE = 32;
+constexpr size_t DCS_BROKER_MAX_BLOCK_WORDS = 1024;
+constexpr size_t DCS_BROKER_ERROR_LENGTH = 256;
+constexpr size_t DCS_BROKER_MAX_IN_FLIGHT = 8;  ///< Requests the broker keeps in flight on the DCS channel
+
+/// <summary>
+/// A single DCS request and its reply, as stored in shared memory
+/// </summary>
+struct DCSBrokerRequest
+{
+	uint32_t state;              ///< DCSBrokerSlotState
+	uint32_t sequence;           ///< Ticket number of this request, assigned by the client
+	uint8_t op;                  ///< DCSBrokerOp
+	uint8_t link;                ///< DTC_Link_ID of the target ROC
+	uint8_t requestAck;          ///< Whether an acknowledgement is requested for writes
+	uint8_t incrementAddress;    ///< Whether block operations increment the address
+	uint16_t block;              ///< Firmware block for extended register access
+	uint16_t address;            ///< ROC register address
+	uint16_t wordCount;          ///< Number of valid words in data
+	int32_t tmo_ms;              ///< Timeout for the reply, in milliseconds
+	int32_t status;              ///< 0 on success, negative if an error occurred (see error)
+	char error[DCS_BROKER_ERROR_LENGTH];       ///< Error message if status is negative
+	uint16_t data[DCS_BROKER_MAX_BLOCK_WORDS];  ///< Write data, or read data on reply
+};
+
+/// <summary>
+/// Per-client request ring. Requests are served in FIFO order within a client,
+/// and clients are served in priority order (higher value first).
+/// </summary>
+struct DCSBrokerClientSlot
+{
+	pid_t pid;               ///< Owning process, 0 if slot is unused
+	int32_t priority;        ///< Client priority, higher values are served first
+	uint32_t head;           ///< Next ring index to be filled by the client
+	uint32_t tail;           ///< Next ring index to be served by the broker
+	uint64_t served;         ///< Number of requests served for this client
+	pthread_cond_t replyReady;  ///< Signalled by the broker when a request completes
+	DCSBrokerRequest ring[DCS_BROKER_RING_SIZE];
+};
+
+/// <summary>
+/// Layout of the broker shared-memory segment
+/// </summary>
+struct DCSBrokerSegment
+{
+	uint32_t magic;
+	uint32_t version;
+	pid_t brokerPid;
+	uint32_t running;
+	pthread_mutex_t mutex;         ///< Process-shared, robust mutex protecting the whole segment
+	pthread_cond_t requestPending;  ///< Signalled by clients when a request is submitted
+	DCSBrokerClientSlot clients[DCS_BROKER_MAX_CLIENTS];
+};
+
+/// <summary>
+/// Get the default shared-memory name of the DCS broker for the given DTC
+/// </summary>
+/// <param name="dtc">DTC index (/dev/mu2eX)</param>
+/// <returns>Shared-memory object name</returns>
+std::string DCSBrokerDefaultName(int dtc);
+
+/// <summary>
+/// The DCSBroker owns the DCS channel of a DTC and serves DCS requests from any number of client
+/// processes, which submit requests through a shared-memory ring (see DCSBrokerClient). Since only
+/// the broker touches the DCS channel, clients no longer contend for M_IOC_DCS_LOCK.
+/// The broker sends requests through a DCSReplyDispatcher and keeps up to DCS_BROKER_MAX_IN_FLIGHT of them in flight,
+/// completing them in the order they were sent. Block operations read the DCS channel themselves, so they are served
+/// alone, once the requests before them have completed.
+/// </summary>
+class DCSBroker
+{
+public:
+	/// <summary>
+	/// Construct a DCSBroker, creating the shared-memory segment. Throws if another live broker owns the segment;
+	/// a segment left behind by a broker which exited is replaced.
+	/// </summary>
+	/// <param name="dtc">DTC instance whose DCS channel the broker owns</param>
+	/// <param name="shmName">Name of the shared-memory segment</param>
+	DCSBroker(DTC* dtc, std::string shmName);
+	virtual ~DCSBroker();
+
+	/// <summary>
+	/// Serve requests until Stop() is called
+	/// </summary>
+	void Run();
+	/// <summary>
+	/// Stop serving requests. Run() returns within 100 ms, after finishing the requests in flight.
+	/// Safe to call from a signal handler.
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// Get the number of requests served since construction
+	/// </summary>
+	/// <returns>Number of requests served</returns>
+	uint64_t GetServedCount() const { return servedCount_; }
+
+private:
+	/// <summary>
+	/// A request taken from a client ring. The broker works on this copy; the ring slot is only written again, under
+	/// the segment lock, when the request completes.
+	/// </summary>
+	struct InFlight_
+	{
+		DCSBrokerRequest request;
+		int clientIndex;
+		pid_t clientPid;
+		std::vector<std::future<std::unique_ptr<DTC_DCSReplyPacket>>> replies;
+	};
+
+	bool ServeBatch_();
+	void Dispatch_();
+	void Send_(InFlight_& inFlight);
+	void Complete_(InFlight_& inFlight);
+	void ProcessBlock_(DCSBrokerRequest& req);
+	void ReapDeadClients_();
+
+	DTC* dtc_;
+	std::string shmName_;
+	DCSBrokerSegment* segment_;
+	std::atomic<bool> stop_;
+	std::atomic<uint64_t> servedCount_;
+	size_t roundRobin_;
+	std::unique_ptr<DCSReplyDispatcher> dispatcher_;
+	std::deque<InFlight_> inFlight_;  ///< Requests sent and not completed yet, oldest first
+};
+
+/// <summary>
+/// Client library for the DCSBroker. Requests can be submitted asynchronously and waited for
+/// later, so that a client may keep several requests in flight, or through the synchronous
+/// convenience functions, which mirror the DTC ROC register functions.
+/// </summary>
+class DCSBrokerClient
+{
+public:
+	/// <summary>
+	/// Connect to a running DCSBroker
+	/// </summary>
+	/// <param name="shmName">Name of the broker shared-memory segment</param>
+	/// <param name="priority">Priority of this client, higher values are served first</param>
+	explicit DCSBrokerClient(std::string shmName, int priority = 0);
+	virtual ~DCSBrokerClient();
+
+	/// <summary>
+	/// Submit a request to the broker. At most DCS_BROKER_RING_SIZE requests may be outstanding (submitted
+	/// but not yet collected with Wait()); blocks while the ring is full of requests the broker has not served yet.
+	/// </summary>
+	/// <param name="op">Operation to perform</param>
+	/// <param name="link">Link of the ROC</param>
+	/// <param name="address">ROC register address</param>
+	/// <param name="data">Data words to write (first word only for single writes)</param>
+	/// <param name="wordCount">Number of words to read for block reads</param>
+	/// <param name="requestAck">Whether to request acknowledgement of writes</param>
+	/// <param name="incrementAddress">Whether block operations increment the address</param>
+	/// <param name="tmo_ms">Timeout for the reply, in milliseconds</param>
+	/// <param name="block">Firmware block for extended register access</param>
+	/// <returns>Ticket to pass to Wait()</returns>
+	uint32_t Submit(DCSBrokerOp op, const DTC_Link_ID& link, roc_address_t address, const std::vector<roc_data_t>& data = {},
+					uint16_t wordCount = 0, bool requestAck = false, bool incrementAddress = true, int tmo_ms = 10,
+					roc_address_t block = 0);
+	/// <summary>
+	/// Wait for the reply to a submitted request. Throws std::runtime_error if the broker reported an error.
+	/// </summary>
+	/// <param name="ticket">Ticket returned by Submit()</param>
+	/// <returns>Data words of the reply (one word for single reads, the ack status for writes)</returns>
+	std::vector<roc_data_t> Wait(uint32_t ticket);
+
+	// Synchronous convenience functions, see the DTC functions of the same name
+	/// <summary>
+	/// Read a ROC register through the broker
+	/// </summary>
+	/// <param name="link">Link of the ROC to read</param>
+	/// <param name="address">Address of the register</param>
+	/// <param name="tmo_ms">Timeout, in milliseconds, for read</param>
+	/// <returns>Value of the ROC register</returns>
+	roc_data_t ReadROCRegister(const DTC_Link_ID& link, const roc_address_t address, int tmo_ms);
+	/// <summary>
+	/// Write a ROC register through the broker
+	/// </summary>
+	/// <param name="link">Link of the ROC to write to</param>
+	/// <param name="address">Address of the register</param>
+	/// <param name="data">Value to write</param>
+	/// <param name="requestAck">Whether to request acknowledement of this operation</param>
+	/// <param name="ack_tmo_ms">Timeout, in milliseconds, for ack</param>
+	/// <returns>Whether the write was acknowledged (true if no ack was requested)</returns>
+	bool WriteROCRegister(const DTC_Link_ID& link, const roc_address_t address, const roc_data_t data, bool requestAck, int ack_tmo_ms);
+	/// <summary>
+	/// Perform a ROC block read through the broker
+	/// </summary>
+	/// <param name="data">Output vector of words returned by the block read</param>
+	/// <param name="link">Link of the ROC to read</param>
+	/// <param name="address">Address of the block</param>
+	/// <param name="wordCount">Number of words to read</param>
+	/// <param name="incrementAddress">Whether to increment the address pointer</param>
+	/// <param name="tmo_ms">Timeout, in milliseconds, for read</param>
+	void ReadROCBlock(std::vector<roc_data_t>& data, const DTC_Link_ID& link, const roc_address_t address, const uint16_t wordCount,
+					  bool incrementAddress, int tmo_ms);
+	/// <summary>
+	/// Perform a ROC block write through the broker
+	/// </summary>
+	/// <param name="link">Link of the ROC to write</param>
+	/// <param name="address">Address of the block</param>
+	/// <param name="blockData">Words to write, at most DCS_BROKER_MAX_BLOCK_WORDS</param>
+	/// <param name="requestAck">Whether to request acknowledement of this operation</param>
+	/// <param name="incrementAddress">Whether to increment the address pointer</param>
+	/// <param name="ack_tmo_ms">Timeout, in milliseconds, for ack</param>
+	/// <returns>Whether the write was acknowledged (true if no ack was requested)</returns>
+	bool WriteROCBlock(const DTC_Link_ID& link, const roc_address_t address, const std::vector<roc_data_t>& blockData,
+					   bool requestAck, bool incrementAddress, int ack_tmo_ms);
+	/// <summary>
+	/// Read a ROC firmware block register through the broker
+	/// </summary>
+	/// <param name="link">Link of the ROC to read</param>
+	/// <param name="block">Block ID to read from</param>
+	/// <param name="address">Address of the register</param>
+	/// <param name="tmo_ms">Timeout, in milliseconds, for read</param>
+	/// <returns>Value of the ROC register</returns>
+	roc_data_t ReadExtROCRegister(const DTC_Link_ID& link, const roc_address_t block, const roc_address_t address, int tmo_ms);
+	/// <summary>
+	/// Write a ROC firmware block register through the broker
+	/// </summary>
+	/// <param name="link">Link of the ROC to write to</param>
+	/// <param name="block">Block ID to write to</param>
+	/// <param name="address">Address of the register</param>
+	/// <param name="data">Value to write</param>
+	/// <param name="requestAck">Whether to request acknowledement of this operation</param>
+	/// <param name="ack_tmo_ms">Timeout, in milliseconds, for ack</param>
+	/// <returns>Whether the writes were acknowledged (true if no ack was requested)</returns>
+	bool WriteExtROCRegister(const DTC_Link_ID& link, const roc_address_t block, const roc_address_t address, const roc_data_t data,
+							 bool requestAck, int ack_tmo_ms);
+
+private:
+	std::string shmName_;
+	DCSBrokerSegment* segment_;
+	int clientIndex_;
+	uint32_t nextSequence_;
+};
+
+}  // namespace DTCLib
+
+#endif  // DCSBROKER_H
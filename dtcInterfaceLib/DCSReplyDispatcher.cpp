@@ -0,0 +1,233 @@
+#include "DCSReplyDispatcher.h"
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "DCSReplyDispatcher"
+
+#define TLVL_RouteReply TLVL_DEBUG + 5
+#define TLVL_SendRequest TLVL_DEBUG + 6
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+DTCLib::DCSReplyDispatcher::DCSReplyDispatcher(DTC* dtc, size_t diagnosticsDepth)
+	: dtc_(dtc), diagnosticsDepth_(diagnosticsDepth), waiterCount_(0), sendersWaiting_(0), stop_(false)
+{
+	if (!dtc_->ReadDCSReception()) dtc_->EnableDCSReception();
+
+	// Start from an empty DCS ring, replies to requests sent before the dispatcher existed cannot be matched
+	dtc_->ReleaseAllBuffers(DTC_DMA_Engine_DCS);
+
+	readerThread_ = std::thread(&DCSReplyDispatcher::Run_, this);
+}
+
+DTCLib::DCSReplyDispatcher::~DCSReplyDispatcher() { Stop(); }
+
+void DTCLib::DCSReplyDispatcher::Stop()
+{
+	stop_ = true;
+	waiterAdded_.notify_all();
+	if (readerThread_.joinable()) readerThread_.join();
+}
+
+std::future<std::unique_ptr<DTCLib::DTC_DCSReplyPacket>> DTCLib::DCSReplyDispatcher::Expect(const DTC_Link_ID& link,
+																							 const DTC_DCSOperationType type,
+																							 const roc_address_t address, int tmo_ms)
+{
+	Waiter waiter;
+	waiter.type = type;
+	waiter.address = address;
+	waiter.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(tmo_ms > 0 ? tmo_ms : dtc_->GetDCSReplyDeadline());
+	auto future = waiter.promise.get_future();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (stop_)
+		{
+			waiter.promise.set_value(nullptr);
+			return future;
+		}
+		waiters_[link].push_back(std::move(waiter));
+		++waiterCount_;
+	}
+	waiterAdded_.notify_one();
+	return future;
+}
+
+std::future<std::unique_ptr<DTCLib::DTC_DCSReplyPacket>> DTCLib::DCSReplyDispatcher::Send(const DTC_Link_ID& link,
+																						   const DTC_DCSOperationType type,
+																						   const roc_address_t address, const roc_data_t data,
+																						   bool requestAck, int tmo_ms)
+{
+	// The ROC only replies to reads and to operations which request an ack
+	auto expectReply = requestAck || type == DTC_DCSOperationType_Read || type == DTC_DCSOperationType_DoubleRead ||
+					   type == DTC_DCSOperationType_BlockRead;
+
+	std::future<std::unique_ptr<DTC_DCSReplyPacket>> future;
+	if (expectReply)
+	{
+		// Register before sending, so that the reply cannot arrive before anyone is waiting for it
+		future = Expect(link, type, address, tmo_ms);
+	}
+	else
+	{
+		std::promise<std::unique_ptr<DTC_DCSReplyPacket>> noReply;
+		noReply.set_value(nullptr);
+		future = noReply.get_future();
+	}
+
+	DTC_DCSRequestPacket req(link, type, requestAck, true /*incrementAddress*/, address, data);
+	TLOG(TLVL_SendRequest) << "Sending DCS request to link " << static_cast<int>(link) << ", type " << static_cast<int>(type)
+						   << ", address 0x" << std::hex << address;
+
+	// The reader thread steps aside while a send is waiting for the DCS lock
+	++sendersWaiting_;
+	try
+	{
+		dtc_->WriteDMAPacket(req);
+	}
+	catch (...)
+	{
+		--sendersWaiting_;
+		throw;  // A registered waiter expires at its deadline
+	}
+	--sendersWaiting_;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	++stats_.requestsSent;
+	return future;
+}
+
+DTCLib::roc_data_t DTCLib::DCSReplyDispatcher::ReadROCRegister(const DTC_Link_ID& link, const roc_address_t address, int tmo_ms)
+{
+	auto reply = Send(link, DTC_DCSOperationType_Read, address, 0, false, tmo_ms).get();
+	if (reply == nullptr)
+	{
+		__SS__ << "A timeout occurred attempting to read a ROC register at link " << static_cast<int>(link) << " address 0x" << std::hex
+			   << static_cast<int>(address) << " through the DCS reply dispatcher." << __E__;
+		__SS_THROW__;
+	}
+	return reply->GetReply(false).second;
+}
+
+bool DTCLib::DCSReplyDispatcher::WriteROCRegister(const DTC_Link_ID& link, const roc_address_t address, const roc_data_t data,
+												  bool requestAck, int ack_tmo_ms)
+{
+	auto reply = Send(link, DTC_DCSOperationType_Write, address, data, requestAck, ack_tmo_ms).get();
+	return !requestAck || reply != nullptr;
+}
+
+void DTCLib::DCSReplyDispatcher::RunExclusive(const std::function<void()>& access)
+{
+	++sendersWaiting_;  // Take the channel at the reader's next turn
+	std::lock_guard<std::mutex> lock(channelMutex_);
+	--sendersWaiting_;
+	access();
+}
+
+std::deque<std::unique_ptr<DTCLib::DTC_DCSReplyPacket>> DTCLib::DCSReplyDispatcher::TakeDiagnostics()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	std::deque<std::unique_ptr<DTC_DCSReplyPacket>> output;
+	output.swap(diagnostics_);
+	return output;
+}
+
+DTCLib::DCSReplyDispatcherStats DTCLib::DCSReplyDispatcher::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+void DTCLib::DCSReplyDispatcher::Run_()
+{
+	auto device = dtc_->GetDevice();
+	while (!stop_)
+	{
+		{
+			// Only poll the channel continuously while requests are waiting, otherwise look for unsolicited replies every 10 ms
+			std::unique_lock<std::mutex> lock(mutex_);
+			waiterAdded_.wait_for(lock, std::chrono::milliseconds(10), [&]() { return waiterCount_ > 0 || stop_; });
+		}
+		if (stop_) break;
+
+		// Give waiting sends the DCS lock first (bounded, so that a stream of sends cannot stall replies)
+		for (auto ii = 0; ii < 100 && sendersWaiting_ > 0; ++ii) std::this_thread::sleep_for(std::chrono::microseconds(10));
+
+		std::unique_ptr<DTC_DCSReplyPacket> reply;
+		std::unique_lock<std::mutex> channelLock(channelMutex_);
+		try
+		{
+			device->begin_dcs_transaction();
+			reply = dtc_->ReadNextDCSPacket(1);
+			device->end_dcs_transaction();
+		}
+		catch (std::exception const& ex)
+		{
+			device->end_dcs_transaction();
+			TLOG(TLVL_WARN) << "Error reading the DCS channel: " << ex.what();
+			std::lock_guard<std::mutex> lock(mutex_);
+			++stats_.readErrors;
+		}
+		channelLock.unlock();
+
+		if (reply != nullptr)
+			Route_(std::move(reply));
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(50));  // Nothing pending, do not hog the DCS lock
+
+		ExpireWaiters_(false);
+	}
+	ExpireWaiters_(true);
+}
+
+void DTCLib::DCSReplyDispatcher::Route_(std::unique_ptr<DTC_DCSReplyPacket> reply)
+{
+	auto link = reply->GetLinkID();
+	auto type = reply->GetType();
+	auto address = reply->GetReply(false).first;
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto linkWaiters = waiters_.find(link);
+	if (linkWaiters != waiters_.end())
+	{
+		// The ROC answers in order, so the oldest request with the same operation and address is the one being answered
+		for (auto waiter = linkWaiters->second.begin(); waiter != linkWaiters->second.end(); ++waiter)
+		{
+			if (waiter->type != type || waiter->address != address) continue;
+
+			TLOG(TLVL_RouteReply) << "Routing DCS reply from link " << static_cast<int>(link) << ", address 0x" << std::hex << address;
+			waiter->promise.set_value(std::move(reply));
+			linkWaiters->second.erase(waiter);
+			--waiterCount_;
+			++stats_.repliesRouted;
+			return;
+		}
+	}
+
+	TLOG(TLVL_RouteReply) << "Unmatched DCS reply from link " << static_cast<int>(link) << ", type " << static_cast<int>(type)
+						  << ", address 0x" << std::hex << address << ", moving it to the diagnostics queue";
+	++stats_.unmatched;
+	diagnostics_.push_back(std::move(reply));
+	while (diagnostics_.size() > diagnosticsDepth_) diagnostics_.pop_front();
+}
+
+void DTCLib::DCSReplyDispatcher::ExpireWaiters_(bool all)
+{
+	auto now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (auto& linkWaiters : waiters_)
+	{
+		auto& queue = linkWaiters.second;
+		for (auto waiter = queue.begin(); waiter != queue.end();)
+		{
+			if (!all && waiter->deadline > now)
+			{
+				++waiter;
+				continue;
+			}
+			waiter->promise.set_value(nullptr);
+			waiter = queue.erase(waiter);
+			--waiterCount_;
+			++stats_.expired;
+		}
+	}
+}
@@ -0,0 +1,149 @@
+#ifndef DCSREPLYDISPATCHER_H
+#define DCSREPLYDISPATCHER_H
+
+#include "DTC.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace DTCLib {
+
+/// <summary>
+/// Counters kept by the DCSReplyDispatcher
+/// </summary>
+struct DCSReplyDispatcherStats
+{
+	uint64_t requestsSent = 0;   ///< Requests sent through Send()
+	uint64_t repliesRouted = 0;  ///< Replies handed to a waiting request
+	uint64_t unmatched = 0;      ///< Unsolicited or stale replies, put on the diagnostics queue
+	uint64_t expired = 0;        ///< Requests whose deadline passed without a reply
+	uint64_t readErrors = 0;     ///< Errors reading the DCS channel (e.g. DTC timeout or error replies)
+};
+
+/// <summary>
+/// The DCSReplyDispatcher is the single reader of the DCS channel of a DTC. A background thread reads each
+/// DTC_DCSReplyPacket once and routes it to the request waiting for it, identified by link, operation and
+/// address. Requests to the same link are matched in the order they were sent.
+/// Replies which no request is waiting for (unsolicited, or stale because the request already expired) go
+/// to a bounded diagnostics queue.
+///
+/// The DCS lock is held only for the duration of each DMA read or write, not across a request/reply pair,
+/// so any number of threads may have requests in flight at the same time. While a dispatcher is running,
+/// all DCS traffic of the DTC must go through it, since the DTC ROC register functions read the DCS channel themselves.
+/// </summary>
+class DCSReplyDispatcher
+{
+public:
+	/// <summary>
+	/// Construct a DCSReplyDispatcher and start its reader thread
+	/// </summary>
+	/// <param name="dtc">DTC instance whose DCS channel the dispatcher reads</param>
+	/// <param name="diagnosticsDepth">Maximum number of unmatched replies kept (oldest are dropped first)</param>
+	explicit DCSReplyDispatcher(DTC* dtc, size_t diagnosticsDepth = 256);
+	virtual ~DCSReplyDispatcher();
+
+	/// <summary>
+	/// Send a DCS request and return a future for its reply. The future holds nullptr if no reply arrives
+	/// before the deadline.
+	/// </summary>
+	/// <param name="link">Link of the ROC</param>
+	/// <param name="type">Operation to perform</param>
+	/// <param name="address">Target address</param>
+	/// <param name="data">Data to write, or word count for block reads</param>
+	/// <param name="requestAck">Whether to request acknowledgement of a write (writes without ack have no reply)</param>
+	/// <param name="tmo_ms">Deadline for the reply, in milliseconds. If <= 0, the DTC DCS reply deadline is used</param>
+	/// <returns>Future for the reply packet</returns>
+	std::future<std::unique_ptr<DTC_DCSReplyPacket>> Send(const DTC_Link_ID& link, const DTC_DCSOperationType type,
+														  const roc_address_t address, const roc_data_t data = 0,
+														  bool requestAck = false, int tmo_ms = 0);
+	/// <summary>
+	/// Register interest in a reply to a request which is sent by the caller. Must be called before the request is sent.
+	/// </summary>
+	/// <param name="link">Link of the ROC</param>
+	/// <param name="type">Operation of the request</param>
+	/// <param name="address">Target address of the request</param>
+	/// <param name="tmo_ms">Deadline for the reply, in milliseconds. If <= 0, the DTC DCS reply deadline is used</param>
+	/// <returns>Future for the reply packet</returns>
+	std::future<std::unique_ptr<DTC_DCSReplyPacket>> Expect(const DTC_Link_ID& link, const DTC_DCSOperationType type,
+															const roc_address_t address, int tmo_ms = 0);
+
+	/// <summary>
+	/// Read a ROC register through the dispatcher. Throws std::runtime_error on timeout.
+	/// </summary>
+	/// <param name="link">Link of the ROC to read</param>
+	/// <param name="address">Address of the register</param>
+	/// <param name="tmo_ms">Timeout, in milliseconds, for read</param>
+	/// <returns>Value of the ROC register</returns>
+	roc_data_t ReadROCRegister(const DTC_Link_ID& link, const roc_address_t address, int tmo_ms);
+	/// <summary>
+	/// Write a ROC register through the dispatcher
+	/// </summary>
+	/// <param name="link">Link of the ROC to write to</param>
+	/// <param name="address">Address of the register</param>
+	/// <param name="data">Value to write</param>
+	/// <param name="requestAck">Whether to request acknowledement of this operation</param>
+	/// <param name="ack_tmo_ms">Timeout, in milliseconds, for ack</param>
+	/// <returns>Whether the write was acknowledged (true if no ack was requested)</returns>
+	bool WriteROCRegister(const DTC_Link_ID& link, const roc_address_t address, const roc_data_t data, bool requestAck, int ack_tmo_ms);
+
+	/// <summary>
+	/// Run a DCS access which reads the DCS channel itself (e.g. the DTC ROC block functions) while the reader thread
+	/// stays off the channel. Replies to requests still in flight may be consumed by the access, so wait for them first.
+	/// </summary>
+	/// <param name="access">DCS access to run</param>
+	void RunExclusive(const std::function<void()>& access);
+
+	/// <summary>
+	/// Take all replies from the diagnostics queue
+	/// </summary>
+	/// <returns>Unsolicited and stale replies, oldest first</returns>
+	std::deque<std::unique_ptr<DTC_DCSReplyPacket>> TakeDiagnostics();
+	/// <summary>
+	/// Get the dispatcher counters
+	/// </summary>
+	/// <returns>Copy of the counters</returns>
+	DCSReplyDispatcherStats GetStats() const;
+
+	/// <summary>
+	/// Stop the reader thread. Requests still waiting for a reply complete with nullptr.
+	/// </summary>
+	void Stop();
+
+private:
+	struct Waiter
+	{
+		DTC_DCSOperationType type;
+		roc_address_t address;
+		std::chrono::steady_clock::time_point deadline;
+		std::promise<std::unique_ptr<DTC_DCSReplyPacket>> promise;
+	};
+
+	void Run_();
+	void Route_(std::unique_ptr<DTC_DCSReplyPacket> reply);
+	void ExpireWaiters_(bool all);
+
+	DTC* dtc_;
+	size_t diagnosticsDepth_;
+
+	mutable std::mutex mutex_;  ///< Guards waiters_, diagnostics_ and stats_
+	std::mutex channelMutex_;   ///< Held by the reader thread while it reads the DCS channel, and by RunExclusive
+	std::condition_variable waiterAdded_;
+	std::map<DTC_Link_ID, std::deque<Waiter>> waiters_;
+	size_t waiterCount_;
+	std::atomic<int> sendersWaiting_;
+	std::deque<std::unique_ptr<DTC_DCSReplyPacket>> diagnostics_;
+	DCSReplyDispatcherStats stats_;
+
+	std::atomic<bool> stop_;
+	std::thread readerThread_;
+};
+
+}  // namespace DTCLib
+
+#endif  // DCSREPLYDISPATCHER_H
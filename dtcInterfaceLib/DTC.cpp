@@ -28,7 +28,9 @@
 #define __COUT_HDR__ "DTC " << device_.getDeviceUID() << ": "
 
 #include <unistd.h>
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>  // Convert uint to hex string
 
@@ -36,6 +38,9 @@ DTCLib::DTC::DTC(DTC_SimMode mode, int dtc, unsigned rocMask, std::string expect
 	: DTC_Registers(mode, dtc, simMemoryFile, rocMask, expectedDesignVersion, skipInit, uid), daqDMAInfo_(), dcsDMAInfo_()
 {
 	__COUT_INFO__ << "CONSTRUCTOR";
+
+	auto deadlineE = getenv("DTCLIB_DCS_REPLY_DEADLINE_MS");
+	if (deadlineE != nullptr) SetDCSReplyDeadline(atoi(deadlineE));
 }
 
 DTCLib::DTC::~DTC()
@@ -66,6 +71,7 @@ DTCLib::DTC::~DTC()
 //
 std::vector<std::unique_ptr<DTCLib::DTC_Event>> DTCLib::DTC::GetData(DTC_EventWindowTag when, bool matchEventWindowTag)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	DTC_TLOG(TLVL_GetData) << "GetData begin EventWindowTag=" << when.GetEventWindowTag(true) << ", matching=" << (matchEventWindowTag ? "true" : "false");
 	std::vector<std::unique_ptr<DTC_Event>> output;
 	std::unique_ptr<DTC_Event> packet = nullptr;
@@ -165,6 +171,7 @@ std::vector<std::unique_ptr<DTCLib::DTC_Event>> DTCLib::DTC::GetData(DTC_EventWi
 //	Similart to GetData() but retrieves a SubEvent, as opposed to an Event -- This is appropriate for SW Event building or more basic tests.
 std::vector<std::unique_ptr<DTCLib::DTC_SubEvent>> DTCLib::DTC::GetSubEventData(DTC_EventWindowTag when, bool matchEventWindowTag)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	DTC_TLOG(TLVL_GetData) << "GetSubEventData begin EventWindowTag=" << when.GetEventWindowTag(true) << ", matching=" << (matchEventWindowTag ? "true" : "false");
 	std::vector<std::unique_ptr<DTC_SubEvent>> output;
 	std::unique_ptr<DTC_SubEvent> packet = nullptr;
@@ -245,6 +252,7 @@ std::vector<std::unique_ptr<DTCLib::DTC_SubEvent>> DTCLib::DTC::GetSubEventData(
 void DTCLib::DTC::WriteSimFileToDTC(std::string file, bool /*goForever*/, bool overwriteEnvironment,
 									std::string outputFileName, bool skipVerify)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	bool success = false;
 	int retryCount = 0;
 	while (!success && retryCount < 5)
@@ -362,6 +370,7 @@ void DTCLib::DTC::WriteSimFileToDTC(std::string file, bool /*goForever*/, bool o
 
 bool DTCLib::DTC::VerifySimFileInDTC(std::string file, std::string rawOutputFilename)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	uint64_t totalSize = 0;
 	auto n = 0;
 	auto sizeCheck = true;
@@ -526,12 +535,13 @@ uint16_t DTCLib::DTC::ReadROCRegister(const DTC_Link_ID& link, const uint16_t ad
 		SendDCSRequestPacket(link, DTC_DCSOperationType_Read, address,
 							 0x0 /*data*/, 0x0 /*address2*/, 0x0 /*data2*/,
 							 false /*quiet*/);
+		auto requestTime = std::chrono::steady_clock::now();
 
 		uint16_t data = 0xFFFF;
 
 		try
 		{
-			auto reply = ReadNextDCSPacket(tmo_ms);
+			auto reply = WaitForDCSReply(link, requestTime, tmo_ms);
 			device_.end_dcs_transaction();
 
 			if (reply != nullptr)  // have data!
@@ -590,12 +600,13 @@ bool DTCLib::DTC::WriteROCRegister(const DTC_Link_ID& link, const uint16_t addre
 	SendDCSRequestPacket(link, DTC_DCSOperationType_Write, address, data,
 						 0x0 /*address2*/, 0x0 /*data2*/,
 						 false /*quiet*/, requestAck);
+	auto requestTime = std::chrono::steady_clock::now();
 
 	bool ackReceived = false;
 	if (requestAck)
 	{
 		DTC_TLOG(TLVL_TRACE) << "WriteROCRegister: Checking for ack";
-		auto reply = ReadNextDCSPacket(ack_tmo_ms);
+		auto reply = WaitForDCSReply(link, requestTime, ack_tmo_ms);
 		while (reply != nullptr)
 		{
 			auto reply1tmp = reply->GetReply(false);
@@ -630,11 +641,11 @@ std::pair<uint16_t, uint16_t> DTCLib::DTC::ReadROCRegisters(const DTC_Link_ID& l
 	device_.begin_dcs_transaction();
 	ReleaseAllBuffers(DTC_DMA_Engine_DCS);
 	SendDCSRequestPacket(link, DTC_DCSOperationType_Read, address1, 0, address2);
-	usleep(2500);
+	auto requestTime = std::chrono::steady_clock::now();
 	uint16_t data1 = 0xFFFF;
 	uint16_t data2 = 0xFFFF;
 
-	auto reply = ReadNextDCSPacket(tmo_ms);
+	auto reply = WaitForDCSReply(link, requestTime, tmo_ms);
 
 	while (reply != nullptr)
 	{
@@ -680,12 +691,13 @@ bool DTCLib::DTC::WriteROCRegisters(const DTC_Link_ID& link, const uint16_t addr
 		ReleaseAllBuffers(DTC_DMA_Engine_DCS);
 	}
 	SendDCSRequestPacket(link, DTC_DCSOperationType_Write, address1, data1, address2, data2, false /*quiet*/, requestAck);
+	auto requestTime = std::chrono::steady_clock::now();
 
 	bool ackReceived = false;
 	if (requestAck)
 	{
 		DTC_TLOG(TLVL_TRACE) << "WriteROCRegisters: Checking for ack";
-		auto reply = ReadNextDCSPacket(ack_tmo_ms);
+		auto reply = WaitForDCSReply(link, requestTime, ack_tmo_ms);
 		while (reply != nullptr)
 		{
 			auto reply1tmp = reply->GetReply(false);
@@ -732,11 +744,10 @@ void DTCLib::DTC::ReadROCBlock(
 	device_.begin_dcs_transaction();
 	ReleaseAllBuffers(DTC_DMA_Engine_DCS);
 	WriteDMAPacket(req);
+	auto requestTime = std::chrono::steady_clock::now();
 	DTC_TLOG(TLVL_SendDCSRequestPacket) << "ReadROCBlock after  WriteDMADCSPacket - DTC_DCSRequestPacket";
 
-	usleep(2500);
-
-	auto reply = ReadNextDCSPacket(tmo_ms);
+	auto reply = WaitForDCSReply(link, requestTime, tmo_ms);
 	while (reply != nullptr)
 	{
 		auto replytmp = reply->GetReply(false);
@@ -803,13 +814,14 @@ bool DTCLib::DTC::WriteROCBlock(const DTC_Link_ID& link, const uint16_t address,
 		ReleaseAllBuffers(DTC_DMA_Engine_DCS);
 	}
 	WriteDMAPacket(req);
+	auto requestTime = std::chrono::steady_clock::now();
 	DTC_TLOG(TLVL_SendDCSRequestPacket) << "WriteROCBlock after  WriteDMADCSPacket - DTC_DCSRequestPacket";
 
 	bool ackReceived = false;
 	if (requestAck)
 	{
 		DTC_TLOG(TLVL_TRACE) << "WriteROCBlock: Checking for ack";
-		auto reply = ReadNextDCSPacket(ack_tmo_ms);
+		auto reply = WaitForDCSReply(link, requestTime, ack_tmo_ms);
 		while (reply != nullptr)
 		{
 			auto reply1tmp = reply->GetReply(false);
@@ -836,6 +848,176 @@ bool DTCLib::DTC::WriteROCBlock(const DTC_Link_ID& link, const uint16_t address,
 	return !requestAck || ackReceived;
 }
 
+DTCLib::DTC_BlockUploadResult DTCLib::DTC::UploadROCBlock(const DTC_Link_ID& link, const uint16_t address,
+														  const std::vector<uint16_t>& data, const DTC_BlockUploadOptions& options)
+{
+	DTC_BlockUploadResult result;
+	result.verify = options.verify;
+	if (data.empty()) return result;
+
+	if (options.maxPacketWords == 0 || options.maxPacketWords > DTC_MAX_DCS_BLOCK_WORDS)
+	{
+		__SS__ << "UploadROCBlock: Invalid packet size of " << options.maxPacketWords << " words, must be between 1 and "
+			   << DTC_MAX_DCS_BLOCK_WORDS << __E__;
+		__SS_THROW__;
+	}
+	if (options.incrementAddress && address + data.size() > 0x10000)
+	{
+		__SS__ << "UploadROCBlock: Block of " << data.size() << " words at address 0x" << std::hex << address
+			   << " exceeds the ROC address space" << __E__;
+		__SS_THROW__;
+	}
+	if (!options.incrementAddress && options.verify != DTC_BlockUploadVerify_None)
+	{
+		__SS__ << "UploadROCBlock: Cannot verify a block written without incrementing the address" << __E__;
+		__SS_THROW__;
+	}
+
+	// Every ack occupies a DCS DMA buffer until the window is drained, stay well below the driver ring size
+	auto window = std::min(options.window, static_cast<size_t>(32));
+	auto requestAck = window > 0;
+	auto tmo_ms = options.ack_tmo_ms > 0 ? options.ack_tmo_ms : dcsReplyDeadline_ms_;
+
+	DTC_TLOG(TLVL_SendDCSRequestPacket) << "UploadROCBlock: Uploading " << data.size() << " words to link " << static_cast<int>(link)
+										<< ", address " << static_cast<int>(address) << ", packet size " << options.maxPacketWords
+										<< " words, window " << window;
+
+	// Address and send time of the block writes which have not been acknowledged yet
+	std::vector<std::pair<uint16_t, std::chrono::steady_clock::time_point>> inFlight;
+	auto collectAcks = [&]() {
+		for (auto& pending : inFlight)
+		{
+			auto reply = WaitForDCSReply(link, pending.second, tmo_ms);
+			// Skip late acks of earlier block writes and stale replies from other links
+			while (reply != nullptr &&
+				   (reply->GetLinkID() != link || reply->GetReply(false).first != pending.first || !reply->IsAckRequested()))
+			{
+				DTC_TLOG(TLVL_TRACE) << "UploadROCBlock: Skipping unexpected reply from link " << static_cast<int>(reply->GetLinkID())
+									 << ", address " << static_cast<int>(reply->GetReply(false).first) << " (expected "
+									 << static_cast<int>(pending.first) << ")";
+				reply = ReadNextDCSPacket(tmo_ms);
+			}
+			if (reply == nullptr)
+			{
+				DTC_TLOG(TLVL_WARN) << "UploadROCBlock: No ack for block write to address " << static_cast<int>(pending.first)
+									<< " on link " << static_cast<int>(link);
+				++result.ackTimeouts;
+			}
+			else
+			{
+				++result.ackedPackets;
+			}
+		}
+		inFlight.clear();
+
+		// Nothing is in flight any more, so all DCS buffers can be handed back to the driver
+		dcsDMAInfo_.currentReadPtr = nullptr;
+		ReleaseAllBuffers(DTC_DMA_Engine_DCS);
+	};
+
+	if (!ReadDCSReception()) EnableDCSReception();
+
+	auto start = std::chrono::steady_clock::now();
+	device_.begin_dcs_transaction();
+	try
+	{
+		if (requestAck)
+		{
+			dcsDMAInfo_.currentReadPtr = nullptr;
+			ReleaseAllBuffers(DTC_DMA_Engine_DCS);
+		}
+
+		for (size_t offset = 0; offset < data.size(); offset += options.maxPacketWords)
+		{
+			auto end = std::min(offset + options.maxPacketWords, data.size());
+			auto packetAddress = static_cast<uint16_t>(options.incrementAddress ? address + offset : address);
+
+			DTC_DCSRequestPacket req(link, DTC_DCSOperationType_BlockWrite, requestAck, options.incrementAddress, packetAddress);
+			req.SetBlockWriteData(std::vector<uint16_t>(data.begin() + offset, data.begin() + end));
+			WriteDMAPacket(req);
+			++result.packets;
+			result.words += end - offset;
+
+			if (requestAck)
+			{
+				inFlight.emplace_back(packetAddress, std::chrono::steady_clock::now());
+				if (inFlight.size() >= window) collectAcks();
+			}
+		}
+		if (requestAck) collectAcks();
+	}
+	catch (...)
+	{
+		device_.end_dcs_transaction();
+		throw;
+	}
+	device_.end_dcs_transaction();
+	auto uploadEnd = std::chrono::steady_clock::now();
+	result.uploadSeconds = std::chrono::duration<double>(uploadEnd - start).count();
+
+	if (options.verify != DTC_BlockUploadVerify_None)
+	{
+		uint32_t readBackCRC = 0;
+		for (size_t offset = 0; offset < data.size(); offset += options.maxPacketWords)
+		{
+			auto wordCount = std::min(options.maxPacketWords, data.size() - offset);
+			std::vector<uint16_t> readBack;
+			ReadROCBlock(readBack, link, static_cast<uint16_t>(address + offset), static_cast<uint16_t>(wordCount), true, tmo_ms);
+
+			if (options.verify == DTC_BlockUploadVerify_Checksum)
+			{
+				if (readBack.size() > wordCount) readBack.resize(wordCount);
+				readBackCRC = ROCBlockCRC32(readBack, readBackCRC);
+				continue;
+			}
+
+			for (size_t ii = 0; ii < wordCount; ++ii)
+			{
+				if (ii >= readBack.size() || readBack[ii] != data[offset + ii])
+				{
+					if (result.mismatches == 0) result.firstMismatch = offset + ii;
+					++result.mismatches;
+				}
+			}
+		}
+
+		if (options.verify == DTC_BlockUploadVerify_Checksum)
+		{
+			result.checksum = ROCBlockCRC32(data);
+			result.readBackChecksum = readBackCRC;
+			result.verified = result.checksum == result.readBackChecksum;
+		}
+		else
+		{
+			result.verified = result.mismatches == 0;
+		}
+		result.verifySeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - uploadEnd).count();
+	}
+
+	DTC_TLOG(TLVL_DEBUG) << "UploadROCBlock: Uploaded " << result.words << " words in " << result.packets << " packets to link "
+						 << static_cast<int>(link) << " in " << result.uploadSeconds << " s (" << result.ThroughputMBps()
+						 << " MB/s), " << result.ackTimeouts << " missing acks"
+						 << (options.verify != DTC_BlockUploadVerify_None ? (result.verified ? ", verified" : ", VERIFICATION FAILED") : "");
+	return result;
+}
+
+uint32_t DTCLib::DTC::ROCBlockCRC32(const std::vector<uint16_t>& data, uint32_t crc)
+{
+	crc = ~crc;
+	for (auto word : data)
+	{
+		for (auto shift : {0, 8})
+		{
+			crc ^= (word >> shift) & 0xFF;
+			for (auto bit = 0; bit < 8; ++bit)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+			}
+		}
+	}
+	return ~crc;
+}
+
 uint16_t DTCLib::DTC::ReadExtROCRegister(const DTC_Link_ID& link, const uint16_t block,
 										 const uint16_t address, int tmo_ms)
 {
@@ -916,6 +1098,7 @@ void DTCLib::DTC::SendDCSRequestPacket(const DTC_Link_ID& link, const DTC_DCSOpe
 
 std::unique_ptr<DTCLib::DTC_Event> DTCLib::DTC::ReadNextDAQDMA(int tmo_ms)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	DTC_TLOG(TLVL_ReadNextDAQPacket) << "ReadNextDAQDMA BEGIN";
 
 	if (daqDMAInfo_.currentReadPtr != nullptr)
@@ -1053,6 +1236,7 @@ std::unique_ptr<DTCLib::DTC_Event> DTCLib::DTC::ReadNextDAQDMA(int tmo_ms)
 
 std::unique_ptr<DTCLib::DTC_SubEvent> DTCLib::DTC::ReadNextDAQSubEventDMA(int tmo_ms)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	TRACE_EXIT
 	{
 		DTC_TLOG(TLVL_ReadNextDAQPacket) << "ReadNextDAQSubEventDMA EXIT"
@@ -1290,7 +1474,7 @@ std::unique_ptr<DTCLib::DTC_DCSReplyPacket> DTCLib::DTC::ReadNextDCSPacket(int t
 		auto test = ReadNextPacket(DTC_DMA_Engine_DCS, tmo_ms);
 		if (test == nullptr) return nullptr;  // Couldn't read new block
 
-		__COUT__ << "If interpreting as a DTC_DataPacket, here is the data: " << test->toJSON();
+		DTC_TLOG(TLVL_ReadNextDCSPacket) << "If interpreting as a DTC_DataPacket, here is the data: " << test->toJSON();
 
 		auto output = std::make_unique<DTC_DCSReplyPacket>(*test.get());
 		if (output->ROCIsCorrupt())
@@ -1351,6 +1535,103 @@ std::unique_ptr<DTCLib::DTC_DCSReplyPacket> DTCLib::DTC::ReadNextDCSPacket(int t
 	}
 }
 
+std::unique_ptr<DTCLib::DTC_DCSReplyPacket> DTCLib::DTC::WaitForDCSReply(const DTC_Link_ID& link,
+																		 std::chrono::steady_clock::time_point requestTime, int tmo_ms)
+{
+	auto deadline = requestTime + std::chrono::milliseconds(tmo_ms > 0 ? tmo_ms : dcsReplyDeadline_ms_);
+
+	std::unique_ptr<DTC_DCSReplyPacket> reply;
+	auto now = std::chrono::steady_clock::now();
+	do
+	{
+		// Round up so that the driver wait does not end before the deadline
+		auto remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now + std::chrono::microseconds(999)).count();
+		reply = ReadNextDCSPacket(remaining_ms > 1 ? static_cast<int>(remaining_ms) : 1);
+		now = std::chrono::steady_clock::now();
+	} while (reply == nullptr && now < deadline);
+
+	auto latencyUs = std::chrono::duration<double, std::micro>(now - requestTime).count();
+
+	std::lock_guard<std::mutex> lock(dcsReplyLatencyMutex_);
+	auto& latency = dcsReplyLatency_[link];
+	if (reply == nullptr)
+	{
+		++latency.timeoutCount;
+		DTC_TLOG(TLVL_ReadNextDCSPacket) << "WaitForDCSReply: No reply from link " << static_cast<int>(link) << " after " << latencyUs
+										 << " us (expected " << latency.expectedLatencyUs << " us)";
+		return nullptr;
+	}
+	if (reply->GetLinkID() != link) return reply;  // Stale reply, do not count it against this link
+
+	if (latency.replyCount > 8 && latencyUs > 4 * latency.expectedLatencyUs)
+	{
+		DTC_TLOG(TLVL_ReadNextDCSPacket) << "WaitForDCSReply: Slow reply from link " << static_cast<int>(link) << ": " << latencyUs
+										 << " us, expected " << latency.expectedLatencyUs << " us";
+	}
+	latency.AddReply(latencyUs);
+	return reply;
+}
+
+void DTCLib::DTC_DCSReplyLatency::AddReply(double latencyUs)
+{
+	size_t bin = 0;
+	while (bin < kHistogramBins - 1 && latencyUs >= BinLowEdgeUs(bin + 1)) ++bin;
+	++histogram[bin];
+
+	if (replyCount == 0 || latencyUs < minLatencyUs) minLatencyUs = latencyUs;
+	if (latencyUs > maxLatencyUs) maxLatencyUs = latencyUs;
+	totalLatencyUs += latencyUs;
+
+	// Moving average with weight 1/8 (as for TCP round-trip estimation), seeded by the first reply
+	expectedLatencyUs = replyCount == 0 ? latencyUs : expectedLatencyUs + (latencyUs - expectedLatencyUs) / 8.0;
+	++replyCount;
+}
+
+double DTCLib::DTC::GetExpectedDCSReplyLatency(const DTC_Link_ID& link) const
+{
+	std::lock_guard<std::mutex> lock(dcsReplyLatencyMutex_);
+	auto it = dcsReplyLatency_.find(link);
+	return it != dcsReplyLatency_.end() ? it->second.expectedLatencyUs : 0;
+}
+
+DTCLib::DTC_DCSReplyLatency DTCLib::DTC::GetDCSReplyLatency(const DTC_Link_ID& link) const
+{
+	std::lock_guard<std::mutex> lock(dcsReplyLatencyMutex_);
+	auto it = dcsReplyLatency_.find(link);
+	return it != dcsReplyLatency_.end() ? it->second : DTC_DCSReplyLatency();
+}
+
+void DTCLib::DTC::ResetDCSReplyLatency()
+{
+	std::lock_guard<std::mutex> lock(dcsReplyLatencyMutex_);
+	dcsReplyLatency_.clear();
+}
+
+std::string DTCLib::DTC::FormatDCSReplyLatency() const
+{
+	std::lock_guard<std::mutex> lock(dcsReplyLatencyMutex_);
+	std::ostringstream o;
+	for (auto& linkLatency : dcsReplyLatency_)
+	{
+		auto& latency = linkLatency.second;
+		o << "Link " << static_cast<int>(linkLatency.first) << ": " << latency.replyCount << " replies, "
+		  << latency.timeoutCount << " timeouts";
+		if (latency.replyCount > 0)
+		{
+			o << ", min " << latency.minLatencyUs << " us, mean " << latency.totalLatencyUs / latency.replyCount
+			  << " us, max " << latency.maxLatencyUs << " us, expected " << latency.expectedLatencyUs << " us";
+		}
+		o << std::endl;
+		for (size_t bin = 0; bin < DTC_DCSReplyLatency::kHistogramBins; ++bin)
+		{
+			if (latency.histogram[bin] == 0) continue;
+			o << "\t>= " << std::setw(8) << DTC_DCSReplyLatency::BinLowEdgeUs(bin) << " us: " << latency.histogram[bin]
+			  << std::endl;
+		}
+	}
+	return o.str();
+}
+
 std::unique_ptr<DTCLib::DTC_DataPacket> DTCLib::DTC::ReadNextPacket(const DTC_DMA_Engine& engine, int tmo_ms)
 {
 	DTC_TLOG(TLVL_ReadNextDAQPacket) << "ReadNextPacket BEGIN";
@@ -1378,6 +1659,14 @@ std::unique_ptr<DTCLib::DTC_DataPacket> DTCLib::DTC::ReadNextPacket(const DTC_DM
 
 	auto index = CFOandDTC_DMAs::GetCurrentBuffer(info);
 
+	// GetCurrentBuffer returns the number of held buffers: keep reading from the last one while it has unread packets
+	if (index > 0)
+	{
+		index = info->buffer.size() - 1;
+		auto bufferEnd = info->buffer[index][0] + CFOandDTC_DMAs::GetBufferByteCount(info, index) + 8;  // +8 because first 8 bytes are not included in byte count
+		if (info->currentReadPtr == nullptr || reinterpret_cast<uint8_t*>(info->currentReadPtr) >= bufferEnd) index = -2;
+	}
+
 	// Need new buffer if GetCurrentBuffer returns -1 (no buffers) or -2 (done with all held buffers)
 	if (index < 0)
 	{
@@ -1386,7 +1675,16 @@ std::unique_ptr<DTCLib::DTC_DataPacket> DTCLib::DTC::ReadNextPacket(const DTC_DM
 
 		void* oldBufferPtr = nullptr;
 		if (info->buffer.size() > 0) oldBufferPtr = &info->buffer.back()[0];
-		auto sts = ReadBuffer(engine, tmo_ms);  // does return code
+		if (engine == DTC_DMA_Engine_DCS && info->buffer.size() > 0)
+		{
+			// DCS replies are copied out of the DMA buffer, so consumed buffers can go back to the driver right away.
+			// This lets a reader consume replies continuously without filling the DCS ring.
+			device_.read_release(engine, info->buffer.size());
+			info->buffer.clear();
+		}
+		// DCS replies are waited for in the driver, which returns as soon as the reply DMA completes
+		auto sts = engine == DTC_DMA_Engine_DCS ? ReadBuffer(engine, 0 /* retries */, tmo_ms > 1 ? tmo_ms : 1)
+												: ReadBuffer(engine, tmo_ms);  // does return code
 		if (sts <= 0)
 		{
 			DTC_TLOG(TLVL_ReadNextDAQPacket) << "ReadNextPacket: ReadBuffer returned " << sts << ", returning nullptr";
@@ -1488,6 +1786,7 @@ std::unique_ptr<DTCLib::DTC_DataPacket> DTCLib::DTC::ReadNextPacket(const DTC_DM
 
 void DTCLib::DTC::WriteDetectorEmulatorData(mu2e_databuff_t* buf, size_t sz)
 {
+	std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 	if (sz < dmaSize_)
 	{
 		sz = dmaSize_;
@@ -1511,12 +1810,13 @@ void DTCLib::DTC::WriteDetectorEmulatorData(mu2e_databuff_t* buf, size_t sz)
 //
 // Private Functions.
 //   On success, returns number of bytes read.
-int DTCLib::DTC::ReadBuffer(const DTC_DMA_Engine& channel, int retries /* = 10 */)
+int DTCLib::DTC::ReadBuffer(const DTC_DMA_Engine& channel, int retries /* = 10 */, int tmo_ms /* = 1 */)
 {
 	mu2e_databuff_t* buffer;
 
 	int retry = 1;
 	if (retries > 0) retry = retries;
+	if (tmo_ms > 1) retry = 0;  // A single blocking wait in the driver (M_IOC_GET_INFO) replaces the 1 ms polling
 
 	int errorCode;
 	TRACE_EXIT
@@ -1529,7 +1829,7 @@ int DTCLib::DTC::ReadBuffer(const DTC_DMA_Engine& channel, int retries /* = 10 *
 		DTC_TLOG(TLVL_ReadBuffer) << "ReadBuffer before device_.read_data retries=" << retries << " retry=" << retry;
 		// WARNING NOTE: if there is existing data still sitting in unreleased buffer, the timeout will not add any delay
 		//  read_data() on success, returns number of bytes read.
-		errorCode = device_.read_data(channel, reinterpret_cast<void**>(&buffer), 1 /* tmo_ms */);
+		errorCode = device_.read_data(channel, reinterpret_cast<void**>(&buffer), tmo_ms);
 		// NOTE: Adding delay here significantly impacts data rates!
 		//  if (errorCode == 0) usleep(tmo_ms*1000); //create timeout delay here to match tmo (tmo not used by read_data())
 
@@ -1570,6 +1870,7 @@ void DTCLib::DTC::ReleaseAllBuffers(const DTC_DMA_Engine& channel)
 
 	if (channel == DTC_DMA_Engine_DAQ)
 	{
+		std::lock_guard<std::recursive_mutex> lock(daqMutex_);
 		daqDMAInfo_.buffer.clear();
 		device_.release_all(channel);
 	}
@@ -1604,6 +1905,8 @@ void DTCLib::DTC::ReleaseBuffers(const DTC_DMA_Engine& channel)  //, int count)/
 		DTC_TLOG(TLVL_ERROR) << "ReleaseBuffers: Invalid DMA Engine specified!";
 		throw new DTC_DataCorruptionException();
 	}
+	std::unique_lock<std::recursive_mutex> daqLock(daqMutex_, std::defer_lock);
+	if (channel == DTC_DMA_Engine_DAQ) daqLock.lock();
 
 	auto releaseBufferCount = CFOandDTC_DMAs::GetCurrentBuffer(info);  // not GetCurrentBuffer(info), but rather Count!!!!
 	if (releaseBufferCount > 0)
@@ -1687,6 +1990,39 @@ void DTCLib::DTC::WriteDataPacket(const DTC_DataPacket& packet)
 	memcpy(&buf[0], &size, sizeof(uint64_t));
 	memcpy(&buf[8], packet.GetData(), packet.GetSize() * sizeof(uint8_t));
 
+	WriteDataBuffer(buf, size);
+}
+
+size_t DTCLib::DTC::WriteDMAPackets(const std::vector<DTC_DataPacket>& packets)
+{
+	DTC_TLOG(TLVL_WriteDataPacket) << "WriteDMAPackets: Writing " << packets.size() << " packets";
+	mu2e_databuff_t buf;
+	size_t dmas = 0;
+	uint64_t size = sizeof(uint64_t);
+	auto flush = [&]() {
+		// Zero padding up to the DMA size: a packet byte count of 0 ends the packet stream
+		uint64_t dmaBytes = size < static_cast<uint64_t>(dmaSize_) ? dmaSize_ : size;
+		bzero(&buf[size], dmaBytes - size);
+		memcpy(&buf[0], &dmaBytes, sizeof(uint64_t));
+		WriteDataBuffer(buf, dmaBytes);
+		++dmas;
+		size = sizeof(uint64_t);
+	};
+
+	for (auto const& packet : packets)
+	{
+		if (size + packet.GetSize() > sizeof(mu2e_databuff_t)) flush();
+		memcpy(&buf[size], packet.GetData(), packet.GetSize() * sizeof(uint8_t));
+		size += packet.GetSize();
+	}
+	if (size > sizeof(uint64_t)) flush();
+
+	DTC_TLOG(TLVL_WriteDataPacket) << "WriteDMAPackets: Wrote " << packets.size() << " packets in " << dmas << " DMAs";
+	return dmas;
+}
+
+void DTCLib::DTC::WriteDataBuffer(mu2e_databuff_t& buf, uint64_t size)
+{
 	Utilities::PrintBuffer(buf, size, 0, TLVL_TRACE + 30);
 
 	bool lock_taken_locally = false;
@@ -1,8 +1,12 @@
 #ifndef DTC_H
 #define DTC_H
 
+#include <array>
+#include <chrono>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 // #include "artdaq-core-mu2e/Overlays/DTC_Packets.h"
@@ -57,6 +61,98 @@ namespace DTCLib {
 typedef uint16_t roc_data_t;
 typedef uint16_t roc_address_t;
 
+/// <summary>
+/// Observed DCS reply latencies for the ROC on a link, and the adaptive expected latency for that link.
+/// Latencies are measured from the moment the DCS request is handed to the DMA engine until the reply is received.
+/// </summary>
+struct DTC_DCSReplyLatency
+{
+	/// <summary>
+	/// Number of histogram bins. Bin 0 counts replies faster than 1 us, bin N counts replies in [2^(N-1), 2^N) us,
+	/// and the last bin is the overflow bin.
+	/// </summary>
+	static constexpr size_t kHistogramBins = 20;
+
+	std::array<uint64_t, kHistogramBins> histogram{};  ///< Reply latency histogram, power-of-two microsecond bins
+	uint64_t replyCount = 0;                            ///< Number of replies received
+	uint64_t timeoutCount = 0;                          ///< Number of requests for which no reply arrived before the deadline
+	double minLatencyUs = 0;                            ///< Fastest observed reply, in microseconds
+	double maxLatencyUs = 0;                            ///< Slowest observed reply, in microseconds
+	double totalLatencyUs = 0;                          ///< Sum of all observed reply latencies, in microseconds
+	double expectedLatencyUs = 0;                       ///< Exponentially-weighted moving average of the reply latency, in microseconds
+
+	/// <summary>
+	/// Add a reply latency measurement to the histogram and update the expected latency estimate
+	/// </summary>
+	/// <param name="latencyUs">Observed latency, in microseconds</param>
+	void AddReply(double latencyUs);
+
+	/// <summary>
+	/// Get the lower edge of the given histogram bin, in microseconds
+	/// </summary>
+	/// <param name="bin">Histogram bin</param>
+	/// <returns>Lower edge of the bin, in microseconds</returns>
+	static double BinLowEdgeUs(size_t bin) { return bin == 0 ? 0 : static_cast<double>(1ULL << (bin - 1)); }
+};
+
+/// <summary>
+/// Maximum number of words in a single DCS block write: 3 words fit in the request packet,
+/// and each of up to 1023 follow-on packets (10-bit packet count) carries 8 more.
+/// </summary>
+constexpr size_t DTC_MAX_DCS_BLOCK_WORDS = 3 + 8 * 1023;
+
+/// <summary>
+/// Verification performed at the end of a streaming ROC block upload (see DTC::UploadROCBlock)
+/// </summary>
+enum DTC_BlockUploadVerify
+{
+	DTC_BlockUploadVerify_None = 0,      ///< No verification
+	DTC_BlockUploadVerify_ReadBack = 1,  ///< Read the block back and compare word by word
+	DTC_BlockUploadVerify_Checksum = 2,  ///< Read the block back and compare the CRC-32 of the whole image
+};
+
+/// <summary>
+/// Options for a streaming ROC block upload
+/// </summary>
+struct DTC_BlockUploadOptions
+{
+	size_t maxPacketWords = DTC_MAX_DCS_BLOCK_WORDS;        ///< Maximum number of words per DCS block write
+	size_t window = 8;                                      ///< Number of block writes in flight before acks are collected. 0 disables acks
+	bool incrementAddress = true;                           ///< Whether to increment the address pointer for block writes
+	DTC_BlockUploadVerify verify = DTC_BlockUploadVerify_None;  ///< Verification to perform after the upload
+	int ack_tmo_ms = 0;                                     ///< Timeout for each ack and read-back, in milliseconds. If <= 0, the DCS reply deadline is used
+};
+
+/// <summary>
+/// Result of a streaming ROC block upload
+/// </summary>
+struct DTC_BlockUploadResult
+{
+	DTC_BlockUploadVerify verify = DTC_BlockUploadVerify_None;  ///< Verification which was performed
+	size_t words = 0;                                       ///< Number of words uploaded
+	size_t packets = 0;                                     ///< Number of DCS block writes sent
+	size_t ackedPackets = 0;                                ///< Number of block writes which were acknowledged
+	size_t ackTimeouts = 0;                                 ///< Number of block writes whose ack did not arrive before the timeout
+	double uploadSeconds = 0;                               ///< Time spent sending block writes and collecting acks
+	double verifySeconds = 0;                               ///< Time spent verifying
+	bool verified = false;                                  ///< Whether the verification passed
+	size_t mismatches = 0;                                  ///< Number of words which did not read back correctly (ReadBack only)
+	size_t firstMismatch = 0;                               ///< Word offset of the first mismatch (ReadBack only)
+	uint32_t checksum = 0;                                  ///< CRC-32 of the uploaded image (Checksum only)
+	uint32_t readBackChecksum = 0;                          ///< CRC-32 of the image as read back from the ROC (Checksum only)
+
+	/// <summary>
+	/// Get the upload throughput
+	/// </summary>
+	/// <returns>Upload throughput, in MB/s (excluding verification)</returns>
+	double ThroughputMBps() const { return uploadSeconds > 0 ? words * sizeof(uint16_t) / uploadSeconds / 1e6 : 0; }
+	/// <summary>
+	/// Whether all requested acks were received and the verification (if any) passed
+	/// </summary>
+	/// <returns>True if the upload succeeded</returns>
+	bool Success() const { return ackTimeouts == 0 && (verify == DTC_BlockUploadVerify_None || verified); }
+};
+
 /// <summary>
 /// The DTC class implements the data transfers to the DTC card. It derives from DTC_Registers, the class representing
 /// the DTC register space.
@@ -182,6 +278,26 @@ public:
 	/// <param name="incrementAddress">Whether to increment the address pointer for block reads/writes</param>
 	/// <param name="ack_tmo_ms">Timeout, in milliseconds, for ack (will retry until timeout is expired or ack received)</param>
 	bool WriteROCBlock(const DTC_Link_ID& link, const roc_address_t address, const std::vector<roc_data_t>& blockData, bool requestAck, bool incrementAddress, int ack_tmo_ms);
+	/// <summary>
+	/// Upload an arbitrarily large block of data to a ROC (calibration tables, firmware images). The data is split into
+	/// block writes of at most options.maxPacketWords words, which are sent back-to-back under a single DCS transaction.
+	/// Up to options.window block writes are in flight before their acks are collected, so the DCS link stays busy
+	/// instead of idling for one round trip per block. The upload can optionally be verified by reading the block back.
+	/// </summary>
+	/// <param name="link">Link of the ROC to write</param>
+	/// <param name="address">Start address of the block</param>
+	/// <param name="data">Words to write</param>
+	/// <param name="options">Packet size, window, and verification options</param>
+	/// <returns>Upload statistics, including throughput and verification result</returns>
+	DTC_BlockUploadResult UploadROCBlock(const DTC_Link_ID& link, const roc_address_t address, const std::vector<roc_data_t>& data,
+										 const DTC_BlockUploadOptions& options = DTC_BlockUploadOptions());
+	/// <summary>
+	/// Compute the CRC-32 (IEEE 802.3) of a block of ROC words, in little-endian byte order
+	/// </summary>
+	/// <param name="data">Words to checksum</param>
+	/// <param name="crc">CRC of the preceding words, to checksum a block in pieces</param>
+	/// <returns>CRC-32 of the words</returns>
+	static uint32_t ROCBlockCRC32(const std::vector<roc_data_t>& data, uint32_t crc = 0);
 
 	/// <summary>
 	/// Sends a DCS Request Packet with fields filled in such that the given ROC firmware block register will be read out.
@@ -244,6 +360,13 @@ public:
 	/// <param name="packet">Packet to write</param>
 	void WriteDMAPacket(const DTC_DMAPacket& packet);
 	/// <summary>
+	/// Writes packets to the DTC on the DCS channel, packed back-to-back into as few DMAs as possible (one DMA buffer
+	/// holds up to 4095 16-byte packets), so that a burst of requests costs one write_data instead of one per packet
+	/// </summary>
+	/// <param name="packets">Packets to write, e.g. from DTC_DMAPacket::ConvertToDataPacket()</param>
+	/// <returns>Number of DMAs written</returns>
+	size_t WriteDMAPackets(const std::vector<DTC_DataPacket>& packets);
+	/// <summary>
 	/// Writes the given data buffer to the DTC's DDR memory, via the DAQ channel.
 	/// </summary>
 	/// <param name="buf">DMA buffer to write. Must have an inclusive 64-bit byte count at the beginning, followed by an
@@ -288,9 +411,53 @@ public:
 	/// <param name="channel">Channel to release</param>
 	void ReleaseAllBuffers(const DTC_DMA_Engine& channel);
 
+	// DCS reply timing
+	/// <summary>
+	/// Set the deadline used when waiting for a DCS reply if the caller does not specify a timeout (tmo_ms <= 0).
+	/// The initial value is taken from the DTCLIB_DCS_REPLY_DEADLINE_MS environment variable, if set.
+	/// </summary>
+	/// <param name="deadline_ms">Deadline, in milliseconds</param>
+	void SetDCSReplyDeadline(int deadline_ms) { dcsReplyDeadline_ms_ = deadline_ms > 0 ? deadline_ms : 1; }
+	/// <summary>
+	/// Get the deadline used when waiting for a DCS reply if the caller does not specify a timeout
+	/// </summary>
+	/// <returns>Deadline, in milliseconds</returns>
+	int GetDCSReplyDeadline() const { return dcsReplyDeadline_ms_; }
+	/// <summary>
+	/// Get the adaptive expected DCS reply latency for the given link
+	/// </summary>
+	/// <param name="link">Link of the ROC</param>
+	/// <returns>Expected reply latency in microseconds, 0 if no replies have been observed on the link</returns>
+	double GetExpectedDCSReplyLatency(const DTC_Link_ID& link) const;
+	/// <summary>
+	/// Get the observed DCS reply latencies for the ROC on the given link
+	/// </summary>
+	/// <param name="link">Link of the ROC</param>
+	/// <returns>Copy of the latency statistics for the link</returns>
+	DTC_DCSReplyLatency GetDCSReplyLatency(const DTC_Link_ID& link) const;
+	/// <summary>
+	/// Clear all DCS reply latency histograms and expected latency estimates
+	/// </summary>
+	void ResetDCSReplyLatency();
+	/// <summary>
+	/// Format the DCS reply latency histograms of all links with observed replies
+	/// </summary>
+	/// <returns>Human-readable histogram table</returns>
+	std::string FormatDCSReplyLatency() const;
+
 private:
 	std::unique_ptr<DTC_DataPacket> ReadNextPacket(const DTC_DMA_Engine& channel, int tmo_ms);
-	int ReadBuffer(const DTC_DMA_Engine& channel, int retries = 10);
+	int ReadBuffer(const DTC_DMA_Engine& channel, int retries = 10, int tmo_ms = 1);
+	/// <summary>
+	/// Wait for the first DCS reply to a request sent at requestTime. The wait is performed in the driver
+	/// (M_IOC_GET_INFO), so it returns as soon as the reply DMA completes, or nullptr once the deadline passes.
+	/// </summary>
+	/// <param name="link">Link the request was sent to</param>
+	/// <param name="requestTime">Time at which the request was written to the DCS DMA engine</param>
+	/// <param name="tmo_ms">Deadline, in milliseconds. If <= 0, the configured DCS reply deadline is used</param>
+	/// <returns>Pointer to the reply packet, or nullptr on timeout</returns>
+	std::unique_ptr<DTC_DCSReplyPacket> WaitForDCSReply(const DTC_Link_ID& link,
+														std::chrono::steady_clock::time_point requestTime, int tmo_ms);
 	/// <summary>
 	/// This function releases all buffers except for the one containing currentReadPtr. Should only be called when done
 	/// with data in other buffers!
@@ -298,6 +465,7 @@ private:
 	/// <param name="channel">Channel to release</param>
 	void ReleaseBuffers(const DTC_DMA_Engine& channel);
 	void WriteDataPacket(const DTC_DataPacket& packet);
+	void WriteDataBuffer(mu2e_databuff_t& buf, uint64_t size);
 
 	// struct DMAInfo
 	// {
@@ -316,10 +484,23 @@ private:
 	// };
 	// int GetCurrentBuffer(DMAInfo* info);
 	// uint16_t GetBufferByteCount(DMAInfo* info, size_t index);
+
+	// Lock domains: the DAQ and DCS paths keep separate per-channel state, so that a slow-control
+	// thread and a readout thread may use the same DTC concurrently without waiting on each other.
+	//  - DAQ domain: daqMutex_ guards daqDMAInfo_ and the DAQ channel of device_. It is taken by the
+	//    DAQ readout entry points (GetData, GetSubEventData, ReadNextDAQDMA, ...) and never by DCS functions.
+	//  - DCS domain: the DCS transaction (device_.begin_dcs_transaction) guards dcsDMAInfo_,
+	//    lastDTCErrorBitsValue_ and the DCS channel of device_. It is never taken by DAQ functions.
+	// Register access goes through the driver and needs neither lock.
+	std::recursive_mutex daqMutex_;
 	CFOandDTC_DMAs::DMAInfo daqDMAInfo_;
 	CFOandDTC_DMAs::DMAInfo dcsDMAInfo_;
 
 	uint8_t lastDTCErrorBitsValue_ = 0;
+
+	int dcsReplyDeadline_ms_ = 20;
+	mutable std::mutex dcsReplyLatencyMutex_;
+	std::map<DTC_Link_ID, DTC_DCSReplyLatency> dcsReplyLatency_;
 };
 }  // namespace DTCLib
 #endif
@@ -1,12 +1,13 @@
 #include "DTCLibTest.h"
 #include "DTCSoftwareCFO.h"
 
+#include <chrono>
 #include <iostream>
 
 #include "TRACE/tracemf.h"
 
 DTCLib::DTCLibTest::DTCLibTest()
-	: running_(false), classPassed_(0), classFailed_(0), regPassed_(0), regFailed_(0), daqPassed_(0), daqFailed_(0), dcsPassed_(0), dcsFailed_(0), classPassedTemp_(0), classFailedTemp_(0), regPassedTemp_(0), regFailedTemp_(0), daqPassedTemp_(0), daqFailedTemp_(0), dcsPassedTemp_(0), dcsFailedTemp_(0), nTests_(0), runClassTest_(false), runRegTest_(false), runDAQTest_(false), runDCSTest_(false), printMessages_(false)
+	: running_(false), classPassed_(0), classFailed_(0), regPassed_(0), regFailed_(0), daqPassed_(0), daqFailed_(0), dcsPassed_(0), dcsFailed_(0), stressPassed_(0), stressFailed_(0), classPassedTemp_(0), classFailedTemp_(0), regPassedTemp_(0), regFailedTemp_(0), daqPassedTemp_(0), daqFailedTemp_(0), dcsPassedTemp_(0), dcsFailedTemp_(0), stressPassedTemp_(0), stressFailedTemp_(0), nTests_(0), runClassTest_(false), runRegTest_(false), runDAQTest_(false), runDCSTest_(false), runStressTest_(false), printMessages_(false)
 {
 	thisDTC_ = new DTC();
 }
@@ -23,12 +24,13 @@ DTCLib::DTCLibTest::~DTCLibTest()
 
 // Test Control
 void DTCLib::DTCLibTest::startTest(bool classEnabled, bool regIOEnabled, bool daqEnabled, bool dcsEnabled, int nTests,
-								   bool printMessages)
+								   bool printMessages, bool stressEnabled)
 {
 	runClassTest_ = classEnabled;
 	runRegTest_ = regIOEnabled;
 	runDCSTest_ = dcsEnabled;
 	runDAQTest_ = daqEnabled;
+	runStressTest_ = stressEnabled;
 	nTests_ = nTests;
 	printMessages_ = printMessages;
 
@@ -110,6 +112,20 @@ int DTCLib::DTCLibTest::dcsFailed()
 	return result;
 }
 
+int DTCLib::DTCLibTest::stressPassed()
+{
+	auto result = stressPassed_ - stressPassedTemp_;
+	stressPassedTemp_ = stressPassed_;
+	return result;
+}
+
+int DTCLib::DTCLibTest::stressFailed()
+{
+	auto result = stressFailed_ - stressFailedTemp_;
+	stressFailedTemp_ = stressFailed_;
+	return result;
+}
+
 // Private Functions
 void DTCLib::DTCLibTest::doTests()
 {
@@ -142,6 +158,10 @@ void DTCLib::DTCLibTest::doTests()
 		{
 			doDAQTest();
 		}
+		if (runStressTest_)
+		{
+			doStressTest();
+		}
 	}
 	running_ = false;
 
@@ -176,6 +196,13 @@ void DTCLib::DTCLibTest::doTests()
 		std::cout << std::dec << daqPassed_ << " of " << daqPassed_ + daqFailed_ << " DAQ DMA I/O tests passed."
 				  << std::endl;
 	}
+	if (runStressTest_)
+	{
+		totalPassed += stressPassed_;
+		totalTests += stressPassed_ + stressFailed_;
+		std::cout << std::dec << stressPassed_ << " of " << stressPassed_ + stressFailed_
+				  << " concurrent DAQ/DCS stress tests passed." << std::endl;
+	}
 	std::cout << std::dec << totalPassed << " of " << totalTests << " tests passed." << std::endl;
 }
 
@@ -367,7 +394,20 @@ void DTCLib::DTCLibTest::doRegTest()
 		}
 		// Make sure that the link is enabled after the test.
 		thisDTC_->EnableLink(DTC_Link_0, DTC_LinkEnableMode(true, true));
-		if (link0New != link0Value)
+
+		// Every link, including the CFO and EVB links, has Link Enable bits in the register table
+		for (uint8_t link = 0; link < 8; ++link)
+		{
+			thisDTC_->ReadLinkEnabled(static_cast<DTC_Link_ID>(link));
+		}
+		auto linkEnableForm = thisDTC_->FormatLinkEnable();
+		auto linkEnableValid = linkEnableForm.vals.size() == 9;  // Header, 6 ROC links, CFO and EVB
+		if (printMessages_)
+		{
+			std::cout << "Link Enable register formatted with " << linkEnableForm.vals.size() << " lines" << std::endl;
+		}
+
+		if (link0New != link0Value && linkEnableValid)
 		{
 			if (printMessages_)
 			{
@@ -513,6 +553,86 @@ void DTCLib::DTCLibTest::doDAQTest()
 	}
 }
 
+void DTCLib::DTCLibTest::doStressTest()
+{
+	if (printMessages_)
+	{
+		std::cout << "Test 6: Full-rate DAQ readout with concurrent DCS polling" << std::endl;
+	}
+	try
+	{
+		thisDTC_->EnableLink(DTC_Link_0, DTC_LinkEnableMode(true, true));
+
+		// Fill the (simulated) DDR memory with events; readout loops over them
+		DTCSoftwareCFO theCFO(thisDTC_, true, 0, DTC_DebugType_SpecialSequence, true, !printMessages_);
+		theCFO.SendRequestsForRange(256);
+
+		const auto measureTime = std::chrono::seconds(1);
+		auto readEvents = [&]() {
+			size_t events = 0;
+			auto start = std::chrono::steady_clock::now();
+			while (std::chrono::steady_clock::now() - start < measureTime)
+			{
+				events += thisDTC_->GetData().size();
+			}
+			return events / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		};
+
+		auto baselineRate = readEvents();
+
+		// Poll a ROC register as fast as possible while reading out
+		std::atomic<bool> stopPolling(false);
+		std::atomic<size_t> polls(0), pollErrors(0);
+		std::thread poller([&]() {
+			while (!stopPolling)
+			{
+				try
+				{
+					thisDTC_->ReadROCRegister(DTC_Link_0, 0, 10);
+					++polls;
+				}
+				catch (std::exception const&)
+				{
+					++pollErrors;
+				}
+			}
+		});
+		auto pollingRate = readEvents();
+		stopPolling = true;
+		poller.join();
+
+		// The rates are wall-clock measurements which depend on the host and its load, so their ratio is only reported;
+		// the test checks that readout and DCS polling both make progress without errors
+		std::cout << "DAQ event rate: " << baselineRate << " Hz alone, " << pollingRate << " Hz with DCS polling (ratio "
+				  << (baselineRate > 0 ? pollingRate / baselineRate : 0) << ", " << polls << " DCS reads, " << pollErrors << " errors)"
+				  << std::endl;
+
+		if (baselineRate > 0 && pollingRate > 0 && polls > 0 && pollErrors == 0)
+		{
+			if (printMessages_) std::cout << "Test Passed" << std::endl;
+			++stressPassed_;
+		}
+		else
+		{
+			if (printMessages_) std::cout << "Test Failed" << std::endl;
+			++stressFailed_;
+		}
+	}
+	catch (std::exception const& ex)
+	{
+		if (printMessages_)
+		{
+			std::cout << "Test failed with exception: " << ex.what() << std::endl;
+		}
+		++stressFailed_;
+	}
+	if (printMessages_)
+	{
+		std::cout << std::endl
+				  << std::endl;
+	}
+}
+
 bool DTCLib::DTCLibTest::DataPacketIntegrityCheck(DTC_DataPacket* packet)
 {
 	auto retCode = true;
@@ -29,8 +29,9 @@ public:
 	/// <param name="dcsEnabled">Run DCS read/write test</param>
 	/// <param name="nTests">Number of times to repeat tests</param>
 	/// <param name="printMessages">Print debuffing messages (Default: false)</param>
+	/// <param name="stressEnabled">Run concurrent DAQ readout/DCS polling stress test (Default: false)</param>
 	void startTest(bool classEnabled, bool regIOEnabled, bool daqEnabled, bool dcsEnabled, int nTests,
-				   bool printMessages = false);
+				   bool printMessages = false, bool stressEnabled = false);
 	/// <summary>
 	/// Abort testing
 	/// </summary>
@@ -83,6 +84,16 @@ public:
 	/// </summary>
 	/// <returns>The number of instances of the DCS test that failed</returns>
 	int dcsFailed();
+	/// <summary>
+	/// Get the number of instances of the DAQ/DCS stress test that passed
+	/// </summary>
+	/// <returns>The number of instances of the DAQ/DCS stress test that passed</returns>
+	int stressPassed();
+	/// <summary>
+	/// Get the number of instances of the DAQ/DCS stress test that failed
+	/// </summary>
+	/// <returns>The number of instances of the DAQ/DCS stress test that failed</returns>
+	int stressFailed();
 
 private:
 	// Test Worker
@@ -91,6 +102,7 @@ private:
 	void doRegTest();
 	void doDCSTest();
 	void doDAQTest();
+	void doStressTest();
 
 	static bool DataPacketIntegrityCheck(DTC_DataPacket*);
 
@@ -105,6 +117,8 @@ private:
 	std::atomic<int> daqFailed_;
 	std::atomic<int> dcsPassed_;
 	std::atomic<int> dcsFailed_;
+	std::atomic<int> stressPassed_;
+	std::atomic<int> stressFailed_;
 
 	int classPassedTemp_;
 	int classFailedTemp_;
@@ -114,6 +128,8 @@ private:
 	int daqFailedTemp_;
 	int dcsPassedTemp_;
 	int dcsFailedTemp_;
+	int stressPassedTemp_;
+	int stressFailedTemp_;
 
 	// Test Internals
 	DTC* thisDTC_;
@@ -123,6 +139,7 @@ private:
 	bool runRegTest_;
 	bool runDAQTest_;
 	bool runDCSTest_;
+	bool runStressTest_;
 
 	bool printMessages_;
 	std::thread workerThread_;
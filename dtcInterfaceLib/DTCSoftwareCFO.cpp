@@ -4,6 +4,7 @@
 //#define TRACE_NAME "DTCSoftwareCFO"
 //#define TRACE_NAME (strstr(&__FILE__[0], "/srcs/") ? strstr(&__FILE__[0], "/srcs/") + 6 : __FILE__)  /* TOO LONG */
 #define TRACE_NAME &std::string(__FILE__).substr(std::string(__FILE__).rfind('/', std::string(__FILE__).rfind('/') - 1) + 1)[0]
+#include <algorithm>
 #include <iostream>
 #include "DTCSoftwareCFO.h"
 
@@ -22,7 +23,9 @@ DTCLib::DTCSoftwareCFO::DTCSoftwareCFO(DTC* dtc, bool useCFOEmulator, uint16_t d
 									   bool forceNoDebug, bool useCFODRP)
 	: useCFOEmulator_(useCFOEmulator), debugPacketCount_(debugPacketCount), debugType_(debugType),
 		 stickyDebugType_(stickyDebugType), quiet_(quiet), asyncRR_(asyncRR), forceNoDebug_(forceNoDebug), 
-		 theThread_(nullptr), requestsSent_(false), abort_(false)
+		 burstSize_(0), requestRate_(0), schedule_(), throttle_(), requestsSent_(false), pacer_(), running_(false),
+		 delayBetweenDataRequests_(0), nextSchedule_(), scheduleChanged_(false), nextBurstSize_(), nextThrottle_(), rebase_(false), tagOffset_(0), nextTag_(0),
+		 indexBase_(0), scheduleShift_(0), generator_()
 {
 	theDTC_ = dtc;
 	for (auto link : DTC_ROC_Links)
@@ -49,19 +52,77 @@ DTCLib::DTCSoftwareCFO::~DTCSoftwareCFO()
 	TLOG(TLVL_TRACE) << "~DTCSoftwareCFO BEGIN";
 	// theDTC_->DisableAutogenDRP();
 	// theDTC_->DisableCFOEmulatorDRP();
-	abort_ = true;
-	if (theThread_ && theThread_->joinable()) theThread_->join();
+	generator_.Cancel();
+	generator_.Wait();
 	TLOG(TLVL_TRACE) << "~DTCSoftwareCFO END";
 }
 
 void DTCLib::DTCSoftwareCFO::WaitForRequestsToBeSent() const
 {
-	while (!requestsSent_)
+	while (!requestsSent_ && generator_.IsActive())
 	{
 		usleep(1000);
 	}
 }
 
+void DTCLib::DTCSoftwareCFO::WaitForCompletion()
+{
+	generator_.Wait();
+}
+
+void DTCLib::DTCSoftwareCFO::setRequestRate(double eventWindowsPerSecond)
+{
+	generator_.Post([this, eventWindowsPerSecond]() {
+		requestRate_ = eventWindowsPerSecond;
+		if (running_ && !schedule_)
+		{
+			if (throttle_)
+				TLOG(TLVL_WARN) << "The request throttle sets the rate; the new rate is used from the next range";
+			else
+				ApplyRate_();
+		}
+	});
+}
+
+void DTCLib::DTCSoftwareCFO::setBurstSize(size_t eventWindows)
+{
+	generator_.Post([this, eventWindows]() {
+		if (running_)
+			nextBurstSize_ = eventWindows;
+		else
+			burstSize_ = eventWindows;
+	});
+}
+
+void DTCLib::DTCSoftwareCFO::setThrottle(std::shared_ptr<RequestThrottle> throttle)
+{
+	generator_.Post([this, throttle]() {
+		if (running_)
+			nextThrottle_ = throttle;
+		else
+			throttle_ = throttle;
+	});
+}
+
+void DTCLib::DTCSoftwareCFO::setRequestSchedule(std::shared_ptr<RequestSchedule> schedule)
+{
+	generator_.Post([this, schedule]() {
+		if (!running_)
+			schedule_ = schedule;
+		else if (asyncRR_)
+		{
+			TLOG(TLVL_WARN) << "The ReadoutRequests of this range were sent ahead; the new request pattern is used from the next range";
+			nextSchedule_ = schedule;
+			scheduleChanged_ = true;
+		}
+		else
+		{
+			schedule_ = schedule;
+			rebase_ = true;
+		}
+	});
+}
+
 void DTCLib::DTCSoftwareCFO::SendRequestForTimestamp(DTC_EventWindowTag ts, uint32_t heartbeatsAfter, bool sendHeartbeats /* = true */)
 {
 	if (theDTC_->IsDetectorEmulatorInUse())
@@ -165,15 +226,15 @@ void DTCLib::DTCSoftwareCFO::SendRequestsForRange(int count, DTC_EventWindowTag
 		requestsSent_ = false;
 		if (asyncRR_)
 		{
-			if (theThread_ && theThread_->joinable()) theThread_->join();
-			theThread_.reset(new std::thread(&DTCSoftwareCFO::SendRequestsForRangeImplAsync, this, start, count, increment,
-											 delayBetweenDataRequests, heartbeatsAfter, sendHeartbeats));
+			generator_.Start(count > 0 ? count : 0, [=]() {
+				Run_([=]() { SendRequestsForRangeImplAsync(start, count, increment, delayBetweenDataRequests, heartbeatsAfter, sendHeartbeats); });
+			});
 		}
 		else
 		{
-			if (theThread_ && theThread_->joinable()) theThread_->join();
-			theThread_.reset(new std::thread(&DTCSoftwareCFO::SendRequestsForRangeImplSync, this, start, count, increment,
-											 delayBetweenDataRequests, requestsAhead, heartbeatsAfter, sendHeartbeats));
+			generator_.Start(count > 0 ? count : 0, [=]() {
+				Run_([=]() { SendRequestsForRangeImplSync(start, count, increment, delayBetweenDataRequests, requestsAhead, heartbeatsAfter, sendHeartbeats); });
+			});
 		}
 		WaitForRequestsToBeSent();
 	}
@@ -220,9 +281,9 @@ void DTCLib::DTCSoftwareCFO::SendRequestsForList(std::set<DTC_EventWindowTag> ti
 		return;
 	}
 
-	if (theThread_ && theThread_->joinable()) theThread_->join();
-	theThread_.reset(
-		new std::thread(&DTCSoftwareCFO::SendRequestsForListImplAsync, this, timestamps, delayBetweenDataRequests, heartbeatsAfter));
+	generator_.Start(timestamps.size(), [=]() {
+		Run_([=]() { SendRequestsForListImplAsync(timestamps, delayBetweenDataRequests, heartbeatsAfter); });
+	});
 }
 
 void DTCLib::DTCSoftwareCFO::SendRequestsForListImplAsync(std::set<DTC_EventWindowTag> timestamps,
@@ -238,7 +299,7 @@ void DTCLib::DTCSoftwareCFO::SendRequestsForListImplAsync(std::set<DTC_EventWind
 	}
 
 	auto ii = timestamps.begin();
-	while (ii != timestamps.end() && !abort_)
+	while (ii != timestamps.end() && Continue_())
 	{
 		TLOG(TLVL_SendRequestsForRangeImpl) << "Setting up CFO Emulator for next entry in list";
 		auto thisTimestamp = *ii;
@@ -270,6 +331,7 @@ void DTCLib::DTCSoftwareCFO::SendRequestsForListImplAsync(std::set<DTC_EventWind
 		theDTC_->SetCFOEmulationEventWindowInterval(delayBetweenDataRequests);
 		TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRange enabling DTC CFO Emulator";
 		theDTC_->EnableCFOEmulation();
+		generator_.Record(1, thisTimestamp.GetEventWindowTag(true));
 		TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRange done";
 	}
 }
@@ -281,19 +343,61 @@ void DTCLib::DTCSoftwareCFO::SendRequestsForRangeImplSync(DTC_EventWindowTag sta
 	try
 	{
 		TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImplSync Start";
-		for (auto ii = 0; ii < count; ++ii)
+		StartPacer_(delayBetweenDataRequests);
+		RequestScheduleEntry entry, first;
+		auto last = start;
+		if (burstSize_ > 1)
 		{
-			auto ts = start + (increment ? ii : 0);
-
-			SendRequestForTimestamp(ts, heartbeatsAfter, sendHeartbeats);
-			if (ii >= requestsAhead || ii == count - 1)
+			// Burst mode: the Heartbeat and Data Request of each event window, burstSize_ event windows per DMA, then the
+			// trailing heartbeats once after the range
+			theDTC_->EnableSoftwareDRP();
+			std::vector<DTC_DataPacket> packets;
+			for (auto ii = 0; ii < count;)
 			{
-				requestsSent_ = true;
+				auto windows = 0;
+				while (windows < static_cast<int>(burstSize_) && NextWindow_(ii + windows, count, increment, entry))
+				{
+					if (windows++ == 0) first = entry;
+					last = Tag_(start, entry);
+					if (sendHeartbeats) AddHeartbeats_(packets, last);
+					AddDataRequests_(packets, last);
+				}
+				if (windows == 0) break;
+				Pace_(first, windows);
+				theDTC_->WriteDMAPackets(packets);
+				packets.clear();
+				generator_.Record(windows, last.GetEventWindowTag(true));
+				ii += windows;
+				if (ii > requestsAhead || ii == count)
+				{
+					requestsSent_ = true;
+				}
+				if (!Continue_()) return;
 			}
+			pacer_.Stop();
 
-			usleep(delayBetweenDataRequests);
-			if (abort_) return;
+			for (uint32_t ii = 1; sendHeartbeats && ii <= heartbeatsAfter; ++ii) AddHeartbeats_(packets, last + ii);
+			if (!packets.empty()) theDTC_->WriteDMAPackets(packets);
 		}
+		else
+		{
+			for (auto ii = 0; NextWindow_(ii, count, increment, entry); ++ii)
+			{
+				Pace_(entry, 1);
+				auto ts = Tag_(start, entry);
+				SendRequestForTimestamp(ts, heartbeatsAfter, sendHeartbeats);
+				generator_.Record(1, ts.GetEventWindowTag(true));
+				if (ii >= requestsAhead || ii == count - 1)
+				{
+					requestsSent_ = true;
+				}
+
+				if (!Continue_()) return;
+			}
+			pacer_.Stop();
+		}
+		requestsSent_ = true;  // Also when a replayed schedule ends early
+		TLOG(TLVL_SendRequestsForRange) << "SendRequestsForRangeImplSync: " << pacer_.FormatReport();
 	}
 	catch(const std::exception& e)
 	{
@@ -307,68 +411,218 @@ void DTCLib::DTCSoftwareCFO::SendRequestsForRangeImplAsync(DTC_EventWindowTag st
 {
 	try
 	{
-		
-
 		TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImplAsync Start";
 
+		// Packets are collected per burst of event windows; without burst mode, each packet is still its own DMA
+		auto burst = burstSize_ > 1 ? static_cast<int>(burstSize_) : 1;
+		std::vector<DTC_DataPacket> packets;
+		auto send = [&]() {
+			if (burstSize_ > 1)
+				theDTC_->WriteDMAPackets(packets);
+			else
+				for (auto const& packet : packets) theDTC_->WriteDMAPackets({packet});
+			packets.clear();
+		};
+		RequestScheduleEntry entry, first;
+
 		// Send Readout Requests first
-		for (auto ii = 0; ii < count; ++ii)
+		for (auto ii = 0; sendHeartbeats && NextWindow_(ii, count, increment, entry); ++ii)
 		{
-			auto ts = start + (increment ? ii : 0);
-			for (auto link : DTC_ROC_Links)
-			{
-				if (linkMode_[link].TransmitEnable && sendHeartbeats)
-				{
-					TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImpl before SendHeartbeatPacket";
-					theDTC_->SendHeartbeatPacket(link, ts, quiet_);
-				}
-				if (abort_) return;
-			}
+			AddHeartbeats_(packets, Tag_(start, entry));
+			if ((ii + 1) % burst == 0) send();
+			if (!Continue_()) return;
 		}
+		if (!packets.empty()) send();
 		TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImpl setting RequestsSent flag";
 		requestsSent_ = true;
 
-		// Now do the DataRequests, sleeping for the required delay between each.
-		for (auto ii = 0; ii < count; ++ii)
+		// Now do the DataRequests, one burst per deadline of the pacer (the schedule restarts for the second pass)
+		StartPacer_(delayBetweenDataRequests);
+		auto last = start;
+		for (auto ii = 0; ii < count;)
 		{
-			auto ts = start + (increment ? ii : 0);
-			for (auto link : DTC_ROC_Links)
+			auto windows = 0;
+			while (windows < burst && NextWindow_(ii + windows, count, increment, entry))
 			{
-				if (linkMode_[link].TransmitEnable)
-				{
-					TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImpl before DTC_DataRequestPacket req";
-					DTC_DataRequestPacket req(link, ts, !forceNoDebug_, static_cast<uint16_t>(debugPacketCount_), debugType_);
-					if (debugType_ == DTC_DebugType_ExternalSerialWithReset && !stickyDebugType_)
-					{
-						debugType_ = DTC_DebugType_ExternalSerial;
-					}
-					TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImpl before WriteDMADAQPacket - DTC_DataRequestPacket";
-					if (!quiet_) std::cout << req.toJSON() << std::endl;
-					theDTC_->WriteDMAPacket(req);
-					TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImpl after  WriteDMADAQPacket - DTC_DataRequestPacket";
-					if (abort_) return;
-				}
-				if (abort_) return;
+				if (windows++ == 0) first = entry;
+				last = Tag_(start, entry);
+				AddDataRequests_(packets, last);
 			}
-			usleep(delayBetweenDataRequests);
+			if (windows == 0) break;
+			Pace_(first, windows);
+			send();
+			generator_.Record(windows, last.GetEventWindowTag(true));
+			ii += windows;
+			if (!Continue_()) return;
 		}
+		pacer_.Stop();
+		TLOG(TLVL_SendRequestsForRange) << "SendRequestsForRangeImplAsync: " << pacer_.FormatReport();
 
-		for (uint32_t ii = 0; ii < heartbeatsAfter; ++ii)
+		for (uint32_t ii = 0; sendHeartbeats && ii < heartbeatsAfter; ++ii)
 		{
-			auto ts = start + (increment ? count + ii : 0);
-			for (auto link : DTC_ROC_Links)
-			{
-				if (linkMode_[link].TransmitEnable && sendHeartbeats)
-				{
-					TLOG(TLVL_SendRequestsForRangeImpl) << "SendRequestsForRangeImpl before SendHeartbeatPacket";
-					theDTC_->SendHeartbeatPacket(link, ts, quiet_);
-				}
-				if (abort_) return;
-			}
+			AddHeartbeats_(packets, increment || schedule_ ? last + (ii + 1) : start);
+			if ((ii + 1) % static_cast<uint32_t>(burst) == 0 || ii == heartbeatsAfter - 1) send();
+			if (!Continue_()) return;
 		}
 	}
 	catch(const std::exception& e)
 	{
 		TLOG(TLVL_ERROR) << e.what() << '\n';
 	}
-}
\ No newline at end of file
+}
+
+void DTCLib::DTCSoftwareCFO::Run_(std::function<void()> requests)
+{
+	// A pattern set during the last asynchronous range is used from this one
+	if (scheduleChanged_)
+	{
+		schedule_ = nextSchedule_;
+		nextSchedule_.reset();
+		scheduleChanged_ = false;
+	}
+	// Burst size and throttle changes made during the last range, whose packing and pacing were already set up
+	if (nextBurstSize_)
+	{
+		burstSize_ = *nextBurstSize_;
+		nextBurstSize_.reset();
+	}
+	if (nextThrottle_)
+	{
+		throttle_ = *nextThrottle_;
+		nextThrottle_.reset();
+	}
+	// Each range starts the schedule from the beginning, also for the heartbeat pass of an asynchronous range, which
+	// comes before StartPacer_; otherwise it would continue where the last range left the schedule
+	if (schedule_) schedule_->Reset();
+	rebase_ = false;
+	tagOffset_ = 0;
+	nextTag_ = 0;
+	indexBase_ = 0;
+	scheduleShift_ = std::chrono::nanoseconds(0);
+	running_ = true;
+
+	requests();
+
+	if (generator_.GetState() == RequestGeneratorState::Cancelled)
+	{
+		pacer_.Stop();
+		TLOG(TLVL_SendRequestsForRange) << "Requests cancelled: " << generator_.FormatProgress();
+	}
+	running_ = false;
+}
+
+bool DTCLib::DTCSoftwareCFO::Continue_()
+{
+	std::chrono::nanoseconds paused;
+	if (!generator_.Checkpoint(paused)) return false;
+	if (paused.count() > 0)
+	{
+		// Skip the paused time instead of catching up with a burst: delay the schedule, or restart the rate's deadlines
+		scheduleShift_ += paused;
+		if (!schedule_) pacer_.SetRate(pacer_.GetRate());
+	}
+	return true;
+}
+
+void DTCLib::DTCSoftwareCFO::StartPacer_(uint32_t delayBetweenDataRequests)
+{
+	delayBetweenDataRequests_ = delayBetweenDataRequests;
+	if (schedule_)
+	{
+		schedule_->Reset();
+		TLOG(TLVL_SendRequestsForRange) << "Request schedule: " << schedule_->Describe();
+		if (throttle_) TLOG(TLVL_WARN) << "The request throttle is not used with a request schedule";
+	}
+	if (throttle_ && !schedule_) throttle_->Start();
+	ApplyRate_();
+	scheduleShift_ = std::chrono::nanoseconds(0);
+	pacer_.Start();
+}
+
+void DTCLib::DTCSoftwareCFO::ApplyRate_()
+{
+	if (throttle_ && !schedule_)
+		pacer_.SetRate(throttle_->GetRate());
+	else if (requestRate_ > 0)
+		pacer_.SetRate(requestRate_);
+	else
+		pacer_.SetDelay(delayBetweenDataRequests_);
+}
+
+bool DTCLib::DTCSoftwareCFO::NextWindow_(int index, int count, bool increment, RequestScheduleEntry& entry)
+{
+	if (index >= count) return false;
+	if (rebase_)
+	{
+		// The pattern changed during the range: the new one starts now, with the tags following the last one sent
+		rebase_ = false;
+		tagOffset_ = nextTag_;
+		indexBase_ = index;
+		if (schedule_)
+		{
+			schedule_->Reset();
+			scheduleShift_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(pacer_.GetReport().elapsedSeconds));
+			TLOG(TLVL_SendRequestsForRange) << "Request schedule from tag offset " << tagOffset_ << ": " << schedule_->Describe();
+		}
+		else
+			ApplyRate_();
+	}
+
+	RequestScheduleEntry next;
+	if (schedule_)
+	{
+		if (!schedule_->Next(next)) return false;
+	}
+	else
+		next.tag = increment ? index - indexBase_ : 0;
+	entry.timeNs = next.timeNs + scheduleShift_.count();
+	entry.tag = tagOffset_ + next.tag;
+	nextTag_ = entry.tag + 1;
+	return true;
+}
+
+void DTCLib::DTCSoftwareCFO::Pace_(const RequestScheduleEntry& first, int windows)
+{
+	if (schedule_)
+		pacer_.PaceAt(std::chrono::nanoseconds(first.timeNs), windows);
+	else
+	{
+		if (throttle_) throttle_->Poll(pacer_);
+		pacer_.Pace(windows);
+	}
+}
+
+DTCLib::DTC_EventWindowTag DTCLib::DTCSoftwareCFO::Tag_(DTC_EventWindowTag start, const RequestScheduleEntry& entry)
+{
+	return DTC_EventWindowTag(start.GetEventWindowTag(true) + entry.tag);
+}
+
+void DTCLib::DTCSoftwareCFO::AddHeartbeats_(std::vector<DTC_DataPacket>& packets, DTC_EventWindowTag ts)
+{
+	for (auto link : DTC_ROC_Links)
+	{
+		if (linkMode_[link].TransmitEnable)
+		{
+			DTC_HeartbeatPacket req(link, ts);
+			if (!quiet_) TLOG(TLVL_SendRequestsForRangeImpl) << req.toJSON();
+			packets.push_back(req.ConvertToDataPacket());
+		}
+	}
+}
+
+void DTCLib::DTCSoftwareCFO::AddDataRequests_(std::vector<DTC_DataPacket>& packets, DTC_EventWindowTag ts)
+{
+	for (auto link : DTC_ROC_Links)
+	{
+		if (linkMode_[link].TransmitEnable)
+		{
+			DTC_DataRequestPacket req(link, ts, !forceNoDebug_, static_cast<uint16_t>(debugPacketCount_), debugType_);
+			if (debugType_ == DTC_DebugType_ExternalSerialWithReset && !stickyDebugType_)
+			{
+				debugType_ = DTC_DebugType_ExternalSerial;
+			}
+			if (!quiet_) std::cout << req.toJSON() << std::endl;
+			packets.push_back(req.ConvertToDataPacket());
+		}
+	}
+}
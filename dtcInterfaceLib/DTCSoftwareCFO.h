@@ -6,7 +6,13 @@
 #ifndef DTCSOFTWARECFO_H
 #define DTCSOFTWARECFO_H 1
 
+#include <optional>
+
 #include "DTC.h"
+#include "RequestGenerator.h"
+#include "RequestPacer.h"
+#include "RequestSchedule.h"
+#include "RequestThrottle.h"
 // #include "artdaq-core-mu2e/Overlays/DTC_Types.h"
 #include "artdaq-core-mu2e/Overlays/DTC_Types/DTC_CharacterNotInTableError.h"
 #include "artdaq-core-mu2e/Overlays/DTC_Types/DTC_DCSOperationType.h"
@@ -37,8 +43,9 @@
 
 
 #include <atomic>
+#include <chrono>
+#include <functional>
 #include <set>
-#include <thread>
 
 namespace DTCLib {
 /// <summary>
@@ -46,6 +53,10 @@ namespace DTCLib {
 /// DataRequest packets to the DTC in the absence of a functioning CFO.
 /// Requests are sent asynchronously, and the overall behaviour is meant to
 /// emulate a system with a CFO as closely as possible.
+///
+/// Software requests run in the thread of a RequestGenerator: a range can be
+/// paused, resumed or cancelled, and its rate and schedule changed, while
+/// it runs, and its progress read at any time.
 /// </summary>
 class DTCSoftwareCFO
 {
@@ -111,9 +122,89 @@ public:
 	void setDebugPacketCount(uint16_t dbc) { debugPacketCount_ = dbc; }
 
 	/// <summary>
-	/// Blocks until all ReadoutRequest packets have been sent
+	/// Set the number of event windows whose Data Requests are packed into one DMA (software requests only).
+	/// With asynchronous ReadoutRequests, the heartbeats before and after the Data Requests are packed the same way.
+	/// During a range, the new burst size is used from the next range.
+	/// </summary>
+	/// <param name="eventWindows">Event windows per DMA (0 or 1: one DMA per packet)</param>
+	void setBurstSize(size_t eventWindows);
+	/// <summary>
+	/// Set the rate of software requests. When set, it replaces delayBetweenDataRequests: the requests are paced on a
+	/// steady-clock schedule (see RequestPacer), which reaches microsecond spacing. During a range, the new rate applies
+	/// from the next burst (unless a schedule or a throttle sets the pace).
+	/// </summary>
+	/// <param name="eventWindowsPerSecond">Event windows per second (0: use delayBetweenDataRequests, in microseconds)</param>
+	void setRequestRate(double eventWindowsPerSecond);
+	/// <summary>
+	/// Set the schedule of software requests, e.g. the Mu2e spill cycle or a Poisson process. When set, it replaces both
+	/// the rate and delayBetweenDataRequests, and gives the tags of the requests (as offsets from the starting tag,
+	/// whether or not the range increments). A range sends count requests, or fewer if the schedule ends first.
+	///
+	/// During a range, the new schedule (or, with nullptr, the rate) takes over from the next burst: it starts at that
+	/// time, with tags following the last one sent. With asynchronous ReadoutRequests, whose heartbeats were all sent
+	/// ahead with the old tags, it takes effect from the next range instead.
+	/// </summary>
+	/// <param name="schedule">Request schedule (nullptr: even spacing)</param>
+	void setRequestSchedule(std::shared_ptr<RequestSchedule> schedule);
+	/// <summary>
+	/// Set a throttle, which adjusts the request rate between bursts to hold the DTC's DDR3 buffers and the host ring
+	/// at a target occupancy (see RequestThrottle). It starts from its own initial rate, replacing the request rate and
+	/// delayBetweenDataRequests, and is not used with a request schedule. Its report (e.g. the maximum sustainable rate)
+	/// is final once the requests have all been sent. During a range, the new throttle is used from the next range.
+	/// </summary>
+	/// <param name="throttle">Request throttle (nullptr: open loop)</param>
+	void setThrottle(std::shared_ptr<RequestThrottle> throttle);
+	/// <summary>
+	/// Get the requested and achieved rate of the last software request range. The report is taken under the pacer's
+	/// lock, so it can be read while the requests run; it is final once the requests have all been sent (see
+	/// WaitForCompletion).
+	/// </summary>
+	/// <returns>Rate report, in event windows</returns>
+	RequestPacerReport GetRateReport() const { return pacer_.GetReport(); }
+	/// <summary>
+	/// Format the requested and achieved rate of the last software request range
+	/// </summary>
+	/// <returns>One-line rate report</returns>
+	std::string FormatRateReport() const { return pacer_.FormatReport(); }
+
+	/// <summary>
+	/// Pause the software requests, after the current burst
+	/// </summary>
+	void Pause() { generator_.Pause(); }
+	/// <summary>
+	/// Resume paused software requests. The pacing restarts from the next burst, so the paused time is not caught up.
+	/// </summary>
+	void Resume() { generator_.Resume(); }
+	/// <summary>
+	/// Cancel the software requests after the current burst, without the trailing heartbeats. Use WaitForCompletion to
+	/// wait for the request thread to stop.
+	/// </summary>
+	void Cancel() { generator_.Cancel(); }
+	/// <summary>
+	/// Whether software requests are being sent (or are paused)
+	/// </summary>
+	/// <returns>True until the request thread has finished</returns>
+	bool IsActive() const { return generator_.IsActive(); }
+	/// <summary>
+	/// Get the progress of the software requests: state, event windows requested, current tag and achieved rate. The
+	/// counters are atomic, so they can be read while the requests run.
+	/// </summary>
+	/// <returns>Progress of the current or last range</returns>
+	RequestGeneratorProgress GetProgress() const { return generator_.GetProgress(); }
+	/// <summary>
+	/// Format the progress of the software requests
+	/// </summary>
+	/// <returns>One-line progress report</returns>
+	std::string FormatProgress() const { return generator_.FormatProgress(); }
+
+	/// <summary>
+	/// Blocks until all ReadoutRequest packets have been sent, or the requests were cancelled
 	/// </summary>
 	void WaitForRequestsToBeSent() const;
+	/// <summary>
+	/// Blocks until the request thread has sent all of its requests (or was cancelled)
+	/// </summary>
+	void WaitForCompletion();
 
 	/// <summary>
 	/// Get a pointer to the DTC instance
@@ -129,6 +220,16 @@ private:
 
 	void SendRequestsForListImplAsync(std::set<DTC_EventWindowTag> timestamps, uint32_t delayBetweenDataRequests = 0, uint32_t heartbeatsAfter = 16);
 
+	void Run_(std::function<void()> requests);
+	bool Continue_();
+	void StartPacer_(uint32_t delayBetweenDataRequests);
+	void ApplyRate_();
+	bool NextWindow_(int index, int count, bool increment, RequestScheduleEntry& entry);
+	void Pace_(const RequestScheduleEntry& first, int windows);
+	static DTC_EventWindowTag Tag_(DTC_EventWindowTag start, const RequestScheduleEntry& entry);
+	void AddHeartbeats_(std::vector<DTC_DataPacket>& packets, DTC_EventWindowTag ts);
+	void AddDataRequests_(std::vector<DTC_DataPacket>& packets, DTC_EventWindowTag ts);
+
 	// Request Parameters
 	bool useCFOEmulator_;
 	uint16_t debugPacketCount_;
@@ -137,13 +238,31 @@ private:
 	bool quiet_;  // Don't print as much
 	bool asyncRR_;
 	bool forceNoDebug_;
+	size_t burstSize_;
+	double requestRate_;
+	std::shared_ptr<RequestSchedule> schedule_;
+	std::shared_ptr<RequestThrottle> throttle_;
 
 	// Object basic properties (not accessible)
 	DTC* theDTC_;
 	DTC_LinkEnableMode linkMode_[6];
-	std::unique_ptr<std::thread> theThread_;
 	std::atomic<bool> requestsSent_;
-	std::atomic<bool> abort_;
+	RequestPacer pacer_;
+
+	// State of the range in the request thread; changes posted to the generator are applied there, between bursts
+	bool running_;
+	uint32_t delayBetweenDataRequests_;
+	std::shared_ptr<RequestSchedule> nextSchedule_;  ///< Schedule for the next range, set during an asynchronous range
+	bool scheduleChanged_;
+	std::optional<size_t> nextBurstSize_;                        ///< Burst size for the next range, set during a range
+	std::optional<std::shared_ptr<RequestThrottle>> nextThrottle_;  ///< Throttle for the next range, set during a range
+	bool rebase_;                              ///< The pattern changed: restart the pacing and continue the tags
+	uint64_t tagOffset_;                       ///< Tag offset of the first window of the current pattern
+	uint64_t nextTag_;                         ///< Tag offset after the last window
+	int indexBase_;                            ///< Index of the first window of the current pattern
+	std::chrono::nanoseconds scheduleShift_;   ///< Start of the current schedule, plus pauses, from the pacer start
+
+	RequestGenerator generator_;  ///< Last, so that its thread stops before the rest is destroyed
 };
 }  // namespace DTCLib
 #endif  // ifndef DTCSOFTWARECFO_H
@@ -0,0 +1,219 @@
+#ifndef DTC_REGISTERTABLE_H
+#define DTC_REGISTERTABLE_H
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "DTC_Registers.h"
+
+namespace DTCLib {
+
+/// <summary>
+/// Software access type of a register field
+/// </summary>
+enum DTC_RegisterAccess : uint8_t
+{
+	DTC_RegisterAccess_ReadOnly,
+	DTC_RegisterAccess_ReadWrite,
+	DTC_RegisterAccess_WriteOnly,  ///< Self-clearing, reads back as 0
+};
+
+/// <summary>
+/// Description of one field of a DTC register: where it is, how it may be accessed and what it means.
+/// Fields which repeat per link have one entry per link, with the same name and the link index set.
+/// </summary>
+struct DTC_RegisterField
+{
+	uint16_t address = 0;
+	uint8_t offset = 0;  ///< Index of the lowest bit of the field
+	uint8_t width = 0;   ///< Width of the field, in bits
+	DTC_RegisterAccess access = DTC_RegisterAccess_ReadOnly;
+	int8_t link = -1;  ///< Link the field belongs to, -1 for fields which are not per-link
+	const char* name = "";
+	const char* description = "";
+
+	/// <summary>
+	/// Get the mask of the field within the register
+	/// </summary>
+	/// <returns>Mask with the bits of the field set</returns>
+	constexpr uint32_t Mask() const { return (width >= 32 ? 0xFFFFFFFFu : ((1u << width) - 1)) << offset; }
+	/// <summary>
+	/// Extract the field from a register value
+	/// </summary>
+	/// <param name="registerValue">Value of the whole register</param>
+	/// <returns>Value of the field</returns>
+	constexpr uint32_t Extract(uint32_t registerValue) const { return (registerValue & Mask()) >> offset; }
+	/// <summary>
+	/// Insert a field value into a register value
+	/// </summary>
+	/// <param name="registerValue">Value of the whole register</param>
+	/// <param name="fieldValue">New value of the field (bits beyond the width are ignored)</param>
+	/// <returns>New value of the whole register</returns>
+	constexpr uint32_t Insert(uint32_t registerValue, uint32_t fieldValue) const
+	{
+		return (registerValue & ~Mask()) | ((fieldValue << offset) & Mask());
+	}
+};
+
+#ifndef SWIG
+namespace RegisterTableDetail {
+constexpr bool NamesEqual(const char* a, const char* b)
+{
+	while (*a != '\0' && *a == *b)
+	{
+		++a;
+		++b;
+	}
+	return *a == *b;
+}
+
+constexpr DTC_RegisterField Field(uint16_t address, uint8_t offset, uint8_t width, DTC_RegisterAccess access, const char* name,
+								  const char* description, int8_t link = -1)
+{
+	DTC_RegisterField field;
+	field.address = address;
+	field.offset = offset;
+	field.width = width;
+	field.access = access;
+	field.link = link;
+	field.name = name;
+	field.description = description;
+	return field;
+}
+
+constexpr size_t FieldCount = 22 + 16 + 18 + 8;
+
+constexpr std::array<DTC_RegisterField, FieldCount> MakeFields()
+{
+	std::array<DTC_RegisterField, FieldCount> fields{};
+	size_t ii = 0;
+
+	// DTC Control register
+	constexpr uint16_t control = CFOandDTC_Register_Control;
+	fields[ii++] = Field(control, 31, 1, DTC_RegisterAccess_WriteOnly, "SoftReset", "DTC Soft Reset (Self-clearing)");
+	fields[ii++] = Field(control, 30, 1, DTC_RegisterAccess_ReadWrite, "CFOEmulationEnable", "CFO Emulation Enable");
+	fields[ii++] = Field(control, 28, 1, DTC_RegisterAccess_ReadWrite, "CFOLinkOutputControl", "CFO Link Timing Card not-in-Loopback");
+	fields[ii++] = Field(control, 27, 1, DTC_RegisterAccess_ReadWrite, "ResetDDRWriteAddress", "Reset DDR Write Address");
+	fields[ii++] = Field(control, 24, 1, DTC_RegisterAccess_ReadWrite, "CFOEmulatorDRPEnable", "CFO Emulator DRP Enable");
+	fields[ii++] = Field(control, 23, 1, DTC_RegisterAccess_ReadWrite, "AutogenerateDRPEnable", "DTC Autogenerate DRP Enable");
+	fields[ii++] = Field(control, 19, 1, DTC_RegisterAccess_ReadWrite, "DownLED0", "Down LED 0");
+	fields[ii++] = Field(control, 18, 1, DTC_RegisterAccess_ReadWrite, "UpLED1", "Up LED 1");
+	fields[ii++] = Field(control, 17, 1, DTC_RegisterAccess_ReadWrite, "UpLED0", "Up LED 0");
+	fields[ii++] = Field(control, 16, 1, DTC_RegisterAccess_ReadWrite, "LED7", "LED 7");
+	fields[ii++] = Field(control, 15, 1, DTC_RegisterAccess_ReadWrite, "CFOEmulationMode", "CFO Emulation Mode");
+	fields[ii++] = Field(control, 13, 1, DTC_RegisterAccess_ReadWrite, "DataFilterEnable", "Data Filter Enable");
+	fields[ii++] = Field(control, 12, 1, DTC_RegisterAccess_ReadWrite, "DRPPrefetchEnable", "DRP Prefetch Enable");
+	fields[ii++] = Field(control, 10, 1, DTC_RegisterAccess_ReadWrite, "DropDataToEmulateEventBuilding", "Drop Subevent Data to Emulate Event Building");
+	fields[ii++] = Field(control, 9, 1, DTC_RegisterAccess_ReadWrite, "PunchEnable", "Punch Enable on RJ-45 Output");
+	fields[ii++] = Field(control, 8, 1, DTC_RegisterAccess_ReadWrite, "SERDESGlobalReset", "SERDES Global Reset");
+	fields[ii++] = Field(control, 6, 1, DTC_RegisterAccess_ReadWrite, "DoForceExternalCFOSampleEdge", "Do Force External CFO Sample Edge");
+	fields[ii++] = Field(control, 5, 1, DTC_RegisterAccess_ReadWrite, "ForceExternalCFOSampleEdgeSelect", "Force External CFO Sample Edge Select");
+	fields[ii++] = Field(control, 4, 1, DTC_RegisterAccess_ReadWrite, "FanoutClockInputSelect", "Fanout Clock Input Select");
+	fields[ii++] = Field(control, 3, 1, DTC_RegisterAccess_ReadWrite, "CFOEmulatorLoopbackTestLaunch", "CFO Emulator Loopback Test Launch Control");
+	fields[ii++] = Field(control, 2, 1, DTC_RegisterAccess_ReadWrite, "DCSEnable", "DCS Enable");
+	fields[ii++] = Field(control, 0, 1, DTC_RegisterAccess_WriteOnly, "HardReset", "DTC Hard Reset (Self-clearing)");
+
+	// Link Enable register: ROC links 0-5, CFO link (6) and EVB link (7)
+	for (int8_t link = 0; link < 8; ++link)
+	{
+		fields[ii++] = Field(CFOandDTC_Register_LinkEnable, link, 1, DTC_RegisterAccess_ReadWrite, "LinkTransmitEnable", "Transmit Enable", link);
+		fields[ii++] = Field(CFOandDTC_Register_LinkEnable, link + 8, 1, DTC_RegisterAccess_ReadWrite, "LinkReceiveEnable", "Receive Enable", link);
+	}
+
+	// ROC Emulation Enable register: one bit per link for each DTC_ROC_Emulation_Type
+	for (int8_t link = 0; link < 6; ++link)
+	{
+		fields[ii++] = Field(DTC_Register_ROCEmulationEnable, link, 1, DTC_RegisterAccess_ReadWrite, "ROCInternalEmulation", "Internal ROC Emulator", link);
+		fields[ii++] = Field(DTC_Register_ROCEmulationEnable, link + 6, 1, DTC_RegisterAccess_ReadWrite, "ROCFiberLoopbackEmulation", "Fiber-Loopback ROC Emulator", link);
+		fields[ii++] = Field(DTC_Register_ROCEmulationEnable, link + 12, 1, DTC_RegisterAccess_ReadWrite, "ROCExternalEmulation", "External ROC Emulator", link);
+	}
+
+	// SERDES Loopback Enable register: ROC links 0-5, CFO link (6) and EVB link (7)
+	for (int8_t link = 0; link < 8; ++link)
+		fields[ii++] = Field(CFOandDTC_Register_SERDES_LoopbackEnable, 3 * link, 3, DTC_RegisterAccess_ReadWrite, "SERDESLoopbackMode", "SERDES Loopback Mode", link);
+
+	if (ii != FieldCount) throw "FieldCount does not match the number of fields in the table";
+	return fields;
+}
+
+template <size_t N>
+constexpr bool FieldsValid(const std::array<DTC_RegisterField, N>& fields)
+{
+	for (size_t ii = 0; ii < N; ++ii)
+	{
+		if (fields[ii].width == 0 || fields[ii].offset + fields[ii].width > 32) return false;
+		for (size_t jj = ii + 1; jj < N; ++jj)
+		{
+			if (fields[ii].address == fields[jj].address && (fields[ii].Mask() & fields[jj].Mask()) != 0) return false;  // Overlap
+			if (fields[ii].link == fields[jj].link && NamesEqual(fields[ii].name, fields[jj].name)) return false;        // Duplicate
+		}
+	}
+	return true;
+}
+}  // namespace RegisterTableDetail
+
+/// <summary>
+/// Compile-time description of the DTC register fields. Entries are grouped by register.
+/// </summary>
+inline constexpr std::array<DTC_RegisterField, RegisterTableDetail::FieldCount> DTC_RegisterFields = RegisterTableDetail::MakeFields();
+
+static_assert(RegisterTableDetail::FieldsValid(DTC_RegisterFields),
+			  "DTC_RegisterFields contains overlapping, out-of-range or duplicate fields");
+
+/// <summary>
+/// Find a field in the register table. When evaluated at compile time, a missing field is a compile error.
+/// </summary>
+/// <param name="name">Name of the field</param>
+/// <param name="link">Link of the field, -1 for fields which are not per-link</param>
+/// <returns>Description of the field</returns>
+constexpr DTC_RegisterField DTC_FindRegisterField(const char* name, int link = -1)
+{
+	for (auto const& field : DTC_RegisterFields)
+		if (field.link == link && RegisterTableDetail::NamesEqual(field.name, name)) return field;
+	throw std::out_of_range("Register field not found in DTC_RegisterFields");
+}
+
+inline constexpr DTC_RegisterField DTC_Field_CFOEmulationEnable = DTC_FindRegisterField("CFOEmulationEnable");
+inline constexpr DTC_RegisterField DTC_Field_CFOEmulationMode = DTC_FindRegisterField("CFOEmulationMode");
+inline constexpr DTC_RegisterField DTC_Field_DataFilterEnable = DTC_FindRegisterField("DataFilterEnable");
+inline constexpr DTC_RegisterField DTC_Field_DRPPrefetchEnable = DTC_FindRegisterField("DRPPrefetchEnable");
+inline constexpr DTC_RegisterField DTC_Field_PunchEnable = DTC_FindRegisterField("PunchEnable");
+
+namespace RegisterTableDetail {
+template <size_t Links>
+constexpr std::array<DTC_RegisterField, Links> PerLinkFields(const char* name)
+{
+	std::array<DTC_RegisterField, Links> fields{};
+	for (size_t link = 0; link < Links; ++link) fields[link] = DTC_FindRegisterField(name, static_cast<int>(link));
+	return fields;
+}
+}  // namespace RegisterTableDetail
+
+/// <summary>
+/// Per-link fields, indexed by DTC_Link_ID and looked up when compiling, so that the per-link accessors only index
+/// an array. at() throws std::out_of_range for a link the register has no field for.
+/// </summary>
+inline constexpr auto DTC_Fields_LinkTransmitEnable = RegisterTableDetail::PerLinkFields<8>("LinkTransmitEnable");
+inline constexpr auto DTC_Fields_LinkReceiveEnable = RegisterTableDetail::PerLinkFields<8>("LinkReceiveEnable");
+inline constexpr auto DTC_Fields_SERDESLoopbackMode = RegisterTableDetail::PerLinkFields<8>("SERDESLoopbackMode");
+inline constexpr auto DTC_Fields_ROCInternalEmulation = RegisterTableDetail::PerLinkFields<6>("ROCInternalEmulation");
+inline constexpr auto DTC_Fields_ROCFiberLoopbackEmulation = RegisterTableDetail::PerLinkFields<6>("ROCFiberLoopbackEmulation");
+inline constexpr auto DTC_Fields_ROCExternalEmulation = RegisterTableDetail::PerLinkFields<6>("ROCExternalEmulation");
+#endif  // SWIG
+
+/// <summary>
+/// Get the register table (for Python, where the constexpr table is not wrapped)
+/// </summary>
+/// <returns>Copy of DTC_RegisterFields</returns>
+std::vector<DTC_RegisterField> DTC_GetRegisterFieldTable();
+/// <summary>
+/// Get the addresses of all registers in the register table, e.g. for CFOandDTC_Registers::TakeRegisterSnapshot
+/// </summary>
+/// <returns>Register addresses, in ascending order</returns>
+std::vector<uint16_t> DTC_GetRegisterTableAddresses();
+
+}  // namespace DTCLib
+
+#endif  // DTC_REGISTERTABLE_H
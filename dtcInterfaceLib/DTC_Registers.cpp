@@ -1,6 +1,9 @@
 #include "DTC_Registers.h"
+#include "DTC_RegisterTable.h"
+#include "RegisterAccessProfiler.h"
 
 #include <assert.h>
+#include <algorithm>
 #include <unistd.h>
 #include <chrono>
 #include <cmath>
@@ -55,7 +58,15 @@ DTCLib::DTC_Registers::DTC_Registers(DTC_SimMode mode, int dtc, std::string simF
 			dtc = 0;
 	}
 
-	SetSimMode(expectedDesignVersion, simMode_, dtc, simFileName, rocMask, skipInit, (uid == "" ? ("DTC" + std::to_string(dtc)) : uid));
+	// Tools can check the configuration of a card without touching it
+	auto verifyOnly = getenv("DTCLIB_INIT_VERIFY_ONLY") != nullptr;
+
+	{
+		BringUpTimeline::Recording recording(&bringUpTimeline_);
+		SetSimMode(expectedDesignVersion, simMode_, dtc, simFileName, rocMask, skipInit, (uid == "" ? ("DTC" + std::to_string(dtc)) : uid),
+				   verifyOnly);
+	}
+	ReportBringUpTimeline_();
 }  // end constructor()
 
 /// <summary>
@@ -79,19 +90,26 @@ DTCLib::DTC_Registers::~DTC_Registers()
 /// <param name="simMemoryFile">Name to use for simulated DTC memory file, if needed</param>
 /// <param name="rocMask">Default 0x1; The initially-enabled links. Each digit corresponds to a link, so all links = 0x111111</param>
 /// <param name="skipInit">Whether to skip initializing the DTC using the SimMode. Used to read state.</param>
+/// <param name="verifyOnly">Only compare the registers to the SimMode configuration and log the differences, without writing</param>
 /// <returns></returns>
 DTCLib::DTC_SimMode DTCLib::DTC_Registers::SetSimMode(std::string expectedDesignVersion, DTC_SimMode mode, int dtc, std::string simMemoryFile,
-													  unsigned rocMask, bool skipInit, const std::string& uid)
+													  unsigned rocMask, bool skipInit, const std::string& uid, bool verifyOnly)
 {
+	BringUpPhaseScope phase("DTC SetSimMode", &device_);
 	simMode_ = mode;
 	TLOG(TLVL_INFO) << "Initializing DTC device, sim mode is " << DTC_SimModeConverter(simMode_).toString() << " for uid = " << uid << ", deviceIndex = " << dtc;
 
 	device_.init(simMode_, dtc, simMemoryFile, uid);
-	if (expectedDesignVersion != "" && expectedDesignVersion != ReadDesignVersion())
+	ClearRegisterCache();  // The cached values belong to the previously opened device
+	if (expectedDesignVersion != "")
 	{
-		__SS__ << "Version mismatch! Expected DTC version is '" << expectedDesignVersion << "' while the readback version was '" << ReadDesignVersion() << ".'" << __E__;
-		__SS_THROW__;
-		// throw new DTC_WrongVersionException(expectedDesignVersion, ReadDesignVersion());
+		BringUpPhaseScope versionPhase("Design version check", &device_);
+		if (expectedDesignVersion != ReadDesignVersion())
+		{
+			__SS__ << "Version mismatch! Expected DTC version is '" << expectedDesignVersion << "' while the readback version was '" << ReadDesignVersion() << ".'" << __E__;
+			__SS_THROW__;
+			// throw new DTC_WrongVersionException(expectedDesignVersion, ReadDesignVersion());
+		}
 	}
 
 	// if (skipInit || true)
@@ -101,67 +119,230 @@ DTCLib::DTC_SimMode DTCLib::DTC_Registers::SetSimMode(std::string expectedDesign
 		return simMode_;
 	}
 
+	if (verifyOnly)
+	{
+		auto differences = ConfigureForSimMode_(rocMask, true);
+		__COUT__ << "Verified device registers against sim mode " << DTC_SimModeConverter(simMode_).toString() << ": "
+				 << differences.size() << " registers differ";
+		for (auto const& difference : differences)
+			__COUT__ << "Register 0x" << std::hex << difference.address << " is 0x" << difference.current << ", sim mode needs 0x"
+					 << difference.target;
+		return simMode_;
+	}
+
 	__COUT__ << "Initialize requested, setting device registers acccording to sim mode " << DTC_SimModeConverter(simMode_).toString();
+	auto writes = ConfigureForSimMode_(rocMask, false).size();
 
-	TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up DTC links...";
-	for (auto link : DTC_ROC_Links)
-	{
-		bool linkEnabled = ((rocMask >> (link * 4)) & 0x1) != 0;
-		if (!linkEnabled)
-		{
-			TLOG(TLVL_Detail) << __COUT_HDR__ << "Disabling Link " << (int)link;
-			DisableLink(link);
+	__COUT__ << "Done setting device registers (" << writes << " register writes)";
+	return simMode_;
+}
 
-			DisableROCEmulator(link);
-			SetSERDESLoopbackMode(link, DTC_SERDESLoopbackMode_Disabled);
-		}
-		else
-		{
-			TLOG(TLVL_Detail) << __COUT_HDR__ << "Enabling Link " << (int)link;
-			EnableLink(link, DTC_LinkEnableMode(true, true));
-		}
+/// <summary>
+/// Compare the link and emulation registers to the given ROC mask and the current sim mode, without writing anything
+/// </summary>
+/// <param name="rocMask">The enabled links. Each digit corresponds to a link, so all links = 0x111111</param>
+/// <returns>Registers which differ from the configuration, with their current and needed values</returns>
+std::vector<DTCLib::RegisterDifference> DTCLib::DTC_Registers::VerifySimMode(unsigned rocMask)
+{
+	return ConfigureForSimMode_(rocMask, true);
+}
+
+/// <summary>
+/// Bring the link and emulation registers into the configuration of the current sim mode. The registers are read in one
+/// snapshot, the configuration is applied to a RegisterTransaction, and only the registers whose value changes are written.
+/// </summary>
+/// <param name="rocMask">The enabled links. Each digit corresponds to a link, so all links = 0x111111</param>
+/// <param name="verifyOnly">If true, nothing is written</param>
+/// <returns>Registers which differed from the configuration (and were written, unless verifyOnly)</returns>
+std::vector<DTCLib::RegisterDifference> DTCLib::DTC_Registers::ConfigureForSimMode_(unsigned rocMask, bool verifyOnly)
+{
+	RegisterAccessTag tag("SetSimMode");
+	auto addresses = DTC_GetRegisterTableAddresses();
+	addresses.push_back(CFOandDTC_Register_DMATransferLength);
+	RegisterSnapshot snapshot;
+	{
+		BringUpPhaseScope phase("Register snapshot", &device_);
+		snapshot = TakeRegisterSnapshot(addresses);
 	}
+	UseRegisterSnapshot(&snapshot);
 
-	if (simMode_ != DTC_SimMode_Disabled)
+	std::vector<RegisterDifference> differences;
+	try
 	{
-		TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up simulation modes in Hardware...";
-		// Set up hardware simulation mode: Link 0 Tx/Rx Enabled, Loopback Enabled, ROC Emulator Enabled. All other links
-		// disabled. for (auto link : DTC_ROC_Links)
-		// 	{
-		// 	  DisableLink(link);
-		// 	}
-		//	EnableLink(DTC_Link_0, DTC_LinkEnableMode(true, true, false), DTC_ROC_0);
+		RegisterTransaction transaction(this);
+
+		TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up DTC links...";
 		for (auto link : DTC_ROC_Links)
 		{
-			if (simMode_ == DTC_SimMode_Loopback)
+			bool linkEnabled = ((rocMask >> (link * 4)) & 0x1) != 0;
+			if (!linkEnabled)
 			{
-				TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up simulation of Loopback in Hardware... Link " << (int)link;
-				SetSERDESLoopbackMode(link, DTC_SERDESLoopbackMode_NearPCS);
-				//			SetMaxROCNumber(DTC_Link_0, DTC_ROC_0);
+				TLOG(TLVL_Detail) << __COUT_HDR__ << "Disabling Link " << (int)link;
+				DisableLink(link);
+
+				DisableROCEmulator(link);
+				SetSERDESLoopbackMode(link, DTC_SERDESLoopbackMode_Disabled);
 			}
-			else if (simMode_ == DTC_SimMode_ROCEmulator)
+			else
 			{
-				TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up simulation of ROC in Hardware... Link " << (int)link;
-				EnableROCEmulator(link);
-				// SetMaxROCNumber(DTC_Link_0, DTC_ROC_0);
+				TLOG(TLVL_Detail) << __COUT_HDR__ << "Enabling Link " << (int)link;
+				EnableLink(link, DTC_LinkEnableMode(true, true));
 			}
-			else
+		}
+
+		if (simMode_ != DTC_SimMode_Disabled)
+		{
+			TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up simulation modes in Hardware...";
+			// Set up hardware simulation mode: Link 0 Tx/Rx Enabled, Loopback Enabled, ROC Emulator Enabled. All other links
+			// disabled. for (auto link : DTC_ROC_Links)
+			// 	{
+			// 	  DisableLink(link);
+			// 	}
+			//	EnableLink(DTC_Link_0, DTC_LinkEnableMode(true, true, false), DTC_ROC_0);
+			for (auto link : DTC_ROC_Links)
 			{
-				TLOG(TLVL_Detail) << __COUT_HDR__ << "Turning off simulation in Hardware... Link " << (int)link;
-				SetSERDESLoopbackMode(link, DTC_SERDESLoopbackMode_Disabled);
-				DisableROCEmulator(link);
+				if (simMode_ == DTC_SimMode_Loopback)
+				{
+					TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up simulation of Loopback in Hardware... Link " << (int)link;
+					SetSERDESLoopbackMode(link, DTC_SERDESLoopbackMode_NearPCS);
+					//			SetMaxROCNumber(DTC_Link_0, DTC_ROC_0);
+				}
+				else if (simMode_ == DTC_SimMode_ROCEmulator)
+				{
+					TLOG(TLVL_Detail) << __COUT_HDR__ << "Setting up simulation of ROC in Hardware... Link " << (int)link;
+					EnableROCEmulator(link);
+					// SetMaxROCNumber(DTC_Link_0, DTC_ROC_0);
+				}
+				else
+				{
+					TLOG(TLVL_Detail) << __COUT_HDR__ << "Turning off simulation in Hardware... Link " << (int)link;
+					SetSERDESLoopbackMode(link, DTC_SERDESLoopbackMode_Disabled);
+					DisableROCEmulator(link);
+				}
 			}
+			SetCFOEmulationMode();
 		}
-		SetCFOEmulationMode();
+		else
+		{
+			ClearCFOEmulationMode();
+		}
+		ReadMinDMATransferLength();
+
+		BringUpPhaseScope phase(verifyOnly ? "Verify register configuration" : "Write register configuration", &device_);
+		differences = transaction.GetPendingWrites();
+		if (verifyOnly)
+			transaction.Abort();
+		else
+			transaction.Commit();
 	}
-	else
+	catch (...)
 	{
-		ClearCFOEmulationMode();
+		UseRegisterSnapshot(nullptr);
+		throw;
 	}
-	ReadMinDMATransferLength();
+	UseRegisterSnapshot(nullptr);
+	return differences;
+}
 
-	__COUT__ << "Done setting device registers";
-	return simMode_;
+namespace {
+// Register table fields of each DTC_ROC_Emulation_Type, per link
+const std::array<DTCLib::DTC_RegisterField, 6>& ROCEmulationFields(DTCLib::DTC_ROC_Emulation_Type const& type)
+{
+	switch (type)
+	{
+		case DTCLib::DTC_ROC_Emulation_Type::ROC_FiberLoopback_Emulation:
+			return DTCLib::DTC_Fields_ROCFiberLoopbackEmulation;
+		case DTCLib::DTC_ROC_Emulation_Type::ROC_External_Emulation:
+			return DTCLib::DTC_Fields_ROCExternalEmulation;
+		default:
+			return DTCLib::DTC_Fields_ROCInternalEmulation;
+	}
+}
+}  // namespace
+
+std::vector<DTCLib::DTC_RegisterField> DTCLib::DTC_GetRegisterFieldTable()
+{
+	return std::vector<DTC_RegisterField>(DTC_RegisterFields.begin(), DTC_RegisterFields.end());
+}
+
+/// <summary>
+/// List the fields the register table describes for a register, for register dump layouts
+/// </summary>
+/// <param name="address">Register address</param>
+/// <param name="fields">Fields of the register, appended to</param>
+void DTCLib::DTC_Registers::DescribeRegisterDumpFields_(uint16_t address, std::vector<RegisterDumpField>& fields)
+{
+	for (auto const& tableField : DTC_RegisterFields)
+	{
+		if (tableField.address != address) continue;
+		RegisterDumpField field;
+		field.name = tableField.name;
+		field.offset = tableField.offset;
+		field.width = tableField.width;
+		field.link = tableField.link;
+		fields.push_back(field);
+	}
+}
+
+std::vector<uint16_t> DTCLib::DTC_GetRegisterTableAddresses()
+{
+	std::vector<uint16_t> addresses;
+	for (auto const& field : DTC_RegisterFields) addresses.push_back(field.address);
+	std::sort(addresses.begin(), addresses.end());
+	addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+	return addresses;
+}
+
+/// <summary>
+/// Read a field described in the register table
+/// </summary>
+/// <param name="field">Field to read</param>
+/// <param name="val">Register value to decode instead of reading the register</param>
+/// <returns>Value of the field</returns>
+uint32_t DTCLib::DTC_Registers::ReadRegisterField(const DTC_RegisterField& field, std::optional<uint32_t> val)
+{
+	return field.Extract(val.has_value() ? *val : ReadRegister_(field.address));
+}
+
+/// <summary>
+/// Write a field described in the register table (read-modify-write, so it joins an open RegisterTransaction)
+/// </summary>
+/// <param name="field">Field to write</param>
+/// <param name="value">Value of the field</param>
+void DTCLib::DTC_Registers::WriteRegisterField(const DTC_RegisterField& field, uint32_t value)
+{
+	if (field.access == DTC_RegisterAccess_ReadOnly)
+	{
+		__SS__ << "Cannot write read-only register field " << field.name << " of register 0x" << std::hex << field.address << __E__;
+		__SS_THROW__;
+	}
+	WriteRegister_(field.Insert(ReadRegister_(field.address), value), field.address);
+}
+
+/// <summary>
+/// Formats a register for register dumps from the fields the register table describes for it
+/// </summary>
+/// <param name="address">Register to format</param>
+/// <param name="description">Description of the register</param>
+/// <returns>RegisterFormatter object containing register information</returns>
+DTCLib::RegisterFormatter DTCLib::DTC_Registers::FormatRegisterFields(uint16_t address, const std::string& description)
+{
+	auto form = CreateFormatter(address);
+	form.description = description;
+	form.vals.push_back("([ x = 1 (hi) ])");  // translation
+	for (auto const& field : DTC_RegisterFields)
+	{
+		if (field.address != address) continue;
+		std::ostringstream o;
+		if (field.link >= 0) o << "Link " << static_cast<int>(field.link) << " ";
+		o << field.description << ": ";
+		if (field.width == 1)
+			o << "[" << (field.Extract(form.value) ? "x" : " ") << "]";
+		else
+			o << "0x" << std::hex << field.Extract(form.value);
+		form.vals.push_back(o.str());
+	}
+	return form;
 }
 
 /// <summary>
@@ -226,9 +407,7 @@ DTCLib::RegisterFormatter DTCLib::DTC_Registers::FormatDesignStatus()
 /// </summary>
 void DTCLib::DTC_Registers::EnableCFOEmulation()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[30] = 1;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_CFOEmulationEnable, 1);
 }
 
 /// <summary>
@@ -236,9 +415,7 @@ void DTCLib::DTC_Registers::EnableCFOEmulation()
 /// </summary>
 void DTCLib::DTC_Registers::DisableCFOEmulation()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[30] = 0;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_CFOEmulationEnable, 0);
 }
 
 /// <summary>
@@ -247,8 +424,7 @@ void DTCLib::DTC_Registers::DisableCFOEmulation()
 /// <returns>True if the emulator is enabled, false otherwise</returns>
 bool DTCLib::DTC_Registers::ReadCFOEmulationEnabled(std::optional<uint32_t> val)
 {
-	std::bitset<32> dataSet = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_Control);
-	return dataSet[30];
+	return ReadRegisterField(DTC_Field_CFOEmulationEnable, val);
 }
 
 /// <summary>
@@ -644,9 +820,7 @@ bool DTCLib::DTC_Registers::ReadLED6State(std::optional<uint32_t> val)
 /// </summary>
 void DTCLib::DTC_Registers::SetCFOEmulationMode()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[15] = 1;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_CFOEmulationMode, 1);
 }
 
 /// <summary>
@@ -654,9 +828,7 @@ void DTCLib::DTC_Registers::SetCFOEmulationMode()
 /// </summary>
 void DTCLib::DTC_Registers::ClearCFOEmulationMode()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[15] = 0;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_CFOEmulationMode, 0);
 }
 
 /// <summary>
@@ -665,48 +837,37 @@ void DTCLib::DTC_Registers::ClearCFOEmulationMode()
 /// <returns>Whether CFO Emulation Mode is enabled</returns>
 bool DTCLib::DTC_Registers::ReadCFOEmulationMode(std::optional<uint32_t> val)
 {
-	std::bitset<32> data = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_Control);
-	return data[15];
+	return ReadRegisterField(DTC_Field_CFOEmulationMode, val);
 }
 
 void DTCLib::DTC_Registers::SetDataFilterEnable()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[13] = 1;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_DataFilterEnable, 1);
 }
 
 void DTCLib::DTC_Registers::ClearDataFilterEnable()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[13] = 0;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_DataFilterEnable, 0);
 }
 
 bool DTCLib::DTC_Registers::ReadDataFilterEnable(std::optional<uint32_t> val)
 {
-	std::bitset<32> data = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_Control);
-	return data[13];
+	return ReadRegisterField(DTC_Field_DataFilterEnable, val);
 }
 
 void DTCLib::DTC_Registers::SetDRPPrefetchEnable()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[12] = 1;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_DRPPrefetchEnable, 1);
 }
 
 void DTCLib::DTC_Registers::ClearDRPPrefetchEnable()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[12] = 0;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_DRPPrefetchEnable, 0);
 }
 
 bool DTCLib::DTC_Registers::ReadDRPPrefetchEnable(std::optional<uint32_t> val)
 {
-	std::bitset<32> data = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_Control);
-	return data[12];
+	return ReadRegisterField(DTC_Field_DRPPrefetchEnable, val);
 }
 
 void DTCLib::DTC_Registers::ROCInterfaceSoftReset()
@@ -748,22 +909,17 @@ bool DTCLib::DTC_Registers::ReadDropDataToEmulateEventBuilding(std::optional<uin
 
 void DTCLib::DTC_Registers::SetPunchEnable()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[9] = 1;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_PunchEnable, 1);
 }
 
 void DTCLib::DTC_Registers::ClearPunchEnable()
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_Control);
-	data[9] = 0;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_Control);
+	WriteRegisterField(DTC_Field_PunchEnable, 0);
 }
 
 bool DTCLib::DTC_Registers::ReadPunchEnable(std::optional<uint32_t> val)
 {
-	std::bitset<32> data = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_Control);
-	return data[9];
+	return ReadRegisterField(DTC_Field_PunchEnable, val);
 }
 
 void DTCLib::DTC_Registers::SetExternalCFOSampleEdgeMode(int forceCFOedge)
@@ -835,9 +991,7 @@ bool DTCLib::DTC_Registers::ReadDCSReception(std::optional<uint32_t> val)
 /// <returns>RegisterFormatter object containing register information</returns>
 DTCLib::RegisterFormatter DTCLib::DTC_Registers::FormatDTCControl()
 {
-	auto form = CreateFormatter(CFOandDTC_Register_Control);
-	form.description = "DTC Control";
-	form.vals.push_back("([ x = 1 (hi) ])");
+	auto form = FormatRegisterFields(CFOandDTC_Register_Control, "DTC Control");
 
 	// ~~~	DTC Control Register (0x9100) ~~~
 	// Bit Position	Mode	Default Value	Description
@@ -978,12 +1132,7 @@ DTCLib::RegisterFormatter DTCLib::DTC_Registers::FormatDMATransferLength()
 /// <param name="mode">DTC_SERDESLoopbackMode to set</param>
 void DTCLib::DTC_Registers::SetSERDESLoopbackMode(DTC_Link_ID const& link, const DTC_SERDESLoopbackMode& mode)
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_SERDES_LoopbackEnable);
-	std::bitset<3> modeSet = mode;
-	data[3 * link] = modeSet[0];
-	data[3 * link + 1] = modeSet[1];
-	data[3 * link + 2] = modeSet[2];
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_SERDES_LoopbackEnable);
+	WriteRegisterField(DTC_Fields_SERDESLoopbackMode.at(link), mode);
 }
 
 /// <summary>
@@ -993,8 +1142,7 @@ void DTCLib::DTC_Registers::SetSERDESLoopbackMode(DTC_Link_ID const& link, const
 /// <returns>DTC_SERDESLoopbackMode of the link</returns>
 DTCLib::DTC_SERDESLoopbackMode DTCLib::DTC_Registers::ReadSERDESLoopback(DTC_Link_ID const& link, std::optional<uint32_t> val)
 {
-	std::bitset<3> dataSet = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_SERDES_LoopbackEnable) >> 3 * link;
-	return static_cast<DTC_SERDESLoopbackMode>(dataSet.to_ulong());
+	return static_cast<DTC_SERDESLoopbackMode>(ReadRegisterField(DTC_Fields_SERDESLoopbackMode.at(link), val));
 }
 
 /// <summary>
@@ -1060,14 +1208,13 @@ DTCLib::RegisterFormatter DTCLib::DTC_Registers::FormatClockOscillatorStatus()
 /// <param name="link">Link to enable</param>
 void DTCLib::DTC_Registers::EnableROCEmulator(DTC_Link_ID const& link, DTC_ROC_Emulation_Type const& type)
 {
-	std::bitset<32> dataSet = ReadRegister_(DTC_Register_ROCEmulationEnable);
+	RegisterTransaction transaction(this);
 	if (link == DTC_Link_ALL)
 		for (const auto& l : DTC_ROC_Links)
-			dataSet[l + type * 6] = 1;
+			WriteRegisterField(ROCEmulationFields(type).at(l), 1);
 	else
-		dataSet[link + type * 6] = 1;
-
-	WriteRegister_(dataSet.to_ulong(), DTC_Register_ROCEmulationEnable);
+		WriteRegisterField(ROCEmulationFields(type).at(link), 1);
+	transaction.Commit();
 }
 
 /// <summary>
@@ -1076,14 +1223,13 @@ void DTCLib::DTC_Registers::EnableROCEmulator(DTC_Link_ID const& link, DTC_ROC_E
 /// <param name="link">Link to disable</param>
 void DTCLib::DTC_Registers::DisableROCEmulator(DTC_Link_ID const& link, DTC_ROC_Emulation_Type const& type)
 {
-	std::bitset<32> dataSet = ReadRegister_(DTC_Register_ROCEmulationEnable);
+	RegisterTransaction transaction(this);
 	if (link == DTC_Link_ALL)
 		for (const auto& l : DTC_ROC_Links)
-			dataSet[l + type * 6] = 0;
+			WriteRegisterField(ROCEmulationFields(type).at(l), 0);
 	else
-		dataSet[link + type * 6] = 0;
-
-	WriteRegister_(dataSet.to_ulong(), DTC_Register_ROCEmulationEnable);
+		WriteRegisterField(ROCEmulationFields(type).at(link), 0);
+	transaction.Commit();
 }
 
 /// <summary>
@@ -1099,8 +1245,7 @@ bool DTCLib::DTC_Registers::ReadROCEmulator(DTC_Link_ID const& link, DTC_ROC_Emu
 		__SS_THROW__;
 	}
 
-	std::bitset<32> dataSet = val.has_value() ? *val : ReadRegister_(DTC_Register_ROCEmulationEnable);
-	return dataSet[link + type * 6];
+	return ReadRegisterField(ROCEmulationFields(type)[link], val);
 }
 void DTCLib::DTC_Registers::SetROCEmulatorMask(uint32_t rocEnableMask)
 {
@@ -1171,10 +1316,10 @@ void DTCLib::DTC_Registers::DisableTransmitCFOLink()
 /// <param name="mode">Link enable bits to set (Default: All)</param>
 void DTCLib::DTC_Registers::EnableLink(DTC_Link_ID const& link, const DTC_LinkEnableMode& mode)
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_LinkEnable);
-	data[link] = mode.TransmitEnable;
-	data[link + 8] = mode.ReceiveEnable;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_LinkEnable);
+	RegisterTransaction transaction(this);
+	WriteRegisterField(DTC_Fields_LinkTransmitEnable.at(link), mode.TransmitEnable);
+	WriteRegisterField(DTC_Fields_LinkReceiveEnable.at(link), mode.ReceiveEnable);
+	transaction.Commit();
 }
 
 /// <summary>
@@ -1185,10 +1330,10 @@ void DTCLib::DTC_Registers::EnableLink(DTC_Link_ID const& link, const DTC_LinkEn
 /// <param name="mode">Link enable bits to unset (Default: All)</param>
 void DTCLib::DTC_Registers::DisableLink(DTC_Link_ID const& link, const DTC_LinkEnableMode& mode)
 {
-	std::bitset<32> data = ReadRegister_(CFOandDTC_Register_LinkEnable);
-	data[link] = data[link] && !mode.TransmitEnable;
-	data[link + 8] = data[link + 8] && !mode.ReceiveEnable;
-	WriteRegister_(data.to_ulong(), CFOandDTC_Register_LinkEnable);
+	RegisterTransaction transaction(this);
+	if (mode.TransmitEnable) WriteRegisterField(DTC_Fields_LinkTransmitEnable.at(link), 0);
+	if (mode.ReceiveEnable) WriteRegisterField(DTC_Fields_LinkReceiveEnable.at(link), 0);
+	transaction.Commit();
 }
 
 /// <summary>
@@ -1198,8 +1343,9 @@ void DTCLib::DTC_Registers::DisableLink(DTC_Link_ID const& link, const DTC_LinkE
 /// <returns>DTC_LinkEnableMode containing TX, RX, and CFO bits</returns>
 DTCLib::DTC_LinkEnableMode DTCLib::DTC_Registers::ReadLinkEnabled(DTC_Link_ID const& link, std::optional<uint32_t> val)
 {
-	std::bitset<32> dataSet = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_LinkEnable);
-	return DTC_LinkEnableMode(dataSet[link], dataSet[link + 8]);
+	auto data = val.has_value() ? *val : ReadRegister_(CFOandDTC_Register_LinkEnable);
+	return DTC_LinkEnableMode(ReadRegisterField(DTC_Fields_LinkTransmitEnable.at(link), data),
+							  ReadRegisterField(DTC_Fields_LinkReceiveEnable.at(link), data));
 }
 
 /// <summary>
@@ -2443,13 +2589,8 @@ void DTCLib::DTC_Registers::ResetDDROscillatorIICInterface()
 /// <param name="data">Data to write</param>
 void DTCLib::DTC_Registers::WriteDDRIICInterface(DTC_IICDDRBusAddress device, uint8_t address, uint8_t data)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16) + (data << 8);
-	WriteRegister_(reg_data, DTC_Register_DDRClock_IICBusLow);
-	WriteRegister_(0x1, DTC_Register_DDRClock_IICBusHigh);
-	while (ReadRegister_(DTC_Register_DDRClock_IICBusHigh) == 0x1)
-	{
-		usleep(1000);
-	}
+	auto& engine = GetIICEngine({DTC_Register_DDRClock_IICBusLow, DTC_Register_DDRClock_IICBusHigh});
+	engine.Write(static_cast<uint8_t>(device), address, data).get();
 }
 /// <summary>
 /// Read a value from the DDR IIC Bus
@@ -2459,15 +2600,8 @@ void DTCLib::DTC_Registers::WriteDDRIICInterface(DTC_IICDDRBusAddress device, ui
 /// <returns>Value of register</returns>
 uint8_t DTCLib::DTC_Registers::ReadDDRIICInterface(DTC_IICDDRBusAddress device, uint8_t address)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16);
-	WriteRegister_(reg_data, DTC_Register_DDRClock_IICBusLow);
-	WriteRegister_(0x2, DTC_Register_DDRClock_IICBusHigh);
-	while (ReadRegister_(DTC_Register_DDRClock_IICBusHigh) == 0x2)
-	{
-		usleep(1000);
-	}
-	auto data = ReadRegister_(DTC_Register_DDRClock_IICBusLow);
-	return static_cast<uint8_t>(data);
+	auto& engine = GetIICEngine({DTC_Register_DDRClock_IICBusLow, DTC_Register_DDRClock_IICBusHigh});
+	return engine.Read(static_cast<uint8_t>(device), address).get();
 }
 
 /// <summary>
@@ -4753,13 +4887,8 @@ void DTCLib::DTC_Registers::ResetSFPIICInterface()
 /// <param name="data">Data to write</param>
 void DTCLib::DTC_Registers::WriteSFPIICInterface(uint8_t device, uint8_t address, uint8_t data)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16) + (data << 8);
-	WriteRegister_(reg_data, DTC_Register_SFP_IICBusLow);
-	WriteRegister_(0x1, DTC_Register_SFP_IICBusHigh);
-	while (ReadRegister_(DTC_Register_SFP_IICBusHigh) == 0x1)
-	{
-		usleep(1000);
-	}
+	auto& engine = GetIICEngine({DTC_Register_SFP_IICBusLow, DTC_Register_SFP_IICBusHigh});
+	engine.Write(device, address, data).get();
 }
 /// <summary>
 /// Read a value from the SFP IIC Bus
@@ -4769,15 +4898,8 @@ void DTCLib::DTC_Registers::WriteSFPIICInterface(uint8_t device, uint8_t address
 /// <returns>Value of register</returns>
 uint8_t DTCLib::DTC_Registers::ReadSFPIICInterface(uint8_t device, uint8_t address)
 {
-	uint32_t reg_data = (static_cast<uint8_t>(device) << 24) + (address << 16);
-	WriteRegister_(reg_data, DTC_Register_SFP_IICBusLow);
-	WriteRegister_(0x2, DTC_Register_SFP_IICBusHigh);
-	while (ReadRegister_(DTC_Register_SFP_IICBusHigh) == 0x2)
-	{
-		usleep(1000);
-	}
-	auto data = ReadRegister_(DTC_Register_SFP_IICBusLow);
-	return static_cast<uint8_t>(data);
+	auto& engine = GetIICEngine({DTC_Register_SFP_IICBusLow, DTC_Register_SFP_IICBusHigh});
+	return engine.Read(device, address).get();
 }
 
 /// <summary>
@@ -6844,6 +6966,47 @@ std::bitset<128> DTCLib::DTC_Registers::ReadDDREventBuilderBufferHalfFullFlags()
 	return out;
 }
 
+DTCLib::DTC_DDRBufferStatus DTCLib::DTC_Registers::ReadDDRBufferStatus()
+{
+	// The 24 flag registers are contiguous from DTC_Register_DDR3LinkBufferEmptyFlags0, in the order of the bitsets
+	std::vector<uint16_t> addresses;
+	for (uint16_t address = DTC_Register_DDR3LinkBufferEmptyFlags0; address <= DTC_Register_DDR3EVBBufferFullFlags3; address += 4)
+		addresses.push_back(address);
+	addresses.push_back(DTC_Register_InputBufferDropCount);
+	addresses.push_back(DTC_Register_OutputBufferDropCount);
+	std::vector<uint32_t> values(addresses.size(), 0);
+
+	DTC_DDRBufferStatus status;
+	status.readDurationUs = ReadRegisterBlock_(addresses.data(), addresses.size(), values.data());
+
+	std::bitset<128>* flags[] = {&status.linkEmpty, &status.linkHalfFull, &status.linkFull,
+								 &status.eventBuilderEmpty, &status.eventBuilderHalfFull, &status.eventBuilderFull};
+	for (size_t flag = 0; flag < 6; ++flag)
+		for (size_t word = 0; word < 4; ++word)
+			for (size_t ii = 0; ii < 32; ++ii) (*flags[flag])[word * 32 + ii] = (values[flag * 4 + word] >> ii) & 0x1;
+	status.inputBufferDrops = values[24];
+	status.outputBufferDrops = values[25];
+	return status;
+}  // end ReadDDRBufferStatus()
+
+double DTCLib::DTC_DDRBufferStatus::GetFill() const
+{
+	auto fill = [](const std::bitset<128>& empty, const std::bitset<128>& halfFull, const std::bitset<128>& full) {
+		double buffers = 0;
+		for (size_t ii = 0; ii < 128; ++ii)
+		{
+			if (full[ii])
+				buffers += 1;
+			else if (halfFull[ii])
+				buffers += 0.75;
+			else if (!empty[ii])
+				buffers += 0.25;
+		}
+		return buffers / 128;
+	};
+	return std::max(fill(linkEmpty, linkHalfFull, linkFull), fill(eventBuilderEmpty, eventBuilderHalfFull, eventBuilderFull));
+}
+
 DTCLib::RegisterFormatter DTCLib::DTC_Registers::FormatDDRLinkBufferEmptyFlags0()
 {
 	auto form = CreateFormatter(DTC_Register_DDR3LinkBufferEmptyFlags0);
@@ -9104,6 +9267,69 @@ void DTCLib::DTC_Registers::WriteCurrentProgram(uint64_t program, DTC_Oscillator
 }
 
 // Private Functions
+DTCLib::RegisterCacheClass DTCLib::DTC_Registers::GetRegisterCacheClass_(const CFOandDTC_Register& address)
+{
+	switch (address)
+	{
+		//list the presets and emulator settings, which only software writes
+		case DTC_Register_ROCEmulationEnable:
+		case DTC_Register_DMATimeoutPreset:
+		case DTC_Register_ROCReplyTimeout:
+		case DTC_Register_EVBPartitionID:
+		case DTC_Register_EVBConfiguration:
+		case DTC_Register_SERDESTimingCardOscillatorFrequency:
+		case DTC_Register_SERDESReferenceClockFrequency:
+		case DTC_Register_DDRReferenceClockFrequency:
+		case DTC_Register_DataPendingTimer:
+		case DTC_Register_CFOEmulation_HeartbeatInterval:
+		case DTC_Register_CFOEmulation_NumNullHeartbeats:
+		case DTC_Register_CFOEmulation_EventMode1:
+		case DTC_Register_CFOEmulation_EventMode2:
+		case DTC_Register_CFOEmulation_DataRequestDelay:
+		case DTC_Register_CFOEmulation_40MHzClockMarkerInterval:
+		case DTC_Register_ROCEmulation_NumPacketsLinks10:
+		case DTC_Register_ROCEmulation_NumPacketsLinks32:
+		case DTC_Register_ROCEmulation_NumPacketsLinks54:
+		case DTC_Register_ROCFinishThreshold:
+		case DTC_Register_EthernetFramePayloadSize:
+		case DTC_Register_SERDESTXRXInvertEnable:
+		case DTC_Register_EVBSubEventReceiveTimerPreset:
+			return RegisterCacheClass_Configuration;
+		default:;
+	}
+	return CFOandDTC_Registers::GetRegisterCacheClass_(address);
+} //end GetRegisterCacheClass_()
+
+bool DTCLib::DTC_Registers::HasReadSideEffect_(const CFOandDTC_Register& address)
+{
+	switch (address)
+	{
+		//list the IIC data registers and the data ports
+		case DTC_Register_DDRClock_IICBusLow:
+		case DTC_Register_DDRClock_IICBusHigh:
+		case DTC_Register_SFP_IICBusLow:
+		case DTC_Register_SFP_IICBusHigh:
+		case DTC_Register_FPGAProgramData:
+		case DTC_Register_RXDataDiagnosticFIFO_Link0:  // The diagnostic FIFOs pop on read
+		case DTC_Register_RXDataDiagnosticFIFO_Link1:
+		case DTC_Register_RXDataDiagnosticFIFO_Link2:
+		case DTC_Register_RXDataDiagnosticFIFO_Link3:
+		case DTC_Register_RXDataDiagnosticFIFO_Link4:
+		case DTC_Register_RXDataDiagnosticFIFO_Link5:
+		case DTC_Register_TXDataDiagnosticFIFO_Link0:
+		case DTC_Register_TXDataDiagnosticFIFO_Link1:
+		case DTC_Register_TXDataDiagnosticFIFO_Link2:
+		case DTC_Register_TXDataDiagnosticFIFO_Link3:
+		case DTC_Register_TXDataDiagnosticFIFO_Link4:
+		case DTC_Register_TXDataDiagnosticFIFO_Link5:
+		case DTC_Register_RXDataDiagnosticFIFO_LinkCFO:
+		case DTC_Register_TXDataDiagnosticFIFO_LinkCFO:
+			return true;
+		default:;
+	}
+	return CFOandDTC_Registers::HasReadSideEffect_(address);
+} //end HasReadSideEffect_()
+
 void DTCLib::DTC_Registers::VerifyRegisterWrite_(const CFOandDTC_Register& address, uint32_t readbackValue, uint32_t dataToWrite)
 {
 	// verify register readback
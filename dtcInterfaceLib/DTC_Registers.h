@@ -339,6 +339,37 @@ enum DTC_Register : uint16_t
 // };
 }; // end DTC_Register enum
 
+struct DTC_RegisterField;  // Defined in DTC_RegisterTable.h
+
+/// <summary>
+/// DDR3 buffer flags and buffer drop counters, read together by DTC_Registers::ReadDDRBufferStatus
+/// </summary>
+struct DTC_DDRBufferStatus
+{
+	std::bitset<128> linkEmpty;
+	std::bitset<128> linkHalfFull;
+	std::bitset<128> linkFull;
+	std::bitset<128> eventBuilderEmpty;
+	std::bitset<128> eventBuilderHalfFull;
+	std::bitset<128> eventBuilderFull;
+	uint32_t inputBufferDrops = 0;   ///< Input Buffer Drop Count register
+	uint32_t outputBufferDrops = 0;  ///< Output Buffer Drop Count register
+	double readDurationUs = 0;
+
+	/// <summary>
+	/// Estimate the fill of the DDR3 memory from the flags: each buffer counts as 0 (empty), 1/4 (not empty), 3/4 (half
+	/// full) or 1 (full). The flags only resolve quarters of a buffer, so this is coarse for a single buffer but
+	/// tracks the memory as a whole.
+	/// </summary>
+	/// <returns>Fill of the fuller of the link and event building buffers, from 0 to 1</returns>
+	double GetFill() const;
+	/// <summary>
+	/// Get the number of buffers flagged full
+	/// </summary>
+	/// <returns>Full link and event building buffers</returns>
+	size_t GetFullBuffers() const { return linkFull.count() + eventBuilderFull.count(); }
+};
+
 /// <summary>
 /// The DTC_Registers class represents the DTC Register space, and all the methods necessary to read and write those
 /// registers. Each register has, at the very least, a read method, a write method, and a RegisterFormatter method
@@ -362,7 +393,15 @@ public:
 	DTC_SimMode GetSimMode() const { return simMode_; }
 
 	DTC_SimMode SetSimMode(std::string expectedDesignVersion, DTC_SimMode mode, int dtc, std::string simMemoryFile, unsigned linkMask,
-						   bool skipInit = false, const std::string& uid = "");
+						   bool skipInit = false, const std::string& uid = "", bool verifyOnly = false);
+	std::vector<RegisterDifference> VerifySimMode(unsigned linkMask);
+
+	//
+	// Register table access (fields described in DTC_RegisterTable.h)
+	//
+	uint32_t ReadRegisterField(const DTC_RegisterField& field, std::optional<uint32_t> val = std::nullopt);
+	void WriteRegisterField(const DTC_RegisterField& field, uint32_t value);
+	RegisterFormatter FormatRegisterFields(uint16_t address, const std::string& description);
 
 	//
 	// Register IO Functions
@@ -1054,6 +1093,12 @@ public:
 	std::bitset<128> ReadDDREventBuilderBufferFullFlags();
 	std::bitset<128> ReadDDREventBuilderBufferEmptyFlags();
 	std::bitset<128> ReadDDREventBuilderBufferHalfFullFlags();
+	/// <summary>
+	/// Read all DDR3 buffer flags and the input and output buffer drop counters in one bulk read, so that they are
+	/// consistent with each other (e.g. for RequestThrottle)
+	/// </summary>
+	/// <returns>Flags and drop counters</returns>
+	DTC_DDRBufferStatus ReadDDRBufferStatus();
 	RegisterFormatter FormatDDRLinkBufferEmptyFlags0();
 	RegisterFormatter FormatDDRLinkBufferEmptyFlags1();
 	RegisterFormatter FormatDDRLinkBufferEmptyFlags2();
@@ -1253,6 +1298,9 @@ public:
 
 private:
 	bool NeedToVerifyRegisterWrite_(const CFOandDTC_Register& /*address*/) override { return true; }
+	RegisterCacheClass GetRegisterCacheClass_(const CFOandDTC_Register& address) override;
+	bool HasReadSideEffect_(const CFOandDTC_Register& address) override;
+	void DescribeRegisterDumpFields_(uint16_t address, std::vector<RegisterDumpField>& fields) override;
 	void VerifyRegisterWrite_(const CFOandDTC_Register& address, uint32_t readbackValue, uint32_t dataToWrite) override;
 
 	int DecodeHighSpeedDivider_(int input);
@@ -1271,6 +1319,7 @@ private:
 	void SetDDROscillatorParameters_(uint64_t program);
 
 	bool WaitForLinkReady_(DTC_Link_ID const& link, size_t interval, double timeout = 2.0 /*seconds*/);
+	std::vector<RegisterDifference> ConfigureForSimMode_(unsigned rocMask, bool verifyOnly);
 
 protected:
 	DTC_SimMode simMode_;                ///< Simulation mode
@@ -0,0 +1,218 @@
+#include "IICEngine.h"
+#include "CFOandDTC_Registers.h"
+
+#include <algorithm>
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "IICEngine"
+
+#define TLVL_Transfer TLVL_DEBUG + 5
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+namespace {
+// Bit times on the bus, including start/stop conditions and the acknowledge bit of each byte:
+// a write sends the device address, the register address and the data;
+// a read sends the device and register addresses, a repeated start and the device address again, then receives the data
+constexpr uint32_t IICWriteBits = 3 * 9 + 2;
+constexpr uint32_t IICReadBits = 4 * 9 + 3;
+constexpr uint32_t IICCommandWrite = 0x1;
+constexpr uint32_t IICCommandRead = 0x2;
+
+std::chrono::microseconds BitTime(uint32_t bits, uint32_t busSpeedHz)
+{
+	return std::chrono::microseconds(static_cast<int64_t>(bits) * 1000000 / busSpeedHz);
+}
+}  // namespace
+
+DTCLib::IICEngine::IICEngine(CFOandDTC_Registers* registers, IICBus const& bus, uint32_t busSpeedHz, int timeoutMs)
+	: registers_(registers), bus_(bus), timeoutMs_(timeoutMs), busy_(false), stop_(false)
+{
+	if (busSpeedHz == 0) busSpeedHz = 100000;
+	writeTime_ = BitTime(IICWriteBits, busSpeedHz);
+	readTime_ = BitTime(IICReadBits, busSpeedHz);
+	// Poll twice per byte time: completion is noticed within half a byte of the end of the transaction
+	pollInterval_ = std::max(BitTime(9, busSpeedHz) / 2, std::chrono::microseconds(5));
+
+	workerThread_ = std::thread(&IICEngine::Run_, this);
+}
+
+DTCLib::IICEngine::~IICEngine() { Stop(); }
+
+void DTCLib::IICEngine::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	queueChanged_.notify_all();
+	if (workerThread_.joinable()) workerThread_.join();
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (auto& operation : queue_)
+	{
+		auto error = std::make_exception_ptr(std::runtime_error("IICEngine stopped before the IIC operation was run"));
+		if (operation.type == OperationType_Read)
+			operation.readDone.set_exception(error);
+		else
+			operation.done.set_exception(error);
+	}
+	queue_.clear();
+	idle_.notify_all();
+}
+
+std::future<void> DTCLib::IICEngine::Write(uint8_t device, uint8_t address, uint8_t data)
+{
+	return WriteSequence({MakeWord(device, address, data)});
+}
+
+std::future<uint8_t> DTCLib::IICEngine::Read(uint8_t device, uint8_t address)
+{
+	Operation operation;
+	operation.type = OperationType_Read;
+	operation.words.push_back(MakeWord(device, address));
+	auto future = operation.readDone.get_future();
+	Enqueue_(std::move(operation));
+	return future;
+}
+
+std::future<void> DTCLib::IICEngine::WriteSequence(std::vector<uint32_t> const& words)
+{
+	Operation operation;
+	operation.type = OperationType_Write;
+	operation.words = words;
+	auto future = operation.done.get_future();
+	Enqueue_(std::move(operation));
+	return future;
+}
+
+std::future<void> DTCLib::IICEngine::Delay(std::chrono::microseconds delay)
+{
+	Operation operation;
+	operation.type = OperationType_Delay;
+	operation.delay = delay;
+	auto future = operation.done.get_future();
+	Enqueue_(std::move(operation));
+	return future;
+}
+
+void DTCLib::IICEngine::Flush()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.wait(lock, [&]() { return (queue_.empty() && !busy_) || stop_; });
+}
+
+DTCLib::IICEngineStats DTCLib::IICEngine::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return stats_;
+}
+
+void DTCLib::IICEngine::Enqueue_(Operation&& operation)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!stop_)
+		{
+			queue_.push_back(std::move(operation));
+			queueChanged_.notify_one();
+			return;
+		}
+	}
+	auto error = std::make_exception_ptr(std::runtime_error("IICEngine is stopped, cannot queue IIC operation"));
+	if (operation.type == OperationType_Read)
+		operation.readDone.set_exception(error);
+	else
+		operation.done.set_exception(error);
+}
+
+void DTCLib::IICEngine::Run_()
+{
+	while (true)
+	{
+		Operation operation;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			queueChanged_.wait(lock, [&]() { return !queue_.empty() || stop_; });
+			if (stop_) return;
+			operation = std::move(queue_.front());
+			queue_.pop_front();
+			busy_ = true;
+		}
+
+		Execute_(operation);
+
+		std::lock_guard<std::mutex> lock(mutex_);
+		busy_ = false;
+		if (queue_.empty()) idle_.notify_all();
+	}
+}
+
+void DTCLib::IICEngine::Execute_(Operation& operation)
+{
+	try
+	{
+		switch (operation.type)
+		{
+			case OperationType_Delay:
+				std::this_thread::sleep_for(operation.delay);
+				operation.done.set_value();
+				break;
+			case OperationType_Write:
+				for (auto word : operation.words) Transfer_(word, IICCommandWrite);
+				operation.done.set_value();
+				break;
+			case OperationType_Read: {
+				Transfer_(operation.words.front(), IICCommandRead);
+				auto data = registers_->ReadRegister_(bus_.lowRegister);
+				operation.readDone.set_value(static_cast<uint8_t>(data));
+				break;
+			}
+		}
+	}
+	catch (...)
+	{
+		if (operation.type == OperationType_Read)
+			operation.readDone.set_exception(std::current_exception());
+		else
+			operation.done.set_exception(std::current_exception());
+	}
+}
+
+void DTCLib::IICEngine::Transfer_(uint32_t word, uint32_t command)
+{
+	TLOG(TLVL_Transfer) << "IIC " << (command == IICCommandRead ? "read" : "write") << " on bus 0x" << std::hex << bus_.lowRegister
+						<< ": 0x" << word;
+	// The register accessors throw if the device reports an error
+	registers_->WriteRegister_(word, bus_.lowRegister);
+	registers_->WriteRegister_(command, bus_.highRegister);
+
+	// Nothing to see until the bytes are on the wire
+	std::this_thread::sleep_for(command == IICCommandRead ? readTime_ : writeTime_);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs_);
+	uint64_t polls = 0;
+	uint32_t status = command;
+	while (true)
+	{
+		status = registers_->ReadRegister_(bus_.highRegister);
+		++polls;
+		if (status != command) break;
+		if (std::chrono::steady_clock::now() > deadline) break;
+		std::this_thread::sleep_for(pollInterval_);
+	}
+
+	std::lock_guard<std::mutex> lock(mutex_);
+	stats_.polls += polls;
+	if (status == command)
+	{
+		++stats_.timeouts;
+		__SS__ << "Timeout waiting for I2C interface to " << (command == IICCommandRead ? "read" : "write") << " (bus 0x" << std::hex
+			   << bus_.lowRegister << ", word 0x" << word << ")!" << __E__;
+		__SS_THROW__;
+	}
+	if (command == IICCommandRead)
+		++stats_.reads;
+	else
+		++stats_.writes;
+}
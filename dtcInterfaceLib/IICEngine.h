@@ -0,0 +1,159 @@
+#ifndef IICENGINE_H
+#define IICENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DTCLib {
+
+class CFOandDTC_Registers;
+
+/// <summary>
+/// Register pair of one IIC master in the CFO/DTC register space. The Low register holds the device address (bits 31-24),
+/// the register address (bits 23-16), the write data (bits 15-8) and the read data (bits 7-0). Writing 1 (write) or 2 (read)
+/// to the High register starts a transaction, and the High register clears when it is complete.
+/// </summary>
+struct IICBus
+{
+	uint16_t lowRegister;   ///< IIC Bus Low register
+	uint16_t highRegister;  ///< IIC Bus High register
+};
+
+/// <summary>
+/// Counters kept by the IICEngine
+/// </summary>
+struct IICEngineStats
+{
+	uint64_t writes = 0;    ///< Completed IIC writes
+	uint64_t reads = 0;     ///< Completed IIC reads
+	uint64_t polls = 0;     ///< Reads of the IIC Bus High register while waiting for completion
+	uint64_t timeouts = 0;  ///< Transactions which did not complete in time
+};
+
+/// <summary>
+/// The IICEngine runs the transactions of one IIC bus from a queue, in a background thread. Each queued operation returns a
+/// future which completes when the transactions are done on the bus, or holds the exception if one of them timed out.
+/// Completion is polled at a fraction of the byte time of the bus, after waiting the expected duration of the transaction,
+/// so a transaction takes a few hundred microseconds at 100 kHz instead of a millisecond per poll.
+///
+/// The engine accesses the registers through the register accessors of its register instance, so IIC traffic is checked,
+/// profiled and traced like any other register access. The accesses run on the worker thread, so they are not part of the
+/// register transactions or snapshots of the thread which queued them.
+/// </summary>
+class IICEngine
+{
+public:
+	/// <summary>
+	/// Construct an IICEngine and start its worker thread
+	/// </summary>
+	/// <param name="registers">Register instance the IIC master belongs to</param>
+	/// <param name="bus">Register pair of the IIC master</param>
+	/// <param name="busSpeedHz">Clock speed of the IIC bus, in Hz</param>
+	/// <param name="timeoutMs">Timeout for the completion of each transaction, in milliseconds</param>
+	IICEngine(CFOandDTC_Registers* registers, IICBus const& bus, uint32_t busSpeedHz = 100000, int timeoutMs = 1000);
+	virtual ~IICEngine();
+
+	/// <summary>
+	/// Make the IIC Bus Low register word of a transaction
+	/// </summary>
+	/// <param name="device">Device address</param>
+	/// <param name="address">Register address</param>
+	/// <param name="data">Data to write (0 for reads)</param>
+	/// <returns>Value for the IIC Bus Low register</returns>
+	static uint32_t MakeWord(uint8_t device, uint8_t address, uint8_t data = 0)
+	{
+		return (static_cast<uint32_t>(device) << 24) + (static_cast<uint32_t>(address) << 16) + (static_cast<uint32_t>(data) << 8);
+	}
+
+	/// <summary>
+	/// Queue a write to an IIC device register
+	/// </summary>
+	/// <param name="device">Device address</param>
+	/// <param name="address">Register address</param>
+	/// <param name="data">Data to write</param>
+	/// <returns>Future which completes when the write is done</returns>
+	std::future<void> Write(uint8_t device, uint8_t address, uint8_t data);
+	/// <summary>
+	/// Queue a read of an IIC device register
+	/// </summary>
+	/// <param name="device">Device address</param>
+	/// <param name="address">Register address</param>
+	/// <returns>Future for the value of the register</returns>
+	std::future<uint8_t> Read(uint8_t device, uint8_t address);
+	/// <summary>
+	/// Queue a sequence of writes, run back to back. If one of them times out, the rest of the sequence is skipped.
+	/// </summary>
+	/// <param name="words">IIC Bus Low register words of the writes (see MakeWord)</param>
+	/// <returns>Future which completes when the whole sequence is done</returns>
+	std::future<void> WriteSequence(std::vector<uint32_t> const& words);
+	/// <summary>
+	/// Queue a pause of the bus, e.g. for a device to finish a calibration before it is accessed again
+	/// </summary>
+	/// <param name="delay">Duration of the pause</param>
+	/// <returns>Future which completes at the end of the pause</returns>
+	std::future<void> Delay(std::chrono::microseconds delay);
+
+	/// <summary>
+	/// Wait until all queued operations are done
+	/// </summary>
+	void Flush();
+	/// <summary>
+	/// Stop the worker thread. Operations still queued fail with std::runtime_error.
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// Get the engine counters
+	/// </summary>
+	/// <returns>Copy of the counters</returns>
+	IICEngineStats GetStats() const;
+
+private:
+	enum OperationType
+	{
+		OperationType_Write,
+		OperationType_Read,
+		OperationType_Delay,
+	};
+
+	struct Operation
+	{
+		OperationType type = OperationType_Write;
+		std::vector<uint32_t> words;
+		std::chrono::microseconds delay{0};
+		std::promise<void> done;        ///< Completion of writes and delays
+		std::promise<uint8_t> readDone;  ///< Completion of reads
+	};
+
+	void Enqueue_(Operation&& operation);
+	void Run_();
+	void Execute_(Operation& operation);
+	void Transfer_(uint32_t word, uint32_t command);
+
+	CFOandDTC_Registers* registers_;
+	IICBus bus_;
+	int timeoutMs_;
+	std::chrono::microseconds writeTime_;     ///< Expected duration of a write on the bus
+	std::chrono::microseconds readTime_;      ///< Expected duration of a read on the bus
+	std::chrono::microseconds pollInterval_;  ///< Interval between completion polls
+
+	mutable std::mutex mutex_;  ///< Guards queue_, busy_ and stats_
+	std::condition_variable queueChanged_;
+	std::condition_variable idle_;
+	std::deque<Operation> queue_;
+	bool busy_;
+	IICEngineStats stats_;
+
+	std::atomic<bool> stop_;
+	std::thread workerThread_;
+};
+
+}  // namespace DTCLib
+
+#endif  // IICENGINE_H
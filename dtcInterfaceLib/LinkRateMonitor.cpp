@@ -0,0 +1,167 @@
+#include "LinkRateMonitor.h"
+#include "RegisterAccessProfiler.h"
+
+#include <cmath>
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "LinkRateMonitor"
+
+#define TLVL_Sample TLVL_DEBUG + 5
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+namespace {
+// Positions of the counters in the batch read
+constexpr size_t ReceiveBytesIndex = 0;
+constexpr size_t ReceivePacketsIndex = ReceiveBytesIndex + DTCLib::LinkRateMonitorLinkCount;
+constexpr size_t TransmitBytesIndex = ReceivePacketsIndex + DTCLib::LinkRateMonitorLinkCount;
+constexpr size_t TransmitPacketsIndex = TransmitBytesIndex + DTCLib::LinkRateMonitorLinkCount;
+constexpr size_t RetransmitIndex = TransmitPacketsIndex + DTCLib::LinkRateMonitorLinkCount;
+constexpr size_t RetransmitLinkCount = 6;  // No retransmit counter on the CFO link
+constexpr size_t LocalFragmentDropIndex = RetransmitIndex + RetransmitLinkCount;
+constexpr size_t InputBufferDropIndex = LocalFragmentDropIndex + 1;
+constexpr size_t OutputBufferDropIndex = InputBufferDropIndex + 1;
+}  // namespace
+
+DTCLib::LinkRateMonitor::LinkRateMonitor(DTC_Registers* registers, int periodMs, double smoothingSeconds)
+	: registers_(registers), periodMs_(periodMs), smoothingSeconds_(smoothingSeconds), haveBaseline_(false), haveRates_(false), publishSequence_(0), running_(false)
+{
+	// The link counters are laid out with a stride of 4 bytes, link 0 to 5 followed by the CFO link
+	for (uint16_t base : {DTC_Register_ReceiveByteCount_Link0, DTC_Register_ReceivePacketCount_Link0, DTC_Register_TransmitByteCount_Link0,
+						  DTC_Register_TransmitPacketCount_Link0})
+		for (size_t link = 0; link < LinkRateMonitorLinkCount; ++link) addresses_.push_back(static_cast<uint16_t>(base + 4 * link));
+	for (size_t link = 0; link < RetransmitLinkCount; ++link)
+		addresses_.push_back(static_cast<uint16_t>(DTC_Register_RetransmitRequestCount_Link0 + 4 * link));
+	addresses_.push_back(DTC_Register_LocalFragmentDropCount);
+	addresses_.push_back(DTC_Register_InputBufferDropCount);
+	addresses_.push_back(DTC_Register_OutputBufferDropCount);
+}
+
+DTCLib::LinkRateMonitor::~LinkRateMonitor() { Stop(); }
+
+void DTCLib::LinkRateMonitor::Start()
+{
+	std::lock_guard<std::mutex> lock(threadMutex_);
+	if (running_) return;
+	running_ = true;
+	samplerThread_ = std::thread(&LinkRateMonitor::Run_, this);
+}
+
+void DTCLib::LinkRateMonitor::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(threadMutex_);
+		running_ = false;
+	}
+	stopCondition_.notify_all();
+	if (samplerThread_.joinable()) samplerThread_.join();
+}
+
+void DTCLib::LinkRateMonitor::Sample()
+{
+	RegisterAccessTag tag("LinkRateMonitor");
+	auto now = std::chrono::steady_clock::now();
+	auto registerSnapshot = registers_->TakeRegisterSnapshot(addresses_);
+	std::vector<uint32_t> values(addresses_.size(), 0);
+	for (size_t ii = 0; ii < addresses_.size(); ++ii) registerSnapshot.Get(addresses_[ii], values[ii]);
+
+	std::lock_guard<std::mutex> lock(sampleMutex_);
+	++current_.sample;
+	current_.timestamp = std::chrono::duration<double>(registerSnapshot.GetTimestamp().time_since_epoch()).count();
+
+	if (!haveBaseline_)
+	{
+		previous_ = values;
+		previousTime_ = now;
+		haveBaseline_ = true;
+		current_.interval = 0;
+		Publish_(current_);
+		return;
+	}
+
+	auto interval = std::chrono::duration<double>(now - previousTime_).count();
+	auto alpha = smoothingSeconds_ > 0 ? 1 - std::exp(-interval / smoothingSeconds_) : 1.0;
+	auto update = [&](size_t index, uint64_t& total, double& rate) {
+		// Unsigned subtraction is modulo 2^32, so a single wrap of the counter yields the correct increment
+		uint32_t delta = values[index] - previous_[index];
+		total += delta;
+		if (interval <= 0) return;
+		auto instant = delta / interval;
+		rate = haveRates_ ? rate + alpha * (instant - rate) : instant;
+	};
+
+	for (size_t link = 0; link < LinkRateMonitorLinkCount; ++link)
+	{
+		auto& rates = current_.links[link];
+		update(ReceiveBytesIndex + link, rates.receiveBytes, rates.receiveBytesPerSecond);
+		update(ReceivePacketsIndex + link, rates.receivePackets, rates.receivePacketsPerSecond);
+		update(TransmitBytesIndex + link, rates.transmitBytes, rates.transmitBytesPerSecond);
+		update(TransmitPacketsIndex + link, rates.transmitPackets, rates.transmitPacketsPerSecond);
+		if (link < RetransmitLinkCount) update(RetransmitIndex + link, rates.retransmitRequests, rates.retransmitRequestsPerSecond);
+	}
+	update(LocalFragmentDropIndex, current_.localFragmentDrops, current_.localFragmentDropsPerSecond);
+	update(InputBufferDropIndex, current_.inputBufferDrops, current_.inputBufferDropsPerSecond);
+	update(OutputBufferDropIndex, current_.outputBufferDrops, current_.outputBufferDropsPerSecond);
+
+	current_.interval = interval;
+	haveRates_ = haveRates_ || interval > 0;
+	previous_ = values;
+	previousTime_ = now;
+
+	TLOG(TLVL_Sample) << "Sample " << current_.sample << " after " << interval << " s, read " << addresses_.size() << " counters in "
+					  << registerSnapshot.GetReadDurationUs() << " us";
+	Publish_(current_);
+}
+
+void DTCLib::LinkRateMonitor::Reset()
+{
+	std::lock_guard<std::mutex> lock(sampleMutex_);
+	haveBaseline_ = false;
+	haveRates_ = false;
+	current_ = LinkRateSnapshot();
+	Publish_(current_);
+}
+
+DTCLib::LinkRateSnapshot DTCLib::LinkRateMonitor::GetSnapshot() const
+{
+	LinkRateSnapshot output;
+	while (true)
+	{
+		auto before = publishSequence_.load(std::memory_order_acquire);
+		if (before & 1)
+		{
+			std::this_thread::yield();  // Publish in progress
+			continue;
+		}
+		output = published_;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (publishSequence_.load(std::memory_order_relaxed) == before) return output;
+	}
+}
+
+void DTCLib::LinkRateMonitor::Publish_(const LinkRateSnapshot& snapshot)
+{
+	auto sequence = publishSequence_.load(std::memory_order_relaxed);
+	publishSequence_.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	published_ = snapshot;
+	publishSequence_.store(sequence + 2, std::memory_order_release);
+}
+
+void DTCLib::LinkRateMonitor::Run_()
+{
+	while (running_)
+	{
+		try
+		{
+			Sample();
+		}
+		catch (std::exception const& ex)
+		{
+			TLOG(TLVL_WARN) << "Error sampling link counters: " << ex.what();
+		}
+
+		std::unique_lock<std::mutex> lock(threadMutex_);
+		stopCondition_.wait_for(lock, std::chrono::milliseconds(periodMs_), [this]() { return !running_; });
+	}
+}
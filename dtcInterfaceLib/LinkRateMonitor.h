@@ -0,0 +1,135 @@
+#ifndef LINKRATEMONITOR_H
+#define LINKRATEMONITOR_H
+
+#include "DTC_Registers.h"
+
+#include <array>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace DTCLib {
+
+constexpr size_t LinkRateMonitorLinkCount = 7;  ///< ROC links 0-5 and the CFO link
+
+/// <summary>
+/// Counters and smoothed rates of one link, as published by the LinkRateMonitor
+/// </summary>
+struct LinkRates
+{
+	uint64_t receiveBytes = 0;          ///< Bytes received since the monitor started (wrap-corrected)
+	uint64_t receivePackets = 0;        ///< Packets received since the monitor started (wrap-corrected)
+	uint64_t transmitBytes = 0;         ///< Bytes transmitted since the monitor started (wrap-corrected)
+	uint64_t transmitPackets = 0;       ///< Packets transmitted since the monitor started (wrap-corrected)
+	uint64_t retransmitRequests = 0;    ///< Retransmit requests since the monitor started (wrap-corrected, ROC links only)
+	double receiveBytesPerSecond = 0;   ///< Smoothed receive byte rate
+	double receivePacketsPerSecond = 0; ///< Smoothed receive packet rate
+	double transmitBytesPerSecond = 0;  ///< Smoothed transmit byte rate
+	double transmitPacketsPerSecond = 0; ///< Smoothed transmit packet rate
+	double retransmitRequestsPerSecond = 0; ///< Smoothed retransmit request rate
+};
+
+/// <summary>
+/// Rates published by the LinkRateMonitor after each sample
+/// </summary>
+struct LinkRateSnapshot
+{
+	uint64_t sample = 0;            ///< Number of samples taken, 0 if no sample has been taken yet
+	double timestamp = 0;           ///< Time of the sample, in seconds since the epoch
+	double interval = 0;            ///< Time since the previous sample, in seconds
+	std::array<LinkRates, LinkRateMonitorLinkCount> links;
+	uint64_t localFragmentDrops = 0;    ///< Local fragments dropped since the monitor started
+	uint64_t inputBufferDrops = 0;      ///< Input buffer drops since the monitor started
+	uint64_t outputBufferDrops = 0;     ///< Output buffer drops since the monitor started
+	double localFragmentDropsPerSecond = 0; ///< Smoothed local fragment drop rate
+	double inputBufferDropsPerSecond = 0;   ///< Smoothed input buffer drop rate
+	double outputBufferDropsPerSecond = 0;  ///< Smoothed output buffer drop rate
+
+	/// <summary>
+	/// Get the rates of a link (accessor for Python, where the array is not wrapped)
+	/// </summary>
+	/// <param name="link">Link to get (DTC_Link_0 to DTC_Link_5, or DTC_Link_CFO)</param>
+	/// <returns>Counters and rates of the link</returns>
+	LinkRates GetLink(DTC_Link_ID const& link) const { return links.at(link == DTC_Link_CFO ? LinkRateMonitorLinkCount - 1 : link); }
+};
+
+/// <summary>
+/// The LinkRateMonitor samples the per-link byte, packet and retransmit counters and the drop counters of a DTC
+/// periodically, in one batched register read per sample. The 32-bit hardware counters are extended to 64 bits
+/// (assuming at most one wrap per sample period), and the rates are smoothed with an exponentially weighted moving average.
+/// The latest LinkRateSnapshot can be read from any thread without blocking the sampler.
+///
+/// Clearing a counter while the monitor is running looks like a wrap; call Reset() afterwards.
+/// </summary>
+class LinkRateMonitor
+{
+public:
+	/// <summary>
+	/// Construct a LinkRateMonitor. Call Start() to sample in a background thread, or Sample() to sample on demand.
+	/// </summary>
+	/// <param name="registers">DTC to monitor</param>
+	/// <param name="periodMs">Sample period of the background thread, in milliseconds</param>
+	/// <param name="smoothingSeconds">Time constant of the exponential smoothing, in seconds (0 = no smoothing)</param>
+	explicit LinkRateMonitor(DTC_Registers* registers, int periodMs = 1000, double smoothingSeconds = 5.0);
+	virtual ~LinkRateMonitor();
+
+	/// <summary>
+	/// Start the background sampling thread
+	/// </summary>
+	void Start();
+	/// <summary>
+	/// Stop the background sampling thread
+	/// </summary>
+	void Stop();
+	/// <summary>
+	/// Whether the background sampling thread is running
+	/// </summary>
+	/// <returns>True if running</returns>
+	bool IsRunning() const { return running_; }
+
+	/// <summary>
+	/// Read all counters once, update the totals and rates and publish a new snapshot
+	/// </summary>
+	void Sample();
+	/// <summary>
+	/// Forget the previous counter values and rates; the next sample becomes the new baseline
+	/// </summary>
+	void Reset();
+
+	/// <summary>
+	/// Get the latest published snapshot. Never takes a lock; retries the copy if a new snapshot was published meanwhile.
+	/// </summary>
+	/// <returns>Copy of the latest snapshot</returns>
+	LinkRateSnapshot GetSnapshot() const;
+
+private:
+	void Run_();
+	void Publish_(const LinkRateSnapshot& snapshot);
+
+	DTC_Registers* registers_;
+	int periodMs_;
+	double smoothingSeconds_;
+	std::vector<uint16_t> addresses_;  ///< Counter registers, read in one batch per sample
+
+	std::mutex sampleMutex_;  ///< Serializes Sample() and Reset(), not taken by readers
+	std::vector<uint32_t> previous_;
+	std::chrono::steady_clock::time_point previousTime_;
+	bool haveBaseline_;
+	bool haveRates_;
+	LinkRateSnapshot current_;
+
+	LinkRateSnapshot published_;               ///< Latest snapshot, guarded by publishSequence_
+	std::atomic<uint64_t> publishSequence_;    ///< Sequence lock, odd while published_ is being written
+
+	std::atomic<bool> running_;
+	std::mutex threadMutex_;
+	std::condition_variable stopCondition_;
+	std::thread samplerThread_;
+};
+
+}  // namespace DTCLib
+
+#endif  // LINKRATEMONITOR_H
@@ -143,6 +143,10 @@ void DTCLib::Mu2eUtil::parse_arguments(int argc, char** argv)
 				{
 					extraReads = DTCLib::Utilities::getLongOptionValue(&optind, &argv);
 				}
+				else if (option == "--profile-registers")
+				{
+					profileRegisters = true;
+				}
 				else if (option == "--help")
 				{
 					printHelpMsg();
@@ -714,6 +718,7 @@ void DTCLib::Mu2eUtil::run()
 {
 
 	if (rawOutput) outputStream.open(rawOutputFile, std::ios::out | std::ios::app | std::ios::binary);
+	if (profileRegisters) RegisterAccessProfiler::Instance().Enable();
 
 	if (op == "read_data")
 	{
@@ -766,6 +771,11 @@ void DTCLib::Mu2eUtil::run()
 		outputStream.flush();
 		outputStream.close();
 	}
+
+	if (RegisterAccessProfiler::Instance().IsEnabled())
+	{
+		std::cout << RegisterAccessProfiler::Instance().FormatReport(30);
+	}
 }
 
 void DTCLib::Mu2eUtil::printHelpMsg()
@@ -816,7 +826,8 @@ void DTCLib::Mu2eUtil::printHelpMsg()
 		<< "    --binary-file-mode: Write DMA sizes to <file> along with read data, to generate a new binary file for detector emulator mode (not compatible with -f)" << std::endl
 		<< "    --stop-verify: If a verify_stream mode error occurs, stop processing" << std::endl
 		<< "    --stop-on-timeout: Stop verify_stream or buffer_test mode if a timeout is detected (0xCAFE in first packet of buffer)" << std::endl
-		<< "    --extra-reads: Number of extra DMA reads to attempt in verify_stream and buffer_test modes (Default: 1)" << std::endl;
+		<< "    --extra-reads: Number of extra DMA reads to attempt in verify_stream and buffer_test modes (Default: 1)" << std::endl
+		<< "    --profile-registers: Print the register accesses made by the operation, most expensive first (also enabled by DTCLIB_REGISTER_PROFILE)" << std::endl;
 
 	exit(0);
 }
@@ -18,6 +18,7 @@
 #include "DTC.h"
 #include "DTCSoftwareCFO.h"
 #include "DTC_Data_Verifier.h"
+#include "RegisterAccessProfiler.h"
 
 namespace DTCLib {
 
@@ -92,6 +93,7 @@ namespace DTCLib {
 		unsigned targetFrequency = 166666667;
 		int clockToProgram = 0;
 		bool useCFODRP = false;
+		bool profileRegisters = false;
 
 
 		int dtc = -1;
@@ -0,0 +1,109 @@
+#include "RegisterAccessProfiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+thread_local std::string currentTag;
+}
+
+DTCLib::RegisterAccessProfiler& DTCLib::RegisterAccessProfiler::Instance()
+{
+	static RegisterAccessProfiler profiler;
+	return profiler;
+}
+
+DTCLib::RegisterAccessProfiler::RegisterAccessProfiler()
+	: enabled_(getenv("DTCLIB_REGISTER_PROFILE") != nullptr) {}
+
+void DTCLib::RegisterAccessProfiler::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	stats_.clear();
+}
+
+DTCLib::RegisterAccessStats& DTCLib::RegisterAccessProfiler::Entry_(uint16_t address)
+{
+	auto& entry = stats_[std::make_pair(address, currentTag)];
+	entry.address = address;
+	entry.tag = currentTag;
+	return entry;
+}
+
+void DTCLib::RegisterAccessProfiler::RecordRead(uint16_t address, double us, uint64_t count)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto& entry = Entry_(address);
+	entry.reads += count;
+	entry.readUs += us;
+	entry.maxReadUs = std::max(entry.maxReadUs, count > 0 ? us / count : us);
+}
+
+void DTCLib::RegisterAccessProfiler::RecordWrite(uint16_t address, double us)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto& entry = Entry_(address);
+	++entry.writes;
+	entry.writeUs += us;
+	entry.maxWriteUs = std::max(entry.maxWriteUs, us);
+}
+
+std::vector<DTCLib::RegisterAccessStats> DTCLib::RegisterAccessProfiler::GetReport() const
+{
+	std::vector<RegisterAccessStats> report;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		report.reserve(stats_.size());
+		for (auto const& entry : stats_) report.push_back(entry.second);
+	}
+	std::stable_sort(report.begin(), report.end(),
+					 [](RegisterAccessStats const& a, RegisterAccessStats const& b) { return a.TotalUs() > b.TotalUs(); });
+	return report;
+}
+
+std::string DTCLib::RegisterAccessProfiler::FormatReport(size_t maxEntries) const
+{
+	auto report = GetReport();
+
+	double totalUs = 0;
+	uint64_t totalAccesses = 0;
+	for (auto const& entry : report)
+	{
+		totalUs += entry.TotalUs();
+		totalAccesses += entry.reads + entry.writes;
+	}
+
+	std::ostringstream o;
+	o << "Register access profile: " << totalAccesses << " device accesses, " << std::fixed << std::setprecision(1) << totalUs
+	  << " us" << (IsEnabled() ? "" : " (profiler disabled)") << std::endl;
+	o << std::left << std::setw(8) << "Address" << std::setw(20) << "Tag" << std::right << std::setw(10) << "Reads" << std::setw(10)
+	  << "Writes" << std::setw(12) << "Total us" << std::setw(12) << "Max rd us" << std::setw(12) << "Max wr us" << std::setw(8) << "Share"
+	  << std::endl;
+	size_t rows = 0;
+	for (auto const& entry : report)
+	{
+		if (maxEntries > 0 && rows++ == maxEntries)
+		{
+			o << "... " << report.size() - maxEntries << " more" << std::endl;
+			break;
+		}
+		std::ostringstream address;
+		address << "0x" << std::hex << std::setw(4) << std::setfill('0') << entry.address;
+		o << std::left << std::setw(8) << address.str() << std::setw(20) << (entry.tag.empty() ? "-" : entry.tag) << std::right
+		  << std::setw(10) << entry.reads << std::setw(10) << entry.writes << std::setw(12) << entry.TotalUs() << std::setw(12)
+		  << entry.maxReadUs << std::setw(12) << entry.maxWriteUs << std::setw(7) << (totalUs > 0 ? 100 * entry.TotalUs() / totalUs : 0)
+		  << "%" << std::endl;
+	}
+	return o.str();
+}
+
+std::string DTCLib::RegisterAccessProfiler::SetTag(const std::string& tag)
+{
+	auto previous = currentTag;
+	currentTag = tag;
+	return previous;
+}
+
+std::string DTCLib::RegisterAccessProfiler::GetTag() { return currentTag; }
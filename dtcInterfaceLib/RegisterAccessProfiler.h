@@ -0,0 +1,134 @@
+#ifndef REGISTERACCESSPROFILER_H
+#define REGISTERACCESSPROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace DTCLib {
+
+/// <summary>
+/// Device accesses of one register by one subsystem, as recorded by the RegisterAccessProfiler
+/// </summary>
+struct RegisterAccessStats
+{
+	uint16_t address = 0;
+	std::string tag;         ///< Subsystem which made the accesses (see RegisterAccessTag), empty if untagged
+	uint64_t reads = 0;      ///< Device reads (single and snapshot)
+	uint64_t writes = 0;     ///< Device writes
+	double readUs = 0;       ///< Total time spent reading, in microseconds
+	double writeUs = 0;      ///< Total time spent writing, in microseconds
+	double maxReadUs = 0;    ///< Longest single read, in microseconds
+	double maxWriteUs = 0;   ///< Longest single write, in microseconds
+
+	/// <summary>
+	/// Total time spent accessing the register
+	/// </summary>
+	/// <returns>Read and write time, in microseconds</returns>
+	double TotalUs() const { return readUs + writeUs; }
+};
+
+/// <summary>
+/// The RegisterAccessProfiler counts the device accesses made through CFOandDTC_Registers, per register address and
+/// subsystem tag, with their total and maximum duration. It is process-wide and disabled by default; while disabled,
+/// each register access only pays for one relaxed atomic load. Reads served from a register snapshot or transaction
+/// do not reach the device and are not counted.
+/// Setting DTCLIB_REGISTER_PROFILE in the environment enables it at startup.
+/// </summary>
+class RegisterAccessProfiler
+{
+public:
+	/// <summary>
+	/// Get the process-wide profiler
+	/// </summary>
+	/// <returns>RegisterAccessProfiler instance</returns>
+	static RegisterAccessProfiler& Instance();
+
+	/// <summary>
+	/// Start or stop recording. The recorded counts are kept until Reset().
+	/// </summary>
+	/// <param name="enable">Whether to record register accesses</param>
+	void Enable(bool enable = true) { enabled_.store(enable, std::memory_order_relaxed); }
+	/// <summary>
+	/// Whether register accesses are being recorded
+	/// </summary>
+	/// <returns>True if recording</returns>
+	bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+	/// <summary>
+	/// Forget all recorded accesses
+	/// </summary>
+	void Reset();
+
+	/// <summary>
+	/// Record device reads of a register
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <param name="us">Duration of the read, in microseconds</param>
+	/// <param name="count">Number of reads (for snapshots, which share one duration between their registers)</param>
+	void RecordRead(uint16_t address, double us, uint64_t count = 1);
+	/// <summary>
+	/// Record a device write of a register
+	/// </summary>
+	/// <param name="address">Register address</param>
+	/// <param name="us">Duration of the write, in microseconds</param>
+	void RecordWrite(uint16_t address, double us);
+
+	/// <summary>
+	/// Get the recorded accesses, most expensive first
+	/// </summary>
+	/// <returns>One entry per register address and tag, sorted by total time</returns>
+	std::vector<RegisterAccessStats> GetReport() const;
+	/// <summary>
+	/// Format the recorded accesses as a table, most expensive first
+	/// </summary>
+	/// <param name="maxEntries">Maximum number of rows (0 = all)</param>
+	/// <returns>Report table</returns>
+	std::string FormatReport(size_t maxEntries = 20) const;
+
+	/// <summary>
+	/// Set the subsystem tag of the register accesses made by the calling thread
+	/// </summary>
+	/// <param name="tag">New tag (empty for untagged)</param>
+	/// <returns>Previous tag</returns>
+	static std::string SetTag(const std::string& tag);
+	/// <summary>
+	/// Get the subsystem tag of the calling thread
+	/// </summary>
+	/// <returns>Current tag</returns>
+	static std::string GetTag();
+
+private:
+	RegisterAccessProfiler();
+	RegisterAccessStats& Entry_(uint16_t address);
+
+	std::atomic<bool> enabled_;
+	mutable std::mutex mutex_;  ///< Guards stats_
+	std::map<std::pair<uint16_t, std::string>, RegisterAccessStats> stats_;
+};
+
+/// <summary>
+/// Scoped subsystem tag: register accesses made by this thread while the tag is alive are attributed to it
+/// </summary>
+class RegisterAccessTag
+{
+public:
+	/// <summary>
+	/// Set the tag of the calling thread until the end of the scope
+	/// </summary>
+	/// <param name="tag">Subsystem name</param>
+	explicit RegisterAccessTag(const std::string& tag)
+		: previous_(RegisterAccessProfiler::SetTag(tag)) {}
+	~RegisterAccessTag() { RegisterAccessProfiler::SetTag(previous_); }
+	RegisterAccessTag(const RegisterAccessTag&) = delete;
+	RegisterAccessTag& operator=(const RegisterAccessTag&) = delete;
+
+private:
+	std::string previous_;
+};
+
+}  // namespace DTCLib
+
+#endif  // REGISTERACCESSPROFILER_H
@@ -0,0 +1,159 @@
+#include "RegisterDump.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace {
+void AppendHex(std::string& out, uint32_t value, int digits)
+{
+	char buffer[8];
+	for (auto ii = digits - 1; ii >= 0; --ii)
+	{
+		buffer[ii] = "0123456789abcdef"[value & 0xF];
+		value >>= 4;
+	}
+	out.append(buffer, digits);
+}
+
+void AppendDecimal(std::string& out, uint64_t value)
+{
+	char buffer[20];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	out.append(buffer, result.ptr);
+}
+
+template <typename T>
+void AppendBinary(std::string& out, const T& value)
+{
+	out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::string JSONEscape(const std::string& text)
+{
+	std::string escaped;
+	for (auto c : text)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		else if (static_cast<unsigned char>(c) < 0x20)
+			continue;
+		escaped += c;
+	}
+	return escaped;
+}
+
+std::string HexAddress(uint16_t address)
+{
+	std::string text = "0x";
+	AppendHex(text, address, 4);
+	return text;
+}
+}  // namespace
+
+DTCLib::RegisterDumpLayout::RegisterDumpLayout(const std::vector<RegisterDumpEntry>& entries)
+{
+	size_t nameWidth = 0;
+	for (auto const& entry : entries) nameWidth = std::max(nameWidth, entry.name.size());
+
+	addresses_.reserve(entries.size());
+	entries_.reserve(entries.size());
+	textSize_ = 64;
+	jsonSize_ = 64;
+	for (auto const& entry : entries)
+	{
+		addresses_.push_back(entry.address);
+
+		EntryLayout_ layout;
+		layout.text = HexAddress(entry.address) + " | 0x";
+		layout.textName = " | " + entry.name + std::string(nameWidth - entry.name.size(), ' ') + "\n";
+		layout.json = "{\"address\":\"" + HexAddress(entry.address) + "\",\"name\":\"" + JSONEscape(entry.name) + "\",\"value\":";
+		textSize_ += layout.text.size() + 8 + layout.textName.size();
+		jsonSize_ += layout.json.size() + 10 + 16;
+
+		for (auto const& field : entry.fields)
+		{
+			auto name = field.link >= 0 ? field.name + "[" + std::to_string(field.link) + "]" : field.name;
+
+			FieldLayout_ fieldLayout;
+			fieldLayout.mask = (field.width >= 32 ? 0xFFFFFFFFu : ((1u << field.width) - 1)) << field.offset;
+			fieldLayout.offset = field.offset;
+			fieldLayout.text = "    " + name + " = ";
+			fieldLayout.json = "\"" + JSONEscape(name) + "\":";
+			textSize_ += fieldLayout.text.size() + 10 + 1;
+			jsonSize_ += fieldLayout.json.size() + 10 + 1;
+			layout.fields.push_back(std::move(fieldLayout));
+		}
+		entries_.push_back(std::move(layout));
+	}
+}
+
+void DTCLib::RegisterDumpLayout::Format(const uint32_t* values, RegisterDumpFormat format, std::string& out, uint64_t timestampNs) const
+{
+	out.clear();
+	switch (format)
+	{
+		case RegisterDumpFormat_Text:
+			out.reserve(textSize_);
+			out.append("Register Dump: ");
+			AppendDecimal(out, entries_.size());
+			out.append(" registers\n");
+			for (size_t ii = 0; ii < entries_.size(); ++ii)
+			{
+				auto const& entry = entries_[ii];
+				out.append(entry.text);
+				AppendHex(out, values[ii], 8);
+				out.append(entry.textName);
+				for (auto const& field : entry.fields)
+				{
+					out.append(field.text);
+					AppendDecimal(out, (values[ii] & field.mask) >> field.offset);
+					out.push_back('\n');
+				}
+			}
+			break;
+
+		case RegisterDumpFormat_JSON:
+			out.reserve(jsonSize_);
+			out.append("{\"timestamp_ns\":");
+			AppendDecimal(out, timestampNs);
+			out.append(",\"registers\":[");
+			for (size_t ii = 0; ii < entries_.size(); ++ii)
+			{
+				auto const& entry = entries_[ii];
+				if (ii > 0) out.push_back(',');
+				out.append(entry.json);
+				AppendDecimal(out, values[ii]);
+				if (!entry.fields.empty())
+				{
+					out.append(",\"fields\":{");
+					for (size_t jj = 0; jj < entry.fields.size(); ++jj)
+					{
+						if (jj > 0) out.push_back(',');
+						out.append(entry.fields[jj].json);
+						AppendDecimal(out, (values[ii] & entry.fields[jj].mask) >> entry.fields[jj].offset);
+					}
+					out.push_back('}');
+				}
+				out.push_back('}');
+			}
+			out.append("]}");
+			break;
+
+		case RegisterDumpFormat_Binary: {
+			out.reserve(sizeof(RegisterDumpBinaryHeader) + entries_.size() * sizeof(RegisterDumpBinaryRecord));
+			RegisterDumpBinaryHeader header;
+			header.count = static_cast<uint32_t>(entries_.size());
+			header.timestampNs = timestampNs;
+			AppendBinary(out, header);
+			for (size_t ii = 0; ii < entries_.size(); ++ii)
+			{
+				RegisterDumpBinaryRecord record;
+				record.address = addresses_[ii];
+				record.value = values[ii];
+				AppendBinary(out, record);
+			}
+			break;
+		}
+	}
+}
@@ -0,0 +1,120 @@
+#ifndef REGISTERDUMP_H
+#define REGISTERDUMP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace DTCLib {
+
+/// <summary>
+/// Output format of a RegisterDumpLayout
+/// </summary>
+enum RegisterDumpFormat
+{
+	RegisterDumpFormat_Text,    ///< One line per register (address, value, name), then one line per described field
+	RegisterDumpFormat_JSON,    ///< {"timestamp_ns":..., "registers":[{"address":"0x9000","name":...,"value":...,"fields":{...}}, ...]}
+	RegisterDumpFormat_Binary,  ///< RegisterDumpBinaryHeader, then one RegisterDumpBinaryRecord per register
+};
+
+/// <summary>
+/// Header of a binary register dump. All binary dump words are in host byte order.
+/// </summary>
+struct RegisterDumpBinaryHeader
+{
+	uint32_t magic = 0x504D4452;  ///< "RDMP"
+	uint32_t count = 0;           ///< Number of records following the header
+	uint64_t timestampNs = 0;     ///< Time of the register read, in nanoseconds since the epoch
+};
+
+/// <summary>
+/// One register of a binary register dump
+/// </summary>
+struct RegisterDumpBinaryRecord
+{
+	uint16_t address = 0;
+	uint16_t reserved = 0;
+	uint32_t value = 0;
+};
+
+/// <summary>
+/// A named bit field of a register in a RegisterDumpLayout
+/// </summary>
+struct RegisterDumpField
+{
+	std::string name;
+	uint8_t offset = 0;  ///< Index of the lowest bit of the field
+	uint8_t width = 1;   ///< Width of the field, in bits
+	int link = -1;       ///< Link the field belongs to (shown as name[link]), -1 for none
+};
+
+/// <summary>
+/// A register of a RegisterDumpLayout
+/// </summary>
+struct RegisterDumpEntry
+{
+	uint16_t address = 0;
+	std::string name;
+	std::vector<RegisterDumpField> fields;
+};
+
+/// <summary>
+/// The RegisterDumpLayout is a register dump with the layout worked out in advance: every label, padding and JSON key is
+/// rendered once at construction, so that formatting a dump only appends the prepared text and the value digits to a
+/// caller-owned buffer. With a buffer reused between dumps, formatting makes no heap allocation.
+/// It is the cheap path for periodic monitoring; FormattedRegDump remains the fully decorated dump for humans.
+/// </summary>
+class RegisterDumpLayout
+{
+public:
+	/// <summary>
+	/// Render the layout of the given registers
+	/// </summary>
+	/// <param name="entries">Registers to dump, in order</param>
+	explicit RegisterDumpLayout(const std::vector<RegisterDumpEntry>& entries);
+
+	/// <summary>
+	/// Get the addresses of the registers, in dump order (the values passed to Format are in the same order)
+	/// </summary>
+	/// <returns>Register addresses</returns>
+	const std::vector<uint16_t>& GetAddresses() const { return addresses_; }
+	/// <summary>
+	/// Get the number of registers in the layout
+	/// </summary>
+	/// <returns>Number of registers</returns>
+	size_t Size() const { return addresses_.size(); }
+
+	/// <summary>
+	/// Format register values into a buffer. The buffer is cleared first; its capacity is kept.
+	/// </summary>
+	/// <param name="values">Register values, one per address of GetAddresses()</param>
+	/// <param name="format">Output format</param>
+	/// <param name="out">Output buffer</param>
+	/// <param name="timestampNs">Time of the register read, in nanoseconds since the epoch</param>
+	void Format(const uint32_t* values, RegisterDumpFormat format, std::string& out, uint64_t timestampNs = 0) const;
+
+private:
+	struct FieldLayout_
+	{
+		uint32_t mask;
+		uint8_t offset;
+		std::string text;  ///< "    name[link] = "
+		std::string json;  ///< "\"name[link]\":"
+	};
+	struct EntryLayout_
+	{
+		std::string text;      ///< "0x9000 | 0x"
+		std::string textName;  ///< " | name\n"
+		std::string json;      ///< "{\"address\":\"0x9000\",\"name\":\"...\",\"value\":"
+		std::vector<FieldLayout_> fields;
+	};
+
+	std::vector<uint16_t> addresses_;
+	std::vector<EntryLayout_> entries_;
+	size_t textSize_ = 0;  ///< Upper bound of the formatted size, reserved before formatting
+	size_t jsonSize_ = 0;
+};
+
+}  // namespace DTCLib
+
+#endif  // REGISTERDUMP_H
@@ -0,0 +1,41 @@
+#include "RequestClock.h"
+
+#include <unistd.h>
+
+std::chrono::steady_clock::time_point DTCLib::RequestClock::Now() const
+{
+	return std::chrono::steady_clock::now();
+}
+
+void DTCLib::RequestClock::WaitUntil(std::chrono::steady_clock::time_point deadline, std::chrono::nanoseconds spinThreshold)
+{
+	auto remaining = deadline - std::chrono::steady_clock::now();
+	if (remaining > spinThreshold)
+	{
+		// Sleep through most of the wait; the scheduler wakes us up late by up to tens of microseconds
+		usleep(std::chrono::duration_cast<std::chrono::microseconds>(remaining - spinThreshold).count());
+	}
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+	}
+}  // end WaitUntil()
+
+std::shared_ptr<DTCLib::RequestClock> DTCLib::RequestClock::Steady()
+{
+	static auto steady = std::make_shared<RequestClock>();
+	return steady;
+}
+
+std::chrono::steady_clock::time_point DTCLib::SimulatedRequestClock::Now() const
+{
+	return std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(nowNs_)));
+}
+
+void DTCLib::SimulatedRequestClock::WaitUntil(std::chrono::steady_clock::time_point deadline, std::chrono::nanoseconds /*spinThreshold*/)
+{
+	auto deadlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+	auto now = nowNs_.load();
+	while (now < deadlineNs && !nowNs_.compare_exchange_weak(now, deadlineNs))
+	{
+	}
+}
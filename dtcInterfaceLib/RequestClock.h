@@ -0,0 +1,69 @@
+#ifndef REQUESTCLOCK_H
+#define REQUESTCLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace DTCLib {
+
+/// <summary>
+/// Time source of a RequestPacer (and of a RequestThrottle). The base class is the steady clock, with waits which
+/// sleep and then spin up to the deadline; a SimulatedRequestClock replaces it where the timing must be reproducible.
+/// </summary>
+class RequestClock
+{
+public:
+	virtual ~RequestClock() = default;
+
+	/// <summary>
+	/// Get the current time
+	/// </summary>
+	/// <returns>Current time</returns>
+	virtual std::chrono::steady_clock::time_point Now() const;
+	/// <summary>
+	/// Wait until the given time, sleeping, then spinning for the last spin threshold
+	/// </summary>
+	/// <param name="deadline">Time to wait for</param>
+	/// <param name="spinThreshold">Last part of the wait which is spent spinning instead of sleeping</param>
+	virtual void WaitUntil(std::chrono::steady_clock::time_point deadline, std::chrono::nanoseconds spinThreshold);
+
+	/// <summary>
+	/// Get the steady clock, shared by the pacers which are not given a clock
+	/// </summary>
+	/// <returns>Steady clock</returns>
+	static std::shared_ptr<RequestClock> Steady();
+};
+
+/// <summary>
+/// Simulated time, for tests: the clock starts at the steady clock epoch and only moves when it is waited on or
+/// advanced, so that waits return at once and land exactly on their deadlines. Advance stands for the time spent
+/// between waits, e.g. sending the requests. The clock can be shared between threads.
+/// </summary>
+class SimulatedRequestClock : public RequestClock
+{
+public:
+	SimulatedRequestClock()
+		: nowNs_(0) {}
+
+	std::chrono::steady_clock::time_point Now() const override;
+	/// <summary>
+	/// Move the clock to the deadline, unless it is already past it
+	/// </summary>
+	/// <param name="deadline">Time to wait for</param>
+	/// <param name="spinThreshold">Unused</param>
+	void WaitUntil(std::chrono::steady_clock::time_point deadline, std::chrono::nanoseconds spinThreshold) override;
+	/// <summary>
+	/// Move the clock forward
+	/// </summary>
+	/// <param name="duration">Time to add</param>
+	void Advance(std::chrono::nanoseconds duration) { nowNs_ += duration.count(); }
+
+private:
+	std::atomic<int64_t> nowNs_;  ///< Time since the steady clock epoch
+};
+
+}  // namespace DTCLib
+
+#endif  // REQUESTCLOCK_H
@@ -0,0 +1,183 @@
+#include "RequestGenerator.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "RequestGenerator"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+DTCLib::RequestGenerator::RequestGenerator()
+	: mutex_(), resumed_(), thread_(), changes_(), state_(RequestGeneratorState::Idle), active_(false), requestsSent_(0), requestsTotal_(0), currentTag_(0), startNs_(0), stopNs_(0), pausedNs_(0), pauseStartNs_(0)
+{
+}
+
+DTCLib::RequestGenerator::~RequestGenerator()
+{
+	Cancel();
+	Wait();
+}
+
+void DTCLib::RequestGenerator::Start(uint64_t requestsTotal, std::function<void()> body)
+{
+	if (state_ == RequestGeneratorState::Paused)
+	{
+		__SS__ << "The request generator is paused; resume or cancel it before starting another run" << __E__;
+		__SS_THROW__;
+	}
+	Wait();
+
+	std::unique_lock<std::mutex> lock(mutex_);
+	requestsSent_ = 0;
+	requestsTotal_ = requestsTotal;
+	currentTag_ = 0;
+	startNs_ = Now_();
+	stopNs_ = 0;
+	pausedNs_ = 0;
+	pauseStartNs_ = 0;
+	state_ = RequestGeneratorState::Running;
+	active_ = true;
+	thread_ = std::thread([this, body]() {
+		body();
+		Finish_();
+	});
+}  // end Start()
+
+void DTCLib::RequestGenerator::Pause()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (state_ == RequestGeneratorState::Running && active_)
+	{
+		state_ = RequestGeneratorState::Paused;
+		TLOG(TLVL_INFO) << "Pausing requests after " << requestsSent_ << " event windows";
+	}
+}
+
+void DTCLib::RequestGenerator::Resume()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (state_ == RequestGeneratorState::Paused)
+	{
+		state_ = RequestGeneratorState::Running;
+		TLOG(TLVL_INFO) << "Resuming requests";
+		resumed_.notify_all();
+	}
+}
+
+void DTCLib::RequestGenerator::Cancel()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (active_ && state_ != RequestGeneratorState::Cancelled)
+	{
+		state_ = RequestGeneratorState::Cancelled;
+		TLOG(TLVL_INFO) << "Cancelling requests after " << requestsSent_ << " of " << requestsTotal_ << " event windows";
+		resumed_.notify_all();
+	}
+}
+
+void DTCLib::RequestGenerator::Wait()
+{
+	if (thread_.joinable()) thread_.join();
+}
+
+void DTCLib::RequestGenerator::Post(std::function<void()> change)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (active_)
+		changes_.push_back(change);
+	else
+		change();
+}
+
+bool DTCLib::RequestGenerator::Checkpoint(std::chrono::nanoseconds& paused)
+{
+	paused = std::chrono::nanoseconds(0);
+	std::unique_lock<std::mutex> lock(mutex_);
+	ApplyChanges_();
+	if (state_ == RequestGeneratorState::Paused)
+	{
+		auto pauseStart = Now_();
+		pauseStartNs_ = pauseStart;
+		resumed_.wait(lock, [this]() { return state_ != RequestGeneratorState::Paused; });
+		paused = std::chrono::nanoseconds(Now_() - pauseStart);
+		pausedNs_ += paused.count();
+		pauseStartNs_ = 0;
+		ApplyChanges_();  // Those posted while paused
+	}
+	return state_ != RequestGeneratorState::Cancelled;
+}  // end Checkpoint()
+
+void DTCLib::RequestGenerator::Record(uint64_t windows, uint64_t tag)
+{
+	requestsSent_ += windows;
+	currentTag_ = tag;
+}
+
+void DTCLib::RequestGenerator::ApplyChanges_()
+{
+	for (auto& change : changes_) change();
+	changes_.clear();
+}
+
+void DTCLib::RequestGenerator::Finish_()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	if (state_ != RequestGeneratorState::Cancelled) state_ = RequestGeneratorState::Finished;
+	stopNs_ = Now_();
+	ApplyChanges_();  // So that changes posted during the last burst are kept for the next run
+	active_ = false;
+	TLOG(TLVL_DEBUG) << "Request thread done: " << FormatProgress();
+}
+
+int64_t DTCLib::RequestGenerator::Now_()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+DTCLib::RequestGeneratorProgress DTCLib::RequestGenerator::GetProgress() const
+{
+	RequestGeneratorProgress progress;
+	progress.state = state_;
+	progress.requestsSent = requestsSent_;
+	progress.requestsTotal = requestsTotal_;
+	progress.currentTag = currentTag_;
+	progress.holding = pauseStartNs_ != 0;
+	if (startNs_ == 0) return progress;
+
+	auto now = Now_();
+	auto end = stopNs_ != 0 ? stopNs_.load() : now;
+	auto pauseStart = pauseStartNs_.load();
+	auto running = end - startNs_ - pausedNs_ - (pauseStart != 0 ? now - pauseStart : 0);
+	progress.elapsedSeconds = running > 0 ? running / 1e9 : 0;
+	progress.achievedRate = progress.elapsedSeconds > 0 ? progress.requestsSent / progress.elapsedSeconds : 0;
+	return progress;
+}
+
+std::string DTCLib::RequestGenerator::FormatProgress() const
+{
+	auto progress = GetProgress();
+	std::ostringstream o;
+	o << std::fixed << std::setprecision(1) << StateName(progress.state) << ": " << progress.requestsSent << " of "
+	  << progress.requestsTotal << " event windows requested, current tag " << progress.currentTag << ", "
+	  << progress.elapsedSeconds * 1000 << " ms running: achieved " << progress.achievedRate << " /s";
+	return o.str();
+}
+
+std::string DTCLib::RequestGenerator::StateName(RequestGeneratorState state)
+{
+	switch (state)
+	{
+		case RequestGeneratorState::Idle:
+			return "Idle";
+		case RequestGeneratorState::Running:
+			return "Running";
+		case RequestGeneratorState::Paused:
+			return "Paused";
+		case RequestGeneratorState::Finished:
+			return "Finished";
+		case RequestGeneratorState::Cancelled:
+			return "Cancelled";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,155 @@
+#ifndef REQUESTGENERATOR_H
+#define REQUESTGENERATOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DTCLib {
+
+/// <summary>
+/// State of a RequestGenerator
+/// </summary>
+enum class RequestGeneratorState
+{
+	Idle,       ///< Never started
+	Running,
+	Paused,
+	Finished,   ///< The last run sent all of its requests
+	Cancelled,  ///< The last run was cancelled before sending all of its requests
+};
+
+/// <summary>
+/// Progress of the current (or last) run of a RequestGenerator
+/// </summary>
+struct RequestGeneratorProgress
+{
+	RequestGeneratorState state = RequestGeneratorState::Idle;
+	uint64_t requestsSent = 0;   ///< Event windows requested so far
+	uint64_t requestsTotal = 0;  ///< Event windows to request in the run
+	uint64_t currentTag = 0;     ///< Event Window Tag of the last request sent
+	bool holding = false;        ///< The request thread is blocked at a checkpoint by a pause, and sends nothing until resumed
+	double elapsedSeconds = 0;   ///< Time since the start of the run, not counting pauses
+	double achievedRate = 0;     ///< Event windows per second, over the elapsed time
+};
+
+/// <summary>
+/// The RequestGenerator runs the requests of a DTCSoftwareCFO range in their own thread, and lets other threads steer
+/// them while they run: pause, resume and cancel, read the progress, and post changes (e.g. of the rate or the
+/// schedule) which the request thread applies between two bursts. This way a long soak test is changed in place,
+/// instead of being killed and restarted, which loses the state of the DTC buffers.
+///
+/// The request thread calls Checkpoint between bursts, which applies the posted changes, blocks while paused and
+/// tells whether the run was cancelled, and Record after each burst. The progress counters are atomic, so they can be
+/// read at any time without stopping the requests.
+/// </summary>
+class RequestGenerator
+{
+public:
+	RequestGenerator();
+	/// <summary>
+	/// Cancel the run, if any, and wait for the request thread
+	/// </summary>
+	~RequestGenerator();
+
+	/// <summary>
+	/// Start a run: wait for the previous run to finish, then call the body in a new request thread. Throws if the
+	/// previous run is paused, as it would never finish.
+	/// </summary>
+	/// <param name="requestsTotal">Event windows the body will request</param>
+	/// <param name="body">Requests of the run, which calls Checkpoint and Record</param>
+	void Start(uint64_t requestsTotal, std::function<void()> body);
+	/// <summary>
+	/// Pause the run at the next checkpoint of the request thread
+	/// </summary>
+	void Pause();
+	/// <summary>
+	/// Resume a paused run
+	/// </summary>
+	void Resume();
+	/// <summary>
+	/// Cancel the run at the next checkpoint of the request thread (also when paused). Use Wait to wait for it to stop.
+	/// </summary>
+	void Cancel();
+	/// <summary>
+	/// Block until the request thread has finished
+	/// </summary>
+	void Wait();
+
+	/// <summary>
+	/// Run a change in the request thread, at its next checkpoint; or right away, if no run is active. Changes are
+	/// applied in the order they were posted. A change must not call the RequestGenerator.
+	/// </summary>
+	/// <param name="change">Change to apply</param>
+	void Post(std::function<void()> change);
+
+	/// <summary>
+	/// Get the state of the run
+	/// </summary>
+	/// <returns>Current state</returns>
+	RequestGeneratorState GetState() const { return state_; }
+	/// <summary>
+	/// Whether a run is running or paused
+	/// </summary>
+	/// <returns>True until the request thread has finished</returns>
+	bool IsActive() const { return active_; }
+	/// <summary>
+	/// Get the progress of the run
+	/// </summary>
+	/// <returns>Progress counters</returns>
+	RequestGeneratorProgress GetProgress() const;
+	/// <summary>
+	/// Format the progress of the run
+	/// </summary>
+	/// <returns>One-line progress report</returns>
+	std::string FormatProgress() const;
+	/// <summary>
+	/// Get the name of a state
+	/// </summary>
+	/// <param name="state">State</param>
+	/// <returns>Name of the state</returns>
+	static std::string StateName(RequestGeneratorState state);
+
+	/// <summary>
+	/// Called by the request thread between bursts: apply the posted changes, and block while the run is paused
+	/// </summary>
+	/// <param name="paused">Set to the time spent paused, so that the pacing can skip it</param>
+	/// <returns>False if the run was cancelled, and the body should return</returns>
+	bool Checkpoint(std::chrono::nanoseconds& paused);
+	/// <summary>
+	/// Called by the request thread after each burst
+	/// </summary>
+	/// <param name="windows">Event windows requested in the burst</param>
+	/// <param name="tag">Event Window Tag of the last request of the burst</param>
+	void Record(uint64_t windows, uint64_t tag);
+
+private:
+	void ApplyChanges_();
+	void Finish_();
+	static int64_t Now_();
+
+	mutable std::mutex mutex_;
+	std::condition_variable resumed_;
+	std::thread thread_;
+	std::vector<std::function<void()>> changes_;
+
+	std::atomic<RequestGeneratorState> state_;
+	std::atomic<bool> active_;  ///< The request thread has not finished
+	std::atomic<uint64_t> requestsSent_;
+	std::atomic<uint64_t> requestsTotal_;
+	std::atomic<uint64_t> currentTag_;
+	std::atomic<int64_t> startNs_;
+	std::atomic<int64_t> stopNs_;         ///< 0 while the request thread runs
+	std::atomic<int64_t> pausedNs_;       ///< Time spent paused, up to the last resume
+	std::atomic<int64_t> pauseStartNs_;   ///< 0 unless the request thread is paused
+};
+
+}  // namespace DTCLib
+
+#endif  // REQUESTGENERATOR_H
@@ -0,0 +1,126 @@
+#include "RequestPacer.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+DTCLib::RequestPacer::RequestPacer(double requestsPerSecond, std::chrono::nanoseconds spinThreshold, std::shared_ptr<RequestClock> clock)
+	: rate_(requestsPerSecond > 0 ? requestsPerSecond : 0), spinThreshold_(spinThreshold), clock_(clock ? clock : RequestClock::Steady()), start_(clock_->Now()), stop_(start_), stopped_(false), epoch_(start_), epochRequest_(0), lastPace_(start_), lastDue_(0), requestsBeforeLastPace_(0), requests_(0), paces_(0), latePaces_(0), maximumLateness_(0)
+{
+}
+
+void DTCLib::RequestPacer::SetRate(double requestsPerSecond)
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	rate_ = requestsPerSecond > 0 ? requestsPerSecond : 0;
+	epoch_ = clock_->Now();
+	epochRequest_ = requests_;
+}
+
+double DTCLib::RequestPacer::GetRate() const
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	return rate_;
+}
+
+void DTCLib::RequestPacer::Start()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	start_ = clock_->Now();
+	stop_ = start_;
+	stopped_ = false;
+	epoch_ = start_;
+	epochRequest_ = 0;
+	lastPace_ = start_;
+	lastDue_ = std::chrono::nanoseconds(0);
+	requestsBeforeLastPace_ = 0;
+	requests_ = 0;
+	paces_ = 0;
+	latePaces_ = 0;
+	maximumLateness_ = std::chrono::nanoseconds(0);
+}
+
+void DTCLib::RequestPacer::Pace(uint64_t requests)
+{
+	if (rate_ > 0)
+	{
+		auto deadline = epoch_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+									 std::chrono::duration<double>((requests_ - epochRequest_) / rate_));
+		Wait_(deadline, requests_ > epochRequest_);  // The first request of a schedule is due immediately
+	}
+	std::unique_lock<std::mutex> lock(mutex_);
+	Count_(requests);
+}  // end Pace()
+
+void DTCLib::RequestPacer::PaceAt(std::chrono::nanoseconds due, uint64_t requests)
+{
+	Wait_(start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(due), due.count() > 0);
+	std::unique_lock<std::mutex> lock(mutex_);
+	lastDue_ = due;
+	Count_(requests);
+}  // end PaceAt()
+
+void DTCLib::RequestPacer::Wait_(std::chrono::steady_clock::time_point deadline, bool countLateness)
+{
+	auto now = clock_->Now();
+	if (now > deadline)
+	{
+		if (countLateness)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			++latePaces_;
+			maximumLateness_ = std::max(maximumLateness_, std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline));
+		}
+	}
+	else
+		WaitUntil(deadline);
+}
+
+void DTCLib::RequestPacer::Count_(uint64_t requests)
+{
+	lastPace_ = clock_->Now();
+	requestsBeforeLastPace_ = requests_;
+	requests_ += requests;
+	++paces_;
+}
+
+void DTCLib::RequestPacer::Stop()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	stop_ = clock_->Now();
+	stopped_ = true;
+}
+
+DTCLib::RequestPacerReport DTCLib::RequestPacer::GetReport() const
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	RequestPacerReport report;
+	report.requests = requests_;
+	report.paces = paces_;
+	report.elapsedSeconds = std::chrono::duration<double>((stopped_ ? stop_ : clock_->Now()) - start_).count();
+	report.requestedRate = rate_;
+	if (lastDue_.count() > 0)
+		report.requestedRate = requestsBeforeLastPace_ / std::chrono::duration<double>(lastDue_).count();  // Mean rate of the schedule
+	// Measured from the first to the last pace, so that the last burst is not counted without its interval
+	auto pacedSeconds = std::chrono::duration<double>(lastPace_ - start_).count();
+	report.achievedRate = paces_ > 1 && pacedSeconds > 0 ? requestsBeforeLastPace_ / pacedSeconds : 0;
+	report.latePaces = latePaces_;
+	report.maximumLatenessUs = maximumLateness_.count() / 1000.0;
+	return report;
+}
+
+std::string DTCLib::RequestPacer::FormatReport() const
+{
+	auto report = GetReport();
+	std::ostringstream o;
+	o << std::fixed << std::setprecision(1) << report.requests << " requests in " << report.paces << " bursts, "
+	  << report.elapsedSeconds * 1000 << " ms: achieved " << report.achievedRate << " /s";
+	if (report.requestedRate > 0)
+	{
+		o << " of " << report.requestedRate << " /s requested (" << 100 * report.achievedRate / report.requestedRate << "%), "
+		  << report.latePaces << " late, maximum lateness " << report.maximumLatenessUs << " us";
+	}
+	else
+		o << " (not paced)";
+	return o.str();
+}
@@ -0,0 +1,133 @@
+#ifndef REQUESTPACER_H
+#define REQUESTPACER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "RequestClock.h"
+
+namespace DTCLib {
+
+/// <summary>
+/// Requested and achieved request rates of a RequestPacer
+/// </summary>
+struct RequestPacerReport
+{
+	uint64_t requests = 0;         ///< Requests paced since Start
+	uint64_t paces = 0;            ///< Calls to Pace (bursts) since Start
+	double elapsedSeconds = 0;     ///< Time from Start to Stop (or to now, if not stopped)
+	double requestedRate = 0;      ///< Requests per second asked for, or mean rate of the schedule (0: not paced)
+	double achievedRate = 0;       ///< Requests per second, from the first to the last Pace
+	uint64_t latePaces = 0;        ///< Paces which found their deadline already passed
+	double maximumLatenessUs = 0;  ///< Largest delay past a deadline, in microseconds
+};
+
+/// <summary>
+/// The RequestPacer spaces requests on a steady-clock deadline schedule: request n is due at start + n / rate, so
+/// that the time spent sending does not add up over a run as it does with a sleep between requests. Waits longer than
+/// the spin threshold sleep until the threshold, then spin on the clock up to the deadline, which gives microsecond
+/// spacing that usleep alone cannot. A pacer which falls behind sends without waiting until it has caught up.
+/// All times come from the pacer's RequestClock, so that a simulated clock makes the pacing exact.
+///
+/// One thread paces the requests; the rate and the report can be read from any thread, e.g. while a range runs.
+/// </summary>
+class RequestPacer
+{
+public:
+	/// <summary>
+	/// Construct a RequestPacer
+	/// </summary>
+	/// <param name="requestsPerSecond">Request rate (0: do not wait)</param>
+	/// <param name="spinThreshold">Last part of each wait which is spent spinning instead of sleeping</param>
+	/// <param name="clock">Time source (nullptr: the steady clock)</param>
+	explicit RequestPacer(double requestsPerSecond = 0, std::chrono::nanoseconds spinThreshold = std::chrono::microseconds(100),
+						  std::shared_ptr<RequestClock> clock = nullptr);
+
+	/// <summary>
+	/// Set the request rate. The schedule is restarted from the next request, so a change takes effect immediately.
+	/// </summary>
+	/// <param name="requestsPerSecond">Request rate (0: do not wait)</param>
+	void SetRate(double requestsPerSecond);
+	/// <summary>
+	/// Get the request rate
+	/// </summary>
+	/// <returns>Requests per second, 0 if not paced</returns>
+	double GetRate() const;
+	/// <summary>
+	/// Set the request rate from a delay between requests
+	/// </summary>
+	/// <param name="delayUs">Delay between requests, in microseconds (0: do not wait)</param>
+	void SetDelay(double delayUs) { SetRate(delayUs > 0 ? 1e6 / delayUs : 0); }
+
+	/// <summary>
+	/// Start the schedule and the rate measurement: the first Pace returns immediately
+	/// </summary>
+	void Start();
+	/// <summary>
+	/// Wait for the deadline of the next request, then count the given number of requests (a burst sent together)
+	/// </summary>
+	/// <param name="requests">Number of requests about to be sent</param>
+	void Pace(uint64_t requests = 1);
+	/// <summary>
+	/// Wait until the given time after Start, then count the given number of requests. This paces requests on an
+	/// explicit schedule (see RequestSchedule) instead of the rate; the requested rate is then the mean rate of the
+	/// schedule.
+	/// </summary>
+	/// <param name="due">Time of the requests, from Start</param>
+	/// <param name="requests">Number of requests about to be sent</param>
+	void PaceAt(std::chrono::nanoseconds due, uint64_t requests = 1);
+	/// <summary>
+	/// Stop the rate measurement, once the last request was sent
+	/// </summary>
+	void Stop();
+
+	/// <summary>
+	/// Wait until the given time, sleeping, then spinning for the last spin threshold
+	/// </summary>
+	/// <param name="deadline">Time to wait for</param>
+	void WaitUntil(std::chrono::steady_clock::time_point deadline) const { clock_->WaitUntil(deadline, spinThreshold_); }
+	/// <summary>
+	/// Get the time source of the pacer
+	/// </summary>
+	/// <returns>Clock</returns>
+	const std::shared_ptr<RequestClock>& GetClock() const { return clock_; }
+
+	/// <summary>
+	/// Get the requested and achieved rates
+	/// </summary>
+	/// <returns>Rate report</returns>
+	RequestPacerReport GetReport() const;
+	/// <summary>
+	/// Format the requested and achieved rates
+	/// </summary>
+	/// <returns>One-line rate report</returns>
+	std::string FormatReport() const;
+
+private:
+	void Wait_(std::chrono::steady_clock::time_point deadline, bool countLateness);
+	void Count_(uint64_t requests);  ///< Called with mutex_ held
+
+	mutable std::mutex mutex_;  ///< Held while the pacing thread updates what GetRate and GetReport read
+	double rate_;
+	std::chrono::nanoseconds spinThreshold_;
+	std::shared_ptr<RequestClock> clock_;
+	std::chrono::steady_clock::time_point start_;
+	std::chrono::steady_clock::time_point stop_;
+	bool stopped_;
+	std::chrono::steady_clock::time_point epoch_;  ///< Due time of request epochRequest_
+	uint64_t epochRequest_;
+	std::chrono::steady_clock::time_point lastPace_;
+	std::chrono::nanoseconds lastDue_;  ///< Time of the last PaceAt, 0 when pacing by rate
+	uint64_t requestsBeforeLastPace_;
+	uint64_t requests_;
+	uint64_t paces_;
+	uint64_t latePaces_;
+	std::chrono::nanoseconds maximumLateness_;
+};
+
+}  // namespace DTCLib
+
+#endif  // REQUESTPACER_H
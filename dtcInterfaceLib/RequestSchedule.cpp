@@ -0,0 +1,244 @@
+#include "RequestSchedule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "TRACE/tracemf.h"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+namespace {
+std::vector<std::string> SplitSpecification(const std::string& specification)
+{
+	std::vector<std::string> fields;
+	std::istringstream in(specification);
+	std::string field;
+	while (std::getline(in, field, ':')) fields.push_back(field);
+	return fields;
+}
+}  // namespace
+
+std::unique_ptr<DTCLib::RequestSchedule> DTCLib::RequestSchedule::Create(const std::string& specification)
+{
+	auto fields = SplitSpecification(specification);
+	try
+	{
+		if (fields.size() == 2 && fields[0] == "uniform") return std::make_unique<UniformRequestSchedule>(std::stod(fields[1]));
+		if (fields.size() == 1 && fields[0] == "spill") return std::make_unique<SpillCycleRequestSchedule>();
+		if (fields.size() == 6 && fields[0] == "spill")
+		{
+			SpillCycleParameters parameters;
+			parameters.microbunchNs = std::stoull(fields[1]);
+			parameters.spillNs = static_cast<uint64_t>(std::stod(fields[2]) * 1e6);
+			parameters.spillGapNs = static_cast<uint64_t>(std::stod(fields[3]) * 1e6);
+			parameters.spillsPerCycle = std::stoul(fields[4]);
+			parameters.cycleNs = static_cast<uint64_t>(std::stod(fields[5]) * 1e6);
+			return std::make_unique<SpillCycleRequestSchedule>(parameters);
+		}
+		if ((fields.size() == 2 || fields.size() == 3) && fields[0] == "poisson")
+			return std::make_unique<PoissonRequestSchedule>(std::stod(fields[1]), fields.size() == 3 ? std::stoull(fields[2]) : 1);
+		if (fields.size() == 4 && fields[0] == "bursty")
+			return std::make_unique<BurstyRequestSchedule>(std::stod(fields[1]), static_cast<uint64_t>(std::stod(fields[2]) * 1e3), std::stod(fields[3]));
+		if ((fields.size() == 2 || fields.size() == 3) && fields[0] == "replay")
+			return ReplayRequestSchedule::LoadFile(fields[1], fields.size() == 3 ? std::stoull(fields[2]) : 1695);
+	}
+	catch (std::invalid_argument const&)
+	{
+	}
+	catch (std::out_of_range const&)
+	{
+	}
+
+	__SS__ << "Invalid request schedule '" << specification
+		   << "'; expected uniform:RATE, spill[:MICROBUNCH_NS:SPILL_MS:GAP_MS:SPILLS:CYCLE_MS], poisson:RATE[:SEED], "
+		   << "bursty:RATE:PERIOD_US:DUTY_CYCLE or replay:FILE[:SPACING_NS]" << __E__;
+	__SS_THROW__;
+}  // end Create()
+
+DTCLib::UniformRequestSchedule::UniformRequestSchedule(double requestsPerSecond)
+	: periodNs_(0), count_(0)
+{
+	if (!(requestsPerSecond > 0))
+	{
+		__SS__ << "The request rate must be positive, not " << requestsPerSecond << __E__;
+		__SS_THROW__;
+	}
+	periodNs_ = 1e9 / requestsPerSecond;
+}
+
+bool DTCLib::UniformRequestSchedule::Next(RequestScheduleEntry& entry)
+{
+	entry.timeNs = static_cast<uint64_t>(count_ * periodNs_);
+	entry.tag = count_++;
+	return true;
+}
+
+std::string DTCLib::UniformRequestSchedule::Describe() const
+{
+	std::ostringstream o;
+	o << "uniform, " << 1e9 / periodNs_ << " requests/s";
+	return o.str();
+}
+
+DTCLib::SpillCycleRequestSchedule::SpillCycleRequestSchedule(const SpillCycleParameters& parameters)
+	: parameters_(parameters), microbunchesPerSpill_(0), microbunch_(0), spill_(0), cycle_(0), count_(0)
+{
+	if (parameters_.microbunchNs == 0 || parameters_.spillNs < parameters_.microbunchNs || parameters_.spillsPerCycle == 0 ||
+		parameters_.cycleNs < parameters_.spillsPerCycle * (parameters_.spillNs + parameters_.spillGapNs) - parameters_.spillGapNs)
+	{
+		__SS__ << "Invalid spill cycle: " << parameters_.spillsPerCycle << " spills of " << parameters_.spillNs << " ns, "
+			   << parameters_.spillGapNs << " ns apart, do not fit in a cycle of " << parameters_.cycleNs << " ns with "
+			   << parameters_.microbunchNs << " ns microbunches" << __E__;
+		__SS_THROW__;
+	}
+	microbunchesPerSpill_ = parameters_.spillNs / parameters_.microbunchNs;
+}
+
+bool DTCLib::SpillCycleRequestSchedule::Next(RequestScheduleEntry& entry)
+{
+	entry.timeNs = cycle_ * parameters_.cycleNs + spill_ * (parameters_.spillNs + parameters_.spillGapNs) + microbunch_ * parameters_.microbunchNs;
+	entry.tag = count_++;
+
+	if (++microbunch_ == microbunchesPerSpill_)
+	{
+		microbunch_ = 0;
+		if (++spill_ == parameters_.spillsPerCycle)
+		{
+			spill_ = 0;
+			++cycle_;
+		}
+	}
+	return true;
+}
+
+void DTCLib::SpillCycleRequestSchedule::Reset()
+{
+	microbunch_ = 0;
+	spill_ = 0;
+	cycle_ = 0;
+	count_ = 0;
+}
+
+std::string DTCLib::SpillCycleRequestSchedule::Describe() const
+{
+	std::ostringstream o;
+	o << "spill cycle, " << parameters_.spillsPerCycle << " spills of " << parameters_.spillNs / 1e6 << " ms every "
+	  << (parameters_.spillNs + parameters_.spillGapNs) / 1e6 << " ms per " << parameters_.cycleNs / 1e6 << " ms cycle, "
+	  << microbunchesPerSpill_ << " microbunches of " << parameters_.microbunchNs << " ns per spill";
+	return o.str();
+}
+
+DTCLib::PoissonRequestSchedule::PoissonRequestSchedule(double requestsPerSecond, uint64_t seed)
+	: rate_(requestsPerSecond), seed_(seed), engine_(seed), intervals_(1), timeNs_(0), count_(0)
+{
+	if (!(requestsPerSecond > 0))
+	{
+		__SS__ << "The request rate must be positive, not " << requestsPerSecond << __E__;
+		__SS_THROW__;
+	}
+	intervals_ = std::exponential_distribution<double>(requestsPerSecond / 1e9);
+}
+
+bool DTCLib::PoissonRequestSchedule::Next(RequestScheduleEntry& entry)
+{
+	entry.timeNs = static_cast<uint64_t>(timeNs_);
+	entry.tag = count_++;
+	timeNs_ += intervals_(engine_);
+	return true;
+}
+
+void DTCLib::PoissonRequestSchedule::Reset()
+{
+	engine_.seed(seed_);
+	intervals_.reset();
+	timeNs_ = 0;
+	count_ = 0;
+}
+
+std::string DTCLib::PoissonRequestSchedule::Describe() const
+{
+	std::ostringstream o;
+	o << "Poisson, " << rate_ << " requests/s, seed " << seed_;
+	return o.str();
+}
+
+DTCLib::BurstyRequestSchedule::BurstyRequestSchedule(double requestsPerSecond, uint64_t periodNs, double dutyCycle)
+	: rate_(requestsPerSecond), periodNs_(periodNs), dutyCycle_(dutyCycle), requestsPerPeriod_(0), count_(0)
+{
+	if (!(requestsPerSecond > 0) || periodNs == 0 || !(dutyCycle > 0) || dutyCycle > 1)
+	{
+		__SS__ << "Invalid bursty schedule: " << requestsPerSecond << " requests/s, period " << periodNs << " ns, duty cycle "
+			   << dutyCycle << __E__;
+		__SS_THROW__;
+	}
+	requestsPerPeriod_ = std::max<uint64_t>(1, static_cast<uint64_t>(std::floor(periodNs * dutyCycle * requestsPerSecond / 1e9)));
+}
+
+bool DTCLib::BurstyRequestSchedule::Next(RequestScheduleEntry& entry)
+{
+	entry.timeNs = (count_ / requestsPerPeriod_) * periodNs_ + static_cast<uint64_t>((count_ % requestsPerPeriod_) * 1e9 / rate_);
+	entry.tag = count_++;
+	return true;
+}
+
+std::string DTCLib::BurstyRequestSchedule::Describe() const
+{
+	std::ostringstream o;
+	o << "bursty, " << rate_ << " requests/s for " << dutyCycle_ * 100 << "% of each " << periodNs_ / 1e3 << " us period ("
+	  << requestsPerPeriod_ << " requests per burst)";
+	return o.str();
+}
+
+DTCLib::ReplayRequestSchedule::ReplayRequestSchedule(const std::vector<RequestScheduleEntry>& entries)
+	: entries_(entries), next_(0)
+{
+	for (size_t ii = 1; ii < entries_.size(); ++ii)
+	{
+		if (entries_[ii].timeNs < entries_[ii - 1].timeNs)
+		{
+			__SS__ << "Replayed request " << ii << " (tag " << entries_[ii].tag << ") is earlier than the one before it" << __E__;
+			__SS_THROW__;
+		}
+	}
+}
+
+std::unique_ptr<DTCLib::ReplayRequestSchedule> DTCLib::ReplayRequestSchedule::LoadFile(const std::string& fileName, uint64_t spacingNs)
+{
+	std::ifstream file(fileName);
+	if (!file)
+	{
+		__SS__ << "Cannot open request list " << fileName << __E__;
+		__SS_THROW__;
+	}
+
+	std::vector<RequestScheduleEntry> entries;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#') continue;
+		std::istringstream in(line);
+		RequestScheduleEntry entry;
+		if (!(in >> entry.tag)) continue;
+		if (!(in >> entry.timeNs)) entry.timeNs = entries.empty() ? 0 : entries.back().timeNs + spacingNs;
+		entries.push_back(entry);
+	}
+	__COUT__ << "Loaded " << entries.size() << " requests from " << fileName << __E__;
+	return std::make_unique<ReplayRequestSchedule>(entries);
+}  // end LoadFile()
+
+bool DTCLib::ReplayRequestSchedule::Next(RequestScheduleEntry& entry)
+{
+	if (next_ >= entries_.size()) return false;
+	entry = entries_[next_++];
+	return true;
+}
+
+std::string DTCLib::ReplayRequestSchedule::Describe() const
+{
+	std::ostringstream o;
+	o << "replay of " << entries_.size() << " requests";
+	if (!entries_.empty()) o << " over " << entries_.back().timeNs / 1e6 << " ms";
+	return o.str();
+}
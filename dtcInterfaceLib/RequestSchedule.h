@@ -0,0 +1,191 @@
+#ifndef REQUESTSCHEDULE_H
+#define REQUESTSCHEDULE_H
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace DTCLib {
+
+/// <summary>
+/// One request of a RequestSchedule
+/// </summary>
+struct RequestScheduleEntry
+{
+	uint64_t timeNs = 0;  ///< Time of the request, from the start of the schedule
+	uint64_t tag = 0;     ///< Event Window Tag of the request, as an offset from the starting tag
+};
+
+/// <summary>
+/// A RequestSchedule generates the times and Event Window Tags of software requests (see
+/// DTCSoftwareCFO::setRequestSchedule), so that tests can reproduce the time structure of the beam instead of an even
+/// spacing. Schedules are deterministic: after Reset, a schedule generates the same requests again.
+/// </summary>
+class RequestSchedule
+{
+public:
+	virtual ~RequestSchedule() = default;
+
+	/// <summary>
+	/// Generate the next request
+	/// </summary>
+	/// <param name="entry">Time and tag of the request</param>
+	/// <returns>False if the schedule has no more requests</returns>
+	virtual bool Next(RequestScheduleEntry& entry) = 0;
+	/// <summary>
+	/// Restart the schedule from its first request
+	/// </summary>
+	virtual void Reset() = 0;
+	/// <summary>
+	/// Describe the schedule and its parameters
+	/// </summary>
+	/// <returns>One-line description</returns>
+	virtual std::string Describe() const = 0;
+
+	/// <summary>
+	/// Create a schedule from a specification, as given on the command line:
+	///   uniform:RATE
+	///   spill[:MICROBUNCH_NS:SPILL_MS:GAP_MS:SPILLS:CYCLE_MS]
+	///   poisson:RATE[:SEED]
+	///   bursty:RATE:PERIOD_US:DUTY_CYCLE
+	///   replay:FILE[:SPACING_NS]
+	/// Rates are in requests per second.
+	/// </summary>
+	/// <param name="specification">Schedule specification</param>
+	/// <returns>The schedule. Throws on an invalid specification.</returns>
+	static std::unique_ptr<RequestSchedule> Create(const std::string& specification);
+};
+
+/// <summary>
+/// Evenly spaced requests with consecutive tags
+/// </summary>
+class UniformRequestSchedule : public RequestSchedule
+{
+public:
+	explicit UniformRequestSchedule(double requestsPerSecond);
+
+	bool Next(RequestScheduleEntry& entry) override;
+	void Reset() override { count_ = 0; }
+	std::string Describe() const override;
+
+private:
+	double periodNs_;
+	uint64_t count_;
+};
+
+/// <summary>
+/// Parameters of the Mu2e spill cycle (SpillCycleRequestSchedule). The defaults are the nominal slow extraction: eight
+/// 43.1 ms spills, 5 ms apart, in each 1.4 s Main Injector cycle, with one event window per 1695 ns microbunch.
+/// </summary>
+struct SpillCycleParameters
+{
+	uint64_t microbunchNs = 1695;
+	uint64_t spillNs = 43100000;
+	uint64_t spillGapNs = 5000000;  ///< Between the spills of a cycle
+	uint32_t spillsPerCycle = 8;
+	uint64_t cycleNs = 1400000000;
+};
+
+/// <summary>
+/// One request per microbunch during the spills of the Mu2e spill cycle, none between spills or between the last
+/// spill and the next cycle. Tags are consecutive.
+/// </summary>
+class SpillCycleRequestSchedule : public RequestSchedule
+{
+public:
+	explicit SpillCycleRequestSchedule(const SpillCycleParameters& parameters = SpillCycleParameters());
+
+	bool Next(RequestScheduleEntry& entry) override;
+	void Reset() override;
+	std::string Describe() const override;
+
+private:
+	SpillCycleParameters parameters_;
+	uint64_t microbunchesPerSpill_;
+	uint64_t microbunch_;  ///< In the current spill
+	uint32_t spill_;       ///< In the current cycle
+	uint64_t cycle_;
+	uint64_t count_;
+};
+
+/// <summary>
+/// Requests at exponentially distributed intervals (a Poisson process) with consecutive tags
+/// </summary>
+class PoissonRequestSchedule : public RequestSchedule
+{
+public:
+	PoissonRequestSchedule(double requestsPerSecond, uint64_t seed = 1);
+
+	bool Next(RequestScheduleEntry& entry) override;
+	void Reset() override;
+	std::string Describe() const override;
+
+private:
+	double rate_;
+	uint64_t seed_;
+	std::mt19937_64 engine_;
+	std::exponential_distribution<double> intervals_;
+	double timeNs_;
+	uint64_t count_;
+};
+
+/// <summary>
+/// Evenly spaced requests during the first dutyCycle of each period, none for the rest of the period. Tags are
+/// consecutive.
+/// </summary>
+class BurstyRequestSchedule : public RequestSchedule
+{
+public:
+	/// <summary>
+	/// Construct a BurstyRequestSchedule
+	/// </summary>
+	/// <param name="requestsPerSecond">Request rate during the on part of each period</param>
+	/// <param name="periodNs">Period of the on/off cycle</param>
+	/// <param name="dutyCycle">Fraction of each period with requests (0 to 1)</param>
+	BurstyRequestSchedule(double requestsPerSecond, uint64_t periodNs, double dutyCycle);
+
+	bool Next(RequestScheduleEntry& entry) override;
+	void Reset() override { count_ = 0; }
+	std::string Describe() const override;
+
+private:
+	double rate_;
+	uint64_t periodNs_;
+	double dutyCycle_;
+	uint64_t requestsPerPeriod_;
+	uint64_t count_;
+};
+
+/// <summary>
+/// Replay of a recorded list of requests, e.g. the tags of a run (as offsets from the starting tag, so start the
+/// requests at tag 0 to replay absolute tags)
+/// </summary>
+class ReplayRequestSchedule : public RequestSchedule
+{
+public:
+	explicit ReplayRequestSchedule(const std::vector<RequestScheduleEntry>& entries);
+
+	/// <summary>
+	/// Load a request list from a text file with one request per line: the tag, then optionally the time in
+	/// nanoseconds. Requests without a time follow the previous one after the given spacing. Lines starting with # are
+	/// skipped.
+	/// </summary>
+	/// <param name="fileName">File to load</param>
+	/// <param name="spacingNs">Spacing of requests without a time</param>
+	/// <returns>The schedule. Throws if the file cannot be read or is not in time order.</returns>
+	static std::unique_ptr<ReplayRequestSchedule> LoadFile(const std::string& fileName, uint64_t spacingNs = 1695);
+
+	bool Next(RequestScheduleEntry& entry) override;
+	void Reset() override { next_ = 0; }
+	std::string Describe() const override;
+
+private:
+	std::vector<RequestScheduleEntry> entries_;
+	size_t next_;
+};
+
+}  // namespace DTCLib
+
+#endif  // REQUESTSCHEDULE_H
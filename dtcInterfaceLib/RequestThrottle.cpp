@@ -0,0 +1,142 @@
+#include "RequestThrottle.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "RequestThrottle"
+
+#include "dtcInterfaceLib/otsStyleCoutMacros.h"
+
+DTCLib::RequestThrottle::RequestThrottle(DTC_Registers* registers, const RequestThrottleParameters& parameters, std::shared_ptr<RequestClock> clock)
+	: registers_(registers), parameters_(parameters), clock_(clock ? clock : RequestClock::Steady()), rate_(parameters.initialRate), haveSample_(false), previousOccupancy_(0), previousDrops_(0), history_(), lastPoll_(clock_->Now()), lastPollRequests_(0), report_(), occupancySum_(0)
+{
+	if (!(parameters_.minimumRate > 0) || parameters_.maximumRate < parameters_.minimumRate || parameters_.targetOccupancy <= 0 ||
+		parameters_.targetOccupancy >= 1 || !(parameters_.backoff > 0) || parameters_.backoff >= 1)
+	{
+		__SS__ << "Invalid request throttle: target occupancy " << parameters_.targetOccupancy << " (0 to 1), rates "
+			   << parameters_.minimumRate << " to " << parameters_.maximumRate << " /s, backoff " << parameters_.backoff
+			   << " (0 to 1)" << __E__;
+		__SS_THROW__;
+	}
+	Start();
+}
+
+void DTCLib::RequestThrottle::Start()
+{
+	rate_ = std::min(std::max(parameters_.initialRate, parameters_.minimumRate), parameters_.maximumRate);
+	haveSample_ = false;
+	previousOccupancy_ = 0;
+	previousDrops_ = 0;
+	history_.clear();
+	lastPoll_ = clock_->Now();
+	lastPollRequests_ = 0;
+	report_ = RequestThrottleReport();
+	report_.rate = rate_;
+	occupancySum_ = 0;
+}
+
+DTCLib::RequestThrottleSample DTCLib::RequestThrottle::Sample()
+{
+	if (registers_ == nullptr)
+	{
+		__SS__ << "Request throttle has no DTC to sample" << __E__;
+		__SS_THROW__;
+	}
+
+	RequestThrottleSample sample;
+	auto status = registers_->ReadDDRBufferStatus();
+	sample.ddrFill = status.GetFill();
+	sample.fullBuffers = status.GetFullBuffers();
+	sample.drops = static_cast<uint64_t>(status.inputBufferDrops) + status.outputBufferDrops;
+
+	unsigned filled = 0, size = 0;
+	if (registers_->GetDevice()->read_ring_occupancy(DTC_DMA_Engine_DAQ, &filled, &size) == 0 && size > 0)
+		sample.ringFill = static_cast<double>(filled) / size;
+	return sample;
+}  // end Sample()
+
+double DTCLib::RequestThrottle::Update(const RequestThrottleSample& sample, double intervalRate)
+{
+	auto occupancy = sample.GetOccupancy();
+
+	// The drop counters are cumulative; the first sample (or a counter cleared meanwhile) is the baseline
+	uint64_t drops = haveSample_ && sample.drops >= previousDrops_ ? sample.drops - previousDrops_ : 0;
+	previousDrops_ = sample.drops;
+	auto overflow = sample.fullBuffers > 0 || drops > 0;
+
+	++report_.samples;
+	if (overflow) ++report_.overflowSamples;
+	report_.drops += drops;
+	occupancySum_ += occupancy;
+	report_.meanOccupancy = occupancySum_ / report_.samples;
+	report_.maximumOccupancy = std::max(report_.maximumOccupancy, occupancy);
+
+	// Sustainable: no overflow and at most the target through the window, and no net fill from its start to its end
+	history_.push_back({occupancy, intervalRate, overflow});
+	if (history_.size() > parameters_.sustainSamples + 1) history_.pop_front();
+	if (history_.size() == parameters_.sustainSamples + 1)
+	{
+		auto sustained = history_.back().occupancy <= history_.front().occupancy + parameters_.occupancyTolerance;
+		double rateSum = 0;
+		for (size_t ii = 1; ii < history_.size(); ++ii)
+		{
+			sustained = sustained && !history_[ii].overflow && history_[ii].occupancy <= parameters_.targetOccupancy + parameters_.occupancyTolerance;
+			rateSum += history_[ii].rate;
+		}
+		if (sustained) report_.maximumSustainableRate = std::max(report_.maximumSustainableRate, rateSum / parameters_.sustainSamples);
+	}
+
+	// The integral term moves the rate towards the target; the proportional term, on the change of occupancy (which
+	// follows the excess of the rate over the drain), damps the overshoot
+	double factor = parameters_.backoff;
+	if (!overflow)
+	{
+		auto change = haveSample_ ? occupancy - previousOccupancy_ : 0;
+		factor = 1 + parameters_.integralGain * (parameters_.targetOccupancy - occupancy) - parameters_.proportionalGain * change;
+		factor = std::min(std::max(factor, parameters_.backoff), 1.5);  // At most +50% per sample, so that a step up cannot overfill
+	}
+	rate_ = std::min(std::max(rate_ * factor, parameters_.minimumRate), parameters_.maximumRate);
+	report_.rate = rate_;
+
+	previousOccupancy_ = occupancy;
+	haveSample_ = true;
+	TLOG(TLVL_DEBUG + 5) << "Occupancy " << occupancy << " (DDR " << sample.ddrFill << ", ring " << sample.ringFill << "), "
+						 << sample.fullBuffers << " full buffers, " << drops << " drops: rate " << rate_ << " /s";
+	return rate_;
+}  // end Update()
+
+bool DTCLib::RequestThrottle::Poll(RequestPacer& pacer)
+{
+	auto now = clock_->Now();
+	if (now - lastPoll_ < parameters_.samplePeriod) return false;
+
+	auto requests = pacer.GetReport().requests;
+	auto seconds = std::chrono::duration<double>(now - lastPoll_).count();
+	auto intervalRate = requests >= lastPollRequests_ ? (requests - lastPollRequests_) / seconds : 0;
+	lastPoll_ = now;
+	lastPollRequests_ = requests;
+
+	pacer.SetRate(Update(Sample(), intervalRate));
+	return true;
+}  // end Poll()
+
+DTCLib::RequestThrottleReport DTCLib::RequestThrottle::GetReport() const
+{
+	return report_;
+}
+
+std::string DTCLib::RequestThrottle::FormatReport() const
+{
+	std::ostringstream o;
+	o << std::fixed << std::setprecision(1) << "target occupancy " << 100 * parameters_.targetOccupancy << "%: maximum sustainable rate ";
+	if (report_.maximumSustainableRate > 0)
+		o << report_.maximumSustainableRate << " /s";
+	else
+		o << "not found";
+	o << ", final rate " << report_.rate << " /s, occupancy mean " << 100 * report_.meanOccupancy << "% maximum "
+	  << 100 * report_.maximumOccupancy << "%, " << report_.overflowSamples << " of " << report_.samples
+	  << " samples overflowed, " << report_.drops << " drops";
+	return o.str();
+}
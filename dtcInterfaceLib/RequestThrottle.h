@@ -0,0 +1,160 @@
+#ifndef REQUESTTHROTTLE_H
+#define REQUESTTHROTTLE_H
+
+#include "DTC_Registers.h"
+#include "RequestPacer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace DTCLib {
+
+/// <summary>
+/// Parameters of a RequestThrottle. The rates are in event windows per second.
+/// </summary>
+struct RequestThrottleParameters
+{
+	double targetOccupancy = 0.5;  ///< Buffer occupancy to hold, from 0 (empty) to 1 (full)
+	double initialRate = 1000;
+	double minimumRate = 10;
+	double maximumRate = 1e7;
+	double integralGain = 0.2;      ///< Relative rate change per sample, per unit of occupancy below the target
+	double proportionalGain = 4;    ///< Relative rate change per sample, per unit of occupancy fall since the last sample
+	double backoff = 0.5;           ///< Rate factor when a buffer is full or data was dropped
+	std::chrono::milliseconds samplePeriod = std::chrono::milliseconds(10);
+	size_t sustainSamples = 50;       ///< Samples a rate must be held for to count as sustainable
+	double occupancyTolerance = 0.03;  ///< Occupancy change below the resolution of the flags and the ring
+};
+
+/// <summary>
+/// Buffer occupancy at one RequestThrottle sample
+/// </summary>
+struct RequestThrottleSample
+{
+	double ddrFill = 0;      ///< Estimated fill of the DDR3 buffers (see DTC_DDRBufferStatus::GetFill)
+	size_t fullBuffers = 0;  ///< DDR3 buffers flagged full
+	double ringFill = 0;     ///< Fraction of the host DAQ C2S ring filled by the DTC and not released yet
+	uint64_t drops = 0;      ///< Input plus output buffer drop counters
+
+	/// <summary>
+	/// Get the occupancy the throttle regulates: whichever of the DDR3 buffers and the host ring is fuller
+	/// </summary>
+	/// <returns>Occupancy, from 0 to 1</returns>
+	double GetOccupancy() const { return ddrFill > ringFill ? ddrFill : ringFill; }
+};
+
+/// <summary>
+/// Results of a RequestThrottle since Start
+/// </summary>
+struct RequestThrottleReport
+{
+	uint64_t samples = 0;
+	uint64_t overflowSamples = 0;       ///< Samples with a full buffer or new drops
+	uint64_t drops = 0;                 ///< Drops counted since the first sample
+	double rate = 0;                    ///< Current request rate
+	double maximumSustainableRate = 0;  ///< Highest rate held without overflow or net fill (0: none found yet)
+	double meanOccupancy = 0;
+	double maximumOccupancy = 0;
+};
+
+/// <summary>
+/// The RequestThrottle adjusts the rate of software requests (see DTCSoftwareCFO::setThrottle) to hold the DTC's
+/// DDR3 buffers and the host DAQ ring at a target occupancy. Each sample reads the DDR3 buffer flags and drop counters
+/// in one bulk read and the ring indices from the driver; the rate is then scaled up while the occupancy is below the
+/// target and down while it is above or rising, and cut by the backoff factor whenever a buffer is full or data was
+/// dropped.
+///
+/// A rate held for sustainSamples samples with no overflow, the occupancy at most the target and no net fill over
+/// those samples is sustainable; the highest such rate is the maximum throughput of the DTC and host without drops.
+/// The occupancy only rises measurably when the rate is above what the host drains, so the estimate is bounded by the
+/// occupancy tolerance over sustainSamples sample periods.
+///
+/// The loop can only hold the target when the buffers take several sample periods to fill at the rate excess; with
+/// smaller buffers (or faster hosts), shorten the sample period.
+/// </summary>
+class RequestThrottle
+{
+public:
+	/// <summary>
+	/// Construct a RequestThrottle
+	/// </summary>
+	/// <param name="registers">DTC to sample (nullptr: only Update is used, e.g. with samples from elsewhere)</param>
+	/// <param name="parameters">Target, rate limits and loop gains</param>
+	/// <param name="clock">Time source of the sample period (nullptr: the steady clock); the same as the pacer's</param>
+	explicit RequestThrottle(DTC_Registers* registers, const RequestThrottleParameters& parameters = RequestThrottleParameters(),
+							 std::shared_ptr<RequestClock> clock = nullptr);
+
+	/// <summary>
+	/// Restart at the initial rate and clear the report
+	/// </summary>
+	void Start();
+	/// <summary>
+	/// Get the current request rate
+	/// </summary>
+	/// <returns>Event windows per second</returns>
+	double GetRate() const { return rate_; }
+	/// <summary>
+	/// Get the parameters of the throttle
+	/// </summary>
+	/// <returns>Parameters</returns>
+	const RequestThrottleParameters& GetParameters() const { return parameters_; }
+
+	/// <summary>
+	/// Read the DDR3 buffer flags, the drop counters and the host ring occupancy
+	/// </summary>
+	/// <returns>Occupancy sample</returns>
+	RequestThrottleSample Sample();
+	/// <summary>
+	/// Update the rate from an occupancy sample
+	/// </summary>
+	/// <param name="sample">Occupancy at the end of the sample period</param>
+	/// <param name="intervalRate">Request rate achieved during the sample period</param>
+	/// <returns>New request rate</returns>
+	double Update(const RequestThrottleSample& sample, double intervalRate);
+	/// <summary>
+	/// Sample and update the rate of the pacer, if the sample period has passed since the last sample. Called
+	/// between the requests, so that the throttle runs in the request thread.
+	/// </summary>
+	/// <param name="pacer">Pacer of the requests</param>
+	/// <returns>Whether a sample was taken</returns>
+	bool Poll(RequestPacer& pacer);
+
+	/// <summary>
+	/// Get the results since Start
+	/// </summary>
+	/// <returns>Throttle report</returns>
+	RequestThrottleReport GetReport() const;
+	/// <summary>
+	/// Format the results since Start
+	/// </summary>
+	/// <returns>One-line throttle report</returns>
+	std::string FormatReport() const;
+
+private:
+	struct History
+	{
+		double occupancy;
+		double rate;
+		bool overflow;
+	};
+
+	DTC_Registers* registers_;
+	RequestThrottleParameters parameters_;
+	std::shared_ptr<RequestClock> clock_;
+	double rate_;
+	bool haveSample_;
+	double previousOccupancy_;
+	uint64_t previousDrops_;
+	std::deque<History> history_;  ///< The last sustainSamples + 1 samples
+	std::chrono::steady_clock::time_point lastPoll_;
+	uint64_t lastPollRequests_;
+	RequestThrottleReport report_;
+	double occupancySum_;
+};
+
+}  // namespace DTCLib
+
+#endif  // REQUESTTHROTTLE_H
@@ -0,0 +1,92 @@
+// DCS broker daemon: owns the DCS channel of one DTC and serves DCS requests
+// from client processes (see DCSBrokerClient) over shared memory.
+
+#include <signal.h>
+#include <iostream>
+#include <string>
+
+#include "TRACE/tracemf.h"
+#define TRACE_NAME "mu2eDCSBroker"
+
+#include "dtcInterfaceLib/DCSBroker.h"
+
+using namespace DTCLib;
+
+static DCSBroker* theBroker = nullptr;
+
+static void stopBroker(int)
+{
+	if (theBroker != nullptr) theBroker->Stop();
+}
+
+void printHelpMsg()
+{
+	std::cout << "Usage: mu2eDCSBroker [options]" << std::endl;
+	std::cout << "Options are:" << std::endl
+			  << " -h: This message." << std::endl
+			  << " -n: Name of the shared memory segment (Default: /mu2e_dcs_broker_<dtc>)" << std::endl
+			  << " --dtc: Use dtc <num> (Defaults to DTCLIB_DTC if set, 0 otherwise, see ls /dev/mu2e* for available DTCs)" << std::endl
+			  << " --sim: Run on the simulated DTC (mu2esim)" << std::endl;
+	exit(0);
+}
+
+int main(int argc, char* argv[])
+{
+	int dtc = -1;
+	std::string shmName = "";
+	auto simMode = DTC_SimMode_NoCFO;
+
+	for (auto optind = 1; optind < argc; ++optind)
+	{
+		if (argv[optind][0] == '-')
+		{
+			switch (argv[optind][1])
+			{
+				case 'n':
+					shmName = DTCLib::Utilities::getOptionString(&optind, &argv);
+					break;
+				case '-':  // Long option
+				{
+					auto option = DTCLib::Utilities::getLongOptionOption(&optind, &argv);
+					if (option == "--dtc")
+					{
+						dtc = DTCLib::Utilities::getLongOptionValue(&optind, &argv);
+					}
+					else if (option == "--sim")
+					{
+						simMode = DTC_SimMode_Performance;
+					}
+					else if (option == "--help")
+					{
+						printHelpMsg();
+					}
+					break;
+				}
+				default:
+					TLOG(TLVL_ERROR) << "Unknown option: " << argv[optind] << std::endl;
+					printHelpMsg();
+					break;
+				case 'h':
+					printHelpMsg();
+					break;
+			}
+		}
+	}
+
+	if (shmName == "") shmName = DCSBrokerDefaultName(dtc);
+
+	// Do not re-initialize the DTC, the broker only serves DCS traffic for the current configuration
+	DTC thisDTC(simMode, dtc, 0x1, "", simMode == DTC_SimMode_NoCFO /* skipInit */);
+	DCSBroker broker(&thisDTC, shmName);
+	theBroker = &broker;
+
+	signal(SIGINT, stopBroker);
+	signal(SIGTERM, stopBroker);
+
+	TLOG(TLVL_INFO) << "Serving DCS requests for DTC " << thisDTC.GetDevice()->getDeviceIndex() << " on " << shmName;
+	broker.Run();
+	theBroker = nullptr;
+
+	TLOG(TLVL_INFO) << "DCS broker exiting after serving " << broker.GetServedCount() << " requests";
+	return 0;
+}
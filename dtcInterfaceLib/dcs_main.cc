@@ -10,6 +10,7 @@
 #include <cmath>
 #include <cstdio>   // printf
 #include <cstdlib>  // strtoul
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -40,12 +41,16 @@ void printHelpMsg()
 		<< " -q: Quiet mode (Don't print requests)" << std::endl
 		<< " -Q: Really Quiet mode (Try not to print anything)" << std::endl
 		<< " -v: Expected DTC Design version string (Default: \"\")" << std::endl
-		<< " -c: Word count for Block Reads (Default: 0)" << std::endl
+		<< " -c: Word count for Block Reads and Writes (Default: 0)" << std::endl
 		<< " -i: Do not set the incrementAddress bit for block operations" << std::endl
 		<< " --dtc: Use dtc <num> (Defaults to DTCLIB_DTC if set, 0 otherwise, see ls /dev/mu2e* for available DTCs)" << std::endl
 		<< " --stop-on-error: Abort operation if an error occurs" << std::endl
-		<< " --timeout-ms Try this long to read a DCS DMA from the DTC (Default: 10 ms)"
-		<< " --link-mask ROC links to enable on DTC (Default: 0x111111)"
+		<< " --timeout-ms Try this long to read a DCS DMA from the DTC (Default: 10 ms)" << std::endl
+		<< " --link-mask ROC links to enable on DTC (Default: 0x111111)" << std::endl
+		<< " --file Binary file of 16-bit words to upload with block_write (Default: -c words of counter data)" << std::endl
+		<< " --packet-words Maximum number of words per DCS block write packet for block_write (Default: 8187)" << std::endl
+		<< " --window Number of block_write packets in flight before acks are collected, 0 for no acks (Default: 8)" << std::endl
+		<< " --verify Verify block_write by [none,readback,checksum] (Default: none)" << std::endl
 		;
 	exit(0);
 }
@@ -67,6 +72,10 @@ int main(int argc, char* argv[])
 	std::string op = "";
 	int dtc = -1;
 	bool stopOnError = false;
+	std::string blockFile = "";
+	size_t maxPacketWords = DTC_MAX_DCS_BLOCK_WORDS;
+	size_t window = 8;
+	auto verify = DTC_BlockUploadVerify_None;
 
 	for (auto optind = 1; optind < argc; ++optind)
 	{
@@ -123,6 +132,28 @@ int main(int argc, char* argv[])
 				else if (option == "--link-mask") {
 					link_mask = DTCLib::Utilities::getLongOptionValue(&optind, &argv);
 				}
+				else if (option == "--file")
+				{
+					blockFile = DTCLib::Utilities::getLongOptionString(&optind, &argv);
+				}
+				else if (option == "--packet-words")
+				{
+					maxPacketWords = DTCLib::Utilities::getLongOptionValue(&optind, &argv);
+				}
+				else if (option == "--window")
+				{
+					window = DTCLib::Utilities::getLongOptionValue(&optind, &argv);
+				}
+				else if (option == "--verify")
+				{
+					auto mode = DTCLib::Utilities::getLongOptionString(&optind, &argv);
+					if (mode == "readback")
+						verify = DTC_BlockUploadVerify_ReadBack;
+					else if (mode == "checksum")
+						verify = DTC_BlockUploadVerify_Checksum;
+					else
+						verify = DTC_BlockUploadVerify_None;
+				}
 				else if (option == "--help")
 				{
 					printHelpMsg();
@@ -369,11 +400,55 @@ int main(int argc, char* argv[])
 			try
 			{
 				std::vector<uint16_t> blockData;
-				for (size_t ii = 0; ii < count; ++ii)
+				if (blockFile != "")
+				{
+					std::ifstream file(blockFile, std::ios::binary);
+					if (!file)
+					{
+						TLOG(TLVL_ERROR) << "Could not open block data file " << blockFile;
+						break;
+					}
+					uint16_t word;
+					while (file.read(reinterpret_cast<char*>(&word), sizeof(word)))
+					{
+						blockData.push_back(word);
+					}
+				}
+				else
+				{
+					for (size_t ii = 0; ii < count; ++ii)
+					{
+						blockData.push_back(static_cast<uint16_t>(ii));
+					}
+				}
+
+				DTC_BlockUploadOptions options;
+				options.maxPacketWords = maxPacketWords;
+				options.window = window;
+				options.incrementAddress = incrementAddress;
+				options.verify = verify;
+				options.ack_tmo_ms = tmo_ms;
+				auto result = thisDTC->UploadROCBlock(dtc_link, address, blockData, options);
+
+				TLOG(DCS_TLVL(reallyQuiet)) << "Wrote " << result.words << " words in " << result.packets << " packets in "
+											<< result.uploadSeconds * 1000 << " ms (" << result.ThroughputMBps() << " MB/s), "
+											<< result.ackedPackets << " acks, " << result.ackTimeouts << " missing acks";
+				if (verify == DTC_BlockUploadVerify_ReadBack)
+				{
+					TLOG(DCS_TLVL(reallyQuiet)) << "Read-back verification " << (result.verified ? "passed" : "FAILED") << ": "
+												<< result.mismatches << " mismatched words"
+												<< (result.mismatches > 0 ? ", first at word " + std::to_string(result.firstMismatch) : "");
+				}
+				else if (verify == DTC_BlockUploadVerify_Checksum)
+				{
+					TLOG(DCS_TLVL(reallyQuiet)) << "Checksum verification " << (result.verified ? "passed" : "FAILED") << ": wrote 0x"
+												<< std::hex << result.checksum << ", read back 0x" << result.readBackChecksum;
+				}
+				if (!result.Success())
 				{
-					blockData.push_back(static_cast<uint16_t>(ii));
+					TLOG(TLVL_ERROR) << "Block write on iteration " << ii << " did not complete successfully";
+					if (stopOnError) break;
 				}
-				thisDTC->WriteROCBlock(dtc_link, address, blockData, false, incrementAddress, tmo_ms);
 			}
 			catch (std::runtime_error& err)
 			{
@@ -15,6 +15,8 @@ void printHelpMsg()
 	std::cout << "Options are:" << std::endl
 			  << "    -h: This message." << std::endl
 			  << "    -R: DON'T Print Register Dump." << std::endl
+			  << "    -j: Print the Register Dump as JSON (register names, values and table fields)." << std::endl
+			  << "    -b: Write the Register Dump in compact binary form to stdout, and nothing else." << std::endl
 			  << "    -s: Print SERDES Byte and Packet Counters." << std::endl
 			  << "    -p: Print Performance Counters." << std::endl
 			  << "    -e: Print SERDES Error Counters" << std::endl
@@ -32,6 +34,8 @@ int main(int argc, char* argv[])
 	auto printSERDESErrors = false;
 	auto printProtocolCounters = false;
 	auto printPerformanceCounters = false;
+	auto dumpFormat = DTCLib::RegisterDumpFormat_Text;
+	auto formattedDump = true;
 	int dtc = -1;
 	std::string memFileName = "mu2esim.bin";
 
@@ -47,6 +51,14 @@ int main(int argc, char* argv[])
 				case 'R':
 					printRegisterDump = false;
 					break;
+				case 'j':
+					dumpFormat = DTCLib::RegisterDumpFormat_JSON;
+					formattedDump = false;
+					break;
+				case 'b':
+					dumpFormat = DTCLib::RegisterDumpFormat_Binary;
+					formattedDump = false;
+					break;
 				case 'd':
 					dtc = DTCLib::Utilities::getOptionValue(&optind, &argv);
 					break;
@@ -75,6 +87,15 @@ int main(int argc, char* argv[])
 
 	auto thisDTC = new DTCLib::DTC_Registers(DTCLib::DTC_SimMode_Disabled, dtc,memFileName, 0x1, "", true);
 
+	if (dumpFormat == DTCLib::RegisterDumpFormat_Binary)
+	{
+		std::string dump;
+		thisDTC->FormatRegisterDump(dumpFormat, dump);
+		fwrite(dump.data(), 1, dump.size(), stdout);
+		delete thisDTC;
+		return 0;
+	}
+
 	auto cols = 80;
 	auto lines = 24;
 
@@ -99,10 +120,16 @@ int main(int argc, char* argv[])
 
 	std::cout << "Driver Version: " << thisDTC->GetDevice()->get_driver_version() << std::endl;
 
-	if (printRegisterDump)
+	if (printRegisterDump && formattedDump)
 	{
 		std::cout << thisDTC->FormattedRegDump(cols, thisDTC->formattedDumpFunctions_) << std::endl;
 	}
+	else if (printRegisterDump)
+	{
+		std::string dump;
+		thisDTC->FormatRegisterDump(dumpFormat, dump);
+		std::cout << dump << std::endl;
+	}
 
 	if (printSERDESCounters)
 	{
@@ -16,6 +16,7 @@
 #include "TRACE/tracemf.h"
 
 #include "mu2edev.h"
+#include "BringUpTimeline.h"
 
 #include "dtcInterfaceLib/otsStyleCoutMacros.h"
 
@@ -27,10 +28,10 @@ typedef unsigned long dma_addr_t;
 
 
 static const std::thread::id NULL_TID = std::thread::id();
-std::atomic<std::thread::id> mu2edev::dcs_lock_held_ = NULL_TID;
+std::atomic<std::thread::id> mu2edev::dcs_lock_held_[MU2E_MAX_NUM_DTCS];
 
 mu2edev::mu2edev()
-	: devfd_(0), buffers_held_(0), simulator_(nullptr), activeDeviceIndex_(0), deviceTime_(0LL), writeSize_(0), readSize_(0), UID_("")
+	: devfd_(0), buffers_held_(), simulator_(nullptr), activeDeviceIndex_(0), deviceTime_(0LL), writeSize_(0), readSize_(0), registerReads_(0), registerWrites_(0), UID_("")
 {
 	// TRACE_CNTL( "lvlmskM", 0x3 );
 	// TRACE_CNTL( "lvlmskS", 0x3 );
@@ -44,8 +45,9 @@ mu2edev::~mu2edev()
 	if (debugFp_) fclose(debugFp_);
 }
 
-int mu2edev::init(DTCLib::DTC_SimMode simMode, int deviceIndex, std::string simMemoryFileName, const std::string& uid)
+int mu2edev::init(DTCLib::DTC_SimMode simMode, int deviceIndex, std::string simMemoryFileName, const std::string& uid, bool simulateCFO)
 {
+	DTCLib::BringUpPhaseScope phase("mu2edev::init", this);
 	UID_ = uid;
 
 	auto debugWriteFilePath = getenv("DTCLIB_DEBUG_WRITE_FILE_PATH");
@@ -70,7 +72,8 @@ int mu2edev::init(DTCLib::DTC_SimMode simMode, int deviceIndex, std::string simM
 	if (simMode != DTCLib::DTC_SimMode_Disabled && simMode != DTCLib::DTC_SimMode_NoCFO &&
 		simMode != DTCLib::DTC_SimMode_ROCEmulator && simMode != DTCLib::DTC_SimMode_Loopback)
 	{
-		simulator_ = new mu2esim(simMemoryFileName);
+		DTCLib::BringUpPhaseScope simulatorPhase("mu2esim::init", this);
+		simulator_ = new mu2esim(simMemoryFileName, simulateCFO);
 		simulator_->init(simMode);
 	}
 	else
@@ -99,6 +102,7 @@ void mu2edev::initDMAEngine()
 		__COUT__ << "Using simulator, so no need to init DMA Engine..." << __E__;
 		return; //do nothing if using simulator
 	}
+	DTCLib::BringUpPhaseScope phase("DMA engine mmap setup", this);
 	__COUT__ << "Initializing DMA engine..." << __E__;
 
 	char devfile[11];
@@ -192,7 +196,7 @@ int mu2edev::read_data(DTC_DMA_Engine const& chn, void** buffer, int tmo_ms)
 	int retsts;
 	TRACE_EXIT { TRACE(TLVL_DEBUG + 11, UID_ +  " - mu2edev::read_data returning retsts(bytes)=%d",retsts);};
 
-	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_.load() != std::this_thread::get_id())
+	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_[activeDeviceIndex_].load() != std::this_thread::get_id())
 	{
 		TRACE(TLVL_ERROR, UID_ + " - read_data dcs lock not held!");
 		return retsts=-2;
@@ -212,16 +216,16 @@ int mu2edev::read_data(DTC_DMA_Engine const& chn, void** buffer, int tmo_ms)
 			((retsts = init(DTCLib::DTC_SimMode_Disabled, 0)) == 0))  // Default-init mu2edev if not given guidance
 		{
 			has_recv_data = mu2e_chn_info_delta_(activeDeviceIndex_, chn, C2S, &mu2e_channel_info_);
-			TRACE(TLVL_DEBUG+11, UID_ + " - mu2edev::read_data after %u=has_recv_data = delta_( chn=%d, C2S ), held=%u", has_recv_data, chn, buffers_held_);
+			TRACE(TLVL_DEBUG+11, UID_ + " - mu2edev::read_data after %u=has_recv_data = delta_( chn=%d, C2S ), held=%u", has_recv_data, chn, buffers_held_[chn]);
 			mu2e_channel_info_[activeDeviceIndex_][chn][C2S].tmo_ms = tmo_ms;  // in case GET_INFO is called
-			if ((has_recv_data > buffers_held_) ||
+			if ((has_recv_data > buffers_held_[chn]) ||
 				((retsts = ioctl(devfd_, M_IOC_GET_INFO, &mu2e_channel_info_[activeDeviceIndex_][chn][C2S])) == 0 &&
 				 (has_recv_data = mu2e_chn_info_delta_(activeDeviceIndex_, chn, C2S, &mu2e_channel_info_)) >
-					 buffers_held_))
+					 buffers_held_[chn]))
 			{  // have data
 				// get byte count from new/next
 				unsigned newNxtIdx =
-					idx_add(mu2e_channel_info_[activeDeviceIndex_][chn][C2S].swIdx, (int)buffers_held_ + 1, activeDeviceIndex_, chn, C2S);
+					idx_add(mu2e_channel_info_[activeDeviceIndex_][chn][C2S].swIdx, (int)buffers_held_[chn] + 1, activeDeviceIndex_, chn, C2S);
 				int* BC_p = (int*)mu2e_mmap_ptrs_[activeDeviceIndex_][chn][C2S][MU2E_MAP_META];
 				retsts = BC_p[newNxtIdx];
 				*buffer = ((mu2e_databuff_t*)(mu2e_mmap_ptrs_[activeDeviceIndex_][chn][C2S][MU2E_MAP_BUFF]))[newNxtIdx];
@@ -240,7 +244,7 @@ int mu2edev::read_data(DTC_DMA_Engine const& chn, void** buffer, int tmo_ms)
 
 				/// increment buffers held if allowing multiple buffers to be held by user space (e.g. for Data DMA channel, which is different for CFO vs DTC)</param>
 				if (chn == DTC_DMA_Engine_DAQ)
-					++buffers_held_;
+					++buffers_held_[chn];
 			}
 			else
 			{  // was it a tmo or error
@@ -265,7 +269,7 @@ int mu2edev::read_data(DTC_DMA_Engine const& chn, void** buffer, int tmo_ms)
    */
 int mu2edev::read_release(DTC_DMA_Engine const& chn, unsigned num)
 {
-	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_.load() != std::this_thread::get_id())
+	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_[activeDeviceIndex_].load() != std::this_thread::get_id())
 	{
 		TRACE(TLVL_ERROR, UID_ + " - read_release dcs lock not held!");
 		return -2;
@@ -303,10 +307,10 @@ int mu2edev::read_release(DTC_DMA_Engine const& chn, unsigned num)
 			// increment our cached info
 			mu2e_channel_info_[activeDeviceIndex_][chn][C2S].swIdx =
 				idx_add(mu2e_channel_info_[activeDeviceIndex_][chn][C2S].swIdx, (int)num, activeDeviceIndex_, chn, C2S);
-			if (num <= buffers_held_)
-				buffers_held_ -= num;
+			if (num <= buffers_held_[chn])
+				buffers_held_[chn] -= num;
 			else
-				buffers_held_ = 0;
+				buffers_held_[chn] = 0;
 		}
 		else
 			TLOG(TLVL_WARN) << "read_release num=" << num << " > has_recv_data=" << has_recv_data;
@@ -318,6 +322,7 @@ int mu2edev::read_release(DTC_DMA_Engine const& chn, unsigned num)
 int mu2edev::read_register(uint16_t address, int tmo_ms, uint32_t* output)
 {
 	auto start = std::chrono::steady_clock::now();
+	++registerReads_;
 	if (simulator_ != nullptr)
 	{
 		return simulator_->read_register(address, tmo_ms, output);
@@ -341,9 +346,46 @@ int mu2edev::read_register(uint16_t address, int tmo_ms, uint32_t* output)
 	return errorCode;
 }
 
+int mu2edev::read_registers(const uint16_t* addresses, size_t count, int tmo_ms, uint32_t* output)
+{
+	auto start = std::chrono::steady_clock::now();
+	registerReads_ += count;
+	int retsts = 0;
+	if (simulator_ != nullptr)
+	{
+		for (size_t ii = 0; ii < count; ++ii)
+		{
+			auto errorCode = simulator_->read_register(addresses[ii], tmo_ms, output + ii);
+			if (errorCode != 0 && retsts == 0) retsts = errorCode;
+		}
+		return retsts;
+	}
+	m_ioc_reg_access_t reg;
+	reg.access_type = 0;
+
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		reg.reg_offset = addresses[ii];
+		int counter = 0;
+		int errorCode = -99;
+		while (counter < 5 && errorCode < 0)
+		{
+			errorCode = ioctl(devfd_, M_IOC_REG_ACCESS, &reg);
+			counter++;
+			if (errorCode < 0) usleep(10000);
+		}
+		output[ii] = reg.val;
+		if (errorCode != 0 && retsts == 0) retsts = errorCode;
+	}
+	TRACE(TLVL_DEBUG + 15, UID_ + " - Read %zu registers errorcode %d", count, retsts);
+	deviceTime_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	return retsts;
+}
+
 int mu2edev::write_register(uint16_t address, int tmo_ms, uint32_t data)
 {
 	auto start = std::chrono::steady_clock::now();
+	++registerWrites_;
 	auto retsts = -1;
 	if (simulator_ != nullptr)
 	{
@@ -365,9 +407,45 @@ int mu2edev::write_register(uint16_t address, int tmo_ms, uint32_t data)
 	return retsts;
 }
 
+int mu2edev::write_registers(const uint16_t* addresses, const uint32_t* data, size_t count, int tmo_ms)
+{
+	auto start = std::chrono::steady_clock::now();
+	registerWrites_ += count;
+	int retsts = 0;
+	if (simulator_ != nullptr)
+	{
+		for (size_t ii = 0; ii < count; ++ii)
+		{
+			auto errorCode = simulator_->write_register(addresses[ii], tmo_ms, data[ii]);
+			if (errorCode != 0 && retsts == 0) retsts = errorCode;
+		}
+		return retsts;
+	}
+	m_ioc_reg_access_t reg;
+	reg.access_type = 1;
+
+	for (size_t ii = 0; ii < count; ++ii)
+	{
+		reg.reg_offset = addresses[ii];
+		reg.val = data[ii];
+		auto errorCode = ioctl(devfd_, M_IOC_REG_ACCESS, &reg);
+		if (debugFp_) fprintf(debugFp_, (UID_ + " - Writing value 0x%x to register 0x%x (block)\n").c_str(), data[ii], addresses[ii]);
+		if (errorCode != 0)
+		{
+			if (retsts == 0) retsts = errorCode;
+			break;  // Later writes to an auto-incrementing register would land at the wrong offset
+		}
+	}
+	TRACE(TLVL_DEBUG + 16, UID_ + " - Wrote %zu registers errorcode %d", count, retsts);
+	lastWriteTime_ = std::chrono::steady_clock::now();
+	deviceTime_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	return retsts;
+}
+
 int mu2edev::write_register_checked(uint16_t address, int tmo_ms, uint32_t data, uint32_t* output)
 {
 	auto start = std::chrono::steady_clock::now();
+	++registerWrites_;
 	auto retsts = -1;
 	if (simulator_ != nullptr)
 	{
@@ -416,7 +494,7 @@ void mu2edev::meta_dump()
 
 int mu2edev::write_data(DTC_DMA_Engine const& chn, void* buffer, size_t bytes)
 {
-	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_.load() != std::this_thread::get_id())
+	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_[activeDeviceIndex_].load() != std::this_thread::get_id())
 	{
 		__SS__ << "write_data failed - dcs lock not held!" << __E__;		
 		__SS_THROW__;
@@ -498,7 +576,7 @@ int mu2edev::release_all(DTC_DMA_Engine const& chn)
 {
 	TLOG_DEBUG(25) << __PRETTY_FUNCTION__ << " called from\n" << otsStyleStackTrace();   // param to ENTEX is a DEBUG lvl
 	auto retsts = 0; TRACE_EXIT { TLOG_DEBUG(26) << "Exit - retsts=" << retsts; };
-	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_.load() != std::this_thread::get_id())
+	if (chn == DTC_DMA_Engine_DCS && dcs_lock_held_[activeDeviceIndex_].load() != std::this_thread::get_id())
 	{
 		TRACE(TLVL_WARN, UID_ + " - release_all dcs lock not held!");
 		retsts=-2; return retsts;
@@ -546,12 +624,33 @@ int mu2edev::release_all(DTC_DMA_Engine const& chn)
 
    		//releaseBuffersHeld if allowing multiple buffers to be held by user space (e.g. for Data DMA channel, which is different for CFO vs DTC)
 		if (chn == DTC_DMA_Engine_DAQ)
-			buffers_held_ = 0;
+			buffers_held_[chn] = 0;
 	}
 	deviceTime_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 	return retsts;
 }
 
+int mu2edev::read_ring_occupancy(DTC_DMA_Engine const& chn, unsigned* filled, unsigned* size)
+{
+	if (simulator_ != nullptr) return simulator_->ring_occupancy(chn, filled, size);
+
+	// A private channel info, so that the cached indices of the reading thread are not touched; with a 0 timeout,
+	// M_IOC_GET_INFO returns at once
+	m_ioc_get_info_t info{};
+	info.chn = chn;
+	info.dir = C2S;
+	info.tmo_ms = 0;
+	auto retsts = ioctl(devfd_, M_IOC_GET_INFO, &info);
+	if (retsts != 0)
+	{
+		TRACE(TLVL_WARN, UID_ + " - read_ring_occupancy M_IOC_GET_INFO of chn=%d returned %d", chn, retsts);
+		return retsts;
+	}
+	*filled = info.hwIdx >= info.swIdx ? info.hwIdx - info.swIdx : info.num_buffs + info.hwIdx - info.swIdx;
+	*size = info.num_buffs;
+	return 0;
+}
+
 void mu2edev::close()
 {
 	if (simulator_ != nullptr)
@@ -568,12 +667,12 @@ void mu2edev::close()
 
 void mu2edev::begin_dcs_transaction()
 {
-	if (dcs_lock_held_.load() == std::this_thread::get_id())
+	if (dcs_lock_held_[activeDeviceIndex_].load() == std::this_thread::get_id())
 	{
 		TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transation: device lock already held by this thread");
 		return;
 	}
-	if (dcs_lock_held_.load() != NULL_TID)
+	if (dcs_lock_held_[activeDeviceIndex_].load() != NULL_TID)
 		TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transaction: device lock for this instance held by another thread! Waiting...");
 	else
 		TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transaction: device lock not currently held by instance.");
@@ -581,25 +680,27 @@ void mu2edev::begin_dcs_transaction()
 	int tmo_ms = 1000;  // 1s timeout
 	auto start = std::chrono::steady_clock::now();
 	TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transaction: waiting for library thread lock");
-	while (dcs_lock_held_.load() != NULL_TID && dcs_lock_held_.load() != std::this_thread::get_id() && (tmo_ms <= 0 || std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() < tmo_ms))
+	// Claim the library lock atomically, so that two threads can never both see it free and both take it
+	auto owner = NULL_TID;
+	while (!dcs_lock_held_[activeDeviceIndex_].compare_exchange_weak(owner, std::this_thread::get_id()))
 	{
-		std::this_thread::sleep_for(std::chrono::microseconds(100));
-	}
-
-	if (std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= tmo_ms)
-	{
-		TRACE(TLVL_ERROR, UID_ + " begin_dcs_transaction: timed out waiting for library thread lock");
-		std::string file = __FILE__;
-		throw std::runtime_error(
-			std::string(file.find("/srcs/") != std::string::npos ? file.substr(file.find("/srcs") + 6) : file) + ":" +
-			std::to_string(__LINE__) + " | " +
-			UID_ + " - mu2e Device could not take lock - library-internal lock error. Throwing exception.");
+		if (tmo_ms > 0 && std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() >= tmo_ms)
+		{
+			TRACE(TLVL_ERROR, UID_ + " begin_dcs_transaction: timed out waiting for library thread lock");
+			std::string file = __FILE__;
+			throw std::runtime_error(
+				std::string(file.find("/srcs/") != std::string::npos ? file.substr(file.find("/srcs") + 6) : file) + ":" +
+				std::to_string(__LINE__) + " | " +
+				UID_ + " - mu2e Device could not take lock - library-internal lock error. Throwing exception.");
+		}
+		if (owner != NULL_TID) std::this_thread::sleep_for(std::chrono::microseconds(100));
+		owner = NULL_TID;
 	}
 
 	if (simulator_ != nullptr)
 	{
 		TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transaction: sim mode, taking library thread lock and returning");
-		dcs_lock_held_ = std::this_thread::get_id();
+		dcs_lock_held_[activeDeviceIndex_] = std::this_thread::get_id();
 		return;
 	}
 
@@ -617,13 +718,13 @@ void mu2edev::begin_dcs_transaction()
 		else if (retsts != 0)
 		{
 			TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transaction: Method not supported by driver, taking library lock and returning. ioctl returned %d, errno %d", retsts, errno);
-			dcs_lock_held_ = std::this_thread::get_id();
+			dcs_lock_held_[activeDeviceIndex_] = std::this_thread::get_id();
 			return;
 		}
 		else
 		{
 			TRACE(TLVL_DEBUG + 13, UID_ + " begin_dcs_transaction: have driver lock, setting library lock and retunring true");
-			dcs_lock_held_ = std::this_thread::get_id();
+			dcs_lock_held_[activeDeviceIndex_] = std::this_thread::get_id();
 			return;
 		}
 	}
@@ -641,7 +742,7 @@ void mu2edev::begin_dcs_transaction()
 void mu2edev::end_dcs_transaction(bool force)
 {
 	TRACE(TLVL_DEBUG + 14, UID_ + " end_dcs_transaction: checking for ability to release lock force=%d", force);
-	if (force || dcs_lock_held_.load() == std::this_thread::get_id())
+	if (force || dcs_lock_held_[activeDeviceIndex_].load() == std::this_thread::get_id())
 	{
 		if (simulator_ == nullptr)
 		{
@@ -654,14 +755,14 @@ void mu2edev::end_dcs_transaction(bool force)
 			}
 		}
 		TRACE(TLVL_DEBUG + 14, UID_ + " end_dcs_transaction: releasing library lock");
-		dcs_lock_held_ = NULL_TID;
+		dcs_lock_held_[activeDeviceIndex_] = NULL_TID;
 	}
 
 }  // end end_dcs_transaction()
 
 bool mu2edev::thread_owns_dcs_lock()
 {
-	return dcs_lock_held_.load() == std::this_thread::get_id();
+	return dcs_lock_held_[activeDeviceIndex_].load() == std::this_thread::get_id();
 }
 
 std::string mu2edev::get_driver_version()
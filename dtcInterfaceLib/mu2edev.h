@@ -64,14 +64,29 @@ public:
 	/// </summary>
 	void ResetReadSize() { readSize_ = 0; }
 
+	/// <summary>
+	/// Get the number of register reads made since the device was constructed (a bulk read counts each register)
+	/// </summary>
+	/// <returns>Register read counter</returns>
+	uint64_t GetRegisterReadCount() const { return registerReads_; }
+
+	/// <summary>
+	/// Get the number of register writes made since the device was constructed
+	/// </summary>
+	/// <returns>Register write counter</returns>
+	uint64_t GetRegisterWriteCount() const { return registerWrites_; }
+
 	/// <summary>
 	/// Initialize the simulator if simMode requires it, otherwise set up DMA engines
 	/// </summary>
 	/// <param name="simMode">Desired simulation mode</param>
 	/// <param name="dtc">Desired DTC card to use (/dev/mu2eX)</param>
 	/// <param name="simMemoryFileName">If using simulated DTC, name of the memory file ("mu2esim.bin")</param>
+	/// <param name="uid">Device name used in trace messages</param>
+	/// <param name="simulateCFO">If using the simulator, model the CFO register space (e.g. the run plan memory) instead of the DTC one</param>
 	/// <returns>0 on success</returns>
-	int init(DTCLib::DTC_SimMode simMode, int deviceIndex, std::string simMemoryFileName = "mu2esim.bin", const std::string& uid = "");
+	int init(DTCLib::DTC_SimMode simMode, int deviceIndex, std::string simMemoryFileName = "mu2esim.bin", const std::string& uid = "",
+			 bool simulateCFO = false);
 	void initDMAEngine();	
 
 	/// <summary>
@@ -97,6 +112,15 @@ public:
 	/// <returns>0 on success</returns>
 	int release_all(DTC_DMA_Engine const& chn);
 	/// <summary>
+	/// Get the occupancy of the C2S ring of a channel: buffers filled by the DTC which the software has not released
+	/// yet (including the buffers it holds). Does not wait and does not disturb read_data.
+	/// </summary>
+	/// <param name="chn">Channel (DAQ or DCS)</param>
+	/// <param name="filled">Output: buffers filled</param>
+	/// <param name="size">Output: buffers in the ring</param>
+	/// <returns>0 on success</returns>
+	int read_ring_occupancy(DTC_DMA_Engine const& chn, unsigned* filled, unsigned* size);
+	/// <summary>
 	/// Read a DTC register
 	/// </summary>
 	/// <param name="address">Address to read</param>
@@ -105,6 +129,15 @@ public:
 	/// <returns>0 on success</returns>
 	int read_register(uint16_t address, int tmo_ms, uint32_t* output);
 	/// <summary>
+	/// Read a list of DTC registers in one pass, without per-register tracing
+	/// </summary>
+	/// <param name="addresses">Addresses to read</param>
+	/// <param name="count">Number of addresses</param>
+	/// <param name="tmo_ms">Timeout for each read</param>
+	/// <param name="output">Pointer to output words, at least count long</param>
+	/// <returns>0 on success, otherwise the error code of the first failed read</returns>
+	int read_registers(const uint16_t* addresses, size_t count, int tmo_ms, uint32_t* output);
+	/// <summary>
 	/// Write to a DTC register
 	/// </summary>
 	/// <param name="address">Address to write</param>
@@ -113,6 +146,16 @@ public:
 	/// <returns>0 on success</returns>
 	int write_register(uint16_t address, int tmo_ms, uint32_t data);
 	/// <summary>
+	/// Write a list of DTC registers in one pass, without per-register tracing. Addresses may repeat, e.g. for
+	/// auto-incrementing data registers; the writes are made in order.
+	/// </summary>
+	/// <param name="addresses">Addresses to write</param>
+	/// <param name="data">Data to write, one word per address</param>
+	/// <param name="count">Number of addresses</param>
+	/// <param name="tmo_ms">Timeout for each write</param>
+	/// <returns>0 on success, otherwise the error code of the first failed write</returns>
+	int write_registers(const uint16_t* addresses, const uint32_t* data, size_t count, int tmo_ms);
+	/// <summary>
 	/// Write to a DTC register
 	/// </summary>
 	/// <param name="address">Address to write</param>
@@ -180,14 +223,16 @@ private:
 	int devfd_;
 	volatile void* mu2e_mmap_ptrs_[MU2E_MAX_NUM_DTCS][MU2E_MAX_CHANNELS][2][2];
 	m_ioc_get_info_t mu2e_channel_info_[MU2E_MAX_NUM_DTCS][MU2E_MAX_CHANNELS][2];
-	unsigned buffers_held_;
+	unsigned buffers_held_[MU2E_MAX_CHANNELS];  ///< Buffers held per channel, so that DCS releases do not disturb the DAQ count
 	mu2esim* simulator_;
 	int activeDeviceIndex_;
-	static std::atomic<std::thread::id> dcs_lock_held_;
+	static std::atomic<std::thread::id> dcs_lock_held_[MU2E_MAX_NUM_DTCS];  ///< DCS library lock owner, per DTC
 	
 	std::atomic<long long> deviceTime_;
 	std::atomic<size_t> writeSize_;
 	std::atomic<size_t> readSize_;
+	std::atomic<uint64_t> registerReads_;
+	std::atomic<uint64_t> registerWrites_;
 
 	std::string			UID_;
 	FILE*				debugFp_ = 0;
@@ -40,14 +40,53 @@
 #include "mu2esim.h"
 #include "DTC_Registers.h"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
 #define THREADED_CFO_EMULATOR 0
 
-mu2esim::mu2esim(std::string ddrFileName)
+namespace {
+// IIC masters modeled by the simulator: IIC Bus High register -> IIC Bus Low register
+const std::map<uint16_t, uint16_t> SimulatedIICBuses = {
+	{DTCLib::CFOandDTC_Register_SERDESClock_IICBusHigh, DTCLib::CFOandDTC_Register_SERDESClock_IICBusLow},
+	{DTCLib::DTC_Register_DDRClock_IICBusHigh, DTCLib::DTC_Register_DDRClock_IICBusLow},
+	{DTCLib::CFOandDTC_Register_FireflyTX_IICBusConfigHigh, DTCLib::CFOandDTC_Register_FireflyTX_IICBusConfigLow},
+	{DTCLib::CFOandDTC_Register_FireflyRX_IICBusConfigHigh, DTCLib::CFOandDTC_Register_FireflyRX_IICBusConfigLow},
+	{DTCLib::CFOandDTC_Register_FireflyTXRX_IICBusConfigHigh, DTCLib::CFOandDTC_Register_FireflyTXRX_IICBusConfigLow},
+	{DTCLib::DTC_Register_SFP_IICBusHigh, DTCLib::DTC_Register_SFP_IICBusLow},
+};
+constexpr auto SimulatedIICTransactionTime = std::chrono::microseconds(300);  // About one 3-byte transaction at 100 kHz
+
+// CFO run plan memory access registers (CFO_Register_RunPlan_Address/Data); on the DTC these addresses are SFP IIC registers
+constexpr uint16_t SimulatedRunPlanAddressRegister = 0x9314;
+constexpr uint16_t SimulatedRunPlanDataRegister = 0x9318;
+constexpr size_t SimulatedRunPlanWords = 0x100000;
+
+// CFO cable delay measurement: Cable Delay Value registers (0x100 per DTC hop, 4 per link) and Control and Status register
+constexpr uint16_t SimulatedCableDelayValueRegister = 0x9360;
+constexpr uint16_t SimulatedCableDelayControlRegister = 0x9380;
+constexpr unsigned SimulatedCableDelayMaxHops = 6;
+constexpr auto SimulatedCableDelaySampleTime = std::chrono::microseconds(20);  // Per loopback sample; 2^exponent samples are averaged
+
+// DDR3 event building buffers: built events wait in the C2S ring first, then fill these buffers in order
+constexpr unsigned SimulatedDDRBuffers = 128;
+constexpr uint64_t SimulatedDDRBufferBytes = 0x800000;  // Default of DTCLIB_SIM_DDR_BUFFER_BYTES
+}  // namespace
+
+mu2esim::mu2esim(std::string ddrFileName, bool cfo)
 	: registers_()
+	, cfo_(cfo)
+	, runPlanMemory_()
+	, runPlanAddress_(0)
+	, cableDelayHops_(2)
+	, cableDelayMeasurements_(0)
+	, cableDelayDoneAt_()
+	, ddrBufferBytes_(SimulatedDDRBufferBytes)
+	, pendingEvents_(0)
+	, pendingEventBytes_(0)
 	, swIdx_()
+	, hwIdx_()
 	/*, detSimLoopCount_(0)*/
 	, dmaData_()
 	, ddrFileName_(ddrFileName)
@@ -95,6 +134,18 @@ mu2esim::mu2esim(std::string ddrFileName)
 		event_mode_num_crv_blocks_ = std::atoi(crv_count_c);
 	}
 
+	auto cfo_hops_c = getenv("DTCLIB_SIM_CFO_DTCS_PER_LINK");
+	if (cfo_hops_c != nullptr)
+	{
+		cableDelayHops_ = std::atoi(cfo_hops_c);
+	}
+
+	auto ddr_buffer_bytes_c = getenv("DTCLIB_SIM_DDR_BUFFER_BYTES");
+	if (ddr_buffer_bytes_c != nullptr && std::strtoull(ddr_buffer_bytes_c, nullptr, 0) > 0)
+	{
+		ddrBufferBytes_ = std::strtoull(ddr_buffer_bytes_c, nullptr, 0);
+	}
+
 	reopenDDRFile_();
 
 	TLOG(TLVL_Constructor) << "mu2esim::mu2esim END";
@@ -152,6 +203,8 @@ int mu2esim::init(DTCLib::DTC_SimMode mode)
 int mu2esim::read_data(int chn, void** buffer, int tmo_ms)
 {
 	auto start = std::chrono::steady_clock::now();
+	std::unique_lock<std::recursive_mutex> lock(stateMutex_, std::defer_lock);
+	if (chn == 0) lock.lock();
 	size_t bytesReturned = 0;
 	if (delta_(chn, C2S) == 0)
 	{
@@ -186,17 +239,29 @@ int mu2esim::read_data(int chn, void** buffer, int tmo_ms)
 			memcpy(dmaData_[chn][swIdx_[chn]], &size, sizeof(uint64_t));
 			ddrFile_->read(reinterpret_cast<char*>(dmaData_[chn][swIdx_[chn]]) + sizeof(uint64_t), size - sizeof(uint64_t));
 			bytesReturned = size;
+			if (pendingEvents_ > 0)
+			{
+				pendingEventBytes_ -= pendingEventBytes_ / pendingEvents_;
+				--pendingEvents_;
+			}
 		}
 		else if (chn == 1)
 		{
-			// Data should already be in appropriate buffer
+			// No DCS reply pending, equivalent to a driver timeout
+			return 0;
 		}
 	}
+	else if (chn == 1)
+	{
+		// DCS reply was placed in the buffer by dcsPacketSimulator_
+		bytesReturned = *reinterpret_cast<uint64_t*>(dmaData_[chn][swIdx_[chn]]);
+	}
 
 	*buffer = dmaData_[chn][swIdx_[chn]];
 	TLOG(TLVL_ReadData2) << "mu2esim::read_data: *buffer (" << (void*)*buffer << ") should now be equal to dmaData_[" << chn << "]["
 						 << swIdx_[chn] << "] (" << (void*)dmaData_[chn][swIdx_[chn]] << ")";
-	swIdx_[chn] = (swIdx_[chn] + 1) % SIM_BUFFCOUNT;
+	// As in the driver, a DCS reply stays at the head of the ring until it is released with read_release
+	if (chn != 1) swIdx_[chn] = (swIdx_[chn] + 1) % SIM_BUFFCOUNT;
 
 	auto duration =
 		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
@@ -208,6 +273,7 @@ int mu2esim::write_data(int chn, void* buffer, size_t bytes)
 {
 	if (chn == 0)
 	{
+		std::lock_guard<std::recursive_mutex> lock(stateMutex_);
 		TLOG(TLVL_WriteData) << "mu2esim::write_data: adding buffer to simulated DDR memory sz=" << bytes
 							 << ", *buffer=" << *((uint64_t*)buffer);
 		if (bytes <= sizeof(mu2e_databuff_t))
@@ -227,74 +293,18 @@ int mu2esim::write_data(int chn, void* buffer, size_t bytes)
 	else if (chn == 1)
 	{
 		TLOG(TLVL_WriteData) << "mu2esim::write_data start: chn=" << chn << ", buf=" << buffer << ", bytes=" << bytes;
-		uint32_t worda;
-		memcpy(&worda, buffer, sizeof worda);
-		auto word = static_cast<uint16_t>(worda >> 16);
-		TLOG(TLVL_WriteData) << "mu2esim::write_data worda is 0x" << std::hex << worda << " and word is 0x" << std::hex << word;
-		auto activeLink = static_cast<DTCLib::DTC_Link_ID>((word & 0x0F00) >> 8);
-
-		DTCLib::DTC_EventWindowTag ts(reinterpret_cast<uint8_t*>(buffer) + 6);
-		if ((word & 0x8010) == 0x8010)
-		{
-			TLOG(TLVL_WriteData) << "mu2esim::write_data: Readout Request: activeDAQLink=" << activeLink
-								 << ", ts=" << ts.GetEventWindowTag(true);
-			readoutRequestReceived_[ts.GetEventWindowTag(true)][activeLink] = true;
-		}
-		else if ((word & 0x8020) == 0x8020)
+		// Skip the 64-bit DMA size word; the packets follow back-to-back until the end of the DMA or a zero byte count
+		auto dmaBytes = std::min(static_cast<size_t>(*reinterpret_cast<uint64_t*>(buffer)), bytes);
+		size_t offset = sizeof(uint64_t);
+		while (offset + 16 <= dmaBytes)
 		{
-			TLOG(TLVL_WriteData) << "mu2esim::write_data: Data Request: activeDAQLink=" << activeLink << ", ts=" << ts.GetEventWindowTag(true);
-			if (activeLink != DTCLib::DTC_Link_Unused)
-			{
-				if (!readoutRequestReceived_[ts.GetEventWindowTag(true)][activeLink])
-				{
-					TLOG(TLVL_WriteData) << "mu2esim::write_data: Data Request Received but missing Readout Request!";
-				}
-				else
-				{
-					openEvent_(ts);
+			auto packetBuffer = reinterpret_cast<uint8_t*>(buffer) + offset;
+			uint16_t packetBytes;
+			memcpy(&packetBytes, packetBuffer, sizeof packetBytes);
+			if (packetBytes == 0) break;
 
-					if (mode_ == DTCLib::DTC_SimMode_Performance || mode_ == DTCLib::DTC_SimMode_Timeout)
-					{
-						auto packetCount = *(reinterpret_cast<uint16_t*>(buffer) + 7);
-						packetSimulator_(ts, activeLink, packetCount);
-					}
-					else if (mode_ == DTCLib::DTC_SimMode_Tracker)
-					{
-						trackerBlockSimulator_(ts, activeLink, 0);
-					}
-					else if (mode_ == DTCLib::DTC_SimMode_Calorimeter)
-					{
-						calorimeterBlockSimulator_(ts, activeLink, 0);
-					}
-					else if (mode_ == DTCLib::DTC_SimMode_CosmicVeto)
-					{
-						crvBlockSimulator_(ts, activeLink, 0);
-					}
-
-					readoutRequestReceived_[ts.GetEventWindowTag(true)][activeLink] = false;
-					if (readoutRequestReceived_[ts.GetEventWindowTag(true)].count() == 0)
-					{
-						closeEvent_();
-						readoutRequestReceived_.erase(ts.GetEventWindowTag(true));
-					}
-				}
-			}
-		}
-		if ((word & 0x0080) == 0)
-		{
-			TLOG(TLVL_WriteData) << "mu2esim::write_data activeDCSLink is " << activeLink;
-			if (activeLink != DTCLib::DTC_Link_Unused)
-			{
-				DTCLib::DTC_DataPacket packet(buffer);
-				DTCLib::DTC_DCSRequestPacket thisPacket(packet);
-				if (thisPacket.GetType() == DTCLib::DTC_DCSOperationType_Read ||
-					thisPacket.GetType() == DTCLib::DTC_DCSOperationType_BlockRead || thisPacket.RequestsAck())
-				{
-					TLOG(TLVL_WriteData) << "mu2esim::write_data: Recieved DCS Request:";
-					TLOG(TLVL_WriteData) << thisPacket.toJSON().c_str();
-					dcsPacketSimulator_(thisPacket);
-				}
-			}
+			s2cPacketSimulator_(packetBuffer);
+			offset += (packetBytes + 15) & ~static_cast<size_t>(15);
 		}
 	}
 
@@ -316,14 +326,41 @@ int mu2esim::release_all(int chn)
 {
 	read_release(chn, SIM_BUFFCOUNT);
 	swIdx_[chn] = 0;
+	hwIdx_[chn] = 0;
 	return 0;
 }
 
 int mu2esim::read_register(uint16_t address, int tmo_ms, uint32_t* output)
 {
 	auto start = std::chrono::steady_clock::now();
+	std::lock_guard<std::recursive_mutex> lock(stateMutex_);
 	*output = 0;
-	if (registers_.count(address) > 0)
+	auto iicBusy = iicBusyUntil_.find(address);
+	if (iicBusy != iicBusyUntil_.end() && std::chrono::steady_clock::now() >= iicBusy->second)
+	{
+		registers_[address] = 0;  // IIC transaction complete
+		iicBusyUntil_.erase(iicBusy);
+	}
+	if (cfo_ && address == SimulatedRunPlanAddressRegister)
+	{
+		*output = runPlanAddress_;
+	}
+	else if (!cfo_ && address >= DTCLib::DTC_Register_DDR3LinkBufferEmptyFlags0 && address <= DTCLib::DTC_Register_DDR3EVBBufferFullFlags3)
+	{
+		*output = ddrFlagsValue_(address);
+	}
+	else if (cfo_ && address == SimulatedRunPlanDataRegister)
+	{
+		// Reading the data register returns the word at the current address, then increments the address
+		*output = runPlanAddress_ < runPlanMemory_.size() ? runPlanMemory_[runPlanAddress_] : 0;
+		++runPlanAddress_;
+	}
+	else if (cfo_ && address >= SimulatedCableDelayValueRegister && address < SimulatedCableDelayValueRegister + 0x100 * SimulatedCableDelayMaxHops &&
+			 ((address - SimulatedCableDelayValueRegister) & 0xFF) < 0x20)
+	{
+		*output = cableDelayValue_(address);
+	}
+	else if (registers_.count(address) > 0)
 	{
 		TLOG(TLVL_ReadRegister) << "mu2esim::read_register: Returning value 0x" << std::hex << registers_[address] << " for address 0x"
 								<< std::hex << address;
@@ -338,14 +375,37 @@ int mu2esim::read_register(uint16_t address, int tmo_ms, uint32_t* output)
 int mu2esim::write_register(uint16_t address, int tmo_ms, uint32_t data)
 {
 	auto start = std::chrono::steady_clock::now();
+	std::lock_guard<std::recursive_mutex> lock(stateMutex_);
 	// Write the register!!!
 	TLOG(TLVL_WriteRegister) << "mu2esim::write_register: Writing value 0x" << std::hex << data << " into address 0x" << std::hex
 							 << address;
+	auto previous = registers_[address];
 	registers_[address] = data;
+	if (cfo_ && address == SimulatedRunPlanAddressRegister)
+	{
+		runPlanAddress_ = data;
+	}
+	else if (cfo_ && address == SimulatedRunPlanDataRegister)
+	{
+		// Writing the data register stores the word at the current address, then increments the address
+		if (runPlanAddress_ < SimulatedRunPlanWords)
+		{
+			if (runPlanAddress_ >= runPlanMemory_.size()) runPlanMemory_.resize(runPlanAddress_ + 1, 0);
+			runPlanMemory_[runPlanAddress_] = data;
+		}
+		++runPlanAddress_;
+	}
 	auto duration =
 		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
 	TLOG(TLVL_WriteRegister2) << "mu2esim::write_register took " << duration << " milliseconds out of tmo_ms=" << tmo_ms;
 	std::bitset<32> dataBS(data);
+	if (cfo_ && address == DTCLib::CFOandDTC_Register_Control && dataBS[3] == 1 && ((previous >> 3) & 1) == 0)
+	{
+		// Cable delay loopback test: all links measure at once, and complete after 2^exponent loopback samples
+		auto exponent = (registers_[SimulatedCableDelayControlRegister] >> 16) & 0xF;
+		++cableDelayMeasurements_;
+		cableDelayDoneAt_ = std::chrono::steady_clock::now() + SimulatedCableDelaySampleTime * (1 << exponent);
+	}
 	if (address == DTCLib::CFOandDTC_Register_Control)
 	{
 		auto detectorEmulationMode = (registers_[DTCLib::DTC_Register_DetEmulation_Control0] & 0x3) != 0;
@@ -388,9 +448,34 @@ int mu2esim::write_register(uint16_t address, int tmo_ms, uint32_t data)
 	{
 		ddrFile_->seekg(data);
 	}
+	auto iicBus = SimulatedIICBuses.find(address);
+	if (iicBus != SimulatedIICBuses.end() && (data == 0x1 || data == 0x2))
+	{
+		iicTransaction_(iicBus->second, address, data);
+	}
 	return 0;
 }
 
+void mu2esim::iicTransaction_(uint16_t lowAddress, uint16_t highAddress, uint32_t command)
+{
+	auto word = registers_[lowAddress];
+	auto device = static_cast<uint8_t>(word >> 24);
+	auto reg = static_cast<uint8_t>(word >> 16);
+	auto& value = iicDevices_[lowAddress][(device << 8) + reg];
+	if (command == 0x1)
+	{
+		value = static_cast<uint8_t>(word >> 8);
+	}
+	else
+	{
+		registers_[lowAddress] = (word & 0xFFFFFF00) | value;
+	}
+	TLOG(TLVL_WriteRegister2) << "mu2esim::iicTransaction_: " << (command == 0x1 ? "write" : "read") << " of device 0x" << std::hex
+							  << static_cast<int>(device) << " register 0x" << static_cast<int>(reg) << " value 0x" << static_cast<int>(value);
+	// The High register reads back the command until the simulated bus time has passed
+	iicBusyUntil_[highAddress] = std::chrono::steady_clock::now() + SimulatedIICTransactionTime;
+}
+
 void mu2esim::CFOEmulator_()
 {
 	if (cancelCFO_)
@@ -559,8 +644,18 @@ void mu2esim::closeEvent_()
 	if (sub_event_) closeSubEvent_();
 	if (event_ && ddrFile_)
 	{
-		event_->WriteEvent(*ddrFile_, false);
-		ddrFile_->flush();
+		if (ddrBytes_() >= SimulatedDDRBuffers * ddrBufferBytes_)
+		{
+			TLOG(TLVL_CloseEvent) << "mu2esim::closeEvent_: DDR buffers full, dropping event";
+			++registers_[DTCLib::DTC_Register_InputBufferDropCount];
+		}
+		else
+		{
+			event_->WriteEvent(*ddrFile_, false);
+			ddrFile_->flush();
+			++pendingEvents_;
+			pendingEventBytes_ += event_->GetEventByteCount();
+		}
 
 		event_.reset(nullptr);
 		sub_event_.reset(nullptr);
@@ -568,42 +663,105 @@ void mu2esim::closeEvent_()
 	TLOG(TLVL_CloseEvent) << "mu2esim::closeEvent_ FINISH";
 }
 
-void mu2esim::dcsPacketSimulator_(DTCLib::DTC_DCSRequestPacket in)
+void mu2esim::dcsPacketSimulator_(DTCLib::DTC_DCSRequestPacket in, const uint8_t* packetData)
 {
+	// Simulated ROC register space: writes are stored, reads return the stored values (0 if never written).
+	// Block operations always increment the address.
+	auto link = in.GetLinkID();
+	auto& rocMemory = rocRegisters_[link];
+	auto request1 = in.GetRequest(false);
+	std::vector<uint16_t> blockReadData;
+
+	switch (in.GetType())
+	{
+		case DTCLib::DTC_DCSOperationType_Write:
+			rocMemory[request1.first] = request1.second;
+			if (in.IsDoubleOp())
+			{
+				auto request2 = in.GetRequest(true);
+				rocMemory[request2.first] = request2.second;
+			}
+			break;
+		case DTCLib::DTC_DCSOperationType_BlockWrite:
+		{
+			// Word count at bytes 8-9, then 3 words in the request packet and 8 words in each follow-on packet
+			uint16_t wordCount = packetData[8] + (packetData[9] << 8);
+			uint16_t byteCount = packetData[0] + (packetData[1] << 8);
+			if (byteCount < 10 + 2 * wordCount)
+			{
+				TLOG(TLVL_DCSPacketSimulator) << "mu2esim::dcsPacketSimulator_: Block write of " << wordCount
+											  << " words does not fit in packet of " << byteCount << " bytes, truncating";
+				wordCount = byteCount > 10 ? (byteCount - 10) / 2 : 0;
+			}
+			for (uint16_t ii = 0; ii < wordCount; ++ii)
+			{
+				auto wordPtr = packetData + 10 + 2 * ii;
+				rocMemory[static_cast<uint16_t>(request1.first + ii)] = wordPtr[0] + (wordPtr[1] << 8);
+			}
+			TLOG(TLVL_DCSPacketSimulator) << "mu2esim::dcsPacketSimulator_: Stored block of " << wordCount << " words at address "
+										  << request1.first << " for link " << link;
+			break;
+		}
+		case DTCLib::DTC_DCSOperationType_BlockRead:
+			for (uint16_t ii = 0; ii < request1.second; ++ii)
+			{
+				auto it = rocMemory.find(static_cast<uint16_t>(request1.first + ii));
+				blockReadData.push_back(it != rocMemory.end() ? it->second : 0);
+			}
+			break;
+		default:
+			break;
+	}
+
+	// The ROC only replies to reads and to operations which request an ack
+	if (in.GetType() != DTCLib::DTC_DCSOperationType_Read && in.GetType() != DTCLib::DTC_DCSOperationType_BlockRead &&
+		!in.RequestsAck())
+	{
+		return;
+	}
+
 	auto packetCount = 0;
-	if (in.GetType() == DTCLib::DTC_DCSOperationType_BlockRead)
+	if (blockReadData.size() > 3)
 	{
-		packetCount = 1;
+		packetCount = (blockReadData.size() - 3 + 7) / 8;
 	}
 	TLOG(TLVL_DCSPacketSimulator) << "mu2esim::dcsPacketSimulator_: Constructing DCS Response";
-	DTCLib::DTC_DMAPacket packet(DTCLib::DTC_PacketType_DCSReply, in.GetLinkID(), (1 + packetCount) * 16, true);
+	DTCLib::DTC_DMAPacket packet(DTCLib::DTC_PacketType_DCSReply, link, (1 + packetCount) * 16, true);
 
 	TLOG(TLVL_DCSPacketSimulator) << "mu2esim::dcsPacketSimulator_: copying response into new buffer";
 	auto dataPacket = packet.ConvertToDataPacket();
 
 	dataPacket.SetByte(4, static_cast<int>(in.GetType()) + (in.RequestsAck() ? 0x8 : 0) + (in.IsDoubleOp() ? 0x4 : 0) +
-							  ((packetCount & 0x2) << 6));
+							  ((packetCount & 0x3) << 6));
 	dataPacket.SetByte(5, (packetCount & 0x3FC) >> 2);
 
-	auto request1 = in.GetRequest(false);
+	auto readValue = [&](uint16_t address) {
+		auto it = rocMemory.find(address);
+		return it != rocMemory.end() ? it->second : static_cast<uint16_t>(0);
+	};
+	auto reply1 = request1.second;
+	if (in.GetType() == DTCLib::DTC_DCSOperationType_Read) reply1 = readValue(request1.first);
 	dataPacket.SetByte(6, request1.first & 0xFF);
 	dataPacket.SetByte(7, (request1.first & 0xFF00) >> 8);
-	dataPacket.SetByte(8, request1.second & 0xFF);
-	dataPacket.SetByte(9, (request1.second & 0xFF00) >> 8);
+	dataPacket.SetByte(8, reply1 & 0xFF);
+	dataPacket.SetByte(9, (reply1 & 0xFF00) >> 8);
 
 	if (in.GetType() != DTCLib::DTC_DCSOperationType_BlockRead)
 	{
 		auto request2 = in.GetRequest(true);
+		auto reply2 = request2.second;
+		if (in.GetType() == DTCLib::DTC_DCSOperationType_Read && in.IsDoubleOp()) reply2 = readValue(request2.first);
 		dataPacket.SetByte(10, request2.first & 0xFF);
 		dataPacket.SetByte(11, (request2.first & 0xFF00) >> 8);
-		dataPacket.SetByte(12, request2.second & 0xFF);
-		dataPacket.SetByte(13, (request2.second & 0xFF00) >> 8);
+		dataPacket.SetByte(12, reply2 & 0xFF);
+		dataPacket.SetByte(13, (reply2 & 0xFF00) >> 8);
 	}
 	else
 	{
-		for (int ii = 10; ii < dataPacket.GetSize(); ++ii)
+		for (size_t ii = 0; ii < blockReadData.size(); ++ii)
 		{
-			dataPacket.SetByte(ii, ii);
+			dataPacket.SetByte(10 + 2 * ii, blockReadData[ii] & 0xFF);
+			dataPacket.SetByte(11 + 2 * ii, (blockReadData[ii] & 0xFF00) >> 8);
 		}
 	}
 
@@ -796,8 +954,128 @@ void mu2esim::crvBlockSimulator_(DTCLib::DTC_EventWindowTag ts, DTCLib::DTC_Link
 	sub_event_->AddDataBlock(block);
 }
 
+void mu2esim::s2cPacketSimulator_(uint8_t* packetBuffer)
+{
+	uint32_t worda;
+	memcpy(&worda, packetBuffer, sizeof worda);
+	auto word = static_cast<uint16_t>(worda >> 16);
+	TLOG(TLVL_WriteData) << "mu2esim::write_data worda is 0x" << std::hex << worda << " and word is 0x" << std::hex << word;
+	auto activeLink = static_cast<DTCLib::DTC_Link_ID>((word & 0x0F00) >> 8);
+
+	DTCLib::DTC_EventWindowTag ts(packetBuffer + 6);
+	std::unique_lock<std::recursive_mutex> lock(stateMutex_, std::defer_lock);
+	if ((word & 0x00F0) != 0) lock.lock();  // Requests build events, DCS packets only touch the simulated ROCs
+	if ((word & 0x8010) == 0x8010)
+	{
+		TLOG(TLVL_WriteData) << "mu2esim::write_data: Readout Request: activeDAQLink=" << activeLink
+							 << ", ts=" << ts.GetEventWindowTag(true);
+		readoutRequestReceived_[ts.GetEventWindowTag(true)][activeLink] = true;
+	}
+	else if ((word & 0x8020) == 0x8020)
+	{
+		TLOG(TLVL_WriteData) << "mu2esim::write_data: Data Request: activeDAQLink=" << activeLink << ", ts=" << ts.GetEventWindowTag(true);
+		if (activeLink != DTCLib::DTC_Link_Unused)
+		{
+			if (!readoutRequestReceived_[ts.GetEventWindowTag(true)][activeLink])
+			{
+				TLOG(TLVL_WriteData) << "mu2esim::write_data: Data Request Received but missing Readout Request!";
+			}
+			else
+			{
+				openEvent_(ts);
+
+				if (mode_ == DTCLib::DTC_SimMode_Performance || mode_ == DTCLib::DTC_SimMode_Timeout)
+				{
+					auto packetCount = *(reinterpret_cast<uint16_t*>(packetBuffer) + 7);
+					packetSimulator_(ts, activeLink, packetCount);
+				}
+				else if (mode_ == DTCLib::DTC_SimMode_Tracker)
+				{
+					trackerBlockSimulator_(ts, activeLink, 0);
+				}
+				else if (mode_ == DTCLib::DTC_SimMode_Calorimeter)
+				{
+					calorimeterBlockSimulator_(ts, activeLink, 0);
+				}
+				else if (mode_ == DTCLib::DTC_SimMode_CosmicVeto)
+				{
+					crvBlockSimulator_(ts, activeLink, 0);
+				}
+
+				readoutRequestReceived_[ts.GetEventWindowTag(true)][activeLink] = false;
+				if (readoutRequestReceived_[ts.GetEventWindowTag(true)].count() == 0)
+				{
+					closeEvent_();
+					readoutRequestReceived_.erase(ts.GetEventWindowTag(true));
+				}
+			}
+		}
+	}
+	if ((word & 0x00F0) == 0)  // DCS Request packet type
+	{
+		TLOG(TLVL_WriteData) << "mu2esim::write_data activeDCSLink is " << activeLink;
+		if (activeLink != DTCLib::DTC_Link_Unused)
+		{
+			DTCLib::DTC_DataPacket packet(packetBuffer);
+			DTCLib::DTC_DCSRequestPacket thisPacket(packet);
+			TLOG(TLVL_WriteData) << "mu2esim::write_data: Recieved DCS Request:";
+			TLOG(TLVL_WriteData) << thisPacket.toJSON().c_str();
+			dcsPacketSimulator_(thisPacket, packetBuffer);
+		}
+	}
+}
+
+uint32_t mu2esim::cableDelayValue_(uint16_t address)
+{
+	unsigned hop = (address - SimulatedCableDelayValueRegister) / 0x100;
+	unsigned link = ((address - SimulatedCableDelayValueRegister) & 0xFF) / 4;
+	if (cableDelayMeasurements_ == 0 || hop >= cableDelayHops_ || std::chrono::steady_clock::now() < cableDelayDoneAt_) return 0;
+
+	// Round trip grows with the link's cable length and with each DTC along the chain; the last bits jitter between measurements
+	uint32_t delay = 400 + 25 * link + 300 * hop;
+	delay += (cableDelayMeasurements_ * 7 + link * 3 + hop) % 5;
+	return (1u << 31) | delay;  // Done bit
+}
+
+int mu2esim::ring_occupancy(int chn, unsigned* filled, unsigned* size)
+{
+	std::lock_guard<std::recursive_mutex> lock(stateMutex_);
+	*filled = chn == 0 ? static_cast<unsigned>(std::min<uint64_t>(pendingEvents_, SIM_BUFFCOUNT)) : delta_(chn, C2S);
+	*size = SIM_BUFFCOUNT;
+	return 0;
+}
+
+uint64_t mu2esim::ddrBytes_() const
+{
+	// Events are all about the same size, so the bytes beyond the ring are counted pro rata
+	if (pendingEvents_ <= SIM_BUFFCOUNT) return 0;
+	return pendingEventBytes_ / pendingEvents_ * (pendingEvents_ - SIM_BUFFCOUNT);
+}
+
+uint32_t mu2esim::ddrFlagsValue_(uint16_t address) const
+{
+	// Six flag types (link empty, half full, full, then event building empty, half full, full) of four registers each
+	auto index = (address - DTCLib::DTC_Register_DDR3LinkBufferEmptyFlags0) / 4;
+	auto flag = index / 4;
+	auto word = index % 4;
+	if (flag < 3) return flag == 0 ? 0xFFFFFFFF : 0;  // Link buffers are not simulated: always empty
+
+	auto ddrBytes = ddrBytes_();
+	uint32_t value = 0;
+	for (unsigned ii = 0; ii < 32; ++ii)
+	{
+		uint64_t bufferStart = (word * 32 + ii) * ddrBufferBytes_;
+		auto bytes = ddrBytes > bufferStart ? std::min(ddrBytes - bufferStart, ddrBufferBytes_) : 0;
+		bool set = flag == 3 ? bytes == 0 : flag == 4 ? bytes >= ddrBufferBytes_ / 2 : bytes >= ddrBufferBytes_;
+		if (set) value |= 1u << ii;
+	}
+	return value;
+}
+
 void mu2esim::reopenDDRFile_()
 {
+	pendingEvents_ = 0;
+	pendingEventBytes_ = 0;
 	if (!ddrFile_)
 	{
 		TLOG(TLVL_INFO) << "Going to open simulated RAM file " << ddrFileName_;
@@ -6,6 +6,7 @@
 #ifndef MU2ESIM_HH
 #define MU2ESIM_HH 1
 
+#include <chrono>
 #include <fstream>
 #include <map>
 #include <memory>
@@ -13,6 +14,7 @@
 #include <queue>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 
 // #include "artdaq-core-mu2e/Overlays/DTC_Packets.h"
@@ -73,8 +75,9 @@ public:
 	/// <summary>
 	/// Construct the mu2esim class. Initializes register space and zeroes out memory.
 	/// <param name="ddrFileName">Name of the simulated DDR memory file</param>
+	/// <param name="cfo">Model the CFO register space (run plan memory) instead of the DTC one</param>
 	/// </summary>
-	mu2esim(std::string ddrFileName);
+	mu2esim(std::string ddrFileName, bool cfo = false);
 	~mu2esim();
 	/// <summary>
 	/// Initialize the simulator using the given simulation mode
@@ -129,6 +132,15 @@ public:
 	/// <param name="data">Data to write</param>
 	/// <returns>0 when successful (always)</returns>
 	int write_register(uint16_t address, int tmo_ms, uint32_t data);
+	/// <summary>
+	/// Get the occupancy of the C2S ring of a channel. On the DAQ channel, built events wait in the ring (one per
+	/// buffer) until read, and overflow into the simulated DDR3 event building buffers.
+	/// </summary>
+	/// <param name="chn">Channel</param>
+	/// <param name="filled">Output: buffers filled</param>
+	/// <param name="size">Output: buffers in the ring</param>
+	/// <returns>0 (always succeeds)</returns>
+	int ring_occupancy(int chn, unsigned* filled, unsigned* size);
 
 private:
 	unsigned delta_(int chn, int dir);
@@ -139,7 +151,8 @@ private:
 	DTCLib::DTC_EventMode getEventMode_();
 	void CFOEmulator_();
 	void packetSimulator_(DTCLib::DTC_EventWindowTag ts, DTCLib::DTC_Link_ID link, uint16_t packetCount);
-	void dcsPacketSimulator_(DTCLib::DTC_DCSRequestPacket in);
+	void dcsPacketSimulator_(DTCLib::DTC_DCSRequestPacket in, const uint8_t* packetData);
+	void s2cPacketSimulator_(uint8_t* packetBuffer);  ///< One request or DCS packet of a DCS-channel DMA
 
 	void eventSimulator_(DTCLib::DTC_EventWindowTag ts);
 	void trackerBlockSimulator_(DTCLib::DTC_EventWindowTag ts, DTCLib::DTC_Link_ID link, int DTCID);
@@ -147,8 +160,25 @@ private:
 	void crvBlockSimulator_(DTCLib::DTC_EventWindowTag ts, DTCLib::DTC_Link_ID link, int DTCID);
 
 	void reopenDDRFile_();
+	void iicTransaction_(uint16_t lowAddress, uint16_t highAddress, uint32_t command);
+	uint32_t cableDelayValue_(uint16_t address);
+	uint64_t ddrBytes_() const;
+	uint32_t ddrFlagsValue_(uint16_t address) const;
 
+	std::recursive_mutex stateMutex_;  ///< Guards registers_, the DDR file and event building; the DCS simulation does not take it
 	std::unordered_map<uint16_t, uint32_t> registers_;
+	std::map<DTCLib::DTC_Link_ID, std::unordered_map<uint16_t, uint16_t>> rocRegisters_;  ///< Simulated ROC register space, per link
+	std::map<uint16_t, std::map<uint16_t, uint8_t>> iicDevices_;  ///< Simulated IIC device registers, per IIC Bus Low register, by (device << 8) + register
+	std::map<uint16_t, std::chrono::steady_clock::time_point> iicBusyUntil_;  ///< IIC Bus High registers with a transaction in progress
+	bool cfo_;                              ///< Whether the CFO register space is simulated
+	std::vector<uint32_t> runPlanMemory_;   ///< Simulated CFO run plan memory, by word address
+	uint32_t runPlanAddress_;               ///< Run plan memory word address of the next data register access
+	unsigned cableDelayHops_;               ///< DTCs chained on each simulated CFO link (DTCLIB_SIM_CFO_DTCS_PER_LINK)
+	unsigned cableDelayMeasurements_;       ///< Cable delay measurements started
+	std::chrono::steady_clock::time_point cableDelayDoneAt_;  ///< Completion time of the current cable delay measurement
+	uint64_t ddrBufferBytes_;               ///< Size of each simulated DDR3 event building buffer (DTCLIB_SIM_DDR_BUFFER_BYTES)
+	uint64_t pendingEvents_;                ///< Events built and not read yet, in the C2S ring or the DDR3 buffers
+	uint64_t pendingEventBytes_;            ///< Size of the pending events
 	unsigned swIdx_[MU2E_MAX_CHANNELS];
 	unsigned hwIdx_[MU2E_MAX_CHANNELS];
 	//uint32_t detSimLoopCount_;
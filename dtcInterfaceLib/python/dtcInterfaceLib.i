@@ -10,10 +10,19 @@
 
 %{
 #include "mu2e_driver/mu2e_mmap_ioctl.h"
+#include "dtcInterfaceLib/BringUpTimeline.h"
+#include "dtcInterfaceLib/RegisterDump.h"
 #include "dtcInterfaceLib/CFOandDTC_Registers.h"
 #include "dtcInterfaceLib/DTC_Registers.h"
+#include "dtcInterfaceLib/DTC_RegisterTable.h"
 #include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/RequestGenerator.h"
+#include "dtcInterfaceLib/RequestPacer.h"
+#include "dtcInterfaceLib/RequestSchedule.h"
+#include "dtcInterfaceLib/RequestThrottle.h"
 #include "dtcInterfaceLib/DTCSoftwareCFO.h"
+#include "dtcInterfaceLib/LinkRateMonitor.h"
+#include "dtcInterfaceLib/RegisterAccessProfiler.h"
 #include "dtcInterfaceLib/mu2edev.h"
 #include "dtcInterfaceLib/mu2esim.h"
 using namespace DTCLib;
@@ -29,9 +38,27 @@ using namespace DTCLib;
 %include "mu2e_driver/mu2e_mmap_ioctl.h"
 %include "dtcInterfaceLib/mu2esim.h"
 %include "dtcInterfaceLib/mu2edev.h"
+%include "dtcInterfaceLib/BringUpTimeline.h"
+%template(BringUpPhaseVector) std::vector<DTCLib::BringUpPhase>;
+%template(BringUpRegressionVector) std::vector<DTCLib::BringUpRegression>;
+%include "dtcInterfaceLib/RegisterDump.h"
 %include "dtcInterfaceLib/CFOandDTC_Registers.h"
 %include "dtcInterfaceLib/DTC_Registers.h"
+%include "dtcInterfaceLib/DTC_RegisterTable.h"
+%template(DTC_RegisterFieldVector) std::vector<DTCLib::DTC_RegisterField>;
+%template(RegisterAddressVector) std::vector<uint16_t>;
 %include "dtcInterfaceLib/DTC.h"
+// The request thread's interface takes callables; Python steers the requests through DTCSoftwareCFO
+%ignore DTCLib::RequestGenerator::Start;
+%ignore DTCLib::RequestGenerator::Post;
+%ignore DTCLib::RequestGenerator::Checkpoint;
+%include "dtcInterfaceLib/RequestGenerator.h"
+%include "dtcInterfaceLib/RequestPacer.h"
+%include "dtcInterfaceLib/RequestSchedule.h"
+%include "dtcInterfaceLib/RequestThrottle.h"
 %include "dtcInterfaceLib/DTCSoftwareCFO.h"
+%include "dtcInterfaceLib/LinkRateMonitor.h"
+%include "dtcInterfaceLib/RegisterAccessProfiler.h"
+%template(RegisterAccessStatsVector) std::vector<DTCLib::RegisterAccessStats>;
 %include "dtcInterfaceLib/mu2edev.h"
 %include "dtcInterfaceLib/mu2esim.h"
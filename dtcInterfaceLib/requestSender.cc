@@ -1,7 +1,9 @@
+#include <poll.h>    // poll
 #include <unistd.h>  // usleep
 #include <cstdio>    // printf
 #include <cstdlib>   // strtoul
 #include <iostream>
+#include <sstream>
 #include <string>
 
 #include "DTCSoftwareCFO.h"
@@ -17,19 +19,76 @@ void printHelpMsg()
 			  << "    -o: Starting Timestamp offest. (Default: 1)." << std::endl
 			  << "    -i: Do not increment Timestamps." << std::endl
 			  << "    -d: Delay between tests, in us (Default: 0)." << std::endl
+			  << "    -r: Request rate, in event windows per second, instead of -d (Default: 0, use -d)." << std::endl
+			  << "    -b: Number of event windows to pack into each DMA (Default: 1)." << std::endl
+			  << "    -s: Request schedule, instead of -d and -r:" << std::endl
+			  << "          uniform:RATE, spill[:MICROBUNCH_NS:SPILL_MS:GAP_MS:SPILLS:CYCLE_MS], poisson:RATE[:SEED]," << std::endl
+			  << "          bursty:RATE:PERIOD_US:DUTY_CYCLE or replay:FILE[:SPACING_NS] (tags relative to -o)" << std::endl
+			  << "    -t: Throttle the request rate to hold the DTC DDR3 buffers and the host ring at this occupancy (0 to 1)," << std::endl
+			  << "          starting at -r, and report the maximum sustainable rate (Default: 0, no throttle)." << std::endl
+			  << "    -p: Steer the requests from the terminal while they are sent:" << std::endl
+			  << "          pause, resume, cancel, rate N, schedule SPEC|none, status (or an empty line)" << std::endl
+			  << "    -a: Send all Readout Requests before the Data Requests." << std::endl
 			  << "    -c: Number of Debug Packets to request (Default: 0)." << std::endl
 			  << "    -q: Quiet mode (Don't print)" << std::endl;
 	exit(0);
 }
 
-int main(int argc, char* argv[])
+void steerRequests(DTCLib::DTCSoftwareCFO& theEmulator)
 {
-	DTCLib::DTC theDTC;
-	DTCLib::DTCSoftwareCFO theEmulator(&theDTC, false);
+	std::cout << "Commands: pause, resume, cancel, rate N, schedule SPEC|none, status" << std::endl;
+	while (theEmulator.IsActive())
+	{
+		pollfd input{STDIN_FILENO, POLLIN, 0};
+		if (poll(&input, 1, 200) <= 0) continue;
+		std::string line;
+		if (!std::getline(std::cin, line)) break;  // End of input: let the requests run to the end
 
+		std::istringstream command(line);
+		std::string verb, argument;
+		command >> verb >> argument;
+		try
+		{
+			if (verb == "pause")
+				theEmulator.Pause();
+			else if (verb == "resume")
+				theEmulator.Resume();
+			else if (verb == "cancel")
+				theEmulator.Cancel();
+			else if (verb == "rate" && !argument.empty())
+				theEmulator.setRequestRate(std::stod(argument));
+			else if (verb == "schedule" && !argument.empty())
+			{
+				std::shared_ptr<DTCLib::RequestSchedule> schedule;
+				if (argument != "none") schedule = DTCLib::RequestSchedule::Create(argument);
+				theEmulator.setRequestSchedule(schedule);
+			}
+			else if (!verb.empty() && verb != "status")
+			{
+				std::cout << "Unknown command: " << line << std::endl;
+				continue;
+			}
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << e.what() << std::endl;
+			continue;
+		}
+		std::cout << theEmulator.FormatProgress() << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
 	auto incrementTimestamp = true;
 	auto quiet = false;
+	auto asyncRR = false;
+	auto steer = false;
 	unsigned delay = 0;
+	unsigned rate = 0;
+	unsigned burst = 1;
+	std::string schedule = "";
+	double throttleTarget = 0;
 	unsigned number = 1;
 	unsigned timestampOffset = 1;
 	unsigned packetCount = 0;
@@ -46,6 +105,24 @@ int main(int argc, char* argv[])
 				case 'd':
 					delay = DTCLib::Utilities::getOptionValue(&optind, &argv);
 					break;
+				case 'r':
+					rate = DTCLib::Utilities::getOptionValue(&optind, &argv);
+					break;
+				case 'b':
+					burst = DTCLib::Utilities::getOptionValue(&optind, &argv);
+					break;
+				case 't':
+					throttleTarget = std::stod(DTCLib::Utilities::getOptionString(&optind, &argv));
+					break;
+				case 'a':
+					asyncRR = true;
+					break;
+				case 'p':
+					steer = true;
+					break;
+				case 's':
+					schedule = DTCLib::Utilities::getOptionString(&optind, &argv);
+					break;
 				case 'n':
 					number = DTCLib::Utilities::getOptionValue(&optind, &argv);
 					break;
@@ -74,14 +151,42 @@ int main(int argc, char* argv[])
 	std::cout << "Options are: "
 			  << "Num: " << number << ", Delay: " << delay << ", TS Offset: " << timestampOffset
 			  << ", PacketCount: " << packetCount << ", Increment TS: " << incrementStr << ", Quiet Mode: " << quietStr
-			  << std::endl;
+			  << ", Rate: " << rate << ", Burst: " << burst << ", Schedule: " << (schedule.empty() ? "none" : schedule)
+			  << ", Throttle Target: " << throttleTarget << std::endl;
 
+	std::shared_ptr<DTCLib::RequestSchedule> requestSchedule;
+	if (!schedule.empty())
+	{
+		requestSchedule = DTCLib::RequestSchedule::Create(schedule);
+		std::cout << "Request schedule: " << requestSchedule->Describe() << std::endl;
+	}
+
+	DTCLib::DTC theDTC;
+	DTCLib::DTCSoftwareCFO theEmulator(&theDTC, false, 0, DTCLib::DTC_DebugType_ExternalSerialWithReset, false, quiet, asyncRR);
 	theEmulator.setQuiet(quiet);
 	theEmulator.setDebugPacketCount(packetCount);
+	theEmulator.setBurstSize(burst);
+	theEmulator.setRequestRate(rate);
+	theEmulator.setRequestSchedule(requestSchedule);
+
+	std::shared_ptr<DTCLib::RequestThrottle> throttle;
+	if (throttleTarget > 0)
+	{
+		DTCLib::RequestThrottleParameters parameters;
+		parameters.targetOccupancy = throttleTarget;
+		if (rate > 0) parameters.initialRate = rate;
+		throttle = std::make_shared<DTCLib::RequestThrottle>(&theDTC, parameters);
+		theEmulator.setThrottle(throttle);
+	}
 
 	if (number > 1)
 	{
 		theEmulator.SendRequestsForRange(number, DTCLib::DTC_EventWindowTag(timestampOffset), incrementTimestamp, delay);
+		if (steer) steerRequests(theEmulator);
+		theEmulator.WaitForCompletion();
+		std::cout << theEmulator.FormatProgress() << std::endl;
+		std::cout << theEmulator.FormatRateReport() << std::endl;
+		if (throttle) std::cout << "Throttle: " << throttle->FormatReport() << std::endl;
 	}
 	else
 	{
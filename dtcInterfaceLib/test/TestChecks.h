@@ -0,0 +1,100 @@
+#pragma once
+#include <unistd.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Pass/fail bookkeeping shared by the unit tests: each check prints a PASS: or FAIL: line, and Finish prints
+/// TEST PASSED or TEST FAILED and gives the exit code of the test
+/// </summary>
+class TestChecks
+{
+public:
+	TestChecks()
+		: failures_(0) {}
+
+	/// <summary>
+	/// Record a check
+	/// </summary>
+	/// <param name="what">Description of the check</param>
+	/// <param name="ok">Whether the check passed</param>
+	/// <returns>Whether the check passed</returns>
+	bool Check(std::string const& what, bool ok)
+	{
+		std::cout << (ok ? "PASS: " : "FAIL: ") << what << std::endl;
+		if (!ok) ++failures_;
+		return ok;
+	}
+
+	/// <summary>
+	/// Record a failed check, to be described on the returned stream
+	/// </summary>
+	/// <returns>Stream to write the description of the failure to</returns>
+	std::ostream& Fail()
+	{
+		++failures_;
+		return std::cout << "FAIL: ";
+	}
+
+	/// <summary>
+	/// Get the number of failed checks so far
+	/// </summary>
+	/// <returns>Number of failed checks</returns>
+	int Failures() const { return failures_; }
+
+	/// <summary>
+	/// Print the result of the test
+	/// </summary>
+	/// <returns>Exit code of the test: 0 if every check passed, 1 otherwise</returns>
+	int Finish() const
+	{
+		std::cout << (failures_ == 0 ? "TEST PASSED" : "TEST FAILED") << std::endl;
+		return failures_ == 0 ? 0 : 1;
+	}
+
+private:
+	int failures_;
+};
+
+/// <summary>
+/// A uniquely-named file in $TMPDIR (or /tmp), removed when the object goes out of scope, so that tests running in
+/// parallel do not write over each other's files
+/// </summary>
+class TestTemporaryFile
+{
+public:
+	/// <summary>
+	/// Create the file
+	/// </summary>
+	/// <param name="suffix">End of the file name, e.g. ".txt"</param>
+	explicit TestTemporaryFile(std::string const& suffix)
+	{
+		auto dir = getenv("TMPDIR");
+		auto pattern = std::string(dir != nullptr && *dir != '\0' ? dir : "/tmp") + "/mu2e_pcie_utils_test_XXXXXX" + suffix;
+		std::vector<char> name(pattern.begin(), pattern.end());
+		name.push_back('\0');
+		auto fd = mkstemps(name.data(), static_cast<int>(suffix.size()));
+		if (fd >= 0)
+		{
+			close(fd);
+			path_ = name.data();
+		}
+	}
+	~TestTemporaryFile()
+	{
+		if (!path_.empty()) unlink(path_.c_str());
+	}
+	TestTemporaryFile(TestTemporaryFile const&) = delete;
+	TestTemporaryFile& operator=(TestTemporaryFile const&) = delete;
+
+	/// <summary>
+	/// Get the path of the file
+	/// </summary>
+	/// <returns>Path of the file, empty if it could not be created</returns>
+	std::string const& Path() const { return path_; }
+
+private:
+	std::string path_;
+};
@@ -0,0 +1,75 @@
+// Bring-up timeline test on the simulated DTC (mu2esim).
+// Checks that DTC construction records its phases with register access counts, and that the baseline comparison
+// flags phases which got slower or make more register accesses.
+//
+// Usage: bringUpTimelineTest [baseline file [--save]]
+// With a baseline file, the construction is also compared to it and the test fails on a regression;
+// with --save, the baseline file is (re)written from this run instead.
+// This is a manual tool (cet_make_exec, not cet_test): the baseline is specific to a host and build, so none is
+// kept in the tree, and without one only the self-consistency checks run.
+
+#include <iostream>
+#include <string>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+int main(int argc, char* argv[])
+{
+	std::string baselinePath = argc > 1 ? argv[1] : "";
+	bool save = argc > 2 && std::string(argv[2]) == "--save";
+	TestChecks checks;
+
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1, "v99.99");
+	auto const& timeline = thisDTC.GetBringUpTimeline();
+	std::cout << timeline.Format();
+
+	bool deviceInit = false, setSimMode = false;
+	for (auto const& phase : timeline.GetPhases())
+	{
+		if (phase.name == "mu2edev::init") deviceInit = phase.depth > 0;
+		if (phase.name == "DTC SetSimMode") setSimMode = phase.depth == 0 && phase.registerReads > 0 && phase.registerWrites > 0;
+	}
+	if (!deviceInit || !setSimMode)
+	{
+		checks.Fail() << "bring-up phases were not recorded as expected" << std::endl;
+	}
+
+	// A run against itself does not regress; a baseline with fewer register accesses or a shorter duration does
+	if (!timeline.Compare(timeline.GetPhases()).empty())
+	{
+		checks.Fail() << "bring-up timeline regressed against itself" << std::endl;
+	}
+	auto faster = timeline.GetPhases();
+	for (auto& phase : faster)
+	{
+		phase.durationUs /= 10;
+		if (phase.registerWrites > 0) --phase.registerWrites;
+	}
+	if (timeline.Compare(faster, 0.5, 0).empty())
+	{
+		checks.Fail() << "regressions against a faster baseline were not detected" << std::endl;
+	}
+
+	if (!baselinePath.empty())
+	{
+		if (save)
+		{
+			timeline.SaveBaseline(baselinePath);
+			std::cout << "Saved bring-up baseline to " << baselinePath << std::endl;
+		}
+		else
+		{
+			for (auto const& regression : timeline.Compare(BringUpTimeline::LoadBaseline(baselinePath)))
+			{
+				checks.Fail() << "bring-up phase '" << regression.phase << "' took " << regression.durationUs << " us and "
+							  << regression.accesses << " register accesses, baseline is " << regression.baselineUs << " us and "
+							  << regression.baselineAccesses << " register accesses" << std::endl;
+			}
+		}
+	}
+
+	return checks.Finish();
+}
@@ -0,0 +1,147 @@
+// Loopback test of the DCS broker on the simulated DTC (mu2esim).
+// The broker runs in this process, clients run in forked child processes with
+// different priorities and pipeline their requests through the shared-memory ring.
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "dtcInterfaceLib/DCSBroker.h"
+
+using namespace DTCLib;
+
+void usage()
+{
+	std::cout << "Usage: dcsBrokerTest [clients = 4] [requests per client = 1000]" << std::endl;
+	exit(1);
+}
+
+// Returns the number of failed requests
+int runClient(std::string const& shmName, int clientId, int requests)
+{
+	auto failures = 0;
+	DCSBrokerClient client(shmName, clientId /* priority */);
+
+	// Pipelined reads: keep several requests in flight, each to its own address so that the
+	// DTC address check on the reply verifies that replies are routed back to the right request
+	const size_t window = 8;
+	std::vector<uint32_t> tickets;
+	auto collect = [&]() {
+		for (auto& ticket : tickets)
+		{
+			try
+			{
+				client.Wait(ticket);
+			}
+			catch (std::exception const& ex)
+			{
+				std::cout << "Client " << clientId << " read " << ticket << " failed: " << ex.what() << std::endl;
+				++failures;
+			}
+		}
+		tickets.clear();
+	};
+	for (auto ii = 0; ii < requests; ++ii)
+	{
+		auto address = static_cast<roc_address_t>((clientId << 12) + (ii & 0xFFF));
+		tickets.push_back(client.Submit(DCSBrokerOp_Read, DTC_Link_0, address));
+		if (tickets.size() == window) collect();
+	}
+	collect();
+
+	// Synchronous writes
+	for (auto ii = 0; ii < requests / 10; ++ii)
+	{
+		try
+		{
+			client.WriteROCRegister(DTC_Link_0, static_cast<roc_address_t>(ii), static_cast<roc_data_t>(clientId), false, 10);
+		}
+		catch (std::exception const& ex)
+		{
+			std::cout << "Client " << clientId << " write " << ii << " failed: " << ex.what() << std::endl;
+			++failures;
+		}
+	}
+	return failures;
+}
+
+int main(int argc, char* argv[])
+{
+	auto clients = 4;
+	auto requests = 1000;
+	if (argc > 1) clients = atoi(argv[1]);
+	if (argc > 2) requests = atoi(argv[2]);
+	if (clients <= 0 || requests <= 0) usage();
+
+	auto shmName = "/mu2e_dcs_broker_test_" + std::to_string(getpid());
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+	DCSBroker broker(&thisDTC, shmName);
+
+	// A second broker must not take over the segment of a running one
+	auto secondBrokerRefused = false;
+	try
+	{
+		DCSBroker secondBroker(&thisDTC, shmName);
+	}
+	catch (std::exception const& ex)
+	{
+		std::cout << "Second broker refused: " << ex.what() << std::endl;
+		secondBrokerRefused = true;
+	}
+	if (!secondBrokerRefused)
+	{
+		std::cout << "TEST FAILED: a second broker started on " << shmName << std::endl;
+		return 1;
+	}
+
+	// Fork the clients before the broker thread is started
+	std::vector<pid_t> children;
+	for (auto ii = 0; ii < clients; ++ii)
+	{
+		auto pid = fork();
+		if (pid == 0)
+		{
+			int failures;
+			try
+			{
+				failures = runClient(shmName, ii, requests);
+			}
+			catch (std::exception const& ex)
+			{
+				std::cout << "Client " << ii << " failed: " << ex.what() << std::endl;
+				failures = 1;
+			}
+			_exit(failures > 0 ? 1 : 0);
+		}
+		children.push_back(pid);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::thread brokerThread(&DCSBroker::Run, &broker);
+
+	auto failedClients = 0;
+	for (auto pid : children)
+	{
+		int status;
+		waitpid(pid, &status, 0);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) ++failedClients;
+	}
+	auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	broker.Stop();
+	brokerThread.join();
+
+	auto expected = static_cast<uint64_t>(clients) * (requests + requests / 10);
+	std::cout << "DCS broker served " << broker.GetServedCount() << " of " << expected << " requests from " << clients << " clients in "
+			  << duration << " s (" << broker.GetServedCount() / duration << " requests/s)" << std::endl;
+
+	if (failedClients > 0 || broker.GetServedCount() != expected)
+	{
+		std::cout << "TEST FAILED: " << failedClients << " clients reported errors" << std::endl;
+		return 1;
+	}
+	std::cout << "TEST PASSED" << std::endl;
+	return 0;
+}
@@ -0,0 +1,100 @@
+// DCS reply dispatcher test on the simulated DTC (mu2esim).
+// Several threads read ROC registers concurrently through the dispatcher, each checking that it gets
+// the replies to its own requests, and the aggregate rate is compared to locked DTC::ReadROCRegister calls.
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "dtcInterfaceLib/DCSReplyDispatcher.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+void usage()
+{
+	std::cout << "Usage: dcsReplyDispatcherTest [threads = 4] [reads per thread = 2000]" << std::endl;
+	exit(1);
+}
+
+int main(int argc, char* argv[])
+{
+	auto threads = 4;
+	auto reads = 2000;
+	if (argc > 1) threads = atoi(argv[1]);
+	if (argc > 2) reads = atoi(argv[2]);
+	if (threads <= 0 || threads > 16 || reads <= 0) usage();
+
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+
+	// Each thread owns 256 registers holding a known pattern
+	auto pattern = [](int thread, int ii) { return static_cast<roc_data_t>((thread << 12) ^ (ii * 0x9E37)); };
+	for (auto thread = 0; thread < threads; ++thread)
+		for (auto ii = 0; ii < 256; ++ii)
+			thisDTC.WriteROCRegister(DTC_Link_0, static_cast<roc_address_t>((thread << 8) + ii), pattern(thread, ii), false, 0);
+
+	auto start = std::chrono::steady_clock::now();
+	for (auto ii = 0; ii < reads; ++ii) thisDTC.ReadROCRegister(DTC_Link_0, static_cast<roc_address_t>(ii & 0xFF), 10);
+	auto lockedRate = reads / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	TestChecks checks;
+	{
+		DCSReplyDispatcher dispatcher(&thisDTC);
+
+		std::vector<std::thread> readers;
+		std::vector<int> errors(threads, 0);
+		start = std::chrono::steady_clock::now();
+		for (auto thread = 0; thread < threads; ++thread)
+		{
+			readers.emplace_back([&, thread]() {
+				for (auto ii = 0; ii < reads; ++ii)
+				{
+					auto address = static_cast<roc_address_t>((thread << 8) + (ii & 0xFF));
+					try
+					{
+						if (dispatcher.ReadROCRegister(DTC_Link_0, address, 10) != pattern(thread, ii & 0xFF)) ++errors[thread];
+					}
+					catch (std::exception const&)
+					{
+						++errors[thread];  // Timeout
+					}
+				}
+			});
+		}
+		for (auto& reader : readers) reader.join();
+		auto dispatcherRate = threads * reads / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (auto thread = 0; thread < threads; ++thread)
+		{
+			if (errors[thread] > 0)
+			{
+				checks.Fail() << "thread " << thread << " had " << errors[thread] << " wrong or missing replies" << std::endl;
+			}
+		}
+		std::cout << "Locked reads: " << lockedRate << " reads/s, dispatcher with " << threads << " threads: " << dispatcherRate
+				  << " reads/s" << std::endl;
+
+		// A reply nobody is waiting for must end up on the diagnostics queue
+		thisDTC.SendDCSRequestPacket(DTC_Link_0, DTC_DCSOperationType_Read, 0x42);
+		std::deque<std::unique_ptr<DTC_DCSReplyPacket>> diagnostics;
+		for (auto ii = 0; ii < 100 && diagnostics.empty(); ++ii)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			diagnostics = dispatcher.TakeDiagnostics();
+		}
+		if (diagnostics.size() != 1 || diagnostics.front()->GetReply(false).first != 0x42)
+		{
+			checks.Fail() << "unsolicited reply was not put on the diagnostics queue" << std::endl;
+		}
+
+		auto stats = dispatcher.GetStats();
+		std::cout << "Dispatcher: " << stats.requestsSent << " sent, " << stats.repliesRouted << " routed, " << stats.unmatched
+				  << " unmatched, " << stats.expired << " expired, " << stats.readErrors << " read errors" << std::endl;
+		if (stats.repliesRouted != static_cast<uint64_t>(threads) * reads || stats.expired != 0)
+		{
+			checks.Fail() << "dispatcher counters do not match the requests made" << std::endl;
+		}
+	}
+
+	return checks.Finish();
+}
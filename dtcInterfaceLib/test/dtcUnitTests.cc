@@ -6,16 +6,16 @@
 void usage()
 {
 	std::cout << "This program runs several functionality tests of libDTCInterface." << std::endl
-			  << "If run with no options, it will run all 4 tests." << std::endl
+			  << "If run with no options, it will run the first 4 tests." << std::endl
 			  << "Otherwise, it accepts a space-delimited list of the tests to run," << std::endl
-			  << "defined either by test number {0,1,4,5}, or test name {class, reg, dcs, daq}" << std::endl
+			  << "defined either by test number {0,1,4,5,6}, or test name {class, reg, dcs, daq, stress}" << std::endl
 			  << "It also accepts a -n argument indicating how many iterations of the tests it should run" << std::endl;
 }
 
 int main(int argc, char* argv[])
 {
 	auto testCount = 1;
-	auto classTest = false, registerTest = false, dcsTest = false, daqTest = false;
+	auto classTest = false, registerTest = false, dcsTest = false, daqTest = false, stressTest = false;
 	auto testsSpecified = false;
 
 	if (argc == 1)
@@ -60,6 +60,9 @@ int main(int argc, char* argv[])
 					case 5:
 						daqTest = true;
 						break;
+					case 6:
+						stressTest = true;
+						break;
 					default:
 						break;
 				}
@@ -88,6 +91,11 @@ int main(int argc, char* argv[])
 					daqTest = true;
 					testsSpecified = true;
 				}
+				else if (arg.find("stress") != std::string::npos)
+				{
+					stressTest = true;
+					testsSpecified = true;
+				}
 				else
 				{
 					usage();
@@ -106,11 +114,11 @@ int main(int argc, char* argv[])
 
 	std::cout << "Running tests: " << (classTest ? "Class Construction/Destruction " : "")
 			  << (registerTest ? "Register I/O " : "") << (dcsTest ? "DCS DMA I/O " : "")
-			  << (daqTest ? "DAQ DMA I/O " : "") << ", " << testCount << " times." << std::endl;
+			  << (daqTest ? "DAQ DMA I/O " : "") << (stressTest ? "DAQ/DCS Stress " : "") << ", " << testCount << " times." << std::endl;
 
 	auto tester = new DTCLib::DTCLibTest();
 
-	tester->startTest(classTest, registerTest, daqTest, dcsTest, testCount, true);
+	tester->startTest(classTest, registerTest, daqTest, dcsTest, testCount, true, stressTest);
 
 	while (tester->isRunning())
 	{
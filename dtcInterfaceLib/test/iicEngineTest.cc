@@ -0,0 +1,81 @@
+// IIC engine test on the simulated DTC (mu2esim), which models the IIC masters with a register memory per device.
+// Checks write/read round trips through the blocking IIC Interface functions and the queued engine,
+// the jitter attenuator configuration sequence, and that a transaction which never completes times out.
+
+#include <chrono>
+#include <iostream>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+int main()
+{
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+	TestChecks checks;
+
+	// Blocking functions, on several buses
+	thisDTC.WriteSERDESIICInterface(DTC_IICSERDESBusAddress_EVB, 0x10, 0x5A);
+	thisDTC.WriteFireflyTXIICInterface(0x50, 0x10, 0xA5);
+	thisDTC.WriteSFPIICInterface(0x50, 0x10, 0x3C);
+	if (thisDTC.ReadSERDESIICInterface(DTC_IICSERDESBusAddress_EVB, 0x10) != 0x5A || thisDTC.ReadFireflyTXIICInterface(0x50, 0x10) != 0xA5 ||
+		thisDTC.ReadSFPIICInterface(0x50, 0x10) != 0x3C)
+	{
+		checks.Fail() << "blocking IIC write/read round trip" << std::endl;
+	}
+
+	// Queued operations run in order: each read sees the write queued before it
+	auto& engine = thisDTC.GetIICEngine({CFOandDTC_Register_FireflyRX_IICBusConfigLow, CFOandDTC_Register_FireflyRX_IICBusConfigHigh});
+	std::vector<std::future<uint8_t>> reads;
+	auto start = std::chrono::steady_clock::now();
+	for (auto ii = 0; ii < 100; ++ii)
+	{
+		engine.Write(0x50, static_cast<uint8_t>(ii), static_cast<uint8_t>(ii * 3));
+		reads.push_back(engine.Read(0x50, static_cast<uint8_t>(ii)));
+	}
+	for (auto ii = 0; ii < 100; ++ii)
+	{
+		if (reads[ii].get() != static_cast<uint8_t>(ii * 3))
+		{
+			checks.Fail() << "queued read " << ii << " returned the wrong value" << std::endl;
+			break;
+		}
+	}
+	auto perTransaction = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / 200;
+	auto stats = engine.GetStats();
+	std::cout << "Queued IIC transactions: " << perTransaction << " us each, " << stats.polls << " polls for " << stats.writes
+			  << " writes and " << stats.reads << " reads" << std::endl;
+
+	// Jitter attenuator configuration: preamble, 300 ms pause, then the configuration registers
+	auto& serdes = thisDTC.GetIICEngine({CFOandDTC_Register_SERDESClock_IICBusLow, CFOandDTC_Register_SERDESClock_IICBusHigh});
+	auto writesBefore = serdes.GetStats().writes;
+	start = std::chrono::steady_clock::now();
+	thisDTC.ConfigureJitterAttenuatorAsync().get();
+	auto configureMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	auto configureWrites = serdes.GetStats().writes - writesBefore;
+	std::cout << "Jitter attenuator configuration: " << configureWrites << " IIC writes in " << configureMs << " ms" << std::endl;
+	if (configureWrites == 0 || configureMs < 300)
+	{
+		checks.Fail() << "jitter attenuator configuration did not run as expected" << std::endl;
+	}
+
+	// A bus whose High register never clears (the scratch register is not an IIC master)
+	{
+		IICEngine stuck(&thisDTC, {CFOandDTC_Register_Scratch, CFOandDTC_Register_Scratch}, 100000, 10);
+		try
+		{
+			stuck.Write(0x50, 0, 0).get();
+			checks.Fail() << "write on a stuck IIC bus did not time out" << std::endl;
+		}
+		catch (std::exception const&)
+		{
+		}
+		if (stuck.GetStats().timeouts != 1)
+		{
+			checks.Fail() << "timeout was not counted" << std::endl;
+		}
+	}
+
+	return checks.Finish();
+}
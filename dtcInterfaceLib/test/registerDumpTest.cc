@@ -0,0 +1,44 @@
+// Register dump test on the simulated DTC (mu2esim). Checks the binary dump of the default layout, and builds the
+// layout of every dump formatter, so that a formatter which throws (e.g. a field missing from DTC_RegisterFields) fails
+// the test; then checks the text, JSON and binary dumps made from it.
+
+#include <cstring>
+#include <iostream>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/RegisterDump.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+int main()
+{
+	TestChecks checks;
+
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+
+	// The bulk register dump has one record per register of its layout
+	std::string dump;
+	thisDTC.FormatRegisterDump(RegisterDumpFormat_Binary, dump);
+	RegisterDumpBinaryHeader header;
+	if (dump.size() >= sizeof(header)) memcpy(&header, dump.data(), sizeof(header));
+	checks.Check("binary dump of the default layout", dump.size() >= sizeof(header) && header.count == thisDTC.GetRegisterDumpLayout().Size() &&
+														  dump.size() == sizeof(header) + header.count * sizeof(RegisterDumpBinaryRecord));
+
+	// The full layout, from every formatter
+	auto const& formatters = thisDTC.getFormattedDumpFunctions();
+	auto layout = thisDTC.MakeRegisterDumpLayout(formatters);
+	std::cout << "Register dump layout: " << layout.Size() << " of " << formatters.size() << " registers" << std::endl;
+	checks.Check("one register per formatter", layout.Size() == formatters.size());
+
+	std::string text, json, binary;
+	thisDTC.FormatRegisterDump(layout, RegisterDumpFormat_Text, text);
+	thisDTC.FormatRegisterDump(layout, RegisterDumpFormat_JSON, json);
+	thisDTC.FormatRegisterDump(layout, RegisterDumpFormat_Binary, binary);
+	checks.Check("text dump", !text.empty());
+	checks.Check("JSON dump", !json.empty() && json.front() == '{');
+	checks.Check("binary dump", binary.size() == sizeof(header) + layout.Size() * sizeof(RegisterDumpBinaryRecord));
+	checks.Check("decorated dump", !thisDTC.FormattedRegDump(120, formatters).empty());
+
+	return checks.Finish();
+}
@@ -0,0 +1,163 @@
+// Request generator test. Checks pause, resume and cancel of a RequestGenerator run, that posted changes are applied
+// in the request thread, and the progress counters; then steers a DTCSoftwareCFO range on the simulated DTC (mu2esim)
+// while it runs: rate change, pause without catch-up, schedule change with continuing tags, and cancel.
+// The test waits for states (a run in progress, a pause in effect) instead of sleeping for fixed windows, and checks
+// what the steering did rather than the rates achieved on the wall clock, which are only reported.
+
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/DTCSoftwareCFO.h"
+#include "dtcInterfaceLib/RequestGenerator.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+namespace {
+// Poll until the condition holds, for at most 10 s
+bool WaitFor(std::function<bool()> condition)
+{
+	for (auto ii = 0; ii < 10000 && !condition(); ++ii) usleep(1000);
+	return condition();
+}
+}  // namespace
+
+int main()
+{
+	TestChecks checks;
+
+	// A run of one window per millisecond, much longer than the test
+	RequestGenerator generator;
+	auto body = [&generator](uint64_t windows) {
+		return [&generator, windows]() {
+			std::chrono::nanoseconds paused;
+			for (uint64_t ii = 0; ii < windows && generator.Checkpoint(paused); ++ii)
+			{
+				usleep(1000);
+				generator.Record(1, 100 + ii);
+			}
+		};
+	};
+	auto wallStart = std::chrono::steady_clock::now();
+	generator.Start(1000000, body(1000000));
+	checks.Check("run in progress", WaitFor([&]() { return generator.GetProgress().requestsSent > 10; }) &&
+										generator.GetState() == RequestGeneratorState::Running && generator.IsActive() &&
+										generator.GetProgress().requestsTotal == 1000000);
+	std::cout << generator.FormatProgress() << std::endl;
+
+	// Once the request thread holds at its checkpoint, nothing is sent and posted changes wait
+	generator.Pause();
+	checks.Check("pause takes effect", WaitFor([&]() { return generator.GetProgress().holding; }));
+	auto paused = generator.GetProgress();
+	checks.Check("current tag", paused.currentTag == 99 + paused.requestsSent);
+	std::atomic<bool> applied(false);
+	std::thread::id changeThread;
+	generator.Post([&]() {
+		changeThread = std::this_thread::get_id();
+		applied = true;
+	});
+	usleep(100000);
+	auto stillPaused = generator.GetProgress();
+	checks.Check("pause stops the requests", stillPaused.state == RequestGeneratorState::Paused && stillPaused.holding && stillPaused.requestsSent == paused.requestsSent);
+	checks.Check("changes wait for the next checkpoint", !applied);
+
+	generator.Resume();
+	checks.Check("resume continues the requests", WaitFor([&]() { return generator.GetProgress().requestsSent > paused.requestsSent; }) &&
+													  generator.GetState() == RequestGeneratorState::Running && !generator.GetProgress().holding);
+	checks.Check("changes are applied in the request thread", applied && changeThread != std::this_thread::get_id());
+
+	// The request thread was held for at least the 100 ms above, which the elapsed time leaves out
+	generator.Cancel();
+	generator.Wait();
+	auto cancelled = generator.GetProgress();
+	auto wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+	std::cout << generator.FormatProgress() << std::endl;
+	checks.Check("cancel stops the run", cancelled.state == RequestGeneratorState::Cancelled && !generator.IsActive() && cancelled.requestsSent < 1000000);
+	checks.Check("elapsed time excludes the pause", cancelled.elapsedSeconds <= wallSeconds - 0.1 && cancelled.achievedRate > 0);
+
+	applied = false;
+	generator.Post([&]() { applied = true; });
+	checks.Check("changes apply right away when idle", applied);
+
+	generator.Start(10, body(10));
+	generator.Wait();
+	checks.Check("run to the end", generator.GetState() == RequestGeneratorState::Finished && generator.GetProgress().requestsSent == 10);
+
+	generator.Start(1000, body(1000));
+	generator.Pause();
+	auto threw = false;
+	try
+	{
+		generator.Start(10, body(10));
+	}
+	catch (const std::exception&)
+	{
+		threw = true;
+	}
+	checks.Check("no new run while paused", threw);
+	generator.Cancel();
+	generator.Wait();
+	checks.Check("cancel while paused", generator.GetState() == RequestGeneratorState::Cancelled);
+
+	// Steering a software range on the simulated DTC; synchronous ReadoutRequests, so the pattern can change mid-range
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+	DTCSoftwareCFO theCFO(&thisDTC, false, 0, DTC_DebugType_SpecialSequence, true, true /* quiet */, false /* asyncRR */);
+	theCFO.setBurstSize(10);
+	theCFO.setRequestRate(2000);
+	theCFO.SendRequestsForRange(1000000, DTC_EventWindowTag(static_cast<uint64_t>(1)), true, 0, 1, 0);
+	checks.Check("range in progress", WaitFor([&]() { return theCFO.GetProgress().requestsSent > 100; }) &&
+										  theCFO.GetProgress().state == RequestGeneratorState::Running);
+	std::cout << theCFO.FormatProgress() << std::endl;
+
+	theCFO.setRequestRate(10000);
+	checks.Check("rate change while running", WaitFor([&]() { return theCFO.GetRateReport().requestedRate == 10000; }));
+	auto beforeFast = theCFO.GetProgress();
+	usleep(200000);
+	auto fast = theCFO.GetProgress();
+	std::cout << theCFO.FormatProgress() << ", " << (fast.requestsSent - beforeFast.requestsSent) / 0.2 << " /s since the rate change" << std::endl;
+
+	// A resumed range restarts its deadlines instead of catching up: no burst is as late as the pause was long
+	theCFO.Pause();
+	checks.Check("range pause takes effect", WaitFor([&]() { return theCFO.GetProgress().holding; }));
+	auto pausedRange = theCFO.GetProgress();
+	checks.Check("range tags", pausedRange.currentTag == pausedRange.requestsSent);
+	usleep(300000);
+	checks.Check("range paused", theCFO.GetProgress().requestsSent == pausedRange.requestsSent);
+	theCFO.Resume();
+	checks.Check("range resumed", WaitFor([&]() { return theCFO.GetProgress().requestsSent > pausedRange.requestsSent + 100; }));
+	std::cout << theCFO.FormatProgress() << "; " << theCFO.FormatRateReport() << std::endl;
+	checks.Check("range resumed without catching up the pause", theCFO.GetRateReport().maximumLatenessUs < 300000);
+
+	theCFO.setRequestSchedule(RequestSchedule::Create("uniform:1000"));
+	auto switched = theCFO.GetProgress();
+	checks.Check("range continues on the new schedule", WaitFor([&]() { return theCFO.GetProgress().requestsSent > switched.requestsSent + 100; }));
+	theCFO.Pause();
+	checks.Check("range pause takes effect on the new schedule", WaitFor([&]() { return theCFO.GetProgress().holding; }));
+	auto scheduled = theCFO.GetProgress();
+	std::cout << theCFO.FormatProgress() << std::endl;
+	checks.Check("tags continue across the schedule change", scheduled.currentTag == scheduled.requestsSent);
+	theCFO.Resume();
+
+	auto cancelStart = std::chrono::steady_clock::now();
+	theCFO.Cancel();
+	theCFO.WaitForCompletion();
+	auto cancelSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - cancelStart).count();
+	auto cancelledRange = theCFO.GetProgress();
+	std::cout << theCFO.FormatProgress() << ", cancelled in " << cancelSeconds * 1000 << " ms" << std::endl;
+	checks.Check("range cancelled", cancelledRange.state == RequestGeneratorState::Cancelled && !theCFO.IsActive() && cancelledRange.requestsSent < 1000000);
+
+	// The next range runs from the start, with the settings made since
+	theCFO.setRequestSchedule(nullptr);
+	theCFO.setRequestRate(20000);
+	theCFO.SendRequestsForRange(100, DTC_EventWindowTag(static_cast<uint64_t>(1)), true, 0, 1, 0);
+	theCFO.WaitForCompletion();
+	auto next = theCFO.GetProgress();
+	checks.Check("next range", next.state == RequestGeneratorState::Finished && next.requestsSent == 100 && next.currentTag == 100);
+
+	return checks.Finish();
+}
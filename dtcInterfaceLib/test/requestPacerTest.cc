@@ -0,0 +1,93 @@
+// Request pacing and burst test on the simulated DTC (mu2esim).
+// Checks the deadline schedule of the RequestPacer on a simulated clock (exact spacing, no drift from the time spent
+// sending, lateness when sending is slower than the rate, rate changes), that packed DMAs are split back into their
+// packets by the DTC (here, the simulator), and that DTCSoftwareCFO bursts send every request. The rate DTCSoftwareCFO
+// achieves on the wall clock is only reported.
+
+#include <cmath>
+#include <iostream>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/DTCSoftwareCFO.h"
+#include "dtcInterfaceLib/RequestPacer.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+int main()
+{
+	TestChecks checks;
+
+	// 200 kHz, i.e. 5 us between requests; sending takes 2 us, which the schedule absorbs
+	auto clock = std::make_shared<SimulatedRequestClock>();
+	RequestPacer pacer(200000, std::chrono::microseconds(100), clock);
+	pacer.Start();
+	for (auto ii = 0; ii < 20000; ++ii)
+	{
+		pacer.Pace();
+		clock->Advance(std::chrono::microseconds(2));
+	}
+	pacer.Stop();
+	auto report = pacer.GetReport();
+	std::cout << "Pacer: " << pacer.FormatReport() << std::endl;
+	if (report.requests != 20000 || std::fabs(report.achievedRate - 200000) > 1 || report.latePaces != 0 ||
+		std::fabs(report.elapsedSeconds - 0.099997) > 1e-8)
+	{
+		checks.Fail() << "pacer did not hold 200 kHz" << std::endl;
+	}
+
+	// Sending takes 10 us: every request after the first is late, and the pacer sends as fast as it can
+	pacer.Start();
+	for (auto ii = 0; ii < 1000; ++ii)
+	{
+		pacer.Pace();
+		clock->Advance(std::chrono::microseconds(10));
+	}
+	pacer.Stop();
+	report = pacer.GetReport();
+	std::cout << "Pacer, slow sender: " << pacer.FormatReport() << std::endl;
+	if (report.latePaces != 999 || std::fabs(report.achievedRate - 100000) > 1 || std::fabs(report.maximumLatenessUs - 4995) > 0.01)
+	{
+		checks.Fail() << "slow sender" << std::endl;
+	}
+
+	// A rate change restarts the schedule at the next request: 999 intervals of 5 us, then 999 of 50 us
+	pacer.SetRate(200000);
+	pacer.Start();
+	for (auto ii = 0; ii < 1000; ++ii) pacer.Pace();
+	pacer.SetRate(20000);
+	for (auto ii = 0; ii < 1000; ++ii) pacer.Pace();
+	pacer.Stop();
+	report = pacer.GetReport();
+	auto expectedSeconds = 999 / 200000.0 + 999 / 20000.0;
+	if (std::fabs(report.elapsedSeconds - expectedSeconds) > 1e-8 || report.latePaces != 0)
+	{
+		checks.Fail() << "rate change: " << report.elapsedSeconds << " s instead of " << expectedSeconds << " s" << std::endl;
+	}
+
+	// Two DCS writes packed into one DMA both reach the ROC
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+	std::vector<DTC_DataPacket> packets;
+	packets.push_back(DTC_DCSRequestPacket(DTC_Link_0, DTC_DCSOperationType_Write, false, false, 20, 0x1234).ConvertToDataPacket());
+	packets.push_back(DTC_DCSRequestPacket(DTC_Link_0, DTC_DCSOperationType_Write, false, false, 21, 0x5678).ConvertToDataPacket());
+	auto dmas = thisDTC.WriteDMAPackets(packets);
+	if (dmas != 1 || thisDTC.ReadROCRegister(DTC_Link_0, 20, 100) != 0x1234 || thisDTC.ReadROCRegister(DTC_Link_0, 21, 100) != 0x5678)
+	{
+		checks.Fail() << "packed DCS writes (" << dmas << " DMAs)" << std::endl;
+	}
+
+	// Bursts of 64 event windows per DMA, at 20 kHz on the wall clock
+	DTCSoftwareCFO theCFO(&thisDTC, false, 0, DTC_DebugType_SpecialSequence, true, true /* quiet */, true /* asyncRR */);
+	theCFO.setBurstSize(64);
+	theCFO.setRequestRate(20000);
+	theCFO.SendRequestsForRange(2000, DTC_EventWindowTag(static_cast<uint64_t>(1)), true, 0, 1, 4);
+	theCFO.WaitForCompletion();
+	report = theCFO.GetRateReport();
+	std::cout << "Bursts: " << theCFO.FormatRateReport() << std::endl;
+	if (report.requests != 2000 || report.paces != (2000 + 63) / 64 || report.requestedRate != 20000)
+	{
+		checks.Fail() << "DTCSoftwareCFO bursts" << std::endl;
+	}
+
+	return checks.Finish();
+}
@@ -0,0 +1,135 @@
+// Request schedule test. Checks the time structure of each schedule (spill cycle, Poisson, bursty, replay), that
+// schedules repeat after Reset, and that DTCSoftwareCFO follows a schedule on the simulated DTC (mu2esim), also over
+// consecutive asynchronous ranges, where the heartbeats must carry the same tags as the data requests.
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/DTCSoftwareCFO.h"
+#include "dtcInterfaceLib/RequestSchedule.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+int main()
+{
+	TestChecks checks;
+	RequestScheduleEntry entry;
+
+	// Spill cycle: one request per microbunch in each spill, a gap between spills, and the rest of the cycle off
+	auto spill = RequestSchedule::Create("spill");
+	std::cout << spill->Describe() << std::endl;
+	uint64_t perSpill = 43100000 / 1695, spillStarts = 0, previous = 0;
+	for (uint64_t ii = 0; ii < 9 * perSpill; ++ii)
+	{
+		spill->Next(entry);
+		if (ii > 0 && entry.timeNs - previous != 1695)
+		{
+			++spillStarts;
+			if (ii == 8 * perSpill && entry.timeNs != 1400000000) checks.Check("second cycle starts at 1.4 s", false);
+			if (ii < 8 * perSpill && entry.timeNs != (ii / perSpill) * 48100000) checks.Check("spill " + std::to_string(ii / perSpill) + " start", false);
+		}
+		if (entry.tag != ii) checks.Check("spill cycle tags are consecutive", false);
+		previous = entry.timeNs;
+	}
+	checks.Check("spill cycle has 8 spills per cycle", spillStarts == 8);
+
+	// Poisson: mean interval close to 1/rate, coefficient of variation close to 1, and the same times after Reset
+	PoissonRequestSchedule poisson(100000, 42);
+	std::vector<uint64_t> times;
+	for (auto ii = 0; ii < 100000; ++ii)
+	{
+		poisson.Next(entry);
+		times.push_back(entry.timeNs);
+	}
+	double sum = 0, sumOfSquares = 0;
+	for (size_t ii = 1; ii < times.size(); ++ii)
+	{
+		double interval = times[ii] - times[ii - 1];
+		sum += interval;
+		sumOfSquares += interval * interval;
+	}
+	auto mean = sum / (times.size() - 1);
+	auto cv = std::sqrt(sumOfSquares / (times.size() - 1) - mean * mean) / mean;
+	std::cout << "Poisson: mean interval " << mean << " ns, coefficient of variation " << cv << std::endl;
+	checks.Check("Poisson mean interval", std::fabs(mean - 10000) < 200);
+	checks.Check("Poisson interval spread", std::fabs(cv - 1) < 0.05);
+	poisson.Reset();
+	auto repeats = true;
+	for (auto ii = 0; ii < 1000; ++ii) repeats = repeats && poisson.Next(entry) && entry.timeNs == times[ii];
+	checks.Check("Poisson schedule repeats after Reset", repeats);
+
+	// Bursty: 1 MHz for 25% of each 100 us period, i.e. 25 requests per period
+	auto bursty = RequestSchedule::Create("bursty:1000000:100:0.25");
+	std::cout << bursty->Describe() << std::endl;
+	auto burstyOk = true;
+	for (auto ii = 0; ii < 100; ++ii)
+	{
+		bursty->Next(entry);
+		burstyOk = burstyOk && entry.timeNs == static_cast<uint64_t>((ii / 25) * 100000 + (ii % 25) * 1000);
+	}
+	checks.Check("bursty schedule on/off structure", burstyOk);
+
+	// Replay: explicit times, and times filled in at the spacing
+	TestTemporaryFile replayFile(".txt");
+	auto const& fileName = replayFile.Path();
+	{
+		std::ofstream file(fileName);
+		file << "# tag time_ns" << std::endl
+			 << "100 0" << std::endl
+			 << "105 5000" << std::endl
+			 << "106" << std::endl
+			 << "200 1000000" << std::endl;
+	}
+	auto replay = RequestSchedule::Create("replay:" + fileName + ":2000");
+	std::vector<RequestScheduleEntry> replayed;
+	while (replay->Next(entry)) replayed.push_back(entry);
+	checks.Check("replay of a request list", replayed.size() == 4 && replayed[1].tag == 105 && replayed[2].timeNs == 7000 && replayed[3].timeNs == 1000000);
+
+	try
+	{
+		RequestSchedule::Create("bursty:1000:100");
+		checks.Check("invalid specification throws", false);
+	}
+	catch (std::exception const&)
+	{
+		checks.Check("invalid specification throws", true);
+	}
+
+	// DTCSoftwareCFO on the replayed list: tags from the list, times from the list, and no more requests than listed
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+	DTCSoftwareCFO theCFO(&thisDTC, false, 0, DTC_DebugType_SpecialSequence, true, true /* quiet */, true /* asyncRR */);
+	theCFO.setRequestSchedule(std::shared_ptr<RequestSchedule>(std::move(replay)));
+	theCFO.SendRequestsForRange(10, DTC_EventWindowTag(static_cast<uint64_t>(0)), true, 0, 1, 4);
+	theCFO.WaitForCompletion();
+	auto report = theCFO.GetRateReport();
+	std::cout << "Replay: " << theCFO.FormatRateReport() << std::endl;
+	checks.Check("DTCSoftwareCFO follows the replayed schedule", report.requests == 4 && report.elapsedSeconds >= 0.001);
+
+	// The simulated DTC only builds an event when a data request follows a heartbeat with the same tag, so each
+	// asynchronous range (heartbeat pass, then data request pass) builds one event per entry of the schedule
+	auto builtEvents = [&]() {
+		auto events = 0;
+		void* buffer;
+		while (thisDTC.GetDevice()->read_data(DTC_DMA_Engine_DAQ, &buffer, 10) > 0)
+		{
+			thisDTC.GetDevice()->read_release(DTC_DMA_Engine_DAQ, 1);
+			++events;
+		}
+		return events;
+	};
+	auto firstRangeEvents = builtEvents();
+	theCFO.SendRequestsForRange(10, DTC_EventWindowTag(static_cast<uint64_t>(0)), true, 0, 1, 0);
+	theCFO.WaitForCompletion();
+	auto secondRangeEvents = builtEvents();
+	std::cout << "Events built: " << firstRangeEvents << " in the first range, " << secondRangeEvents << " in the second" << std::endl;
+	checks.Check("first range heartbeat tags match the data request tags", firstRangeEvents == 4);
+	checks.Check("second range heartbeat tags match the data request tags",
+				 secondRangeEvents == 4 && theCFO.GetProgress().currentTag == 200 && theCFO.GetRateReport().requests == 4);
+	std::remove(fileName.c_str());
+
+	return checks.Finish();
+}
@@ -0,0 +1,147 @@
+// Request throttle test. Checks the control loop on a modelled buffer (it settles at the drain rate, finds it as the
+// maximum sustainable rate, and backs off on drops), the DDR3 flag and host ring readout on the simulated DTC
+// (mu2esim), and a closed loop of paced requests against a reader draining the simulated ring at a fixed rate. The
+// closed loop runs on a simulated clock in one thread, so its result does not depend on the load of the machine.
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/DTCSoftwareCFO.h"
+#include "dtcInterfaceLib/RequestThrottle.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+namespace {
+// Buffer of the given capacity, drained at a fixed rate, sampled every 10 ms with the resolution of the DDR3 flags
+void RunModel(RequestThrottle& throttle, double& events, uint64_t& drops, double drainRate, double capacity, int samples)
+{
+	for (auto ii = 0; ii < samples; ++ii)
+	{
+		auto rate = throttle.GetRate();
+		events = std::max(0.0, events + (rate - drainRate) * 0.01);
+		if (events > capacity)
+		{
+			drops += static_cast<uint64_t>(events - capacity);
+			events = capacity;
+		}
+		RequestThrottleSample sample;
+		sample.ddrFill = std::floor(events / capacity * 512) / 512;
+		sample.fullBuffers = events >= capacity ? 128 : 0;
+		sample.drops = drops;
+		throttle.Update(sample, rate);
+	}
+}
+}  // namespace
+
+int main()
+{
+	TestChecks checks;
+
+	// Control loop: 50 kHz drain, 0.4 s of buffering
+	RequestThrottle model(nullptr);
+	double events = 0;
+	uint64_t drops = 0;
+	RunModel(model, events, drops, 50000, 20000, 1000);
+	auto report = model.GetReport();
+	std::cout << "Model: " << model.FormatReport() << std::endl;
+	checks.Check("rate settles at the drain rate", std::fabs(report.rate - 50000) < 1000);
+	checks.Check("occupancy held at the target", std::fabs(events / 20000 - 0.5) < 0.05 && report.maximumOccupancy < 0.6);
+	checks.Check("maximum sustainable rate is the drain rate", std::fabs(report.maximumSustainableRate - 50000) < 2500);
+	checks.Check("no overflow", report.overflowSamples == 0 && report.drops == 0);
+
+	// The drain slows down: the buffer rises past the target, and the rate settles at the new drain rate
+	RunModel(model, events, drops, 20000, 20000, 1000);
+	report = model.GetReport();
+	std::cout << "Model, slower drain: " << model.FormatReport() << std::endl;
+	checks.Check("rate settles at the slower drain rate", std::fabs(report.rate - 20000) < 1000);
+
+	// Drops cut the rate by the backoff factor
+	RequestThrottleSample sample;
+	auto rate = model.GetRate();
+	sample.drops = drops + 10;
+	model.Update(sample, rate);
+	checks.Check("backoff on drops", std::fabs(model.GetRate() - 0.5 * rate) < 1e-6 * rate);
+
+	// Readout on the simulated DTC: 64-byte DDR3 buffers, so that a few hundred unread events fill them all
+	setenv("DTCLIB_SIM_DDR_BUFFER_BYTES", "64", 1);
+	{
+		DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+		RequestThrottle throttle(&thisDTC);
+		DTCSoftwareCFO theCFO(&thisDTC, false, 0, DTC_DebugType_SpecialSequence, true, true /* quiet */, true /* asyncRR */);
+
+		auto empty = throttle.Sample();
+		checks.Check("simulated buffers start empty", empty.GetOccupancy() == 0 && empty.fullBuffers == 0);
+
+		theCFO.SendRequestsForRange(20, DTC_EventWindowTag(static_cast<uint64_t>(1)), true, 0, 1, 0);
+		theCFO.WaitForCompletion();
+		auto ring = throttle.Sample();
+		std::cout << "20 events: ring " << ring.ringFill << ", DDR " << ring.ddrFill << std::endl;
+		checks.Check("events wait in the host ring first", ring.ringFill == 0.5 && ring.ddrFill == 0);
+
+		theCFO.SendRequestsForRange(2000, DTC_EventWindowTag(static_cast<uint64_t>(21)), true, 0, 1, 0);
+		theCFO.WaitForCompletion();
+		auto full = throttle.Sample();
+		std::cout << "2020 events: ring " << full.ringFill << ", DDR " << full.ddrFill << ", " << full.fullBuffers
+				  << " full buffers, " << full.drops << " drops" << std::endl;
+		checks.Check("DDR3 buffers fill and drop", full.ringFill == 1 && full.ddrFill == 1 && full.fullBuffers == 128 && full.drops > 0);
+
+		auto device = thisDTC.GetDevice();
+		for (auto ii = 0; ii < 3000 && throttle.Sample().GetOccupancy() > 0; ++ii)
+		{
+			void* buffer;
+			device->read_data(DTC_DMA_Engine_DAQ, &buffer, 1);
+			device->read_release(DTC_DMA_Engine_DAQ, 1);
+		}
+		auto drained = throttle.Sample();
+		checks.Check("reading drains the buffers", drained.GetOccupancy() == 0 && drained.fullBuffers == 0);
+	}
+	unsetenv("DTCLIB_SIM_DDR_BUFFER_BYTES");
+
+	// Closed loop: a reader drains the simulated ring at 1 kHz; the throttle holds it half full (20 events, 20 ms).
+	// The requests, the samples and the reader all follow the simulated clock: pacing moves it to the next deadline,
+	// and the reader then takes the events due by that time.
+	{
+		DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+		DTCSoftwareCFO theCFO(&thisDTC, false, 0, DTC_DebugType_SpecialSequence, true, true /* quiet */, false /* asyncRR */);
+		auto clock = std::make_shared<SimulatedRequestClock>();
+		RequestThrottleParameters parameters;
+		parameters.initialRate = 200;
+		parameters.samplePeriod = std::chrono::milliseconds(2);
+		parameters.sustainSamples = 20;
+		RequestThrottle throttle(&thisDTC, parameters, clock);
+		RequestPacer pacer(throttle.GetRate(), std::chrono::microseconds(100), clock);
+
+		auto device = thisDTC.GetDevice();
+		uint64_t readerPolls = 0;
+		pacer.Start();
+		for (uint64_t tag = 1; tag <= 3000; ++tag)
+		{
+			throttle.Poll(pacer);
+			pacer.Pace();
+			theCFO.SendRequestForTimestamp(DTC_EventWindowTag(tag), 0);
+
+			// The reader polls every millisecond, and takes one event if there is any
+			for (auto due = static_cast<uint64_t>(pacer.GetReport().elapsedSeconds * 1000); readerPolls < due; ++readerPolls)
+			{
+				unsigned filled = 0, size = 0;
+				void* buffer;
+				if (device->read_ring_occupancy(DTC_DMA_Engine_DAQ, &filled, &size) == 0 && filled > 0 &&
+					device->read_data(DTC_DMA_Engine_DAQ, &buffer, 1) > 0)
+					device->read_release(DTC_DMA_Engine_DAQ, 1);
+			}
+		}
+		pacer.Stop();
+
+		auto closedLoop = throttle.GetReport();
+		std::cout << "Closed loop: " << throttle.FormatReport() << std::endl;
+		std::cout << "Closed loop: " << pacer.FormatReport() << std::endl;
+		checks.Check("closed loop samples the DTC", closedLoop.samples > 100);
+		checks.Check("closed loop finds a sustainable rate near the reader's", closedLoop.maximumSustainableRate > 500 && closedLoop.maximumSustainableRate < 2000);
+		checks.Check("closed loop does not drop", closedLoop.drops == 0 && closedLoop.overflowSamples == 0);
+	}
+
+	return checks.Finish();
+}
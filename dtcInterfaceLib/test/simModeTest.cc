@@ -0,0 +1,31 @@
+// Sim mode setup test on the simulated DTC (mu2esim). Checks that a DTC configured by SetSimMode verifies clean, that
+// VerifySimMode reports a register changed since without writing it, and that the DTC verifies clean once restored.
+
+#include <iostream>
+
+#include "dtcInterfaceLib/DTC.h"
+#include "dtcInterfaceLib/test/TestChecks.h"
+
+using namespace DTCLib;
+
+int main()
+{
+	TestChecks checks;
+
+	DTC thisDTC(DTC_SimMode_Performance, 0, 0x1);
+	checks.Check("configured DTC verifies clean", thisDTC.VerifySimMode(0x1).empty());
+
+	thisDTC.DisableLink(DTC_Link_0);
+	auto differences = thisDTC.VerifySimMode(0x1);
+	for (auto const& difference : differences)
+		std::cout << "    0x" << std::hex << difference.address << ": 0x" << difference.current << " instead of 0x" << difference.target
+				  << std::dec << std::endl;
+	checks.Check("disabled link is reported", differences.size() == 1 && differences[0].address == CFOandDTC_Register_LinkEnable);
+	auto link0 = thisDTC.ReadLinkEnabled(DTC_Link_0);
+	checks.Check("verifying does not write", !link0.TransmitEnable && !link0.ReceiveEnable);
+
+	thisDTC.EnableLink(DTC_Link_0, DTC_LinkEnableMode(true, true));
+	checks.Check("restored DTC verifies clean", thisDTC.VerifySimMode(0x1).empty());
+
+	return checks.Finish();
+}